@@ -17,6 +17,7 @@
 
 #include <dynamo/BC/LEBC.hpp>
 #include <dynamo/simulation.hpp>
+#include <dynamo/checkpoint.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
 #include <cmath>
@@ -103,6 +104,20 @@ namespace dynamo {
     _dxd -= floor(_dxd/Sim->primaryCellSize[0])*Sim->primaryCellSize[0];
   }
 
+  void
+  BCLeesEdwards::saveCheckpoint(CheckpointWriter& out) const
+  {
+    out.tag("LEBC");
+    out.write(_dxd);
+  }
+
+  void
+  BCLeesEdwards::loadCheckpoint(CheckpointReader& in)
+  {
+    in.tag("LEBC");
+    in.read(_dxd);
+  }
+
   Vector
   BCLeesEdwards::getStreamVelocity(const Particle& part) const
   { return Vector{part.getPosition()[1] * _shearRate, 0, 0}; }
@@ -50,6 +50,10 @@ namespace dynamo {
 
     virtual void update(const double&);
 
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    virtual void loadCheckpoint(CheckpointReader&);
+
     /*! \brief Returns the shear rate of the boundaries. */
     inline double getShearRate() const { return _shearRate; }
 
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <dynamo/2particleEventData.hpp>
+#include <magnet/memory/pool.hpp>
 #include <list>
 
 namespace dynamo {
@@ -31,7 +32,9 @@ namespace dynamo {
     NEventData&  operator+=(const ParticleEventData& p) { L1partChanges.push_back(p); return *this; }
     NEventData&  operator+=(const PairEventData& p) { L2partChanges.push_back(p); return *this; }
 
-    std::list<ParticleEventData> L1partChanges;
-    std::list<PairEventData> L2partChanges;
+    //A NEventData is created for every event, so the list nodes are
+    //taken from the memory pools
+    std::list<ParticleEventData, magnet::memory::PoolAllocator<ParticleEventData> > L1partChanges;
+    std::list<PairEventData, magnet::memory::PoolAllocator<PairEventData> > L2partChanges;
   };
 }
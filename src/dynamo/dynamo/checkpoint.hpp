@@ -0,0 +1,159 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <magnet/exception.hpp>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief A binary archive for the dynamic state of a Simulation.
+
+    Checkpoints hold the state which is not stored in (or cannot be
+    exactly recovered from) the XML configuration file, such as the
+    contents of the event queue, the neighbour list occupancy and the
+    random number generator. Values are written in the native byte
+    order and memory layout, so a checkpoint can only be read by the
+    same build of DynamO that wrote it.
+
+    Each section of the archive starts with a named tag, which is
+    checked on reading to catch checkpoints which do not match the
+    configuration they are loaded with.
+   */
+  class CheckpointWriter
+  {
+  public:
+    CheckpointWriter(std::ostream& os): _os(os) {}
+
+    template<class T>
+    void write(const T& val)
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written directly");
+      _os.write(reinterpret_cast<const char*>(&val), sizeof(T));
+    }
+
+    template<class T>
+    void write(const std::vector<T>& vec)
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "Only vectors of trivially copyable types can be written directly");
+      write(uint64_t(vec.size()));
+      _os.write(reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(T));
+    }
+
+    void write(const std::string& str)
+    {
+      write(uint64_t(str.size()));
+      _os.write(str.data(), str.size());
+    }
+
+    //! \brief Mark the start of a section of the checkpoint.
+    void tag(const std::string& name) { write(name); }
+
+    bool good() const { return bool(_os); }
+
+  private:
+    std::ostream& _os;
+  };
+
+  /*! \brief Reads the archives written by CheckpointWriter.
+   */
+  class CheckpointReader
+  {
+  public:
+    CheckpointReader(std::istream& is, const std::string& name): _is(is), _name(name) {}
+
+    template<class T>
+    void read(T& val)
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read directly");
+      readBytes(reinterpret_cast<char*>(&val), sizeof(T));
+    }
+
+    template<class T>
+    void read(std::vector<T>& vec)
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "Only vectors of trivially copyable types can be read directly");
+      uint64_t size;
+      read(size);
+      vec.resize(size);
+      readBytes(reinterpret_cast<char*>(vec.data()), size * sizeof(T));
+    }
+
+    /*! \brief Read a vector, which must already have the size of
+        the stored vector.
+
+      This is used for vectors of types which cannot be default
+      constructed, and to check the size of the stored vector.
+     */
+    template<class T>
+    void readFixed(std::vector<T>& vec)
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "Only vectors of trivially copyable types can be read directly");
+      if (read<uint64_t>() != vec.size())
+	M_throw() << "The checkpoint " << _name << " does not match the configuration";
+      readBytes(reinterpret_cast<char*>(vec.data()), vec.size() * sizeof(T));
+    }
+
+    void read(std::string& str)
+    {
+      uint64_t size;
+      read(size);
+      str.resize(size);
+      readBytes(&str[0], size);
+    }
+
+    template<class T>
+    T read() { T val; read(val); return val; }
+
+    /*! \brief Check the start of a section of the checkpoint.
+
+      \param name The name of the section which must be next in the
+      checkpoint.
+     */
+    void tag(const std::string& name)
+    {
+      uint64_t size;
+      read(size);
+      std::string val;
+      if (size <= name.size())
+	{
+	  val.resize(size);
+	  readBytes(&val[0], size);
+	}
+
+      if (val != name)
+	M_throw() << "The checkpoint " << _name << " is corrupt or does not match the configuration"
+		  << " (expected the " << name << " section)";
+    }
+
+    const std::string& getName() const { return _name; }
+
+  private:
+    void readBytes(char* data, const size_t bytes)
+    {
+      if (!_is.read(data, bytes))
+	M_throw() << "Unexpected end of the checkpoint " << _name;
+    }
+
+    std::istream& _is;
+    std::string _name;
+  };
+}
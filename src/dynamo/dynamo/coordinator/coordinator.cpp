@@ -21,7 +21,9 @@
 
 #include <dynamo/coordinator/coordinator.hpp>
 #include <dynamo/coordinator/engine/include.hpp>
+#include <algorithm>
 #include <cstdio>
+#include <thread>
 
 //Need special treatment for the ways signals are handled on different platforms
 #ifndef _WIN32
@@ -116,7 +118,7 @@ namespace dynamo {
       systemopts.add_options()
       ("help", "Produces this message")
       ("n-threads,N", po::value<unsigned int>(),
-       "Number of threads to spawn for concurrent processing. (Only utilised by certain engine/sim configurations)")
+       "Number of threads to spawn for concurrent processing, shared by the replica exchange engine and the parallel output plugins (e.g., VTK, RadialDistribution, SHCrystal). Defaults to one less than the number of hardware threads, as the main thread also takes part.")
       ("out-config-file,o", po::value<std::string>(),
        ("Default config output file,(config.%ID.end.xml"+extension+")").c_str())
       ("out-data-file", po::value<std::string>(),
@@ -173,6 +175,8 @@ namespace dynamo {
     
     if (vm.count("n-threads"))
       _threads.setThreadCount(vm["n-threads"].as<unsigned int>());
+    else
+      _threads.setThreadCount(std::max(std::thread::hardware_concurrency(), 1u) - 1);
 
     switch (vm["engine"].as<size_t>())
       {
@@ -20,6 +20,7 @@
 #include <dynamo/inputplugins/compression.hpp>
 #include <dynamo/systems/tHalt.hpp>
 #include <limits>
+#include <random>
 
 
 namespace dynamo {
@@ -49,6 +50,15 @@ namespace dynamo {
        "Sets the system time inbetween saving snapshots of the system.")
       ("snapshot-events", boost::program_options::value<size_t>(),
        "Sets the event count inbetween saving snapshots of the system.")
+      ("check-period", boost::program_options::value<double>(),
+       "Sets the system time inbetween checks of the system for invalid states (e.g., overlaps).")
+      ("async-plugins", "Run the output plugins which support it (e.g., CollisionMatrix, IntEnergyHist) on worker threads.")
+      ("checkpoint", "Also write a binary checkpoint (of the event queue, neighbour lists and random number generator) "
+       "next to the output configuration file, so that the run can be continued exactly using --resume.")
+      ("resume", boost::program_options::value<std::string>(),
+       "Continue the run from a checkpoint written using --checkpoint. The configuration file must be the "
+       "one written with the checkpoint.")
+      ("validate-resume", "Check the event queue of the checkpoint against freshly calculated events when resuming.")
       ;
   
     opts.add(simopts);
@@ -92,12 +102,33 @@ namespace dynamo {
     Sim.ranGenerator.seed(std::random_device()());
     if (vm.count("random-seed"))
       Sim.ranGenerator.seed(vm["random-seed"].as<unsigned int>());
+
+    //The output plugins share the threads of the Coordinator
+    Sim.setThreadPool(&threads);
   
     ////////////////////////Simulation Initialisation!!!!!!!!!!!!!
     //Now load the config
     Sim.loadXMLfile(filename.c_str());
+
+    //Every run draws new random number streams, so repeated runs of
+    //a configuration are independent. The replica index is mixed
+    //into the seed so the replicas never share streams, even when
+    //they are given the same seed.
+    std::seed_seq streamSeed{vm.count("random-seed") ? vm["random-seed"].as<unsigned int>() : std::random_device()(),
+	static_cast<unsigned int>(Sim.simID)};
+    streamSeed.generate(&Sim.randomStreamSeed, &Sim.randomStreamSeed + 1);
+
+    if (vm.count("resume"))
+      {
+	if (dynamic_cast<const EReplicaExchangeSimulation*>(this) != NULL)
+	  M_throw() << "Checkpoints can only be resumed in single simulation mode";
+	Sim.loadCheckpoint(vm["resume"].as<std::string>(), vm.count("validate-resume"));
+      }
     
+    //The events are counted from the start of this run
     Sim.endEventCount = vm["events"].as<size_t>();
+    if (Sim.endEventCount != std::numeric_limits<size_t>::max())
+      Sim.endEventCount += Sim.eventCount;
   
     if (vm["events"].as<size_t>() 
 	> vm["print-events"].as<size_t>())
@@ -118,5 +149,7 @@ namespace dynamo {
     if (!vm.count("equilibrate"))
       //Just add the bare minimum outputplugin
       Sim.addOutputPlugin("Misc");
+
+    Sim.asyncOutputPlugins = vm.count("async-plugins");
   }
 }
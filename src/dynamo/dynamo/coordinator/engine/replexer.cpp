@@ -22,6 +22,7 @@
 #include <dynamo/dynamics/dynamics.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/systems/snapshot.hpp>
+#include <dynamo/systems/integrityCheck.hpp>
 #include <magnet/thread/threadpool.hpp>
 #include <magnet/string/searchreplace.hpp>
 #include <fstream>
@@ -74,6 +75,9 @@ namespace dynamo {
   EReplicaExchangeSimulation::initialisation()
   {
     preSimInit();
+    if (vm.count("checkpoint"))
+      M_throw() << "Checkpoints can only be written in single simulation mode";
+
     for (unsigned int i = 0; i < nSims; i++)
       {
 	setupSim(Simulations[i], 
@@ -85,6 +89,11 @@ namespace dynamo {
 	if (vm.count("snapshot-events"))
 	  Simulations[i].systems.push_back(shared_ptr<System>(new SysSnapshot(&(Simulations[i]), vm["snapshot-events"].as<size_t>(), "SnapshotEventTimer", "%COUNTe", !vm.count("unwrapped"))));
 
+	//The simulations are already run in parallel, so each check is
+	//single threaded
+	if (vm.count("check-period"))
+	  Simulations[i].systems.push_back(shared_ptr<System>(new SysIntegrityCheck(&(Simulations[i]), vm["check-period"].as<double>(), "IntegrityCheck")));
+
 	Simulations[i].initialise();
 
 	postSimInit(Simulations[i]);
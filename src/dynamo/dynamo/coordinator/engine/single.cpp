@@ -18,7 +18,9 @@
 #include <dynamo/coordinator/coordinator.hpp>
 #include <dynamo/coordinator/engine/single.hpp>
 #include <dynamo/systems/snapshot.hpp>
+#include <dynamo/systems/integrityCheck.hpp>
 #include <dynamo/systems/visualizer.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <stdio.h>
 
 namespace dynamo {
@@ -104,6 +106,9 @@ namespace dynamo {
     if (vm.count("snapshot-events"))
       simulation.systems.push_back(shared_ptr<System>(new SysSnapshot(&simulation, vm["snapshot-events"].as<size_t>(), "SnapshotEventTimer", "%COUNTe", !vm.count("unwrapped"))));
 
+    if (vm.count("check-period"))
+      simulation.systems.push_back(shared_ptr<System>(new SysIntegrityCheck(&simulation, vm["check-period"].as<double>(), "IntegrityCheck")));
+
     simulation.initialise();
 
     postSimInit(simulation);
@@ -121,6 +126,16 @@ namespace dynamo {
   void
   ESingleSimulation::outputConfigs()
   {
-    simulation.writeXMLfile(configFormat.c_str(), !vm.count("unwrapped"));
+    if (vm.count("checkpoint"))
+      {
+	//The checkpoint is named after the configuration file
+	std::string stateFile = configFormat;
+	for (const std::string extension : {".bz2", ".xml"})
+	  if (boost::algorithm::ends_with(stateFile, extension))
+	    stateFile.erase(stateFile.size() - extension.size());
+	simulation.writeCheckpoint(configFormat, stateFile + ".state", !vm.count("unwrapped"));
+      }
+    else
+      simulation.writeXMLfile(configFormat.c_str(), !vm.count("unwrapped"));
   }
 }
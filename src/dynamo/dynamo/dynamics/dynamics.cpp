@@ -20,6 +20,7 @@
 #include <dynamo/simulation.hpp>
 #include <dynamo/NparticleEventData.hpp>
 #include <dynamo/units/units.hpp>
+#include <dynamo/checkpoint.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
 #include <cstring>
@@ -78,6 +79,13 @@ namespace dynamo {
       }
   }
 
+  void
+  Dynamics::SphereSphereInRoots(const Particle& p1, const Particle* const* p2, const double* d, double* dt, const size_t N) const
+  {
+    for (size_t i(0); i < N; ++i)
+      dt[i] = SphereSphereInRoot(p1, *p2[i], d[i]);
+  }
+
   NEventData
   Dynamics::enforceParabola(Particle&) const
   {
@@ -386,6 +394,24 @@ namespace dynamo {
       }
   }
 
+  void
+  Dynamics::saveCheckpoint(CheckpointWriter& out) const
+  {
+    out.tag("Dynamics");
+    out.write(partPecTime);
+    out.write(uint64_t(streamCount));
+    out.write(orientationData);
+  }
+
+  void
+  Dynamics::loadCheckpoint(CheckpointReader& in)
+  {
+    in.tag("Dynamics");
+    in.read(partPecTime);
+    streamCount = in.read<uint64_t>();
+    in.read(orientationData);
+  }
+
   void
   Dynamics::advanceUpdateParticle(Particle& part, double& dt) const
   {
@@ -28,6 +28,8 @@ namespace dynamo {
   class ParticleEventData;
   class NEventData;
   class Event;
+  class CheckpointWriter;
+  class CheckpointReader;
 
   /*! \brief Provides the primitivve event-detection and processing
    routines for all events.
@@ -141,6 +143,21 @@ namespace dynamo {
      */
     virtual double SphereSphereInRoot(const Particle& p1, const Particle& p2, double d) const = 0;
 
+    /*! \brief Determines if and when a sphere will intersect each
+      of N other spheres.
+
+      This is the batched form of \ref SphereSphereInRoot, used when
+      the events of a particle are predicted against its
+      neighbours. The default implementation tests each pair in
+      turn.
+     
+      \param p2 The N partner particles.
+      \param d The N interaction diameters/distances.
+      \param dt The N times of the next events, or
+      std::numeric_limits<float>::infinity() if no event.
+     */
+    virtual void SphereSphereInRoots(const Particle& p1, const Particle* const* p2, const double* d, double* dt, const size_t N) const;
+
     /*! \brief Determines if and when two spheres, around the center
       of masses of the supplied sets of particles, will
       intersect.
@@ -509,18 +526,23 @@ namespace dynamo {
 					   const double& e, const double& d,
 					   const EEventType& eType = CORE) const;
 
-    /*! \brief Tests for a collision between spherical particles
-      according to the ESMC (Enskog DSMC)
+    /*! \brief Calculates the probability of a collision between
+      spherical particles according to the ESMC (Enskog DSMC)
+
+      The acceptance of the collision is left to the caller, so that
+      it may draw from its own random number stream.
       
       \param p1 First particle to test
       \param p1 Second particle to test
-      \param maxprob The current maximum of the collision radius
+      \param factor The collision probability per unit approach
+      velocity.
       \param rij The vector seperating the two particles.
-      \return Whether the collision occurs
+      \return The collision probability, this is negative if the
+      particles are receding.
      */  
-    virtual bool DSMCSpheresTest(Particle& p1, Particle& p2,
-				 double& maxprob, const double& factor,
-				 Vector rij) const = 0;
+    virtual double DSMCSpheresProbability(Particle& p1, Particle& p2,
+					  const double& factor,
+					  Vector rij) const = 0;
   
     /*! \brief Performs a hard sphere collision between the two
       particles according to the ESMC (Enskog DSMC)
@@ -558,6 +580,9 @@ namespace dynamo {
      
       \param part The particle to reassign the velocities of.
       \param sqrtT The square root of the temperature.
+      \param normals Unit normal random numbers for each of the
+      dimensions, which are generated by the caller so that they may
+      be drawn in batches.
 
       \param dimensions This sets how many dimensions the thermostat
       should be applied in (1=x, 2=x&y, 3=x&y&z).
@@ -568,6 +593,7 @@ namespace dynamo {
      */
     virtual ParticleEventData randomGaussianEvent(Particle& part, 
 						  const double& sqrtT,
+						  const Vector& normals,
 						  const size_t dimensions) const = 0;
 
     /*! \brief An XML output operator for the class. Calls the virtual
@@ -672,6 +698,14 @@ namespace dynamo {
       orientationData = dynamicsdata.orientationData;
     }
 
+    /*! \brief Writes the delayed state and the orientations of the
+        particles to a checkpoint.
+     */
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    //! \brief Restores the state written by saveCheckpoint().
+    virtual void loadCheckpoint(CheckpointReader&);
+
   protected:
     friend class GCellsShearing;
 
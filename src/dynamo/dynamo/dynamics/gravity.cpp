@@ -103,6 +103,48 @@ namespace dynamo {
     return magnet::intersection::parabola_sphere(r12, v12, g12, d);
   }
 
+  void
+  DynGravity::SphereSphereInRoots(const Particle& p1, const Particle* const* p2, const double* d, double* dt, const size_t N) const
+  {
+    //Pairs where both particles feel gravity (or both don't) have
+    //ballistic relative motion. The remaining pairs are gathered in
+    //blocks, and their parabolic ray and sphere intersections are
+    //solved together.
+    const bool p1Dynamic = p1.testState(Particle::DYNAMIC);
+    const size_t blocksize = 64;
+    Vector r12[blocksize], v12[blocksize], g12[blocksize];
+    double diameters[blocksize], times[blocksize];
+    size_t lanes[blocksize];
+
+    for (size_t start(0); start < N; start += blocksize)
+      {
+	const size_t end = std::min(N, start + blocksize);
+	size_t n = 0;
+	for (size_t i(start); i < end; ++i)
+	  {
+	    const bool p2Dynamic = p2[i]->testState(Particle::DYNAMIC);
+	    if (p1Dynamic == p2Dynamic)
+	      {
+		dt[i] = DynNewtonian::SphereSphereInRoot(p1, *p2[i], d[i]);
+		continue;
+	      }
+
+	    r12[n] = p1.getPosition() - p2[i]->getPosition();
+	    v12[n] = p1.getVelocity() - p2[i]->getVelocity();
+	    Sim->BCs->applyBC(r12[n], v12[n]);
+	    //Get the sign right on the acceleration
+	    g12[n] = g;
+	    if (p2Dynamic) g12[n] = -g;
+	    diameters[n] = d[i];
+	    lanes[n++] = i;
+	  }
+
+	magnet::intersection::parabola_sphere(r12, v12, g12, diameters, times, n);
+	for (size_t k(0); k < n; ++k)
+	  dt[lanes[k]] = times[k];
+      }
+  }
+
   double
   DynGravity::SphereSphereInRoot(const IDRange& p1, const IDRange& p2, double d) const
   {
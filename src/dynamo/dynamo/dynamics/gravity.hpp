@@ -31,6 +31,7 @@ namespace dynamo {
     void initialise();
     const Vector& getGravityVector() const { return g; }
     virtual double SphereSphereInRoot(const Particle& p1, const Particle& p2, double d) const;
+    virtual void SphereSphereInRoots(const Particle& p1, const Particle* const* p2, const double* d, double* dt, const size_t N) const;
     virtual double SphereSphereInRoot(const IDRange& p1, const IDRange& p2, double d) const;
     virtual double SphereSphereOutRoot(const Particle& p1, const Particle& p2, double d) const;
     virtual double SphereSphereOutRoot(const IDRange& p1, const IDRange& p2, double d) const;
@@ -27,7 +27,7 @@
 
 namespace dynamo {
   DynNewtonianMCCMap::DynNewtonianMCCMap(dynamo::Simulation* tmp, const magnet::xml::Node& XML):
-    DynNewtonian(tmp)
+    DynNewtonian(tmp), _tethers_hash(0), _tethers_valid(false)
   {
     _interaction_name = XML.getAttribute("Interaction");
 
@@ -45,9 +45,14 @@ namespace dynamo {
 		= entry_node.getAttribute("State").as<size_t>();
 
 	    if (distance)
-	      _W.push_back(std::make_pair(map, WData(distance, Wval)));
+	      _W.push_back(std::make_pair(detail::CaptureMapKey(map), WData(distance, Wval)));
 	    else {
-	      _single_W[map] = WData(0, Wval);
+	      const detail::CaptureMapKey key(map);
+	      auto it = _single_W.find(key.hash());
+	      if ((it != _single_W.end()) && !(it->second.first == key))
+		M_throw() << "Two of the single maps have the same hash, cannot look them up by their hash";
+	      _single_W.erase(key.hash());
+	      _single_W.insert(std::make_pair(key.hash(), std::make_pair(key, WData(0, Wval))));
 	    }
 	  }
       }
@@ -64,8 +69,9 @@ namespace dynamo {
 	<< magnet::xml::attr("Interaction") << _interaction_name
 	<< magnet::xml::tag("Potential");
 
-    for (const auto& entry : _single_W)
+    for (const auto& hashentry : _single_W)
       {
+	const auto& entry = hashentry.second;
 	XML << magnet::xml::tag("Map")
 	    << magnet::xml::attr("W") << entry.second._wval
 	    << magnet::xml::attr("Distance") << entry.second._distance
@@ -80,7 +86,7 @@ namespace dynamo {
 	XML << magnet::xml::endtag("Map");
       }
     
-    for (const auto entry : _W)
+    for (const auto& entry : _W)
       {
 	XML << magnet::xml::tag("Map")
 	    << magnet::xml::attr("W") << entry.second._wval
@@ -107,6 +113,14 @@ namespace dynamo {
       M_throw() << "Multi-canonical simulations require an NVT ensemble";
     
     _interaction = std::dynamic_pointer_cast<ICapture>(Sim->interactions[_interaction_name]);
+
+    if (!_interaction)
+      M_throw() << "Could not cast \"" << _interaction_name << "\" to an ICapture type for the multi-canonical contact map";
+
+    _tethers = detail::TetherIndex();
+    for (const auto& tether : _W)
+      _tethers.addTether(tether.first, tether.second._distance, tether.second._wval);
+    _tethers_valid = false;
   }
 
 
@@ -140,15 +154,30 @@ namespace dynamo {
     //Calculate the deformed energy change of the system (the one used in the dynamics)
     double MCDeltaKE = deltaKE;
 
+    //Only the events of the tracked interaction change its contact map
+    const bool tracked = (event._source == INTERACTION) && (event._sourceID == _interaction->getID());
+    const detail::PairKey key(particle1.getID(), particle2.getID());
+    const bool toggles = tracked && (!_interaction->isCaptured(particle1, particle2) != !newstate);
+    const uint64_t hash = _interaction->hash();
+    const uint64_t newhash = tracked ? _interaction->hash(key, newstate) : hash;
+
+    if (!_tethers_valid || (_tethers_hash != hash))
+      {
+	_tethers.reset(*_interaction);
+	_tethers_hash = hash;
+	_tethers_valid = true;
+      }
+
     //If there are entries for the current and possible future energy, then take them into account
-    detail::CaptureMap contact_map = *_interaction;
+    std::pair<size_t, double> tethers(_tethers.applicable(), _tethers.applicableW());
     
     //Add the current bias potential
-    MCDeltaKE += W(contact_map) * Sim->ensemble->getEnsembleVals()[2];
+    MCDeltaKE += W(tethers.first, tethers.second, hash) * Sim->ensemble->getEnsembleVals()[2];
 
     //subtract the possible bias potential in the new state
-    contact_map[detail::CaptureMap::key_type(particle1, particle2)] = newstate;
-    MCDeltaKE -= W(contact_map) * Sim->ensemble->getEnsembleVals()[2];
+    if (toggles)
+      tethers = _tethers.trial(key, newstate);
+    MCDeltaKE -= W(tethers.first, tethers.second, newhash) * Sim->ensemble->getEnsembleVals()[2];
 
     //Test if the deformed energy change allows a capture event to occur
     double sqrtArg = retVal.rvdot * retVal.rvdot + 2.0 * R2 * MCDeltaKE / mu;
@@ -162,6 +191,11 @@ namespace dynamo {
       {
 	retVal.particle1_.setDeltaU(-0.5 * deltaKE);
 	retVal.particle2_.setDeltaU(-0.5 * deltaKE);	  
+
+	//The interaction will now set the new state of the pair
+	if (toggles)
+	  _tethers.update(key, newstate);
+	_tethers_hash = newhash;
       
 	if (retVal.rvdot < 0)
 	  retVal.impulse = retVal.rij 
@@ -193,6 +227,21 @@ namespace dynamo {
 
     DynNewtonianMCCMap& ol(static_cast<DynNewtonianMCCMap&>(oDynamics));
     std::swap(_W, ol._W);
+    _tethers.swap(ol._tethers);
+    _tethers_valid = ol._tethers_valid = false;
+  }
+
+  double 
+  DynNewtonianMCCMap::W(size_t applicable_tethers, double accumilated_W, uint64_t hash) const
+  {
+    auto it = _single_W.find(hash);
+
+    if (it != _single_W.end()) {
+      ++applicable_tethers;
+      accumilated_W += it->second.second._wval;
+    }
+
+    return accumilated_W / (applicable_tethers + (applicable_tethers==0));
   }
 
   double 
@@ -203,20 +252,14 @@ namespace dynamo {
     size_t applicable_tethers = 0;
     double accumilated_W = 0;
 
-    auto it = _single_W.find(detail::CaptureMapKey(map));
-
-    if (it != _single_W.end()) {
-      ++applicable_tethers;
-      accumilated_W += it->second._wval;
-    }
-      
-    for (auto tethermap : _W)
+    const detail::CaptureMapKey sorted_map(map);
+    for (const auto& tethermap : _W)
       {
 	auto il = tethermap.first.begin();
-	auto ir = map.begin();
+	auto ir = sorted_map.begin();
 	
 	size_t distance = 0;
-	while (il != tethermap.first.end() && ir != map.end())
+	while (il != tethermap.first.end() && ir != sorted_map.end())
 	  {
 	    if ((*il).first < (*ir).first)
 	      {
@@ -235,17 +278,7 @@ namespace dynamo {
 	      }
 	  }
 
-	while (il != tethermap.first.end())
-	  {
-	    ++il;
-	    ++distance;
-	  }
-
-	while (ir != map.end())
-	  {
-	    ++ir;
-	    ++distance;
-	  }
+	distance += (tethermap.first.end() - il) + (sorted_map.end() - ir);
 
 	if (distance <= tethermap.second._distance)
 	  {
@@ -254,7 +287,137 @@ namespace dynamo {
 	  }
       }
 
-    return accumilated_W / (applicable_tethers + (applicable_tethers==0));
+    return W(applicable_tethers, accumilated_W, map.hash());
   }
 
+  namespace detail {
+    void
+    TetherIndex::addTether(const CaptureMapKey& map, size_t distance, double W)
+    {
+      const Tether tether = {map.size(), distance, W, 0};
+      for (const auto& entry : map)
+	_index[entry.first].push_back(_tethers.size());
+      _tethers.push_back(tether);
+    }
+
+    void
+    TetherIndex::reset(const CaptureMap& map)
+    {
+      _contacts = map.size();
+
+      std::vector<long> overlap(_tethers.size(), 0);
+      for (const auto& entry : map)
+	{
+	  auto it = _index.find(entry.first);
+	  if (it != _index.end())
+	    for (const size_t id : it->second)
+	      ++overlap[id];
+	}
+
+      //The scores of a tether lie in the range d_max-|T| to d_max+|T|
+      long lo = 0, hi = 0;
+      for (const Tether& tether : _tethers)
+	{
+	  lo = std::min(lo, long(tether._distance) - long(tether._size));
+	  hi = std::max(hi, long(tether._distance) + long(tether._size));
+	}
+      _offset = -lo;
+      _bins.assign(hi - lo + 1, Bin());
+
+      _applicable = 0;
+      _applicable_W = 0;
+      for (size_t id(0); id < _tethers.size(); ++id)
+	{
+	  Tether& tether = _tethers[id];
+	  tether._score = 2 * overlap[id] + long(tether._distance) - long(tether._size);
+	  Bin& bin = _bins[tether._score + _offset];
+	  ++bin._count;
+	  bin._W += tether._W;
+
+	  if (tether._score >= _contacts)
+	    {
+	      ++_applicable;
+	      _applicable_W += tether._W;
+	    }
+	}
+    }
+
+    const TetherIndex::Bin&
+    TetherIndex::bin(long score) const
+    {
+      static const Bin empty;
+      score += _offset;
+      return ((score < 0) || (score >= long(_bins.size()))) ? empty : _bins[score];
+    }
+
+    std::pair<size_t, double>
+    TetherIndex::trial(const PairKey& key, bool captured) const
+    {
+      /* Capturing the pair raises the threshold |M| by one, so the
+	 tethers with a score of |M| no longer apply, unless they
+	 contain the pair and their score rises by two. Releasing the
+	 pair lowers the threshold, so the tethers with a score of
+	 |M|-1 now apply, unless they contain the pair and their
+	 score falls by two.*/
+      const long m = _contacts;
+      const long edge = captured ? m : m - 1;
+      const Bin& moved = bin(edge);
+      const long sign = captured ? -1 : +1;
+      long count = long(_applicable) + sign * long(moved._count);
+      double W = _applicable_W + sign * moved._W;
+
+      auto it = _index.find(key);
+      if (it != _index.end())
+	for (const size_t id : it->second)
+	  {
+	    const Tether& tether = _tethers[id];
+	    if ((tether._score == m) || (tether._score == m - 1))
+	      {
+		count -= sign;
+		W -= sign * tether._W;
+	      }
+	  }
+
+      return std::make_pair(size_t(count), W);
+    }
+
+    void
+    TetherIndex::move(Tether& tether, long newscore)
+    {
+      Bin& oldbin = _bins[tether._score + _offset];
+      --oldbin._count;
+      oldbin._W -= tether._W;
+      tether._score = newscore;
+      Bin& newbin = _bins[tether._score + _offset];
+      ++newbin._count;
+      newbin._W += tether._W;
+    }
+
+    void
+    TetherIndex::update(const PairKey& key, bool captured)
+    {
+      const std::pair<size_t, double> result = trial(key, captured);
+      _applicable = result.first;
+      _applicable_W = result.second;
+
+      auto it = _index.find(key);
+      if (it != _index.end())
+	for (const size_t id : it->second)
+	  move(_tethers[id], _tethers[id]._score + (captured ? 2 : -2));
+
+      _contacts += captured ? 1 : -1;
+    }
+
+    void
+    TetherIndex::swap(TetherIndex& other)
+    {
+      std::swap(_tethers, other._tethers);
+      std::swap(_index, other._index);
+      std::swap(_bins, other._bins);
+      std::swap(_contacts, other._contacts);
+      std::swap(_applicable, other._applicable);
+      std::swap(_applicable_W, other._applicable_W);
+      std::swap(_offset, other._offset);
+    }
+  }
 }
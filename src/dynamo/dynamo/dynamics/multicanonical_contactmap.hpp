@@ -21,9 +21,92 @@
 #include <unordered_map>
 
 namespace dynamo {
+  namespace detail {
+    /*! \brief Tracks which of a set of tether maps lie within their
+      distance of a contact map, as the contact map changes.
+
+      The distance between a tether map T and the contact map M is the
+      number of pairs which are captured in only one of the two maps,
+      \f$d=|T|+|M|-2|T\cap M|\f$. A tether applies if
+      \f$d\le d_{max}\f$, which can be rearranged into a test on a
+      score of the tether, \f$2|T\cap M| + d_{max} - |T| \ge |M|\f$.
+
+      The score of a tether only changes when one of its own pairs is
+      captured or released, so an index from each pair to the tethers
+      containing it allows the scores to be updated without visiting
+      the other tethers. The tethers are binned by their score, and
+      the total weight of the applicable tethers is maintained as the
+      threshold \f$|M|\f$ moves. The cost of a capture or release is
+      therefore proportional to the number of tethers containing the
+      pair, and not to the number of tethers.
+
+      Only the presence of a pair in the maps is compared, not its
+      state.
+     */
+    class TetherIndex
+    {
+    public:
+      TetherIndex(): _contacts(0), _applicable(0), _applicable_W(0), _offset(0) {}
+
+      //! \brief Add a tether map, which applies within distance of the contact map.
+      void addTether(const CaptureMapKey& map, size_t distance, double W);
+
+      //! \brief Set the contact map, recalculating all scores.
+      void reset(const CaptureMap& map);
+
+      //! \brief The number of tethers which currently apply.
+      size_t applicable() const { return _applicable; }
+
+      //! \brief The summed weight of the tethers which currently apply.
+      double applicableW() const { return _applicable_W; }
+
+      /*! \brief The number and summed weight of the applicable tethers
+	if the pair were to be captured (or released if captured is false).
+       */
+      std::pair<size_t, double> trial(const PairKey& key, bool captured) const;
+
+      //! \brief Capture (or release) a pair in the tracked contact map.
+      void update(const PairKey& key, bool captured);
+
+      size_t size() const { return _tethers.size(); }
+
+      void swap(TetherIndex& other);
+
+    private:
+      struct Tether {
+	size_t _size;
+	size_t _distance;
+	double _W;
+	long _score;
+      };
+
+      struct Bin {
+	Bin(): _count(0), _W(0) {}
+	size_t _count;
+	double _W;
+      };
+
+      const Bin& bin(long score) const;
+      void move(Tether& tether, long newscore);
+
+      std::vector<Tether> _tethers;
+      std::unordered_map<PairKey, std::vector<size_t> > _index;
+      std::vector<Bin> _bins;
+      long _contacts;
+      size_t _applicable;
+      double _applicable_W;
+      long _offset;
+    };
+  }
+
   /*! \brief A Dynamics which implements Newtonian dynamics, but with
     a deformed energy landscape set controlled through an interaction
     contact map.
+
+    The bias of a single map is looked up by the hash of the contact
+    map maintained by the interaction, and the tether maps are tracked
+    by a \ref detail::TetherIndex, so neither requires a copy or scan
+    of the contact map for each event.
    */
   class DynNewtonianMCCMap: public DynNewtonian
   {
@@ -36,7 +119,19 @@ namespace dynamo {
 
     std::vector<std::pair<detail::CaptureMapKey, WData> > _W;
 
-    std::unordered_map<detail::CaptureMapKey, WData, detail::CaptureMapKeyHash> _single_W;
+    //! \brief The single maps, stored by their hash.
+    std::unordered_map<uint64_t, std::pair<detail::CaptureMapKey, WData> > _single_W;
+
+    /*! \brief The distances of the tether maps in _W to the contact
+      map of the interaction.
+
+      This is kept in step with the interaction as events are
+      executed, and is rebuilt if the hash of the contact map is not
+      the one expected (e.g., after a replica exchange).
+    */
+    mutable detail::TetherIndex _tethers;
+    mutable uint64_t _tethers_hash;
+    mutable bool _tethers_valid;
 
     std::string _interaction_name;
     std::shared_ptr<ICapture> _interaction;
@@ -48,9 +143,19 @@ namespace dynamo {
     virtual void initialise();
     virtual void replicaExchange(Dynamics& oDynamics);
 
+    /*! \brief The bias potential of a contact map.
+
+      This evaluates the bias from scratch, \ref SphereWellEvent
+      instead uses the incrementally maintained distances.
+    */
     double W(const detail::CaptureMap& map) const;
 
   protected:
     virtual void outputXML(magnet::xml::XmlStream& ) const;
+
+    /*! \brief Combine the bias of the applicable tethers with the
+      bias of the single map with the given hash.
+    */
+    double W(size_t applicable_tethers, double accumilated_W, uint64_t hash) const;
   };
 }
@@ -97,7 +97,7 @@ namespace dynamo {
 
   ParticleEventData 
   DynNewtonian::randomGaussianEvent(Particle& part, const double& sqrtT, 
-				  const size_t dimensions) const
+				  const Vector& normals, const size_t dimensions) const
   {
 #ifdef DYNAMO_DEBUG
     if (dimensions > NDIM)
@@ -119,10 +119,9 @@ namespace dynamo {
     double mass = Sim->species[tmpDat.getSpeciesID()]->getMass(part.getID());
     double factor = sqrtT / std::sqrt(mass);
 
-    std::normal_distribution<> norm_dist;
     //Assign the new velocities
     for (size_t iDim = 0; iDim < dimensions; iDim++)
-      part.getVelocity()[iDim] = norm_dist(Sim->ranGenerator) * factor;
+      part.getVelocity()[iDim] = normals[iDim] * factor;
 
     return tmpDat;
   }
@@ -324,27 +323,16 @@ namespace dynamo {
     return retVal;
   }
 
-  bool 
-  DynNewtonian::DSMCSpheresTest(Particle& p1, Particle& p2, double& maxprob, const double& factor, Vector rij) const
+  double
+  DynNewtonian::DSMCSpheresProbability(Particle& p1, Particle& p2, const double& factor, Vector rij) const
   {
     updateParticlePair(Sim->particles[p1.getID()], Sim->particles[p2.getID()]);
 
     Vector vij = p1.getVelocity() - p2.getVelocity();
     Sim->BCs->applyBC(rij, vij);
 
-    //Sim->BCs->applyBC(pdat.rij, pdat.vij);
-    double rvdot = (rij | vij);
-  
-    if (rvdot > 0)
-      return false; //Positive rvdot
-
-    double prob = factor * (-rvdot);
-
-    if (prob > maxprob)
-      maxprob = prob;
-
-    std::uniform_real_distribution<> uniform_dist;
-    return prob > uniform_dist(Sim->ranGenerator) * maxprob;
+    //A positive rvdot (a receding pair) gives a negative probability
+    return factor * (-(rij | vij));
   }
 
   PairEventData
@@ -48,7 +48,7 @@ namespace dynamo {
     virtual ParticleEventData runOscilatingPlate(Particle& part, const Vector& rw0, const Vector& nhat, double& delta, const double& omega0, const double& sigma, const double& mass, const double& e, double& t, bool strongPlate) const;
     virtual double getPBCSentinelTime(const Particle&, const double&) const;
     virtual PairEventData SmoothSpheresColl(Event&, const double&, const double&, const EEventType& eType) const;
-    virtual bool DSMCSpheresTest(Particle&, Particle&, double&, const double&, Vector) const;
+    virtual double DSMCSpheresProbability(Particle&, Particle&, const double&, Vector) const;
     virtual PairEventData DSMCSpheresRun(Particle&, Particle&, const double&, Vector) const;
     virtual PairEventData SphereWellEvent(Event&, const double&, const double&, size_t) const;
     virtual double getPlaneEvent(const Particle&, const Vector &, const Vector &, double) const;
@@ -57,7 +57,7 @@ namespace dynamo {
     virtual ParticleEventData runCylinderWallCollision(Particle&, const Vector &, const Vector &, const double&) const;
     virtual ParticleEventData runPlaneEvent(Particle&, const Vector &, const double, const double) const;
     virtual ParticleEventData runAndersenWallCollision(Particle&, const Vector &, const double& T, const double d, const double slip) const;
-    virtual ParticleEventData randomGaussianEvent(Particle&, const double&, const size_t) const;
+    virtual ParticleEventData randomGaussianEvent(Particle&, const double&, const Vector&, const size_t) const;
     virtual NEventData multibdyCollision(const IDRange&, const IDRange&, const double&, const EEventType&) const;
     virtual NEventData multibdyWellEvent(const IDRange&, const IDRange&, const double&, const double&, EEventType&) const;
     virtual PairEventData parallelCubeColl(Event& event, const double& e, const double& d, const EEventType& eType = CORE) const;
@@ -54,7 +54,7 @@ namespace dynamo {
     virtual int getSquareCellCollision3(const Particle&, const Vector &, const Vector &) const { M_throw() << "Not implemented"; }
     virtual std::pair<bool,double> getPointPlateCollision(const Particle& np1, const Vector& nrw0, const Vector& nhat, const double& Delta, const double& Omega, const double& Sigma, const double& t, bool) const { M_throw() << "Not implemented"; }
     virtual ParticleEventData runOscilatingPlate(Particle& part, const Vector& rw0, const Vector& nhat, double& delta, const double& omega0, const double& sigma, const double& mass, const double& e, double& t, bool strongPlate) const { M_throw() << "Not implemented"; }
-    virtual bool DSMCSpheresTest(Particle&, Particle&, double&, const double&, Vector) const { M_throw() << "Not implemented"; }
+    virtual double DSMCSpheresProbability(Particle&, Particle&, const double&, Vector) const { M_throw() << "Not implemented"; }
     virtual PairEventData DSMCSpheresRun(Particle&, Particle&, const double&, Vector) const { M_throw() << "Not implemented"; }
     virtual PairEventData SphereWellEvent(Event&, const double&, const double&, size_t) const { M_throw() << "Not implemented"; }
     virtual double getPlaneEvent(const Particle&, const Vector &, const Vector &, double) const { M_throw() << "Not implemented"; }
@@ -63,7 +63,7 @@ namespace dynamo {
     virtual double getCylinderWallCollision(const Particle&, const Vector &, const Vector &, const double&) const { M_throw() << "Not implemented"; }
     virtual ParticleEventData runCylinderWallCollision(Particle&, const Vector &, const Vector &, const double&) const { M_throw() << "Not implemented"; }
     virtual ParticleEventData runAndersenWallCollision(Particle&, const Vector &, const double& T, const double d, const double slip) const { M_throw() << "Not implemented"; }
-    virtual ParticleEventData randomGaussianEvent(Particle&, const double&, const size_t) const { M_throw() << "Not implemented"; }
+    virtual ParticleEventData randomGaussianEvent(Particle&, const double&, const Vector&, const size_t) const { M_throw() << "Not implemented"; }
     virtual NEventData multibdyCollision(const IDRange&, const IDRange&, const double&, const EEventType&) const { M_throw() << "Not implemented"; }
     virtual NEventData multibdyWellEvent(const IDRange&, const IDRange&, const double&, const double&, EEventType&) const { M_throw() << "Not implemented"; }
     virtual PairEventData parallelCubeColl(Event& event, const double& e, const double& d, const EEventType& eType = CORE) const { M_throw() << "Not implemented"; }
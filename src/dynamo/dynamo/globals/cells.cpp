@@ -188,6 +188,23 @@ namespace dynamo {
 	<< magnet::xml::endtag("Global");
   }
 
+  void
+  GCells::saveCheckpoint(CheckpointWriter& out) const
+  {
+    out.tag("Cells");
+    out.write(_ordering.getDimensions());
+    _cellData.saveCheckpoint(out, _ordering.length());
+  }
+
+  void
+  GCells::loadCheckpoint(CheckpointReader& in)
+  {
+    in.tag("Cells");
+    if (in.read<std::array<size_t, 3> >() != _ordering.getDimensions())
+      M_throw() << "The cells of " << globName << " in the checkpoint " << in.getName() << " do not match the configuration";
+    _cellData.loadCheckpoint(in, _ordering.length(), Sim->particles.size());
+  }
+
   void GCells::addCells(std::array<size_t, 3> cellCount)
   {
     const double maxdiam = _maxInteractionRange;
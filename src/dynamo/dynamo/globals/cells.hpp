@@ -18,6 +18,7 @@
 #pragma once
 #include <dynamo/globals/neighbourList.hpp>
 #include <dynamo/particle.hpp>
+#include <dynamo/checkpoint.hpp>
 #ifdef DYNAMO_JUDY
 # include <magnet/containers/judy.hpp>
 #endif
@@ -83,6 +84,38 @@ namespace dynamo {
 
       size_t size() const { return _particleCell.size(); }
       void clear() { _particleCell.clear(); _cellcontents.clear(); }
+
+      /*! \brief Write the contents of each cell to a checkpoint.
+
+	The contents are written in their stored order, as this order
+	decides the order in which events are found (and so the order
+	of simultaneous events).
+       */
+      void saveCheckpoint(CheckpointWriter& out, const size_t cellcount) const {
+	out.write(uint64_t(cellcount));
+	std::vector<size_t> contents;
+	for (size_t cell(0); cell < cellcount; ++cell)
+	  {
+	    const auto range = getCellContents(cell);
+	    contents.assign(range.begin(), range.end());
+	    out.write(contents);
+	  }
+      }
+
+      //! \brief Restore the cell contents written by saveCheckpoint().
+      void loadCheckpoint(CheckpointReader& in, const size_t cellcount, const size_t N) {
+	if (in.read<uint64_t>() != cellcount)
+	  M_throw() << "The cell count of the checkpoint " << in.getName() << " does not match the configuration";
+	clear();
+	resize(cellcount, N);
+	std::vector<size_t> contents;
+	for (size_t cell(0); cell < cellcount; ++cell)
+	  {
+	    in.read(contents);
+	    for (const size_t& particle : contents)
+	      add(cell, particle);
+	  }
+      }
     };
   }
 
@@ -136,6 +169,10 @@ namespace dynamo {
 
     void setConfigOutput(bool val) { _inConfig = val; }
 
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    virtual void loadCheckpoint(CheckpointReader&);
+
   protected:
     virtual void getParticleNeighbours(const std::array<size_t, 3>&, std::vector<size_t>&) const;
 
@@ -163,7 +200,7 @@ namespace dynamo {
     std::array<size_t, 3> getCellCoords(Vector) const;
 
     void addCells(std::array<size_t, 3> cellCount);
-    void buildCells();
+    virtual void buildCells();
 
     Vector calcPosition(const size_t cellIndex, const Particle& part) const { return calcPosition(_ordering.toCoord(cellIndex), part);}
     Vector calcPosition(const std::array<size_t, 3>& coords, const Particle& part) const ;
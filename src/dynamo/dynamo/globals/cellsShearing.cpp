@@ -16,17 +16,20 @@
 */
 
 #include <dynamo/globals/cellsShearing.hpp>
+#include <dynamo/systems/cellsShearingSlide.hpp>
 #include <dynamo/NparticleEventData.hpp>
 #include <dynamo/dynamics/dynamics.hpp>
 #include <dynamo/units/units.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/BC/LEBC.hpp>
 #include <magnet/xmlwriter.hpp>
+#include <cmath>
 
 namespace dynamo {
   GCellsShearing::GCellsShearing(dynamo::Simulation* nSim, 
 				 const std::string& globalname):
-    GCells(nSim, globalname)
+    GCells(nSim, globalname),
+    _slideOffset(0)
   {
     setOutputPrefix("ShearingCells");
     dout << "Shearing Cells Loaded" << std::endl;
@@ -34,7 +37,8 @@ namespace dynamo {
 
   GCellsShearing::GCellsShearing(const magnet::xml::Node& XML, 
 				 dynamo::Simulation* ptrSim):
-    GCells(ptrSim, "ShearingCells")
+    GCells(ptrSim, "ShearingCells"),
+    _slideOffset(0)
   {
     operator<<(XML);
     dout << "Cells in shearing Loaded" << std::endl;
@@ -48,12 +52,95 @@ namespace dynamo {
     if (!std::dynamic_pointer_cast<BCLeesEdwards>(Sim->BCs))
       derr << "You should not use the shearing neighbour list"
 	   << " in a system without Lees Edwards BC's" << std::endl;
+    else if (!_slideSystem)
+      {
+	//The slide events are not written to the configuration
+	//file, they are recreated here on loading
+	_slideSystem = shared_ptr<SysCellsShearingSlide>(new SysCellsShearingSlide(Sim, nID));
+	Sim->systems.push_back(_slideSystem);
+      }
 
     if (overlink != 1) M_throw() << "Cannot shear with overlinking yet";
 
     reinitialise();
   }
 
+  void
+  GCellsShearing::buildCells()
+  {
+    GCells::buildCells();
+
+    //Determine how many whole cells the images have slid past each
+    //other
+    _slideOffset = 0;
+    shared_ptr<BCLeesEdwards> bc = std::dynamic_pointer_cast<BCLeesEdwards>(Sim->BCs);
+    if (bc)
+      {
+	const double Lx = Sim->primaryCellSize[0];
+	const double dxd = bc->getBoundaryDisplacement() - Lx * std::floor(bc->getBoundaryDisplacement() / Lx);
+	_slideOffset = std::min(size_t(dxd / _cellLatticeWidth[0]), _ordering.getDimensions()[0] - 1);
+      }
+
+    //The time of the next slide changes with the cell width
+    if (_slideSystem) _slideSystem->reschedule();
+  }
+
+  double
+  GCellsShearing::getBoundaryShearRate() const
+  {
+    //The velocity at which the images slide past each other
+    return static_cast<const BCLeesEdwards&>(*Sim->BCs).getShearRate() * Sim->primaryCellSize[1];
+  }
+
+  double
+  GCellsShearing::getSlideTime() const
+  {
+    const double rate = getBoundaryShearRate();
+    if (rate == 0) return std::numeric_limits<float>::infinity();
+
+    //The distance to the next cell boundary in the direction of the
+    //shear. The boundary displacement is wrapped into the primary
+    //image, so the distance is too.
+    const double dxd = static_cast<const BCLeesEdwards&>(*Sim->BCs).getBoundaryDisplacement();
+    const double L = _cellLatticeWidth[0];
+    const double Lx = Sim->primaryCellSize[0];
+    double distance = (rate > 0) ? (_slideOffset + 1) * L - dxd : dxd - _slideOffset * L;
+    distance -= Lx * std::floor((distance + 0.5 * L) / Lx);
+    return std::max(distance, 0.0) / std::abs(rate);
+  }
+
+  void
+  GCellsShearing::slide()
+  {
+    const size_t nx = _ordering.getDimensions()[0];
+    const bool forward = getBoundaryShearRate() > 0;
+    _slideOffset = (_slideOffset + (forward ? 1 : nx - 1)) % nx;
+
+    //If the strip spans the whole row, there are no new neighbours
+    if (stripWidth() == nx) return;
+
+    //Each cell of the top row gains one column of the bottom row at
+    //an edge of its strip. Each new pair only needs to be signalled
+    //once, so only the top row particles are signalled.
+    const size_t topRow = _ordering.getDimensions()[1] - 1;
+    const size_t nz = _ordering.getDimensions()[2];
+    for (size_t z(0); z < nz; ++z)
+      for (size_t x(0); x < nx; ++x)
+	{
+	  const std::array<size_t, 3> cellCoords = {{x, topRow, z}};
+	  const std::array<size_t, 3> start = {{stripStart(cellCoords) + (forward ? 0 : stripWidth() - 1), 0, z + nz - 1}};
+	  const std::array<size_t, 3> range = {{1, 1, 3}};
+	  for (const size_t& id1 : _cellData.getCellContents(_ordering.toIndex(cellCoords)))
+	    {
+	      Particle& part = Sim->particles[id1];
+	      Sim->dynamics->updateParticle(part);
+	      for (const size_t cellIndex : _ordering.getIndices(start, range))
+		for (const size_t& id2 : _cellData.getCellContents(cellIndex))
+		  _sigNewNeighbour(part, id2);
+	    }
+	}
+  }
+
   Event 
   GCellsShearing::getEvent(const Particle& part) const
   {
@@ -119,20 +206,17 @@ namespace dynamo {
 	for (const size_t& id2 : neighbours)
 	  _sigNewNeighbour(part, id2);
       }
-    else if ((cellDirection == 1) && (oldCellCoord[1] == ((cellDirectionInt < 0) ? 1 : (_ordering.getDimensions()[1] - 2))))
+    else if ((cellDirection == 1) && isBoundaryRow(newCellCoord[1]))
       {
 	//We're entering the boundary of the y direction
 	//Calculate the end cell, no boundary wrap check required
 	_cellData.moveTo(oldCellIndex, _ordering.toIndex(newCellCoord), part.getID());
             
-	//Check the extra LE neighbourhood strip
+	//The only new neighbours are in the strip across the boundary
 	std::vector<size_t> nbs;
-	getAdditionalLEParticleNeighbourhood(part, nbs);
+	getAdditionalLEParticleNeighbourhood(newCellCoord, nbs);
 	for (const size_t& id2 : nbs)
-	  {
-	    Sim->ptrScheduler->addInteractionEvent(part, id2);
-	    _sigNewNeighbour(part, id2);
-	  }
+	  _sigNewNeighbour(part, id2);
       }
     else
       {
@@ -142,16 +226,6 @@ namespace dynamo {
 	newNBCellCoord[cellDirection] += _ordering.getDimensions()[cellDirection] + ((cellDirectionInt > 0) ? 1 : -1);
 	newNBCellCoord[cellDirection] %= _ordering.getDimensions()[cellDirection];
 
-	if ((cellDirection == 2) && ((oldCellCoord[1] == 0) || (oldCellCoord[1] == _ordering.getDimensions()[1] - 1)))
-	  {
-	    //We're at the boundary moving in the z direction, we must
-	    //add the new LE strips as neighbours	
-	    //We just check the entire Extra LE neighbourhood
-	    std::vector<size_t> nbs;
-	    getAdditionalLEParticleNeighbourhood(part, nbs);
-	    for (const size_t& id2 : nbs) _sigNewNeighbour(part, id2);
-	  }
-
 	//Particle has just arrived into a new cell warn the scheduler about
 	//its new neighbours so it can add them to the heap
 	//Holds the displacement in each dimension, the unit is cells!
@@ -160,9 +234,45 @@ namespace dynamo {
 	std::array<size_t, 3> steps = {{overlink, overlink, overlink}};
 	steps[cellDirection] = 0;
 	
-	for (auto cellIndex : _ordering.getSurroundingIndices(newNBCellCoord, steps))
-	  for (const size_t& next : _cellData.getCellContents(cellIndex))
-	    _sigNewNeighbour(part, next);
+	if ((cellDirection != 1) && isBoundaryRow(newCellCoord[1]))
+	  {
+	    //We're moving along the boundary. The new plane of cells
+	    //is only walked on this side of the boundary...
+	    std::array<size_t, 3> start;
+	    std::array<size_t, 3> range;
+	    for (size_t iDim(0); iDim < NDIM; ++iDim)
+	      {
+		start[iDim] = (newNBCellCoord[iDim] + _ordering.getDimensions()[iDim] - steps[iDim]) % _ordering.getDimensions()[iDim];
+		range[iDim] = 2 * steps[iDim] + 1;
+	      }
+	    start[1] = newCellCoord[1] ? newCellCoord[1] - 1 : 0;
+	    range[1] = 2;
+	    for (const size_t cellIndex : _ordering.getIndices(start, range))
+	      for (const size_t& next : _cellData.getCellContents(cellIndex))
+		_sigNewNeighbour(part, next);
+
+	    //...and across the boundary, the strip has moved with the
+	    //particle. Moving along x, the strip gains a column on its
+	    //leading edge; moving along z, the strip gains a new plane.
+	    const size_t width = stripWidth();
+	    start = {{stripStart(newCellCoord), opposingRow(newCellCoord[1]), newNBCellCoord[2]}};
+	    range = {{width, 1, 1}};
+	    if (cellDirection == 0)
+	      {
+		start[0] += (cellDirectionInt > 0) ? width - 1 : 0;
+		start[2] = (newCellCoord[2] + _ordering.getDimensions()[2] - 1) % _ordering.getDimensions()[2];
+		range = {{1, 1, 3}};
+	      }
+
+	    if ((cellDirection != 0) || (width != _ordering.getDimensions()[0]))
+	      for (const size_t cellIndex : _ordering.getIndices(start, range))
+		for (const size_t& next : _cellData.getCellContents(cellIndex))
+		  _sigNewNeighbour(part, next);
+	  }
+	else
+	  for (auto cellIndex : _ordering.getSurroundingIndices(newNBCellCoord, steps))
+	    for (const size_t& next : _cellData.getCellContents(cellIndex))
+	      _sigNewNeighbour(part, next);
       }
     
     //Push the next virtual event, this is the reason the scheduler
@@ -174,9 +284,22 @@ namespace dynamo {
   void
   GCellsShearing::getParticleNeighbours(const std::array<size_t, 3>& cellCoords, std::vector<size_t>& retlist) const
   {
-    GCells::getParticleNeighbours(cellCoords, retlist);
-    if ((cellCoords[1] == 0) || (cellCoords[1] == (_ordering.getDimensions()[1] - 1)))
-      getAdditionalLEParticleNeighbourhood(cellCoords, retlist);
+    if (!isBoundaryRow(cellCoords[1]))
+      return GCells::getParticleNeighbours(cellCoords, retlist);
+
+    //The cells on this side of the boundary
+    const std::array<size_t, 3> start = {{(cellCoords[0] + _ordering.getDimensions()[0] - 1) % _ordering.getDimensions()[0],
+					  cellCoords[1] ? cellCoords[1] - 1 : 0,
+					  (cellCoords[2] + _ordering.getDimensions()[2] - 1) % _ordering.getDimensions()[2]}};
+    const std::array<size_t, 3> range = {{3, 2, 3}};
+    for (const size_t cellIndex : _ordering.getIndices(start, range))
+      {
+	const auto neighbours = _cellData.getCellContents(cellIndex);
+	retlist.insert(retlist.end(), neighbours.begin(), neighbours.end());
+      }
+
+    //And the strip across it
+    getAdditionalLEParticleNeighbourhood(cellCoords, retlist);
   }
   
   void
@@ -184,20 +307,52 @@ namespace dynamo {
     return getAdditionalLEParticleNeighbourhood(_ordering.toCoord(_cellData.getCellID(part.getID())), retlist);
   }
 
+  size_t
+  GCellsShearing::stripStart(const std::array<size_t, 3>& cellCoords) const
+  {
+    //The images across the boundary are displaced by the boundary
+    //displacement, +dxd when seen from the top row and -dxd from
+    //the bottom. With cells overlapping by less than a cell width,
+    //a cell in column i of the top row neighbours the columns
+    //i-2-m to i+1-m of the bottom row, where m is the slide
+    //offset. The columns are symmetric for the bottom row.
+    const size_t nx = _ordering.getDimensions()[0];
+    if (cellCoords[1])
+      return (cellCoords[0] + 2 * nx - 2 - _slideOffset) % nx;
+    else
+      return (cellCoords[0] + nx - 1 + _slideOffset) % nx;
+  }
+
   void
   GCellsShearing::getAdditionalLEParticleNeighbourhood(std::array<size_t, 3> cellCoords, std::vector<size_t>& retlist) const
   {  
 #ifdef DYNAMO_DEBUG
-    if ((cellCoords[1] != 0) && (cellCoords[1] != (_ordering.getDimensions()[1] - 1)))
+    if (!isBoundaryRow(cellCoords[1]))
       M_throw() << "Shouldn't call this function unless the particle is at a border in the y dimension";
 #endif
-    std::array<size_t, 3> start = {{0, (cellCoords[1] > 0) ? 0 : _ordering.getDimensions()[1] - 1, cellCoords[2]}};
-    std::array<size_t, 3> steps = {{_ordering.getDimensions()[0], 0, overlink}};
-    //These are the two dimensions to walk in
-    for (auto cellIndex : _ordering.getSurroundingIndices(start, steps))
+    const std::array<size_t, 3> start = {{stripStart(cellCoords), opposingRow(cellCoords[1]),
+					  (cellCoords[2] + _ordering.getDimensions()[2] - overlink) % _ordering.getDimensions()[2]}};
+    const std::array<size_t, 3> range = {{stripWidth(), 1, 2 * overlink + 1}};
+    for (auto cellIndex : _ordering.getIndices(start, range))
       {
 	const auto neighbours = _cellData.getCellContents(cellIndex);
 	retlist.insert(retlist.end(), neighbours.begin(), neighbours.end());
       }
   }
+
+  void
+  GCellsShearing::saveCheckpoint(CheckpointWriter& out) const
+  {
+    GCells::saveCheckpoint(out);
+    out.tag("ShearingCells");
+    out.write(uint64_t(_slideOffset));
+  }
+
+  void
+  GCellsShearing::loadCheckpoint(CheckpointReader& in)
+  {
+    GCells::loadCheckpoint(in);
+    in.tag("ShearingCells");
+    _slideOffset = in.read<uint64_t>();
+  }
 }
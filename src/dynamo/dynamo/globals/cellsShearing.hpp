@@ -20,6 +20,23 @@
 #include <dynamo/ranges/IDRange.hpp>
 
 namespace dynamo {
+  class SysCellsShearingSlide;
+
+  /*! \brief A cell neighbour list for systems with Lees-Edwards
+    boundary conditions.
+
+    The rows of cells at the top and bottom of the primary image (in
+    the y dimension) neighbour each other across the sheared
+    boundary. As the images slide past each other, the cells of the
+    opposite row which can hold neighbours of a boundary cell slide
+    with them. The integer number of cell widths the images have
+    slid by (the slide offset) is tracked explicitly, so only a fixed
+    strip of four columns of the opposite row needs to be searched
+    for a boundary cell. Each time the boundary displacement crosses
+    a multiple of the cell width, a \ref SysCellsShearingSlide event
+    advances the slide offset and adds the one column each boundary
+    cell gains to its neighbourhood.
+  */
   class GCellsShearing: public GCells
   {
   public:
@@ -35,9 +52,48 @@ namespace dynamo {
 
     virtual void runEvent(Particle&, const double);
 
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    virtual void loadCheckpoint(CheckpointReader&);
+
+    /*! \brief The time until the boundary displacement next crosses
+        a multiple of the cell width.
+     */
+    double getSlideTime() const;
+
+    /*! \brief Advance the slide offset by one cell and add the new
+        neighbours across the sheared boundary.
+     */
+    void slide();
+
   protected:
+    virtual void buildCells();
+
     void getParticleNeighbours(const std::array<size_t, 3>&, std::vector<size_t>&) const;
     void getAdditionalLEParticleNeighbourhood(const Particle&, std::vector<size_t>&) const;
     void getAdditionalLEParticleNeighbourhood(std::array<size_t, 3>, std::vector<size_t>&) const;
+
+    //! \brief Test if a row of cells lies on the sheared boundary.
+    bool isBoundaryRow(const size_t row) const
+    { return (row == 0) || (row == _ordering.getDimensions()[1] - 1); }
+
+    //! \brief The row on the other side of the sheared boundary.
+    size_t opposingRow(const size_t row) const
+    { return row ? 0 : _ordering.getDimensions()[1] - 1; }
+
+    /*! \brief The first column of the strip of the opposing row
+        which neighbours a boundary cell.
+     */
+    size_t stripStart(const std::array<size_t, 3>&) const;
+
+    //! \brief The number of columns in the strip of the opposing row.
+    size_t stripWidth() const { return std::min(_ordering.getDimensions()[0], size_t(4)); }
+
+    double getBoundaryShearRate() const;
+
+    //! \brief How many cell widths the images have slid past each other.
+    size_t _slideOffset;
+
+    shared_ptr<SysCellsShearingSlide> _slideSystem;
   };
 }
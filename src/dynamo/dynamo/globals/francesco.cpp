@@ -21,6 +21,7 @@
 #include <dynamo/dynamics/dynamics.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/outputplugins/outputplugin.hpp>
+#include <dynamo/checkpoint.hpp>
 #include <magnet/xmlreader.hpp>
 
 namespace dynamo {
@@ -70,6 +71,20 @@ namespace dynamo {
     	<< magnet::xml::endtag("Global");
   }
 
+  void
+  GFrancesco::saveCheckpoint(CheckpointWriter& out) const
+  {
+    out.tag("Francesco");
+    out.write(_eventTimes);
+  }
+
+  void
+  GFrancesco::loadCheckpoint(CheckpointReader& in)
+  {
+    in.tag("Francesco");
+    in.readFixed(_eventTimes);
+  }
+
   void 
   GFrancesco::operator<<(const magnet::xml::Node& XML)
   {
@@ -106,8 +121,7 @@ namespace dynamo {
     part.getVelocity() = _vel * (Sim->dynamics->getRotData(part).orientation * magnet::math::Quaternion::initialDirector());
 
     Sim->_sigParticleUpdate(EDat);
-    for (shared_ptr<OutputPlugin> & Ptr : Sim->outputPlugins)
-      Ptr->eventUpdate(iEvent, EDat);
+    Sim->eventUpdate(iEvent, EDat);
     Sim->ptrScheduler->fullUpdate(part);
   }
 }
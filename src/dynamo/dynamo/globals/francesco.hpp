@@ -49,6 +49,10 @@ namespace dynamo {
 
     virtual void operator<<(const magnet::xml::Node&);
 
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    virtual void loadCheckpoint(CheckpointReader&);
+
   protected:
     virtual void outputXML(magnet::xml::XmlStream&) const;
     void particlesUpdated(const NEventData& PDat);
@@ -53,6 +53,18 @@ namespace dynamo {
 	else
 	  return shared_ptr<Global>(new GCells(XML, Sim));
       }
+    else if (!XML.getAttribute("Type").getValue().compare("MultiCells"))
+      {
+	if (std::dynamic_pointer_cast<BCLeesEdwards>(Sim->BCs))
+	  M_throw() << "The MultiCells neighbour list does not support Lees-Edwards boundary conditions";
+	return shared_ptr<Global>(new GMultiCells(XML, Sim));
+      }
+    else if (!XML.getAttribute("Type").getValue().compare("VerletList"))
+      {
+	if (std::dynamic_pointer_cast<BCLeesEdwards>(Sim->BCs))
+	  M_throw() << "The VerletList neighbour list does not support Lees-Edwards boundary conditions";
+	return shared_ptr<Global>(new GVerletList(XML, Sim));
+      }
     else if (!XML.getAttribute("Type").getValue().compare("SOCells"))
       return shared_ptr<Global>(new GSOCells(XML, Sim));
     else if (!XML.getAttribute("Type").getValue().compare("Francesco"))
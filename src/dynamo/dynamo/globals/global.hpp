@@ -25,6 +25,8 @@ namespace xml { class XmlStream; }
 
 namespace dynamo {
   class NEventData;
+  class CheckpointWriter;
+  class CheckpointReader;
 
   /*! \brief Base class for Non-\ref Local single-particle events.
    
@@ -92,6 +94,21 @@ namespace dynamo {
     /*! \brief Returns the unique ID number of this Global.
      */
     inline const size_t& getID() const { return ID; }
+
+    /*! \brief Writes any state of this Global which is not stored
+        in the configuration file to a checkpoint.
+
+      The queued events of a checkpointed simulation are only valid
+      for the exact state they were calculated with, so Globals which
+      track the particles (e.g., neighbour lists) must store their
+      state here, rather than rebuild it in initialise().
+     */
+    virtual void saveCheckpoint(CheckpointWriter&) const {}
+
+    /*! \brief Restores the state written by saveCheckpoint(), after
+        the Global has been initialised.
+     */
+    virtual void loadCheckpoint(CheckpointReader&) {}
   
   protected:
     /*! \brief Writes out an XML representation of the Global
@@ -0,0 +1,468 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/globals/multicells.hpp>
+#include <dynamo/NparticleEventData.hpp>
+#include <dynamo/dynamics/dynamics.hpp>
+#include <dynamo/dynamics/compression.hpp>
+#include <dynamo/interactions/interaction.hpp>
+#include <dynamo/species/species.hpp>
+#include <dynamo/units/units.hpp>
+#include <dynamo/schedulers/scheduler.hpp>
+#include <dynamo/BC/BC.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <magnet/xmlreader.hpp>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace dynamo {
+  GMultiCells::GMultiCells(dynamo::Simulation* nSim, const std::string& name):
+    GNeighbourList(nSim, "MultiCellNeighbourList"),
+    _levelRatio(1.5),
+    _inConfig(true)
+  {
+    globName = name;
+    dout << "Multi-level cells loaded" << std::endl;
+  }
+
+  GMultiCells::GMultiCells(const magnet::xml::Node& XML, dynamo::Simulation* ptrSim):
+    GNeighbourList(ptrSim, "MultiCellNeighbourList"),
+    _levelRatio(1.5),
+    _inConfig(true)
+  {
+    operator<<(XML);
+    dout << "Multi-level cells loaded" << std::endl;
+  }
+
+  void
+  GMultiCells::operator<<(const magnet::xml::Node& XML)
+  {
+    if (XML.hasAttribute("NeighbourhoodRange"))
+      _maxInteractionRange = XML.getAttribute("NeighbourhoodRange").as<double>() * Sim->units.unitLength();
+
+    if (XML.hasAttribute("LevelRatio"))
+      _levelRatio = XML.getAttribute("LevelRatio").as<double>();
+
+    if (_levelRatio < 1)
+      M_throw() << "The LevelRatio of the multi-level cells must be greater than or equal to 1";
+
+    globName = XML.getAttribute("Name");
+
+    range = shared_ptr<IDRange>(IDRange::getClass(XML.getNode("IDRange"), Sim));
+  }
+
+  void
+  GMultiCells::outputXML(magnet::xml::XmlStream& XML) const
+  {
+    if (!_inConfig) return;
+    XML << magnet::xml::tag("Global")
+	<< magnet::xml::attr("Type") << "MultiCells"
+	<< magnet::xml::attr("Name") << globName
+	<< magnet::xml::attr("NeighbourhoodRange")
+	<< _maxInteractionRange / Sim->units.unitLength()
+	<< magnet::xml::attr("LevelRatio") << _levelRatio
+	<< range
+	<< magnet::xml::endtag("Global");
+  }
+
+  void
+  GMultiCells::initialise(size_t nID)
+  {
+    Global::initialise(nID);
+    reinitialise();
+  }
+
+  void
+  GMultiCells::reinitialise()
+  {
+    GNeighbourList::reinitialise();
+
+    dout << "Reinitialising on collision " << Sim->eventCount << std::endl;
+
+    buildLevels();
+    _sigReInitialise();
+  }
+
+  void
+  GMultiCells::saveCheckpoint(CheckpointWriter& out) const
+  {
+    out.tag("MultiCells");
+    out.write(uint64_t(_levels.size()));
+    for (const detail::CellLevel& level : _levels)
+      {
+	out.write(level._ordering.getDimensions());
+	level._cellData.saveCheckpoint(out, level._ordering.length());
+      }
+    out.write(_particleLevel);
+  }
+
+  void
+  GMultiCells::loadCheckpoint(CheckpointReader& in)
+  {
+    in.tag("MultiCells");
+    if (in.read<uint64_t>() != _levels.size())
+      M_throw() << "The levels of " << globName << " in the checkpoint " << in.getName() << " do not match the configuration";
+    for (detail::CellLevel& level : _levels)
+      {
+	if (in.read<std::array<size_t, 3> >() != level._ordering.getDimensions())
+	  M_throw() << "The cells of " << globName << " in the checkpoint " << in.getName() << " do not match the configuration";
+	level._cellData.loadCheckpoint(in, level._ordering.length(), Sim->particles.size());
+      }
+    in.readFixed(_particleLevel);
+  }
+
+  void
+  GMultiCells::buildLevels()
+  {
+    const size_t NSpecies = Sim->species.size();
+
+    //Find two representative particles of each species in the range
+    //of this neighbour list. These are used to determine the
+    //interaction range between each pair of species.
+    std::vector<size_t> rep1(NSpecies, std::numeric_limits<size_t>::max()), rep2(NSpecies, std::numeric_limits<size_t>::max());
+    for (size_t s(0); s < NSpecies; ++s)
+      for (const size_t pid : *Sim->species[s]->getRange())
+	if (range->isInRange(Sim->particles[pid]))
+	  {
+	    if (rep1[s] == std::numeric_limits<size_t>::max())
+	      rep1[s] = pid;
+	    else
+	      {
+		rep2[s] = pid;
+		break;
+	      }
+	  }
+
+    std::vector<size_t> active;
+    for (size_t s(0); s < NSpecies; ++s)
+      if (rep1[s] != std::numeric_limits<size_t>::max())
+	{
+	  if (rep2[s] == std::numeric_limits<size_t>::max())
+	    rep2[s] = rep1[s];
+	  active.push_back(s);
+	}
+
+    if (active.empty())
+      M_throw() << "The multi-level cell neighbour list \"" << globName << "\" has no particles in its range";
+
+    auto crossRange = [&](const size_t a, const size_t b) {
+      const Particle& p1 = Sim->particles[rep1[a]];
+      const Particle& p2 = Sim->particles[(a == b) ? rep2[b] : rep1[b]];
+      return Sim->getInteraction(p1, p2)->maxIntDist();
+    };
+
+    //Sort the species by their self-interaction range, then group
+    //them into levels.
+    std::sort(active.begin(), active.end(), [&](const size_t a, const size_t b) { return crossRange(a, a) < crossRange(b, b); });
+
+    std::vector<size_t> speciesLevel(NSpecies, std::numeric_limits<size_t>::max());
+    std::vector<std::vector<size_t> > levelSpecies;
+    double levelStart = 0;
+    for (const size_t s : active)
+      {
+	const double srange = crossRange(s, s);
+	if (levelSpecies.empty() || (srange > levelStart * _levelRatio))
+	  {
+	    levelSpecies.push_back(std::vector<size_t>());
+	    levelStart = srange;
+	  }
+	levelSpecies.back().push_back(s);
+	speciesLevel[s] = levelSpecies.size() - 1;
+      }
+
+    //The neighbourhood range may be increased (e.g., for compression
+    //dynamics), so all of the levels are scaled by the same factor.
+    const double longest = Sim->getLongestInteraction();
+    const double scale = longest ? (_maxInteractionRange / longest) : 1.0;
+
+    _levels.clear();
+    _levels.resize(levelSpecies.size());
+    for (size_t l(0); l < _levels.size(); ++l)
+      {
+	//Each level tracks the pairs between its own species and the
+	//species of all finer levels.
+	double levelRange = 0;
+	for (const size_t b : levelSpecies[l])
+	  for (const size_t a : active)
+	    if (speciesLevel[a] <= l)
+	      levelRange = std::max(levelRange, crossRange(a, b));
+	_levels[l]._range = levelRange * scale;
+      }
+
+    _particleLevel.clear();
+    _particleLevel.resize(Sim->N(), std::numeric_limits<size_t>::max());
+    std::vector<size_t> levelCounts(_levels.size(), 0);
+    for (const size_t s : active)
+      for (const size_t pid : *Sim->species[s]->getRange())
+	if (range->isInRange(Sim->particles[pid]))
+	  {
+	    _particleLevel[pid] = speciesLevel[s];
+	    ++levelCounts[speciesLevel[s]];
+	  }
+
+    //Particles are stored in their own and every coarser level
+    std::partial_sum(levelCounts.begin(), levelCounts.end(), levelCounts.begin());
+
+    for (size_t l(0); l < _levels.size(); ++l)
+      {
+	dout << "Level " << l << " interaction range " << _levels[l]._range / Sim->units.unitLength() << std::endl;
+	addCells(_levels[l], levelCounts[l]);
+      }
+
+    ////Add all the particles
+    //Required so particles find the right owning cell
+    Sim->dynamics->updateAllParticles();
+    for (const size_t& pid : *range)
+      {
+	const Particle& p = Sim->particles[pid];
+	for (size_t l(_particleLevel[pid]); l < _levels.size(); ++l)
+	  _levels[l]._cellData.add(_levels[l]._ordering.toIndex(getCellCoords(_levels[l], p.getPosition())), pid);
+      }
+  }
+
+  void
+  GMultiCells::addCells(detail::CellLevel& level, const size_t count)
+  {
+    const double minDistance = level._range;
+
+    //This is the "optimal" neighbourlist size where we have unitary
+    //occupation of the particles stored on this level
+    const double unityOccupancy = std::cbrt(Sim->getSimVolume() / std::max(count, size_t(1)));
+
+    const double l = std::max(minDistance, unityOccupancy);
+
+    std::array<size_t, 3> cellCount;
+    const double embiggen = 1.0 + 10 * std::numeric_limits<double>::epsilon();
+
+    for (size_t iDim = 0; iDim < NDIM; iDim++)
+      {
+	cellCount[iDim] = int(Sim->primaryCellSize[iDim] / (l * embiggen));
+	//At least 4 cells for the PBCSentinel, and enough to contain
+	//one full neighbourhood template
+	cellCount[iDim] = std::max(cellCount[iDim], size_t(4));
+      }
+
+    const double overlap = (std::dynamic_pointer_cast<DynCompression>(Sim->dynamics)) ? 0.001 : 0.9;
+    for (size_t iDim = 0; iDim < NDIM; iDim++)
+      {
+	level._cellLatticeWidth[iDim] = Sim->primaryCellSize[iDim] / cellCount[iDim];
+	level._cellDimension[iDim] = level._cellLatticeWidth[iDim] + (level._cellLatticeWidth[iDim] - level._range) * overlap;
+	level._cellOffset[iDim] = -(level._cellLatticeWidth[iDim] - level._range) * overlap * 0.5;
+      }
+
+    level._ordering = detail::CellLevel::Ordering(cellCount);
+    level._cellData.clear();
+    level._cellData.resize(level._ordering.length(), Sim->particles.size());
+
+    dout << "Cells " << cellCount[0] << "," << cellCount[1] << "," << cellCount[2]
+	 << "\nLattice spacing "
+	 << level._cellLatticeWidth[0] / Sim->units.unitLength() << ","
+	 << level._cellLatticeWidth[1] / Sim->units.unitLength() << ","
+	 << level._cellLatticeWidth[2] / Sim->units.unitLength()
+	 << "\nSupported Interaction range " << getSupportedLength(level) / Sim->units.unitLength()
+	 << std::endl;
+
+    if (getSupportedLength(level) < level._range)
+      M_throw() << "The system size is too small to support the range of interactions specified (i.e. the system is smaller than the interaction diameter of one particle).";
+  }
+
+  double
+  GMultiCells::getSupportedLength(const detail::CellLevel& level) const
+  {
+    double retval(std::numeric_limits<float>::infinity());
+    for (size_t i = 0; i < NDIM; ++i)
+      retval = std::min(retval, 2 * level._cellLatticeWidth[i] - level._cellDimension[i]);
+    return retval;
+  }
+
+  double
+  GMultiCells::getMaxSupportedInteractionLength() const
+  {
+    if (_levels.empty()) return 0;
+
+    //The levels are all scaled together, so the supported length is
+    //limited by the level closest to its limit.
+    double ratio(std::numeric_limits<float>::infinity());
+    for (const detail::CellLevel& level : _levels)
+      if (level._range > 0)
+	ratio = std::min(ratio, getSupportedLength(level) / level._range);
+
+    if (std::isinf(ratio))
+      return getSupportedLength(_levels.back());
+
+    return ratio * _maxInteractionRange;
+  }
+
+  double
+  GMultiCells::getLevelEventTime(const detail::CellLevel& level, const Particle& part) const
+  {
+    const size_t cellIndex = level._cellData.getCellID(part.getID());
+    return Sim->dynamics->getSquareCellCollision2(part, calcPosition(level, level._ordering.toCoord(cellIndex), part), level._cellDimension);
+  }
+
+  Event
+  GMultiCells::getEvent(const Particle& part) const
+  {
+    //The next transition is the earliest over all levels the particle
+    //is stored in.
+    double dt = std::numeric_limits<float>::infinity();
+    for (size_t l(_particleLevel[part.getID()]); l < _levels.size(); ++l)
+      dt = std::min(dt, getLevelEventTime(_levels[l], part));
+
+    return Event(part, dt - Sim->dynamics->getParticleDelay(part), GLOBAL, CELL, ID);
+  }
+
+  void
+  GMultiCells::runEvent(Particle& part, const double)
+  {
+    Sim->dynamics->updateParticle(part);
+    Sim->ptrScheduler->popNextEvent();
+
+    //Determine which level the transition is occurring in
+    const size_t partLevel = _particleLevel[part.getID()];
+    size_t levelID = partLevel;
+    double dt = getLevelEventTime(_levels[partLevel], part);
+    for (size_t l(partLevel + 1); l < _levels.size(); ++l)
+      {
+	const double ldt = getLevelEventTime(_levels[l], part);
+	if (ldt < dt)
+	  {
+	    dt = ldt;
+	    levelID = l;
+	  }
+      }
+
+    detail::CellLevel& level = _levels[levelID];
+    const size_t oldCellIndex = level._cellData.getCellID(part.getID());
+    const auto oldCellCoord = level._ordering.toCoord(oldCellIndex);
+
+    //Determine the cell transition direction
+    const int cellDirectionInt(Sim->dynamics->getSquareCellCollision3(part, calcPosition(level, oldCellCoord, part), level._cellDimension));
+    const size_t cellDirection = abs(cellDirectionInt) - 1;
+    const auto& dims = level._ordering.getDimensions();
+
+    auto newCellCoord = oldCellCoord;
+    newCellCoord[cellDirection] += dims[cellDirection] + ((cellDirectionInt > 0) ? 1 : -1);
+    newCellCoord[cellDirection] %= dims[cellDirection];
+
+    level._cellData.moveTo(oldCellIndex, level._ordering.toIndex(newCellCoord), part.getID());
+
+    //Check the new slab of neighbouring cells for particles tracked
+    //on this level
+    auto newCenterNBCellCoord = newCellCoord;
+    newCenterNBCellCoord[cellDirection] += dims[cellDirection] + ((cellDirectionInt > 0) ? 1 : -1);
+    newCenterNBCellCoord[cellDirection] %= dims[cellDirection];
+    std::array<size_t, 3> steps{{1, 1, 1}};
+    steps[cellDirection] = 0;
+
+    for (auto cellIndex : level._ordering.getSurroundingIndices(newCenterNBCellCoord, steps))
+      for (const size_t& next : level._cellData.getCellContents(cellIndex))
+	if ((partLevel == levelID) || (_particleLevel[next] == levelID))
+	  _sigNewNeighbour(part, next);
+
+    Sim->ptrScheduler->pushEvent(getEvent(part));
+    _sigCellChange(part, oldCellIndex);
+  }
+
+  void
+  GMultiCells::getParticleNeighbours(const Particle& part, std::vector<size_t>& retlist) const
+  {
+    const size_t partLevel = _particleLevel[part.getID()];
+    for (size_t l(partLevel); l < _levels.size(); ++l)
+      {
+	const detail::CellLevel& level = _levels[l];
+	const auto coords = level._ordering.toCoord(level._cellData.getCellID(part.getID()));
+	addLevelNeighbours(level._ordering.getSurroundingIndices(coords, std::array<size_t, 3>{{1, 1, 1}}), l, partLevel, retlist);
+      }
+  }
+
+  void
+  GMultiCells::getParticleNeighbours(const Vector& vec, std::vector<size_t>& retlist) const
+  {
+    //A point has no level, so the neighbourhood of each level is
+    //widened to cover the longest interaction range, and only the
+    //particles belonging to each level are collected from it.
+    double maxRange = 0;
+    for (const detail::CellLevel& level : _levels)
+      maxRange = std::max(maxRange, level._range);
+
+    for (size_t l(0); l < _levels.size(); ++l)
+      {
+	const detail::CellLevel& level = _levels[l];
+	const auto& dims = level._ordering.getDimensions();
+	const auto coords = getCellCoords(level, vec);
+	std::array<size_t, 3> start, distance;
+	for (size_t i(0); i < NDIM; ++i)
+	  {
+	    const size_t steps = std::max(1l, std::lrint(std::ceil((maxRange + level._cellDimension[i]) / level._cellLatticeWidth[i] - 1)));
+	    if (2 * steps + 1 >= dims[i])
+	      {
+		start[i] = 0;
+		distance[i] = dims[i];
+	      }
+	    else
+	      {
+		start[i] = (coords[i] + dims[i] - steps) % dims[i];
+		distance[i] = 2 * steps + 1;
+	      }
+	  }
+	addLevelNeighbours(level._ordering.getIndices(start, distance), l, std::numeric_limits<size_t>::max(), retlist);
+      }
+  }
+
+  std::array<size_t, 3>
+  GMultiCells::getCellCoords(const detail::CellLevel& level, Vector pos) const
+  {
+    Sim->BCs->applyBC(pos);
+
+    std::array<size_t, 3> retval;
+    for (size_t iDim = 0; iDim < NDIM; iDim++)
+      {
+	long coord = std::floor((pos[iDim] - level._cellOffset[iDim]) / level._cellLatticeWidth[iDim] + 0.5 * level._ordering.getDimensions()[iDim]);
+	coord %= long(level._ordering.getDimensions()[iDim]);
+	if (coord < 0) coord += level._ordering.getDimensions()[iDim];
+	retval[iDim] = coord;
+      }
+
+    return retval;
+  }
+
+  Vector
+  GMultiCells::calcPosition(const detail::CellLevel& level, const std::array<size_t, 3>& coords, const Particle& part) const
+  {
+    //We always return the cell that is periodically nearest to the particle
+    Vector primaryCell = calcPosition(level, coords);
+    Vector imageCell;
+
+    for (size_t i = 0; i < NDIM; ++i)
+      imageCell[i] = primaryCell[i] - Sim->primaryCellSize[i] * lrint((primaryCell[i] - part.getPosition()[i]) / Sim->primaryCellSize[i]);
+
+    return imageCell;
+  }
+
+  Vector
+  GMultiCells::calcPosition(const detail::CellLevel& level, const std::array<size_t, 3>& coords) const
+  {
+    Vector primaryCell;
+
+    for (size_t i(0); i < NDIM; ++i)
+      primaryCell[i] = coords[i] * level._cellLatticeWidth[i] - 0.5 * Sim->primaryCellSize[i] + level._cellOffset[i];
+
+    return primaryCell;
+  }
+}
@@ -0,0 +1,154 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/globals/cells.hpp>
+#include <vector>
+
+namespace dynamo {
+  namespace detail {
+    /*! \brief A single regular grid of cells used by GMultiCells.
+
+      This holds the geometry and contents of one level of the cell
+      hierarchy. The layout of the cells (overlapping cells, offsets
+      and so on) is identical to the GCells neighbour list.
+     */
+    struct CellLevel
+    {
+      typedef magnet::containers::RowMajorOrdering<3> Ordering;
+      Ordering _ordering;
+      Vector _cellDimension;
+      Vector _cellLatticeWidth;
+      Vector _cellOffset;
+
+      //! \brief The longest interaction distance of the pairs tracked on this level.
+      double _range;
+
+#ifdef DYNAMO_JUDY
+      CellParticleList<magnet::containers::Vector_Multimap<magnet::containers::VectorSet<size_t>>,
+		       magnet::containers::JudyMap<size_t, size_t>> _cellData;
+#else
+      CellParticleList<magnet::containers::Vector_Multimap<magnet::containers::VectorSet<size_t>>,
+		       std::unordered_map<size_t, size_t> > _cellData;
+#endif
+    };
+  }
+
+  /*! \brief A hierarchical cell neighbour list for size-asymmetric
+      mixtures.
+
+    In a regular GCells neighbour list every cell is sized for the
+    longest interaction in the system. For mixtures with a large size
+    ratio, small particles then search a neighbourhood sized for the
+    largest particles and most of the pair tests are wasted.
+
+    This neighbour list groups the Species of the system into
+    interaction length classes (levels), and keeps a separate grid of
+    cells for each level. A particle is stored in the grid of its own
+    level and in every coarser grid. The pair of particles (A,B) is
+    only ever tracked in the grid of the coarser of their two levels,
+    as both particles are stored there and its cells are large
+    enough for their interaction. Small-small pairs are therefore only
+    found using the fine grid, while large-small pairs are found
+    using the coarse grid.
+
+    The cost is that particles have cell transition events in their
+    own and all coarser grids, but transitions in the coarse grids
+    are rare in comparison to the fine grid.
+
+    The interaction length of each pair of Species is determined from
+    the Interaction between representative particles of each
+    species. Therefore this neighbour list is only suitable where the
+    Interactions are selected by Species (e.g., binary mixtures).
+   */
+  class GMultiCells: public GNeighbourList
+  {
+  public:
+    GMultiCells(const magnet::xml::Node&, dynamo::Simulation*);
+    GMultiCells(Simulation*, const std::string&);
+
+    virtual ~GMultiCells() {}
+
+    virtual Event getEvent(const Particle &) const;
+
+    virtual void runEvent(Particle&, const double);
+
+    virtual void initialise(size_t);
+
+    virtual void reinitialise();
+
+    void getParticleNeighbours(const Particle&, std::vector<size_t>&) const;
+    void getParticleNeighbours(const Vector&, std::vector<size_t>&) const;
+
+    virtual void operator<<(const magnet::xml::Node&);
+
+    virtual double getMaxSupportedInteractionLength() const;
+
+    void setConfigOutput(bool val) { _inConfig = val; }
+
+    //! \brief The number of levels in the cell hierarchy.
+    size_t getLevelCount() const { return _levels.size(); }
+
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    virtual void loadCheckpoint(CheckpointReader&);
+
+  protected:
+    GMultiCells(const GMultiCells&);
+
+    virtual void outputXML(magnet::xml::XmlStream&) const;
+
+    void buildLevels();
+    void addCells(detail::CellLevel&, size_t);
+
+    std::array<size_t, 3> getCellCoords(const detail::CellLevel&, Vector) const;
+    Vector calcPosition(const detail::CellLevel&, const std::array<size_t, 3>& coords, const Particle& part) const;
+    Vector calcPosition(const detail::CellLevel&, const std::array<size_t, 3>& coords) const;
+    double getSupportedLength(const detail::CellLevel&) const;
+
+    /*! \brief Calculate the time until the particle leaves its cell
+        on the passed level.
+     */
+    double getLevelEventTime(const detail::CellLevel& level, const Particle& part) const;
+
+    /*! \brief Add the particles in the passed cells of a level which
+        should be tracked in that level as neighbours of a particle
+        from the level srcLevel.
+     */
+    template<class Range>
+    void addLevelNeighbours(const Range& cells, const size_t level, const size_t srcLevel, std::vector<size_t>& retlist) const
+    {
+      for (auto cellIndex : cells)
+	for (const size_t& id : _levels[level]._cellData.getCellContents(cellIndex))
+	  if ((srcLevel == level) || (_particleLevel[id] == level))
+	    retlist.push_back(id);
+    }
+
+    std::vector<detail::CellLevel> _levels;
+
+    //! \brief The level of each particle, indexed by the particle ID.
+    std::vector<size_t> _particleLevel;
+
+    /*! \brief Species whose interaction lengths are within this ratio
+        of the smallest species in a level are merged into that
+        level.
+     */
+    double _levelRatio;
+
+    bool _inConfig;
+  };
+}
@@ -26,6 +26,7 @@
 #include <dynamo/dynamics/gravity.hpp>
 #include <dynamo/outputplugins/outputplugin.hpp>
 #include <dynamo/particle.hpp>
+#include <dynamo/checkpoint.hpp>
 #include <boost/math/special_functions/pow.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
@@ -75,6 +76,22 @@ namespace dynamo {
       _cellD = XML.getAttribute("Diameter").as<double>() * Sim->units.unitLength();
   }
 
+  void
+  GSOCells::saveCheckpoint(CheckpointWriter& out) const
+  {
+    //The origins are only stored to the precision of the
+    //configuration file
+    out.tag("SOCells");
+    out.write(cell_origins);
+  }
+
+  void
+  GSOCells::loadCheckpoint(CheckpointReader& in)
+  {
+    in.tag("SOCells");
+    in.readFixed(cell_origins);
+  }
+
   Event 
   GSOCells::getEvent(const Particle& part) const
   {
@@ -153,8 +170,7 @@ namespace dynamo {
     //Now we're past the event update everything
     Sim->_sigParticleUpdate(EDat);
     Sim->ptrScheduler->fullUpdate(part);
-    for (shared_ptr<OutputPlugin> & Ptr : Sim->outputPlugins)
-      Ptr->eventUpdate(iEvent, EDat);
+    Sim->eventUpdate(iEvent, EDat);
 
   }
 
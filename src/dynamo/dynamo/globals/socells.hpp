@@ -39,6 +39,10 @@ namespace dynamo {
 
     virtual void outputXML(magnet::xml::XmlStream& XML) const;
 
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    virtual void loadCheckpoint(CheckpointReader&);
+
       void load_cell_origins(const std::vector<Particle>);
       
   protected:
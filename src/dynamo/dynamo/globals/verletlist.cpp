@@ -0,0 +1,309 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/globals/verletlist.hpp>
+#include <dynamo/NparticleEventData.hpp>
+#include <dynamo/dynamics/dynamics.hpp>
+#include <dynamo/dynamics/compression.hpp>
+#include <dynamo/units/units.hpp>
+#include <dynamo/schedulers/scheduler.hpp>
+#include <dynamo/BC/BC.hpp>
+#include <dynamo/species/species.hpp>
+#include <dynamo/outputplugins/outputplugin.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <magnet/xmlreader.hpp>
+#include <algorithm>
+
+namespace dynamo {
+  GVerletList::GVerletList(dynamo::Simulation* nSim, const std::string& name, double skin):
+    GNeighbourList(nSim, "VerletNeighbourList"),
+    _skin(skin),
+    _inConfig(true)
+  {
+    globName = name;
+    dout << "Verlet list Loaded" << std::endl;
+  }
+
+  GVerletList::GVerletList(const magnet::xml::Node& XML, dynamo::Simulation* ptrSim):
+    GNeighbourList(ptrSim, "VerletNeighbourList"),
+    _skin(0.3),
+    _inConfig(true)
+  {
+    operator<<(XML);
+    dout << "Verlet list Loaded" << std::endl;
+  }
+
+  void
+  GVerletList::operator<<(const magnet::xml::Node& XML)
+  {
+    if (XML.hasAttribute("NeighbourhoodRange"))
+      _maxInteractionRange = XML.getAttribute("NeighbourhoodRange").as<double>() * Sim->units.unitLength();
+
+    if (XML.hasAttribute("Skin"))
+      _skin = XML.getAttribute("Skin").as<double>();
+
+    if (_skin <= 0)
+      M_throw() << "The Skin of the VerletList neighbour list must be positive";
+
+    globName = XML.getAttribute("Name");
+    range = shared_ptr<IDRange>(IDRange::getClass(XML.getNode("IDRange"), Sim));
+  }
+
+  void
+  GVerletList::outputXML(magnet::xml::XmlStream& XML) const
+  {
+    if (!_inConfig) return;
+    XML << magnet::xml::tag("Global")
+	<< magnet::xml::attr("Type") << "VerletList"
+	<< magnet::xml::attr("Name") << globName
+	<< magnet::xml::attr("NeighbourhoodRange")
+	<< _maxInteractionRange / Sim->units.unitLength()
+	<< magnet::xml::attr("Skin") << _skin
+	<< range
+	<< magnet::xml::endtag("Global");
+  }
+
+  Event
+  GVerletList::getEvent(const Particle& part) const
+  {
+#ifdef ISSS_DEBUG
+    if (!Sim->dynamics->isUpToDate(part))
+      M_throw() << "Particle is not up to date";
+#endif
+
+    //The anchor is a stationary sphere which the particle must
+    //leave. It is marked as not dynamic so that it does not feel
+    //any external fields.
+    Particle anchor(_anchors[part.getID()], Vector{0, 0, 0}, part.getID());
+    anchor.clearState(Particle::DYNAMIC);
+
+    //As with the GCells, the particle does not need to be updated as
+    //we compensate for the delay using
+    //Sim->dynamics->getParticleDelay(part)
+    return Event(part, Sim->dynamics->SphereSphereOutRoot(part, anchor, 0.5 * _skin * _maxInteractionRange) - Sim->dynamics->getParticleDelay(part), GLOBAL, CELL, ID);
+  }
+
+  void
+  GVerletList::runEvent(Particle& part, const double dt)
+  {
+    //Unlike the GCells, the event cannot be processed early, as the
+    //new anchor must be the position of the particle as it leaves its
+    //skin. The system is moved forward to the time of the event as
+    //is done in the GPBCSentinel.
+    Event iEvent(part, dt, GLOBAL, CELL, ID);
+
+    Sim->systemTime += dt;
+    Sim->ptrScheduler->stream(dt);
+    Sim->stream(dt);
+    Sim->dynamics->updateParticle(part);
+
+    //Get rid of the virtual event we're running, an updated event is
+    //pushed after the callbacks are complete (the callbacks may also
+    //add events so this must be done first).
+    Sim->ptrScheduler->popNextEvent();
+
+    const size_t pID = part.getID();
+
+    //Keep a copy of the old list so that only genuinely new
+    //neighbours are passed to the scheduler.
+    std::vector<size_t> oldList(_lists[pID]);
+    std::sort(oldList.begin(), oldList.end());
+    detachParticle(pID);
+
+    //Re-anchor the particle at its current position
+    _anchors[pID] = part.getPosition();
+    Sim->BCs->applyBC(_anchors[pID]);
+    const auto cellCoords = getCellCoords(_anchors[pID]);
+    _cellData.moveTo(_cellData.getCellID(pID), _ordering.toIndex(cellCoords), pID);
+
+    for (auto cellIndex : _ordering.getSurroundingIndices(cellCoords, std::array<size_t, 3>{{1, 1, 1}}))
+      for (const size_t& next : _cellData.getCellContents(cellIndex))
+	if (testAndAddPair(pID, next) && !std::binary_search(oldList.begin(), oldList.end(), next))
+	  _sigNewNeighbour(part, next);
+
+    //Push the next virtual event, this is the reason the scheduler
+    //doesn't need a second callback
+    Sim->ptrScheduler->pushEvent(getEvent(part));
+
+    //The output plugins must be told that time has passed. The
+    //particle's state is unchanged so its other events remain valid.
+    NEventData EDat(ParticleEventData(part, *Sim->species(part), VIRTUAL));
+    Sim->eventUpdate(iEvent, EDat);
+  }
+
+  bool
+  GVerletList::testAndAddPair(const size_t p1, const size_t p2)
+  {
+    if (p1 == p2) return false;
+
+    Vector r12 = _anchors[p1] - _anchors[p2];
+    Sim->BCs->applyBC(r12);
+    const double listRange = getListRange();
+    if (r12.nrm2() >= listRange * listRange) return false;
+
+    _lists[p1].push_back(p2);
+    _lists[p2].push_back(p1);
+    return true;
+  }
+
+  void
+  GVerletList::detachParticle(const size_t p1)
+  {
+    for (const size_t p2 : _lists[p1])
+      {
+	std::vector<size_t>& list = _lists[p2];
+	auto it = std::find(list.begin(), list.end(), p1);
+#ifdef DYNAMO_DEBUG
+	if (it == list.end())
+	  M_throw() << "Verlet lists are not symmetric for particles " << p1 << " and " << p2;
+#endif
+	*it = list.back();
+	list.pop_back();
+      }
+
+    _lists[p1].clear();
+  }
+
+  void
+  GVerletList::initialise(size_t nID)
+  {
+    Global::initialise(nID);
+    reinitialise();
+  }
+
+  void
+  GVerletList::reinitialise()
+  {
+    if (std::dynamic_pointer_cast<DynCompression>(Sim->dynamics))
+      M_throw() << "The VerletList neighbour list does not support compression dynamics, use the Cells neighbour list instead";
+
+    GNeighbourList::reinitialise();
+
+    dout << "Reinitialising on collision " << Sim->eventCount << std::endl;
+
+    //The anchor cells must contain the whole list range, and there
+    //must be at least three cells in each dimension so that the
+    //surrounding cells are all unique.
+    const double embiggen = 1.0 + 10 * std::numeric_limits<double>::epsilon();
+    std::array<size_t, 3> cellCount;
+    for (size_t iDim = 0; iDim < NDIM; iDim++)
+      {
+	cellCount[iDim] = size_t(Sim->primaryCellSize[iDim] / (getListRange() * embiggen));
+	if (cellCount[iDim] < 3)
+	  M_throw() << "The system size is too small to support the range of the Verlet lists, try reducing the Skin or using the Cells neighbour list.";
+	_cellLatticeWidth[iDim] = Sim->primaryCellSize[iDim] / cellCount[iDim];
+      }
+    _ordering = Ordering(cellCount);
+
+    dout << "List range " << getListRange() / Sim->units.unitLength()
+	 << "\nSkin " << _skin
+	 << "\nAnchor cells " << cellCount[0] << "," << cellCount[1] << "," << cellCount[2]
+	 << std::endl;
+
+    //Required so particles are anchored at their current positions
+    Sim->dynamics->updateAllParticles();
+
+    _cellData.clear();
+    _cellData.resize(_ordering.length(), Sim->particles.size());
+    _anchors.assign(Sim->particles.size(), Vector{0, 0, 0});
+    _lists.clear();
+    _lists.resize(Sim->particles.size());
+
+    for (const size_t& pid : *range)
+      {
+	_anchors[pid] = Sim->particles[pid].getPosition();
+	Sim->BCs->applyBC(_anchors[pid]);
+	_cellData.add(_ordering.toIndex(getCellCoords(_anchors[pid])), pid);
+      }
+
+    size_t pairs = 0;
+    for (const size_t& pid : *range)
+      for (auto cellIndex : _ordering.getSurroundingIndices(getCellCoords(_anchors[pid]), std::array<size_t, 3>{{1, 1, 1}}))
+	for (const size_t& next : _cellData.getCellContents(cellIndex))
+	  if (next > pid)
+	    pairs += testAndAddPair(pid, next);
+
+    dout << "Average list length " << (range->size() ? 2.0 * pairs / range->size() : 0.0) << std::endl;
+
+    _sigReInitialise();
+  }
+
+  void
+  GVerletList::saveCheckpoint(CheckpointWriter& out) const
+  {
+    out.tag("VerletList");
+    out.write(_ordering.getDimensions());
+    _cellData.saveCheckpoint(out, _ordering.length());
+    out.write(_anchors);
+    for (const std::vector<size_t>& list : _lists)
+      out.write(list);
+  }
+
+  void
+  GVerletList::loadCheckpoint(CheckpointReader& in)
+  {
+    in.tag("VerletList");
+    if (in.read<std::array<size_t, 3> >() != _ordering.getDimensions())
+      M_throw() << "The anchor cells of " << globName << " in the checkpoint " << in.getName() << " do not match the configuration";
+    _cellData.loadCheckpoint(in, _ordering.length(), Sim->particles.size());
+    in.readFixed(_anchors);
+    for (std::vector<size_t>& list : _lists)
+      in.read(list);
+  }
+
+  std::array<size_t, 3>
+  GVerletList::getCellCoords(Vector pos) const
+  {
+    Sim->BCs->applyBC(pos);
+
+    std::array<size_t, 3> retval;
+
+    for (size_t iDim = 0; iDim < NDIM; iDim++)
+      {
+	long coord = std::floor(pos[iDim] / _cellLatticeWidth[iDim] + 0.5 * _ordering.getDimensions()[iDim]);
+	coord %= long(_ordering.getDimensions()[iDim]);
+	if (coord < 0) coord += _ordering.getDimensions()[iDim];
+	retval[iDim] = coord;
+      }
+
+    return retval;
+  }
+
+  void
+  GVerletList::getParticleNeighbours(const Particle& part, std::vector<size_t>& retlist) const
+  {
+    const std::vector<size_t>& list = _lists[part.getID()];
+    retlist.insert(retlist.end(), list.begin(), list.end());
+  }
+
+  void
+  GVerletList::getParticleNeighbours(const Vector& vec, std::vector<size_t>& retlist) const
+  {
+    //Any particle within the neighbourhood range of the point has its
+    //anchor within the list range, so the surrounding anchor cells
+    //are sufficient.
+    for (auto cellIndex : _ordering.getSurroundingIndices(getCellCoords(vec), std::array<size_t, 3>{{1, 1, 1}}))
+      {
+	const auto& neighbours = _cellData.getCellContents(cellIndex);
+	retlist.insert(retlist.end(), neighbours.begin(), neighbours.end());
+      }
+  }
+
+  double
+  GVerletList::getMaxSupportedInteractionLength() const
+  { return _maxInteractionRange; }
+}
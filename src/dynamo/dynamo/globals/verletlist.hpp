@@ -0,0 +1,115 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/globals/cells.hpp>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief A Verlet (skin) neighbour list.
+
+    Each particle is given an "anchor" position, which is its position
+    when its list was last built. The neighbour list of a particle
+    contains every particle whose anchor is within
+    \f$\sigma(1+s)\f$ of its own anchor, where \f$\sigma\f$ is the
+    neighbourhood range and \f$s\f$ is the (relative) skin width.
+
+    While every particle remains within \f$\sigma\,s/2\f$ of its
+    anchor, any pair of particles within \f$\sigma\f$ of each other
+    must be in each others lists. A single "skin exit" event is
+    scheduled per particle for when it leaves this sphere, which is
+    calculated using Dynamics::SphereSphereOutRoot. When it fires,
+    the particle is re-anchored at its current position and only its
+    own list entries are rebuilt. This replaces the many cell
+    transition events of the GCells neighbour list, which is
+    beneficial in dense fluids where particles rattle in their cage
+    and rarely travel far.
+
+    The anchors are themselves sorted into a regular (non
+    overlapping) grid of cells, so the rebuild of a single particle's
+    list only needs to test the particles in the surrounding 27
+    cells.
+   */
+  class GVerletList: public GNeighbourList
+  {
+  public:
+    GVerletList(const magnet::xml::Node&, dynamo::Simulation*);
+    GVerletList(Simulation*, const std::string&, double skin = 0.3);
+
+    virtual ~GVerletList() {}
+
+    virtual Event getEvent(const Particle &) const;
+
+    virtual void runEvent(Particle&, const double);
+
+    virtual void initialise(size_t);
+
+    virtual void reinitialise();
+
+    void getParticleNeighbours(const Particle&, std::vector<size_t>&) const;
+    void getParticleNeighbours(const Vector&, std::vector<size_t>&) const;
+
+    virtual void operator<<(const magnet::xml::Node&);
+
+    virtual double getMaxSupportedInteractionLength() const;
+
+    void setConfigOutput(bool val) { _inConfig = val; }
+
+    //! \brief The (absolute) radius of the list around each anchor.
+    double getListRange() const { return _maxInteractionRange * (1 + _skin); }
+
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    virtual void loadCheckpoint(CheckpointReader&);
+
+  protected:
+    GVerletList(const GVerletList&);
+
+    virtual void outputXML(magnet::xml::XmlStream&) const;
+
+    std::array<size_t, 3> getCellCoords(Vector) const;
+
+    //! \brief Add the pair to each others lists if their anchors are in range.
+    bool testAndAddPair(const size_t, const size_t);
+
+    //! \brief Remove the particle from the lists of all its neighbours.
+    void detachParticle(const size_t);
+
+    typedef magnet::containers::RowMajorOrdering<3> Ordering;
+    Ordering _ordering;
+    Vector _cellLatticeWidth;
+
+#ifdef DYNAMO_JUDY
+    detail::CellParticleList<magnet::containers::Vector_Multimap<magnet::containers::VectorSet<size_t>>,
+			     magnet::containers::JudyMap<size_t, size_t>> _cellData;
+#else
+    detail::CellParticleList<magnet::containers::Vector_Multimap<magnet::containers::VectorSet<size_t>>,
+			     std::unordered_map<size_t, size_t> > _cellData;
+#endif
+
+    //! \brief The anchor position of each particle, indexed by particle ID.
+    std::vector<Vector> _anchors;
+
+    //! \brief The neighbour list of each particle, indexed by particle ID.
+    std::vector<std::vector<size_t> > _lists;
+
+    //! \brief The skin width, relative to the neighbourhood range.
+    double _skin;
+
+    bool _inConfig;
+  };
+}
@@ -143,8 +143,7 @@ namespace dynamo {
       
     Sim->_sigParticleUpdate(EDat);
       
-    for (shared_ptr<OutputPlugin> & Ptr : Sim->outputPlugins)
-      Ptr->eventUpdate(iEvent, EDat);
+    Sim->eventUpdate(iEvent, EDat);
 
     //Now we're past the event, update the scheduler and plugins
     Sim->ptrScheduler->fullUpdate(part);
@@ -57,15 +57,27 @@ namespace dynamo {
 
     ICapture::loadCaptureMap(XML);
 
+    _NH_HBonds.clear();
+    _CO_HBonds.clear();
     if (XML.hasNode("HBonds"))
       for (magnet::xml::Node node = XML.getNode("HBonds").findNode("Bond"); node.valid(); ++node)
-	_HBonds.insert(HbondMapType::value_type(node.getAttribute("NH").as<size_t>(), node.getAttribute("CO").as<size_t>()));
+	formHBond(node.getAttribute("NH").as<size_t>(), node.getAttribute("CO").as<size_t>());
   }
 
   void 
   IPRIME::initialise(size_t nID)
   {
     Interaction::initialise(nID);
+
+    //Tabulate the parameters which only depend on the bead types and
+    //their separation
+    _pairParameters.resize(SEPARATION_COUNT * 22 * 22);
+    for (size_t sep(0); sep < SEPARATION_COUNT; ++sep)
+      for (size_t type1(0); type1 < 22; ++type1)
+	for (size_t type2(type1); type2 < 22; ++type2)
+	  _pairParameters[(sep * 22 + type1) * 22 + type2] 
+	    = calcPairParameters(TPRIME::PRIME_residue_type(type1), TPRIME::PRIME_residue_type(type2), PairSeparation(sep));
+
     ICapture::initCaptureMap();
 
     //Need to initialise the HBond map!
@@ -109,8 +121,8 @@ namespace dynamo {
   double 
   IPRIME::getInternalEnergy(const Particle& p1, const Particle& p2) const
   {
-    TPRIME::BeadData p1Data = getBeadData(p1.getID());
-    TPRIME::BeadData p2Data = getBeadData(p2.getID());
+    const TPRIME::BeadData& p1Data = getBeadData(p1.getID());
+    const TPRIME::BeadData& p2Data = getBeadData(p2.getID());
     double pairEnergy;
 
     //Need to be careful with HBonds if the pair are both backbone
@@ -122,7 +134,7 @@ namespace dynamo {
             size_t NH_res = p1Data.bead_type == TPRIME::NH ? p1Data.residue : p2Data.residue;
             size_t CO_res = p1Data.bead_type == TPRIME::CO ? p1Data.residue : p2Data.residue;
             //Are they in an Hbond?
-            if (_HBonds.count(HbondMapType::value_type(NH_res, CO_res)))
+            if (hasHBond(NH_res, CO_res))
                 pairEnergy = - _PRIME_HB_strength;
             else
                 pairEnergy = isCaptured(p1, p2) * TPRIME::_PRIME_well_depths[ 22 * p1Data.bead_type + p2Data.bead_type];
@@ -168,214 +180,211 @@ namespace dynamo {
     return maxdiam;
   }
 
-  std::tuple<double, double, double, size_t, size_t>
-  IPRIME::getInteractionParameters(size_t pID1, size_t pID2) const
+  IPRIME::PairSeparation
+  IPRIME::getSeparation(const TPRIME::BeadData& p1Data, const TPRIME::BeadData& p2Data)
   {
-    TPRIME::BeadData p1Data = getBeadData(pID1);
-    TPRIME::BeadData p2Data = getBeadData(pID2);
-    
-    //Ensure that the first bead has the lowest bead_type (it simplifies the logic later)
-    if (p1Data.bead_type > p2Data.bead_type) {
-      std::swap(pID1, pID2);
-      std::swap(p1Data, p2Data);
-    }
-
-    const size_t no_HB_res = std::numeric_limits<size_t>::max();
-
     if (p1Data.bead_type > TPRIME::CO) //SC-SC interaction (as p2Data.bead_type >= p1Data.bead_type)
-      {
-        const double inner_diameter = TPRIME::_PRIME_diameters[ 22 * p1Data.bead_type + p2Data.bead_type];
-        const double outer_diameter = TPRIME::_PRIME_well_diameters[ 22 * p1Data.bead_type + p2Data.bead_type];
-        const double bond_energy    = TPRIME::_PRIME_well_depths[ 22 * p1Data.bead_type + p2Data.bead_type];
-	return std::make_tuple(outer_diameter, inner_diameter, bond_energy, no_HB_res, no_HB_res);
-      }
-    else if (p2Data.bead_type <= TPRIME::CO) //BB-BB interaction (as p1Data.bead_type <= p2Data.bead_type)
+      return SC_SC;
+
+    if (p2Data.bead_type <= TPRIME::CO) //BB-BB interaction (as p1Data.bead_type <= p2Data.bead_type)
       {
         const size_t loc1 = p1Data.bead_type + 3 * p1Data.residue;
         const size_t loc2 = p2Data.bead_type + 3 * p2Data.residue;
         const size_t distance = std::max(loc1, loc2) - std::min(loc1, loc2);
 
-        //This treats the special cases if they are 0,1,2, or three backbone
-        //bonds apart
         switch (distance)
           {
           case 0:
             M_throw() << "Invalid backbone distance of 0";
-          case 1:
-            {
-	      //Every type of this interaction is a bonded interaction
-              const double inner_diameter = TPRIME::_PRIME_BB_bond_lengths[3 * p1Data.bead_type + p2Data.bead_type] * (1.0 - TPRIME::_PRIME_bond_tolerance);
-              const double outer_diameter = TPRIME::_PRIME_BB_bond_lengths[3 * p1Data.bead_type + p2Data.bead_type] * (1.0 + TPRIME::_PRIME_bond_tolerance);
-              const double bond_energy    = -std::numeric_limits<double>::infinity();
-	      return std::make_tuple(outer_diameter, inner_diameter, bond_energy, no_HB_res, no_HB_res);
-            }
-            break;
-          case 2:
-            {
-	      //Every type of this interaction is a pseudobond interaction
-              const double inner_diameter = TPRIME::_PRIME_pseudobond_lengths[3 * p1Data.bead_type + p2Data.bead_type] * (1.0 - TPRIME::_PRIME_bond_tolerance);
-              const double outer_diameter = TPRIME::_PRIME_pseudobond_lengths[3 * p1Data.bead_type + p2Data.bead_type] * (1.0 + TPRIME::_PRIME_bond_tolerance);
-              const double bond_energy = -std::numeric_limits<double>::infinity();
-	      return std::make_tuple(outer_diameter, inner_diameter, bond_energy, no_HB_res, no_HB_res);
-            }
-            break;
-          case 3:
-            {
-              //Check if this is the special pseudobond
-              if ((p1Data.bead_type == TPRIME::CH) && (p2Data.bead_type == TPRIME::CH))
-                {
-                  const double inner_diameter = TPRIME::_PRIME_CH_CH_pseudobond_length * (1.0 - TPRIME::_PRIME_bond_tolerance);
-                  const double outer_diameter = TPRIME::_PRIME_CH_CH_pseudobond_length * (1.0 + TPRIME::_PRIME_bond_tolerance);
-                  const double bond_energy = -std::numeric_limits<double>::infinity();
-		  return std::make_tuple(outer_diameter, inner_diameter, bond_energy, no_HB_res, no_HB_res);
-                }
-              else
-		{
-		  //Close backbone-backbone hard-sphere interaction
-		  const double inner_diameter = 0.0;
-		  const double outer_diameter = TPRIME::_PRIME_diameters[22 * p1Data.bead_type + p2Data.bead_type] * TPRIME::_PRIME_3_bonds_scale_factor;
-		  const double bond_energy = std::numeric_limits<double>::infinity();
-		  return std::make_tuple(outer_diameter, inner_diameter, bond_energy, no_HB_res, no_HB_res);
-		}
-	    }
-            break;
-          case 4:
-	    {
-	      //Close backbone-backbone hard-sphere interaction
-	      const double inner_diameter = 0.0;
-	      const double outer_diameter = TPRIME::_PRIME_diameters[22 * p1Data.bead_type + p2Data.bead_type] * TPRIME::_PRIME_4_bonds_scale_factor;
-	      const double bond_energy = std::numeric_limits<double>::infinity();
-	      return std::make_tuple(outer_diameter, inner_diameter, bond_energy, no_HB_res, no_HB_res);
+          case 1: return BB_1;
+          case 2: return BB_2;
+          case 3: return BB_3;
+          case 4: return BB_4;
+          default: return BB_FAR;
+          }
+      }
+
+    //BB-SC interaction
+    if (p1Data.residue == p2Data.residue) //They are [pseudo]bonded on the same residue
+      return SC_BB_BONDED;
+
+    //Check for cases where it could be a "close" interaction
+    if ((p2Data.residue == p1Data.residue + 1) && (p1Data.bead_type == TPRIME::CO)) //p1 is on the residue before p2
+      return SC_BB_3;
+
+    if ((p2Data.residue + 1 == p1Data.residue) && (p1Data.bead_type == TPRIME::NH)) //p2 is on the residue after p1
+      return SC_BB_3;
+
+    return SC_BB_FAR;
+  }
+
+  IPRIME::PairParameters
+  IPRIME::calcPairParameters(const TPRIME::PRIME_residue_type type1, const TPRIME::PRIME_residue_type type2, const PairSeparation sep)
+  {
+    const double inf = std::numeric_limits<double>::infinity();
+    switch (sep)
+      {
+      case SC_SC:
+	return PairParameters{TPRIME::_PRIME_well_diameters[22 * type1 + type2], TPRIME::_PRIME_diameters[22 * type1 + type2], TPRIME::_PRIME_well_depths[22 * type1 + type2]};
+      case BB_1:
+	//Every type of this interaction is a bonded interaction
+	return PairParameters{TPRIME::_PRIME_BB_bond_lengths[3 * type1 + type2] * (1.0 + TPRIME::_PRIME_bond_tolerance),
+	    TPRIME::_PRIME_BB_bond_lengths[3 * type1 + type2] * (1.0 - TPRIME::_PRIME_bond_tolerance), -inf};
+      case BB_2:
+	//Every type of this interaction is a pseudobond interaction
+	return PairParameters{TPRIME::_PRIME_pseudobond_lengths[3 * type1 + type2] * (1.0 + TPRIME::_PRIME_bond_tolerance),
+	    TPRIME::_PRIME_pseudobond_lengths[3 * type1 + type2] * (1.0 - TPRIME::_PRIME_bond_tolerance), -inf};
+      case BB_3:
+	//Check if this is the special pseudobond
+	if ((type1 == TPRIME::CH) && (type2 == TPRIME::CH))
+	  return PairParameters{TPRIME::_PRIME_CH_CH_pseudobond_length * (1.0 + TPRIME::_PRIME_bond_tolerance),
+	      TPRIME::_PRIME_CH_CH_pseudobond_length * (1.0 - TPRIME::_PRIME_bond_tolerance), -inf};
+	//Close backbone-backbone hard-sphere interaction
+	return PairParameters{TPRIME::_PRIME_diameters[22 * type1 + type2] * TPRIME::_PRIME_3_bonds_scale_factor, 0.0, inf};
+      case BB_4:
+	//Close backbone-backbone hard-sphere interaction
+	return PairParameters{TPRIME::_PRIME_diameters[22 * type1 + type2] * TPRIME::_PRIME_4_bonds_scale_factor, 0.0, inf};
+      case BB_FAR:
+	//It's a standard hard-sphere interaction (no HB interactions)
+	return PairParameters{TPRIME::_PRIME_diameters[22 * type1 + type2], 0.0, inf};
+      case SC_BB_BONDED:
+	return PairParameters{TPRIME::_PRIME_SC_BB_bond_lengths[type1] * (1.0 + TPRIME::_PRIME_bond_tolerance),
+	    TPRIME::_PRIME_SC_BB_bond_lengths[type1] * (1.0 - TPRIME::_PRIME_bond_tolerance), -inf};
+      case SC_BB_3:
+      case SC_BB_FAR:
+	{
+	  PairParameters params{TPRIME::_PRIME_well_diameters[22 * type1 + type2], TPRIME::_PRIME_diameters[22 * type1 + type2], TPRIME::_PRIME_well_depths[22 * type1 + type2]};
+	  
+	  if (params.bond_energy == 0)
+	    { 
+	      //Its a hard sphere interaction!
+	      params.bond_energy = inf;
+	      params.outer_diameter = params.inner_diameter;
+	      params.inner_diameter = 0;
 	    }
-            break;
-          default:
+
+	  if (sep == SC_BB_3)
 	    {
-	      //Determine if HB interactions are present or not
-	      //If the time-independent criteria are met, it's not a hard-sphere and we track distances.
-	      if ((p1Data.bead_type == TPRIME::NH) && (p2Data.bead_type == TPRIME::CO) && (p1Data.location != TPRIME::NH_END) && (p2Data.location != TPRIME::CO_END) && (std::abs(int(p1Data.residue) - int(p2Data.residue)) > 3) && (p1Data.residue_type != TPRIME::P))
-		{
-		  const size_t NH_res = p1Data.residue;
-		  const size_t CO_res = p2Data.residue;
-		  const double inner_diameter = TPRIME::_PRIME_diameters[ 22 * p1Data.bead_type + p2Data.bead_type ];
-		  const double outer_diameter = TPRIME::_PRIME_HB_well_diameter;
-		  const double bond_energy = checkTimeDependentCriteria(NH_res, CO_res, 0) ? -_PRIME_HB_strength : 0;
-		  return std::make_tuple(outer_diameter, inner_diameter, bond_energy, NH_res, CO_res);
-		}
-	      else if ((p1Data.bead_type == TPRIME::CH) && (p2Data.bead_type == TPRIME::CO) && (p1Data.location != TPRIME::NH_END) && (p2Data.location != TPRIME::CO_END) && (std::abs(int(p1Data.residue) - int(p2Data.residue)) > 3) && (p1Data.residue_type != TPRIME::P))
-		{
-		  const size_t NH_res = p1Data.residue;
-		  const size_t CO_res = p2Data.residue;
-		  const double inner_diameter = TPRIME::_PRIME_diameters[ 22 * p1Data.bead_type + p2Data.bead_type ];
-		  const double outer_diameter = TPRIME::_PRIME_HB_aux_min_distances[3 * p1Data.bead_type + p2Data.bead_type];
-		  const double bond_energy = checkTimeDependentCriteria(NH_res, CO_res, 4) ? _PRIME_HB_strength : 0;
-		  return std::make_tuple(outer_diameter, inner_diameter, bond_energy, NH_res, CO_res);
-		}
-	      else if ((p1Data.bead_type == TPRIME::CO) && (p2Data.bead_type == TPRIME::CO) && (p1Data.location != TPRIME::CO_END) && (p2Data.location != TPRIME::CO_END))
-		{
-		  const size_t NH_res_1 = p2Data.residue + 1;
-		  const size_t CO_res_1 = p1Data.residue;
-		  const bool valid_distance_1 = (std::abs(int(NH_res_1) - int(CO_res_1)) > 3);
-
-		  const size_t NH_res_2 = p1Data.residue + 1;
-		  const size_t CO_res_2 = p2Data.residue;
-		  const bool valid_distance_2 = (std::abs(int(NH_res_2) - int(CO_res_2)) > 3);
-	       
-		  if (valid_distance_1 || valid_distance_2)
-		    {
-		      const double inner_diameter = TPRIME::_PRIME_diameters[22 * p1Data.bead_type + p2Data.bead_type];
-		      const double outer_diameter = TPRIME::_PRIME_HB_aux_min_distances[3 * p1Data.bead_type + p2Data.bead_type];
-		      if (valid_distance_1 && checkTimeDependentCriteria(NH_res_1, CO_res_1, 3))
- 			return std::make_tuple(outer_diameter, inner_diameter, _PRIME_HB_strength, NH_res_1, CO_res_1);
-		      if (valid_distance_2 && checkTimeDependentCriteria(NH_res_2, CO_res_2, 3))
- 			return std::make_tuple(outer_diameter, inner_diameter, _PRIME_HB_strength, NH_res_2, CO_res_2);
-
- 		      return std::make_tuple(outer_diameter, inner_diameter, 0.0, no_HB_res, no_HB_res);
-		    }
-		}
-	      else if ((p1Data.bead_type == TPRIME::NH) && (p2Data.bead_type == TPRIME::NH) && (p1Data.location != TPRIME::NH_END) && (p2Data.location != TPRIME::NH_END))
-		{
-		  //First try assuming p1 is the main NH
-		  //then the main CO is pID2-1 and has a resID of p2Data.residue-1
-		
-		  const size_t NH_res_1 = p1Data.residue;
-		  const size_t CO_res_1 = p2Data.residue - 1;
-		  const bool valid_distance_1 = (std::abs(int(NH_res_1) - int(CO_res_1)) > 3);
-
-		  const size_t NH_res_2 = p2Data.residue;
-		  const size_t CO_res_2 = p1Data.residue - 1;
-		  const bool valid_distance_2 = (std::abs(int(NH_res_2) - int(CO_res_2)) > 3);
-	       
-		  if (valid_distance_1 || valid_distance_2)
-		    {
-		      const double inner_diameter = TPRIME::_PRIME_diameters[22 * p1Data.bead_type + p2Data.bead_type];
-		      const double outer_diameter = TPRIME::_PRIME_HB_aux_min_distances[3 * p1Data.bead_type + p2Data.bead_type];
-		      if (valid_distance_1 && (p1Data.residue_type != TPRIME::P) && checkTimeDependentCriteria(NH_res_1, CO_res_1, 2))
- 			return std::make_tuple(outer_diameter, inner_diameter, _PRIME_HB_strength, NH_res_1, CO_res_1);
-		      if (valid_distance_2 && (p2Data.residue_type != TPRIME::P) && checkTimeDependentCriteria(NH_res_2, CO_res_2, 2))
- 			return std::make_tuple(outer_diameter, inner_diameter, _PRIME_HB_strength, NH_res_2, CO_res_2);
-
- 		      return std::make_tuple(outer_diameter, inner_diameter, 0.0, no_HB_res, no_HB_res);
-		    }
-		}
-	      else if ((p1Data.bead_type == TPRIME::NH) && (p2Data.bead_type == TPRIME::CH) && (p1Data.location != TPRIME::NH_END) && (p2Data.location != TPRIME::CO_END) && (std::abs(int(p1Data.residue) - int(p2Data.residue)) > 3) && (p1Data.residue_type != TPRIME::P))
-		{		
-		  const size_t NH_res = p1Data.residue;
-		  const size_t CO_res = p2Data.residue;
-		  const double inner_diameter = TPRIME::_PRIME_diameters[22 * p1Data.bead_type + p2Data.bead_type];
-		  const double outer_diameter = TPRIME::_PRIME_HB_aux_min_distances[3 * p1Data.bead_type + p2Data.bead_type];
-		  const double bond_energy = checkTimeDependentCriteria(NH_res, CO_res, 1) ? _PRIME_HB_strength : 0;
-		  return std::make_tuple(outer_diameter, inner_diameter, bond_energy, NH_res, CO_res);
-		}
-	      break;
+	      params.inner_diameter *= TPRIME::_PRIME_3_bonds_scale_factor;
+	      params.outer_diameter *= TPRIME::_PRIME_3_bonds_scale_factor;
 	    }
-          };
+	  return params;
+	}
+      default:
+	M_throw() << "Unknown PRIME pair separation";
+      }
+  }
 
-	//It's a standard hard-sphere interaction (no HB interactions)
-	const double inner_diameter = 0.0;
-	const double outer_diameter = TPRIME::_PRIME_diameters[ 22 * p1Data.bead_type + p2Data.bead_type ];
-	const double bond_energy = std::numeric_limits<double>::infinity();
-	return std::make_tuple(outer_diameter, inner_diameter, bond_energy, no_HB_res, no_HB_res);
+  std::tuple<double, double, double, size_t, size_t>
+  IPRIME::getInteractionParameters(size_t pID1, size_t pID2) const
+  {
+    const TPRIME::BeadData* p1Data = &getBeadData(pID1);
+    const TPRIME::BeadData* p2Data = &getBeadData(pID2);
+    
+    //Ensure that the first bead has the lowest bead_type (it simplifies the logic later)
+    if (p1Data->bead_type > p2Data->bead_type)
+      std::swap(p1Data, p2Data);
+
+    const PairSeparation sep = getSeparation(*p1Data, *p2Data);
+
+    //Backbone pairs which are far apart may take part in H-Bonds
+    std::tuple<double, double, double, size_t, size_t> params;
+    if ((sep == BB_FAR) && getHBondParameters(*p1Data, *p2Data, params))
+      return params;
+
+    const size_t no_HB_res = std::numeric_limits<size_t>::max();
+    const PairParameters& pair = _pairParameters[(sep * 22 + p1Data->bead_type) * 22 + p2Data->bead_type];
+    return std::make_tuple(pair.outer_diameter, pair.inner_diameter, pair.bond_energy, no_HB_res, no_HB_res);
+  }
+
+  bool
+  IPRIME::getHBondParameters(const TPRIME::BeadData& p1Data, const TPRIME::BeadData& p2Data, std::tuple<double, double, double, size_t, size_t>& params) const
+  {
+    const size_t no_HB_res = std::numeric_limits<size_t>::max();
+
+    //Determine if HB interactions are present or not
+    //If the time-independent criteria are met, it's not a hard-sphere and we track distances.
+    if ((p1Data.bead_type == TPRIME::NH) && (p2Data.bead_type == TPRIME::CO) && (p1Data.location != TPRIME::NH_END) && (p2Data.location != TPRIME::CO_END) && (std::abs(int(p1Data.residue) - int(p2Data.residue)) > 3) && (p1Data.residue_type != TPRIME::P))
+      {
+	const size_t NH_res = p1Data.residue;
+	const size_t CO_res = p2Data.residue;
+	const double inner_diameter = TPRIME::_PRIME_diameters[ 22 * p1Data.bead_type + p2Data.bead_type ];
+	const double outer_diameter = TPRIME::_PRIME_HB_well_diameter;
+	const double bond_energy = checkTimeDependentCriteria(NH_res, CO_res, 0) ? -_PRIME_HB_strength : 0;
+	params = std::make_tuple(outer_diameter, inner_diameter, bond_energy, NH_res, CO_res);
+	return true;
       }
-    else //BB-SC interaction
+    else if ((p1Data.bead_type == TPRIME::CH) && (p2Data.bead_type == TPRIME::CO) && (p1Data.location != TPRIME::NH_END) && (p2Data.location != TPRIME::CO_END) && (std::abs(int(p1Data.residue) - int(p2Data.residue)) > 3) && (p1Data.residue_type != TPRIME::P))
       {
-        if (p1Data.residue == p2Data.residue) //They are [pseudo]bonded on the same residue
-          {
-	    const double inner_diameter = TPRIME::_PRIME_SC_BB_bond_lengths[ p1Data.bead_type ] * (1.0 - TPRIME::_PRIME_bond_tolerance);
-	    const double outer_diameter = TPRIME::_PRIME_SC_BB_bond_lengths[ p1Data.bead_type ] * (1.0 + TPRIME::_PRIME_bond_tolerance);
-	    const double bond_energy = -std::numeric_limits<double>::infinity();
-	    return std::make_tuple(outer_diameter, inner_diameter, bond_energy, no_HB_res, no_HB_res);
-          }
-        else
-          {
-            double inner_diameter = TPRIME::_PRIME_diameters[22 * p1Data.bead_type + p2Data.bead_type];
-            double outer_diameter = TPRIME::_PRIME_well_diameters[22 * p1Data.bead_type + p2Data.bead_type];
-            double bond_energy = TPRIME::_PRIME_well_depths[22 * p1Data.bead_type + p2Data.bead_type];
-
-	    if (bond_energy == 0)
-	      { 
-		//Its a hard sphere interaction!
-		bond_energy = +std::numeric_limits<double>::infinity();
-		outer_diameter = inner_diameter;
-		inner_diameter = 0;
-	      }
+	const size_t NH_res = p1Data.residue;
+	const size_t CO_res = p2Data.residue;
+	const double inner_diameter = TPRIME::_PRIME_diameters[ 22 * p1Data.bead_type + p2Data.bead_type ];
+	const double outer_diameter = TPRIME::_PRIME_HB_aux_min_distances[3 * p1Data.bead_type + p2Data.bead_type];
+	const double bond_energy = checkTimeDependentCriteria(NH_res, CO_res, 4) ? _PRIME_HB_strength : 0;
+	params = std::make_tuple(outer_diameter, inner_diameter, bond_energy, NH_res, CO_res);
+	return true;
+      }
+    else if ((p1Data.bead_type == TPRIME::CO) && (p2Data.bead_type == TPRIME::CO) && (p1Data.location != TPRIME::CO_END) && (p2Data.location != TPRIME::CO_END))
+      {
+	const size_t NH_res_1 = p2Data.residue + 1;
+	const size_t CO_res_1 = p1Data.residue;
+	const bool valid_distance_1 = (std::abs(int(NH_res_1) - int(CO_res_1)) > 3);
 
-            //Check for cases where it could be a "close" interaction
-            if ((p2Data.residue - 1 ==  p1Data.residue) && (p1Data.bead_type == TPRIME::CO))
-              { //p1 is on the residue before p2
-		inner_diameter *= TPRIME::_PRIME_3_bonds_scale_factor;
-		outer_diameter *= TPRIME::_PRIME_3_bonds_scale_factor;
-	      }
-            else if ((p2Data.residue + 1 == p1Data.residue) && (p1Data.bead_type == TPRIME::NH))
-              { //p2 is on the residue after p1
-		inner_diameter *= TPRIME::_PRIME_3_bonds_scale_factor;
-		outer_diameter *= TPRIME::_PRIME_3_bonds_scale_factor;
-              }
+	const size_t NH_res_2 = p1Data.residue + 1;
+	const size_t CO_res_2 = p2Data.residue;
+	const bool valid_distance_2 = (std::abs(int(NH_res_2) - int(CO_res_2)) > 3);
 
-	    return std::make_tuple(outer_diameter, inner_diameter, bond_energy, no_HB_res, no_HB_res);
-          }
+	if (valid_distance_1 || valid_distance_2)
+	  {
+	    const double inner_diameter = TPRIME::_PRIME_diameters[22 * p1Data.bead_type + p2Data.bead_type];
+	    const double outer_diameter = TPRIME::_PRIME_HB_aux_min_distances[3 * p1Data.bead_type + p2Data.bead_type];
+	    if (valid_distance_1 && checkTimeDependentCriteria(NH_res_1, CO_res_1, 3))
+	      { params = std::make_tuple(outer_diameter, inner_diameter, _PRIME_HB_strength, NH_res_1, CO_res_1); return true; }
+	    if (valid_distance_2 && checkTimeDependentCriteria(NH_res_2, CO_res_2, 3))
+	      { params = std::make_tuple(outer_diameter, inner_diameter, _PRIME_HB_strength, NH_res_2, CO_res_2); return true; }
+
+	    params = std::make_tuple(outer_diameter, inner_diameter, 0.0, no_HB_res, no_HB_res);
+	    return true;
+	  }
       }
+    else if ((p1Data.bead_type == TPRIME::NH) && (p2Data.bead_type == TPRIME::NH) && (p1Data.location != TPRIME::NH_END) && (p2Data.location != TPRIME::NH_END))
+      {
+	//First try assuming p1 is the main NH
+	//then the main CO is pID2-1 and has a resID of p2Data.residue-1
+
+	const size_t NH_res_1 = p1Data.residue;
+	const size_t CO_res_1 = p2Data.residue - 1;
+	const bool valid_distance_1 = (std::abs(int(NH_res_1) - int(CO_res_1)) > 3);
 
-    M_throw() << "Missing return statement in getInteractionParameter!";
+	const size_t NH_res_2 = p2Data.residue;
+	const size_t CO_res_2 = p1Data.residue - 1;
+	const bool valid_distance_2 = (std::abs(int(NH_res_2) - int(CO_res_2)) > 3);
+
+	if (valid_distance_1 || valid_distance_2)
+	  {
+	    const double inner_diameter = TPRIME::_PRIME_diameters[22 * p1Data.bead_type + p2Data.bead_type];
+	    const double outer_diameter = TPRIME::_PRIME_HB_aux_min_distances[3 * p1Data.bead_type + p2Data.bead_type];
+	    if (valid_distance_1 && (p1Data.residue_type != TPRIME::P) && checkTimeDependentCriteria(NH_res_1, CO_res_1, 2))
+	      { params = std::make_tuple(outer_diameter, inner_diameter, _PRIME_HB_strength, NH_res_1, CO_res_1); return true; }
+	    if (valid_distance_2 && (p2Data.residue_type != TPRIME::P) && checkTimeDependentCriteria(NH_res_2, CO_res_2, 2))
+	      { params = std::make_tuple(outer_diameter, inner_diameter, _PRIME_HB_strength, NH_res_2, CO_res_2); return true; }
+
+	    params = std::make_tuple(outer_diameter, inner_diameter, 0.0, no_HB_res, no_HB_res);
+	    return true;
+	  }
+      }
+    else if ((p1Data.bead_type == TPRIME::NH) && (p2Data.bead_type == TPRIME::CH) && (p1Data.location != TPRIME::NH_END) && (p2Data.location != TPRIME::CO_END) && (std::abs(int(p1Data.residue) - int(p2Data.residue)) > 3) && (p1Data.residue_type != TPRIME::P))
+      {               
+	const size_t NH_res = p1Data.residue;
+	const size_t CO_res = p2Data.residue;
+	const double inner_diameter = TPRIME::_PRIME_diameters[22 * p1Data.bead_type + p2Data.bead_type];
+	const double outer_diameter = TPRIME::_PRIME_HB_aux_min_distances[3 * p1Data.bead_type + p2Data.bead_type];
+	const double bond_energy = checkTimeDependentCriteria(NH_res, CO_res, 1) ? _PRIME_HB_strength : 0;
+	params = std::make_tuple(outer_diameter, inner_diameter, bond_energy, NH_res, CO_res);
+	return true;
+      }
+
+    return false;
   }
 
   bool
@@ -385,11 +394,13 @@ namespace dynamo {
     //NH_ID and CO_ID give the IDs of the central NH-CO pair in the candidate hydrogen bond.
 
     //Check if the pair are already bonded
-    if (_HBonds.count(HbondMapType::value_type(NH_res, CO_res)))
+    if (hasHBond(NH_res, CO_res))
       return true; //They are!
 
     //Check if either pair are already within a H-Bond
-    if (_HBonds.by<NH_res_ID>().count(NH_res) || _HBonds.by<CO_res_ID>().count(CO_res))
+    const size_t no_HB_res = std::numeric_limits<size_t>::max();
+    if (((NH_res < _NH_HBonds.size()) && (_NH_HBonds[NH_res] != no_HB_res))
+	|| ((CO_res < _CO_HBonds.size()) && (_CO_HBonds[CO_res] != no_HB_res)))
       return false; //At least one residue is already bonded, so this pair cannot form.
 
     bool all_captures_satisfied = true;
@@ -575,51 +586,33 @@ namespace dynamo {
 
   void 
   IPRIME::formHBond(const size_t NH_res, const size_t CO_res) {
-    //dout << "(" << std::setw(9) << Sim->systemTime/Sim->units.unitTime() << ") FORMING A BOND! NH, CO residues: " << NH_res << ", " << CO_res << std::endl;
-    auto retval = _HBonds.insert(HbondMapType::value_type(NH_res, CO_res));
-    if (retval.second == false)
+    const size_t no_HB_res = std::numeric_limits<size_t>::max();
+    if (NH_res >= _NH_HBonds.size())
+      _NH_HBonds.resize(NH_res + 1, no_HB_res);
+    if (CO_res >= _CO_HBonds.size())
+      _CO_HBonds.resize(CO_res + 1, no_HB_res);
+
+    if ((_NH_HBonds[NH_res] != no_HB_res) || (_CO_HBonds[CO_res] != no_HB_res))
       M_throw() << "Failed to form a HBond";
 
-    //size_t alpha_Hbonds=0;
-    //size_t antialpha_Hbonds=0;
-    //for (auto iter = _HBonds.left.begin(); iter != _HBonds.left.end(); ++iter)
-    //{
-      //if ( iter->first + 4 == iter->second ){
-          //antialpha_Hbonds++;
-      //}
-      //if ( iter->first - 4 == iter->second ){
-          //alpha_Hbonds++;
-      //}
-    //}
-    //dout << "HBs: " << _HBonds.size() << ", alpha HBs: " << alpha_Hbonds <<  ", antialpha HBs: " << antialpha_Hbonds << std::endl;
+    _NH_HBonds[NH_res] = CO_res;
+    _CO_HBonds[CO_res] = NH_res;
   }
 
   void 
   IPRIME::breakHBond(const size_t NH_res, const size_t CO_res) {
-    //dout << "(" << std::setw(9) << Sim->systemTime/Sim->units.unitTime() << ") BREAKING A BOND! NH, CO residues: " << NH_res << ", " << CO_res << std::endl;
-    size_t deleted_count = _HBonds.erase(HbondMapType::value_type(NH_res, CO_res));
-    if (deleted_count == 0)
+    if (!hasHBond(NH_res, CO_res))
       M_throw() << "Failed to break a HBond";
 
-    //size_t alpha_Hbonds=0;
-    //size_t antialpha_Hbonds=0;
-    //for (auto iter = _HBonds.left.begin(); iter != _HBonds.left.end(); ++iter)
-    //{
-      //if ( iter->first + 4 == iter->second ){
-          //antialpha_Hbonds++;
-      //}
-      //if ( iter->first - 4 == iter->second ){
-          //alpha_Hbonds++;
-      //}
-    //}
-    //dout << "HBs: " << _HBonds.size() << ", alpha HBs: " << alpha_Hbonds <<  ", antialpha HBs: " << antialpha_Hbonds << std::endl;
+    _NH_HBonds[NH_res] = std::numeric_limits<size_t>::max();
+    _CO_HBonds[CO_res] = std::numeric_limits<size_t>::max();
   }
 
   bool 
   IPRIME::validateState(const Particle& p1, const Particle& p2, bool textoutput) const
   {
-    const TPRIME::BeadData p1Data = getBeadData(p1);
-    const TPRIME::BeadData p2Data = getBeadData(p2);
+    const TPRIME::BeadData& p1Data = getBeadData(p1);
+    const TPRIME::BeadData& p2Data = getBeadData(p2);
 
     //Calculate the interaction parameters (and name them sensibly)
     const auto interaction_data = getInteractionParameters(p1.getID(), p2.getID());    
@@ -720,11 +713,12 @@ namespace dynamo {
     ICapture::outputCaptureMap(XML);
     
     XML << magnet::xml::tag("HBonds");
-    for (auto iter = _HBonds.left.begin(); iter != _HBonds.left.end(); ++iter)
-      XML << magnet::xml::tag("Bond")
-	  << magnet::xml::attr("NH")  << iter->first
-	  << magnet::xml::attr("CO")  << iter->second
-	  << magnet::xml::endtag("Bond");
+    for (size_t NH_res(0); NH_res < _NH_HBonds.size(); ++NH_res)
+      if (_NH_HBonds[NH_res] != std::numeric_limits<size_t>::max())
+	XML << magnet::xml::tag("Bond")
+	    << magnet::xml::attr("NH")  << NH_res
+	    << magnet::xml::attr("CO")  << _NH_HBonds[NH_res]
+	    << magnet::xml::endtag("Bond");
     XML << magnet::xml::endtag("HBonds");
   }
 }
@@ -21,8 +21,8 @@
 #include <dynamo/simulation.hpp>
 #include <dynamo/topology/PRIME.hpp>
 #include <dynamo/interactions/captures.hpp>
-#include <boost/bimap/bimap.hpp>
-#include <boost/bimap/unordered_set_of.hpp>
+#include <limits>
+#include <vector>
 
 namespace dynamo {
   class IPRIME: public ICapture
@@ -58,13 +58,18 @@ namespace dynamo {
   protected:
     /*! \brief Returns the type of the bead on the backbone.
      */
-    TPRIME::BeadData getBeadData(const size_t particleID) const {
+    const TPRIME::BeadData& getBeadData(const size_t particleID) const {
       return _topology->getBeadInfo(particleID);
     }
 
     void formHBond(const size_t NH_res, const size_t CO_res);
     void breakHBond(const size_t NH_res, const size_t CO_res);
 
+    //! \brief Test if the NH and CO residues are in a H-Bond together.
+    bool hasHBond(const size_t NH_res, const size_t CO_res) const {
+      return (NH_res < _NH_HBonds.size()) && (_NH_HBonds[NH_res] == CO_res);
+    }
+
     /*! \brief Calculates the interaction parameters for the passed pair.
 
       \return This pair has the interaction diameter as the first
@@ -72,24 +77,53 @@ namespace dynamo {
      */
     std::tuple<double, double, double, size_t, size_t> getInteractionParameters(size_t pID1, size_t pID2) const;
 
+    /*! \brief Calculates the parameters of a backbone pair which may
+        take part in a H-Bond.
+
+	\return True if the pair has a H-Bond interaction, in which
+	case the parameters are stored in params.
+     */
+    bool getHBondParameters(const TPRIME::BeadData& p1Data, const TPRIME::BeadData& p2Data, std::tuple<double, double, double, size_t, size_t>& params) const;
+
     bool checkTimeDependentCriteria(const size_t NH_ID, const size_t CO_ID, const size_t distance_i) const;
 
+    /*! \brief The classes of separation of two beads which decide
+        their (time-independent) interaction parameters.
+	
+	The BB_ classes are for backbone-backbone pairs, separated by
+	1 to 4 or more backbone bonds. The SC_BB_ classes are for
+	side-chain to backbone pairs on the same residue, separated by
+	three bonds, or further apart.
+    */
+    enum PairSeparation { SC_SC, BB_1, BB_2, BB_3, BB_4, BB_FAR, SC_BB_BONDED, SC_BB_3, SC_BB_FAR, SEPARATION_COUNT };
+
+    //! \brief The separation class of a pair, where p1Data.bead_type <= p2Data.bead_type.
+    static PairSeparation getSeparation(const TPRIME::BeadData& p1Data, const TPRIME::BeadData& p2Data);
+
+    struct PairParameters {
+      double outer_diameter;
+      double inner_diameter;
+      double bond_energy;
+    };
+
+    /*! \brief The time-independent interaction parameters for each
+        (bead type, bead type, separation) combination, built at
+        initialise().
+    */
+    std::vector<PairParameters> _pairParameters;
+
+    static PairParameters calcPairParameters(const TPRIME::PRIME_residue_type type1, const TPRIME::PRIME_residue_type type2, const PairSeparation sep);
+
     std::shared_ptr<TPRIME> _topology;
 
-    /*! \brief Containers which stores the pairs of NH and CO
-        particles currently within a H-Bond.
+    /*! \brief The residues currently within a H-Bond.
 
-	The first index is the ID of the NH particle, the second is
-	the ID of the CO particle.
+	_NH_HBonds holds the CO residue bonded to each NH residue, and
+	_CO_HBonds the NH residue bonded to each CO residue. Unbonded
+	residues hold std::numeric_limits<size_t>::max().
     */
-    struct NH_res_ID {};
-    struct CO_res_ID {};
-    typedef boost::bimaps::bimap<boost::bimaps::unordered_set_of<boost::bimaps::tagged<size_t, NH_res_ID> >, 
-				 boost::bimaps::unordered_set_of<boost::bimaps::tagged<size_t, CO_res_ID> >,
-				 boost::bimaps::unordered_set_of_relation<> >
-    HbondMapType;
-    
-    HbondMapType _HBonds;
+    std::vector<size_t> _NH_HBonds;
+    std::vector<size_t> _CO_HBonds;
 
     double _PRIME_HB_strength;
   };
@@ -24,9 +24,12 @@
 # include <magnet/containers/judy.hpp>
 #else
 # include <unordered_map>
+# include <magnet/memory/pool.hpp>
 #endif
+#include <algorithm>
 #include <map>
 #include <unordered_set>
+#include <vector>
 
 namespace dynamo { 
   namespace detail { 
@@ -69,12 +72,22 @@ namespace std
 
 namespace dynamo {
   namespace detail {
-    namespace {
-      ::std::size_t
-      hash_combine(const ::std::size_t hash1, const ::std::size_t hash2)
-      {
-	return hash1 ^ (hash2 + 0x9e3779b9 + (hash1 << 6) + (hash1 >> 2));
-      }
+    /*! \brief The Zobrist key of a single entry of a CaptureMap.
+
+      Each (pair, state) combination is mapped to a pseudo-random 64
+      bit value (using the splitmix64 finaliser), and the hash of a
+      whole map is the exclusive-or of the keys of its entries. The
+      hash is independent of the order of the entries and can be
+      updated in O(1) as entries change. A state of zero (an absent
+      entry) has a key of zero.
+    */
+    inline uint64_t captureEntryHash(const PairKey& key, const size_t state)
+    {
+      if (!state) return 0;
+      uint64_t z = uint64_t(key) ^ ((uint64_t(state) + 0x9e3779b97f4a7c15ULL) * 0xbf58476d1ce4e5b9ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
     }
     
     /*!\brief This is a container that stores a single size_t
@@ -82,49 +95,54 @@ namespace dynamo {
        
       To efficiently store the state of all possible particle
       pairings, a map is used and entries are only stored if the
-      state is non-zero. Although an unordered_map may be slightly
-      faster, a map is used to allow comparison of CaptureMaps and a
-      rapid hashing if CaptureMaps are to be used as an index of the
-      simulation state.
+      state is non-zero. A Zobrist hash of the entries is maintained
+      as they are changed, so that CaptureMaps can be rapidly used as
+      an index of the simulation state (see \ref hash()).
        
       To facilitate the storage only if non-zero behaviour, the array
       access operator is overloaded to automatically return a size_t
       0 for any entry which is missing. It also returns a proxy which
-      deletes entries when they are set to 0.
+      deletes entries when they are set to 0. All changes to the map
+      must go through this proxy (or clear()) to keep the hash valid.
     */
 
 #ifdef DYNAMO_JUDY
     typedef magnet::containers::JudyMap<PairKey, size_t> CaptureMapContainer;
 #else
-    typedef std::unordered_map<PairKey, size_t> CaptureMapContainer;
+    typedef std::unordered_map<PairKey, size_t, std::hash<PairKey>, std::equal_to<PairKey>,
+			       magnet::memory::PoolAllocator<std::pair<const PairKey, size_t> > > CaptureMapContainer;
 #endif
     class CaptureMap: public CaptureMapContainer
     {
       typedef CaptureMapContainer Container;
     public:
+      CaptureMap(): _hash(0) {}
+
       /*!\brief This proxy is used to double check if an assignment of
 	zero is done, and delete the entry if it is. */
       struct EntryProxy {
       public:
-	EntryProxy(Container& container, const PairKey& key):
-	  _container(container), _key(key) {}
+	EntryProxy(CaptureMap& map, const PairKey& key):
+	  _map(map), _key(key) {}
 
 	operator const size_t() const {
-	  const auto it (_container.find(_key));
-	  return (it == _container.end()) ? 0 : (it->second);
+	  const auto it (_map.Container::find(_key));
+	  return (it == _map.Container::end()) ? 0 : (it->second);
 	}
 	
 	EntryProxy& operator=(size_t newval) {
+	  _map._hash ^= captureEntryHash(_key, *this) ^ captureEntryHash(_key, newval);
+
 	  if (newval == 0)
-	    _container.erase(_key);
+	    _map.Container::erase(_key);
 	  else
-	    _container[_key] = newval;
+	    _map.Container::operator[](_key) = newval;
 
 	  return *this;
 	}
 	
       private:
-	Container& _container;
+	CaptureMap& _map;
 	const PairKey _key;
       };
       
@@ -140,20 +158,42 @@ namespace dynamo {
 	Container::const_iterator it = Container::find(key);
 	return (it == Container::end()) ? 0 : (it->second);
       }
+
+      //! \brief Remove all entries from the map.
+      void clear() { Container::clear(); _hash = 0; }
+
+      //! \brief The Zobrist hash of the current entries of the map.
+      uint64_t hash() const { return _hash; }
+
+      /*! \brief The hash the map would have if the entry for key was
+	set to newstate, calculated without changing the map. */
+      uint64_t hash(const PairKey& key, const size_t newstate) const {
+	return _hash ^ captureEntryHash(key, operator[](key)) ^ captureEntryHash(key, newstate);
+      }
+
+    private:
+      uint64_t _hash;
     };
 
-    struct CaptureMapKey: public std::vector<CaptureMap::value_type>
+    /*! \brief A copy of the entries of a CaptureMap, sorted by the
+      pair key so that equal maps compare equal, along with the hash
+      of the map.
+     */
+    struct CaptureMapKey: public std::vector<std::pair<PairKey, size_t> >
     {
-      typedef std::vector<CaptureMap::value_type> Container;
+      typedef std::vector<std::pair<PairKey, size_t> > Container;
       CaptureMapKey(const CaptureMap& map):
-      Container(map.begin(), map.end()) {}
-
-      std::size_t hash() const {
-	std::size_t hash(0);
-	for (const Container::value_type& val : *this)
-	  hash = hash_combine(hash, hash_combine(size_t(val.first), size_t(val.second)));
-	return hash;
+	Container(map.begin(), map.end()), _hash(map.hash())
+      {
+	std::sort(Container::begin(), Container::end(), 
+		  [](const Container::value_type& a, const Container::value_type& b) 
+		  { return uint64_t(a.first) < uint64_t(b.first); });
       }
+
+      std::size_t hash() const { return _hash; }
+
+    private:
+      uint64_t _hash;
     };
 
     /*! \brief A functor to allow the storage of CaptureMapKey types
@@ -101,6 +101,41 @@ namespace dynamo {
     return Event(p1, std::numeric_limits<float>::infinity(), INTERACTION, NONE, ID, p2);
   }
 
+  void
+  IHardSphere::getEvents(const Particle& p1, const Particle* const* p2, Event* events, const size_t N) const
+  {
+#ifdef DYNAMO_DEBUG
+    if (!Sim->dynamics->isUpToDate(p1))
+      M_throw() << "Particle 1 is not up to date: ID1=" << p1.getID() << ", delay1=" << Sim->dynamics->getParticleDelay(p1);
+
+    for (size_t i(0); i < N; ++i)
+      {
+	if (!Sim->dynamics->isUpToDate(*p2[i]))
+	  M_throw() << "Particle 2 is not up to date: ID1=" << p1.getID() << ", ID2=" << p2[i]->getID() << ", delay2=" << Sim->dynamics->getParticleDelay(*p2[i]);
+
+	if (p1 == *p2[i])
+	  M_throw() << "You shouldn't pass p1==p2 events to the interactions!";
+      }
+#endif
+
+    const size_t blocksize = 64;
+    double d[blocksize], dt[blocksize];
+    for (size_t start(0); start < N; start += blocksize)
+      {
+	const size_t n = std::min(N - start, blocksize);
+	for (size_t i(0); i < n; ++i)
+	  d[i] = _diameter->getProperty(p1, *p2[start + i]);
+
+	Sim->dynamics->SphereSphereInRoots(p1, p2 + start, d, dt, n);
+
+	for (size_t i(0); i < n; ++i)
+	  if (dt[i] != std::numeric_limits<float>::infinity())
+	    events[start + i] = Event(p1, dt[i], INTERACTION, CORE, ID, *p2[start + i]);
+	  else
+	    events[start + i] = Event(p1, std::numeric_limits<float>::infinity(), INTERACTION, NONE, ID, *p2[start + i]);
+      }
+  }
+
   PairEventData
   IHardSphere::runEvent(Particle& p1, Particle& p2, Event iEvent)
   {
@@ -70,6 +70,8 @@ namespace dynamo {
     virtual void rescaleLengths(double) {}
 
     virtual Event getEvent(const Particle&, const Particle&) const;
+
+    virtual void getEvents(const Particle&, const Particle* const*, Event*, const size_t) const;
  
     virtual PairEventData runEvent(Particle&, Particle&, Event);
    
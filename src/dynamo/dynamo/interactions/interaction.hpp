@@ -73,6 +73,18 @@ namespace dynamo {
      */
     virtual Event getEvent(const Particle &, const Particle &) const = 0;
 
+    /*! \brief Calculate the events between a particle and N
+        partners which all interact through this Interaction.
+
+	The default implementation calls getEvent for each pair, but
+	interactions may override this to predict the events together
+	(see Dynamics::SphereSphereInRoots).
+     */
+    virtual void getEvents(const Particle& p1, const Particle* const* p2, Event* events, const size_t N) const {
+      for (size_t i(0); i < N; ++i)
+	events[i] = getEvent(p1, *p2[i]);
+    }
+
     /*! \brief Run the dynamics of an event which is occuring now.
      */
     virtual PairEventData runEvent(Particle&, Particle&, Event) = 0;
@@ -153,6 +165,15 @@ namespace dynamo {
     */
     virtual bool validateState(const Particle& p1, const Particle& p2, bool textoutput = true) const = 0;
 
+    /*! \brief Returns true if validateState(const Particle&, const
+        Particle&, bool) may be called from several threads at once.
+
+	Interactions whose test extends a lazily filled cache (e.g.,
+	the step table of an energy stepped Lennard-Jones Potential)
+	must return false, and their pairs are then tested serially.
+    */
+    virtual bool parallelValidation() const { return true; }
+
     /*! \brief Test if the internal state of the Interaction is valid.
 	
 	\param textoutput If true, there will be a text description of
@@ -83,6 +83,7 @@ namespace dynamo {
   PotentialLennardJones::operator<<(const magnet::xml::Node& XML) {
     _r_cache.clear();
     _u_cache.clear();
+    _r2_cache.clear();
 
     _sigma = XML.getAttribute("Sigma").as<double>();
     _epsilon = XML.getAttribute("Epsilon").as<double>();
@@ -20,6 +20,8 @@
 #include <cmath>
 #include <dynamo/base.hpp>
 #include <algorithm>
+#include <functional>
+#include <limits>
 
 namespace magnet { namespace xml { class Node; class XmlStream; } }
 
@@ -100,14 +102,42 @@ namespace dynamo {
 
     /*! \brief Determine which step in the potential the passed radius
         corresponds to.
+
+	This is a binary search of the cached step positions, which
+	are extended (doubling in length) if the radius lies beyond
+	them.
     */
     size_t calculateStepID(const double r) const {
-      size_t retval(0);
-      if (direction())
-	for (; (retval < steps()) && (r > operator[](retval).first); ++retval) {}
-      else
-	for (; (retval < steps()) && (r < operator[](retval).first); ++retval) {}
-      return retval;
+      return findStep(_r_cache, r);
+    }
+
+    /*! \brief Determine which step in the potential the passed
+        squared radius corresponds to.
+
+	This avoids the square root when the squared separation of a
+	pair is already available, by searching the table of squared
+	step positions.
+    */
+    size_t calculateStepIDSq(const double r2) const {
+      return findStep(_r2_cache, r2);
+    }
+
+    /*! \brief Calculate and cache every step of the potential.
+
+	Potentials with an infinite number of steps (e.g., energy
+	stepped Lennard-Jones) are left to extend their cache as steps
+	are accessed.
+     */
+    void materialise() const {
+      if (materialisable())
+	cacheSteps(steps());
+    }
+
+    /*! \brief Returns true if materialise() caches every step, so
+        that the step lookups no longer modify the Potential.
+     */
+    bool materialisable() const {
+      return steps() != std::numeric_limits<std::size_t>::max();
     }
 
     /*! \brief Return a pair with the min-max bounds of the potential
@@ -117,17 +147,20 @@ namespace dynamo {
 #ifdef DYNAMO_DEBUG
       if (ID > steps()) M_throw() << "Out of range access";
 #endif
+      const size_t needed = std::min(ID + 1, steps());
+      if (needed > cached_steps()) cacheSteps(needed);
+
       double minR, maxR;
 
       if (direction())
 	{
-	  minR = (ID == 0) ? 0 : operator[](ID - 1).first;
-	  maxR = (ID == steps()) ? std::numeric_limits<float>::infinity() : operator[](ID).first;
+	  minR = (ID == 0) ? 0 : _r_cache[ID - 1];
+	  maxR = (ID == steps()) ? std::numeric_limits<float>::infinity() : _r_cache[ID];
 	}
       else
 	{
-	  minR = (ID == steps()) ? 0 : operator[](ID).first;
-	  maxR = (ID == 0) ? std::numeric_limits<float>::infinity() : operator[](ID - 1).first;
+	  minR = (ID == steps()) ? 0 : _r_cache[ID];
+	  maxR = (ID == 0) ? std::numeric_limits<float>::infinity() : _r_cache[ID - 1];
 	}
 
       return std::pair<double, double>(minR, maxR);
@@ -215,8 +248,42 @@ namespace dynamo {
     virtual void calculateToStep(size_t) const = 0;
     virtual void outputXML(magnet::xml::XmlStream&) const = 0;
 
+    /*! \brief Ensure the first n steps are cached, and that the
+        table of squared step positions covers all cached steps.
+     */
+    void cacheSteps(const size_t n) const {
+      if (n > cached_steps()) calculateToStep(n - 1);
+      for (size_t i(_r2_cache.size()); i < cached_steps(); ++i)
+	_r2_cache.push_back(_r_cache[i] * _r_cache[i]);
+    }
+
+    /*! \brief Binary search for the step containing the position x
+        in a table of step positions (either _r_cache or _r2_cache).
+
+	The step returned is the first whose discontinuity is not
+	passed by x, as the original linear walk over the steps
+	found. The search is repeated over a cache of twice the length
+	if it runs off the end of the cached steps.
+     */
+    size_t findStep(const std::vector<double>& table, const double x) const {
+      size_t n = std::min(cached_steps(), steps());
+      for (;;)
+	{
+	  cacheSteps(n);
+	  const std::vector<double>::const_iterator end = table.begin() + n;
+	  const std::vector<double>::const_iterator it = direction()
+	    ? std::lower_bound(table.begin(), end, x)
+	    : std::lower_bound(table.begin(), end, x, std::greater<double>());
+	  if ((it != end) || (n == steps()))
+	    return it - table.begin();
+	  n = std::min(steps(), 2 * n + 1);
+	}
+    }
+
     mutable std::vector<double> _r_cache;
     mutable std::vector<double> _u_cache;
+    //! \brief The squares of the cached step positions.
+    mutable std::vector<double> _r2_cache;
   };
 
   /*! \brief A manually stepped potential.
@@ -79,6 +79,7 @@ namespace dynamo {
   IStepped::initialise(size_t nID)
   {
     Interaction::initialise(nID);
+    _potential->materialise();
     ICapture::initCaptureMap();
   }
 
@@ -92,7 +93,7 @@ namespace dynamo {
     Vector rij = p1.getPosition() - p2.getPosition();
     Sim->BCs->applyBC(rij);
     
-    return _potential->calculateStepID(rij.nrm() / length_scale);
+    return _potential->calculateStepIDSq(rij.nrm2() / (length_scale * length_scale));
   }
 
   double 
@@ -62,6 +62,8 @@ namespace dynamo {
     using ICapture::validateState;
     virtual bool validateState(const Particle& p1, const Particle& p2, bool textoutput = true) const;
 
+    virtual bool parallelValidation() const { return _potential->materialisable(); }
+
     virtual void outputData(magnet::xml::XmlStream&) const;
 
   protected:
@@ -38,36 +38,45 @@ namespace dynamo {
   {}
 
   void 
-  OPCollMatrix::eventUpdate(const Event& event, const NEventData& SDat)
+  OPCollMatrix::recordUpdate(const EventRecord& record)
   {
-    for (const ParticleEventData& pData : SDat.L1partChanges)
-      newEvent(pData.getParticleID(), pData.getType(), getClassKey(event));  
-  
-    for (const PairEventData& pData : SDat.L2partChanges)
-      {
-	newEvent(pData.particle1_.getParticleID(), pData.getType(), getClassKey(event));
-	newEvent(pData.particle2_.getParticleID(), pData.getType(), getClassKey(event));
-      }
+    if (record._particle1ID == std::numeric_limits<size_t>::max())
+      return;
+
+    const classKey ck(record._sourceID, record._source);
+    newEvent(record._particle1ID, record._type, ck, record._systemTime);
+
+    if (record._particle2ID != std::numeric_limits<size_t>::max())
+      newEvent(record._particle2ID, record._type, ck, record._systemTime);
   }
 
   void 
-  OPCollMatrix::newEvent(const size_t& part, const EEventType& etype, const classKey& ck)
+  OPCollMatrix::newEvent(const size_t& part, const EEventType& etype, const classKey& ck, const double& time)
   {
     if (lastEvent[part].second.first.second != NOSOURCE)
       {
 	counterData& refCount = counters[counterKey(eventKey(ck,etype), lastEvent[part].second)];
       
-	refCount.totalTime += Sim->systemTime - lastEvent[part].first;
+	refCount.totalTime += time - lastEvent[part].first;
 	++(refCount.count);
 	++(totalCount);
       }
     else
       ++initialCounter[eventKey(ck,etype)];
 
-    lastEvent[part].first = Sim->systemTime;
+    lastEvent[part].first = time;
     lastEvent[part].second = eventKey(ck, etype);
   }
 
+  size_t
+  OPCollMatrix::getTotalCount() const
+  {
+    size_t count = totalCount;
+    for (const auto& n : initialCounter)
+      count += n.second;
+    return count;
+  }
+
   void
   OPCollMatrix::output(magnet::xml::XmlStream &XML)
   {
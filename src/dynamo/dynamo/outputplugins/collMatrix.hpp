@@ -37,12 +37,20 @@ namespace dynamo {
 
     virtual void initialise();
 
-    virtual void eventUpdate(const Event&, const NEventData&);
+    //! \brief Unused, this plugin is updated through recordUpdate().
+    virtual void eventUpdate(const Event&, const NEventData&) {}
+
+    virtual bool isRecordConsumer() const { return true; }
+
+    virtual void recordUpdate(const EventRecord&);
 
     void output(magnet::xml::XmlStream &);
+
+    //! \brief The total number of particle events counted.
+    size_t getTotalCount() const;
   
   protected:
-    void newEvent(const size_t&, const EEventType&, const classKey&);
+    void newEvent(const size_t&, const EEventType&, const classKey&, const double&);
   
     struct counterData
     {
@@ -63,21 +63,23 @@ namespace dynamo {
 
     struct MapData
     {
-      MapData(double discovery_time = 0, double energy=0, size_t id = 0): 
-        _weight(0), _energy(energy), _discovery_time(discovery_time), _id(id) {}
+      MapData(const detail::CaptureMap& map, double discovery_time = 0, double energy=0, size_t id = 0): 
+        _map(map), _weight(0), _energy(energy), _discovery_time(discovery_time), _id(id) {}
+      detail::CaptureMapKey _map;
       double _weight;
       double _energy;
       double _discovery_time;
       size_t _id;
     };
 
-    typedef std::unordered_map<detail::CaptureMapKey, MapData,  detail::CaptureMapKeyHash> CollectedMapType;
+    typedef std::unordered_map<uint64_t, MapData> CollectedMapType;
     typedef std::unordered_map<std::pair<size_t, size_t>, size_t, detail::OPContactMapPairHash> LinksMapType;
     /*! \brief A hash table storing the histogram of the contact maps.
       
-      The key of this map is a sorted list of the captured pairs in
-      the system. This sorting is implicitly carried out by the
-      _current_map.
+      The key of this map is the hash of the contact map, which is
+      maintained by the interaction as pairs are captured and
+      released. A copy of the contact map is only taken when a new
+      map is discovered.
      */
     CollectedMapType _collected_maps;
     CollectedMapType::iterator _current_map;
@@ -0,0 +1,268 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/outputplugins/eventlog.hpp>
+#include <dynamo/include.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/NparticleEventData.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <magnet/xmlreader.hpp>
+#ifdef DYNAMO_zlib_support
+# include <zlib.h>
+#endif
+#include <cstring>
+#include <cstddef>
+
+namespace dynamo {
+  OPEventLog::OPEventLog(const dynamo::Simulation* tmp, const magnet::xml::Node& XML):
+    OutputPlugin(tmp, "EventLog"),
+    _filename("eventlog.bin"),
+    _compress(false),
+    _chunkSize(65536),
+    _writeOffset(0),
+    _footerOffset(0),
+    _pending(0)
+  {
+    operator<<(XML);
+    _writer.setThreadCount(1);
+  }
+
+  OPEventLog::~OPEventLog()
+  {
+    //Complete the log, unless it was never started
+    try { if (_file.is_open()) flush(); } catch (...) {}
+  }
+
+  void
+  OPEventLog::operator<<(const magnet::xml::Node& XML)
+  {
+    try {
+      if (XML.hasAttribute("File"))
+	_filename = XML.getAttribute("File").getValue();
+
+      if (XML.hasAttribute("Compress"))
+	_compress = true;
+
+      if (XML.hasAttribute("ChunkSize"))
+	_chunkSize = XML.getAttribute("ChunkSize").as<size_t>();
+    }
+    catch (std::exception& excep)
+      {
+	M_throw() << "Error while parsing output plugin options\n" << excep.what();
+      }
+
+#ifndef DYNAMO_zlib_support
+    if (_compress)
+      M_throw() << "zlib compression support was not built in!";
+#endif
+
+    if (!_chunkSize)
+      M_throw() << "The ChunkSize must be at least one record";
+  }
+
+  void
+  OPEventLog::initialise()
+  {
+    if (Sim->N() >= eventlog::noParticle)
+      M_throw() << "The event log only supports up to " << eventlog::noParticle - 1 << " particles";
+
+    if (_file.is_open())
+      {
+	_writer.wait();
+	_file.close();
+      }
+
+    _file.open(_filename, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!_file)
+      M_throw() << "Failed to open " << _filename << " for writing";
+
+    eventlog::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, eventlog::fileMagic, sizeof(header.magic));
+    header.version = eventlog::formatVersion;
+    header.recordSize = sizeof(eventlog::Record);
+    header.byteOrder = eventlog::byteOrderMark;
+    header.flags = _compress ? eventlog::COMPRESSED : 0;
+    header.N = Sim->N();
+    header.startEvent = Sim->eventCount;
+    header.startTime = Sim->systemTime;
+    header.unitTime = Sim->units.unitTime();
+    header.unitLength = Sim->units.unitLength();
+    header.unitMomentum = Sim->units.unitMomentum();
+    _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _writeOffset = sizeof(header);
+    _footerOffset = 0;
+
+    _index.clear();
+    _buffer = std::make_shared<Buffer>();
+    _buffer->reserve(_chunkSize);
+
+    dout << "Logging events to " << _filename << (_compress ? " (compressed)" : "") << std::endl;
+  }
+
+  void
+  OPEventLog::eventUpdate(const Event& event, const NEventData& NDat)
+  {
+    eventlog::Record record;
+    record.eventCount = Sim->eventCount;
+    record.time = Sim->systemTime;
+    record.sourceID = event._sourceID;
+    record.source = event._source;
+    record.eventType = event._type;
+    record.index = 0;
+
+    for (const ParticleEventData& pData : NDat.L1partChanges)
+      {
+	const Particle& part = Sim->particles[pData.getParticleID()];
+	const double mass = Sim->species[pData.getSpeciesID()]->getMass(part.getID());
+	const Vector impulse = (mass == std::numeric_limits<double>::infinity())
+	  ? Vector{0, 0, 0} : Vector(mass * (part.getVelocity() - pData.getOldVel()));
+	record.particle1 = part.getID();
+	record.particle2 = eventlog::noParticle;
+	record.changeType = pData.getType();
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  record.impulse[iDim] = impulse[iDim];
+	_buffer->push_back(record);
+	++record.index;
+      }
+
+    for (const PairEventData& pData : NDat.L2partChanges)
+      {
+	//The impulse stored in the PairEventData is zeroed if either
+	//particle has an infinite mass, so the impulse on particle1 is
+	//recovered from whichever velocity change is finite.
+	const Particle& p1 = Sim->particles[pData.particle1_.getParticleID()];
+	const Particle& p2 = Sim->particles[pData.particle2_.getParticleID()];
+	const double m1 = Sim->species[pData.particle1_.getSpeciesID()]->getMass(p1.getID());
+	const double m2 = Sim->species[pData.particle2_.getSpeciesID()]->getMass(p2.getID());
+	Vector impulse{0, 0, 0};
+	if (m1 != std::numeric_limits<double>::infinity())
+	  impulse = m1 * (p1.getVelocity() - pData.particle1_.getOldVel());
+	else if (m2 != std::numeric_limits<double>::infinity())
+	  impulse = - m2 * (p2.getVelocity() - pData.particle2_.getOldVel());
+
+	record.particle1 = p1.getID();
+	record.particle2 = p2.getID();
+	record.changeType = pData.getType();
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  record.impulse[iDim] = impulse[iDim];
+	_buffer->push_back(record);
+	++record.index;
+      }
+
+    if (_buffer->size() >= _chunkSize)
+      writeChunk();
+  }
+
+  void
+  OPEventLog::writeChunk()
+  {
+    if (_buffer->empty()) return;
+
+    //Limit the memory held by chunks waiting to be written
+    if (_pending >= 4)
+      _writer.wait();
+
+    std::shared_ptr<Buffer> buffer = _buffer;
+    _buffer = std::make_shared<Buffer>();
+    _buffer->reserve(_chunkSize);
+    ++_pending;
+
+    _writer.queueTask([this, buffer]() {
+	eventlog::Chunk chunk;
+	chunk.records = buffer->size();
+	chunk.firstEvent = buffer->front().eventCount;
+	chunk.lastEvent = buffer->back().eventCount;
+	chunk.firstTime = buffer->front().time;
+	chunk.lastTime = buffer->back().time;
+	chunk.offset = _writeOffset + sizeof(chunk);
+
+	const char* data = reinterpret_cast<const char*>(buffer->data());
+	chunk.bytes = buffer->size() * sizeof(eventlog::Record);
+	std::vector<char> compressed;
+#ifdef DYNAMO_zlib_support
+	if (_compress)
+	  {
+	    uLongf size = compressBound(chunk.bytes);
+	    compressed.resize(size);
+	    if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &size,
+			  reinterpret_cast<const Bytef*>(data), chunk.bytes, 1) != Z_OK)
+	      M_throw() << "zlib failed to compress an event log chunk";
+	    chunk.bytes = size;
+	    data = compressed.data();
+	  }
+#endif
+
+	//A chunk smaller than the index of the last flush would leave
+	//its footer at the end of the file, referring to an index which
+	//is now partly overwritten, so the footer is invalidated first
+	if (_footerOffset)
+	  {
+	    const char zeros[sizeof(eventlog::indexMagic)] = {};
+	    _file.seekp(_footerOffset + offsetof(eventlog::Footer, magic));
+	    _file.write(zeros, sizeof(zeros));
+	    _footerOffset = 0;
+	  }
+
+	_file.seekp(_writeOffset);
+	_file.write(reinterpret_cast<const char*>(&chunk), sizeof(chunk));
+	_file.write(data, chunk.bytes);
+	if (!_file)
+	  M_throw() << "Failed while writing to " << _filename;
+	_writeOffset = chunk.offset + chunk.bytes;
+	_index.push_back(chunk);
+	--_pending;
+      });
+  }
+
+  void
+  OPEventLog::flush()
+  {
+    writeChunk();
+    _writer.wait();
+
+    //The index is written after the last chunk, and is overwritten
+    //by any later chunks
+    _file.seekp(_writeOffset);
+    _file.write(reinterpret_cast<const char*>(_index.data()), _index.size() * sizeof(eventlog::Chunk));
+    _footerOffset = _writeOffset + _index.size() * sizeof(eventlog::Chunk);
+    eventlog::Footer footer;
+    footer.chunks = _index.size();
+    footer.indexOffset = _writeOffset;
+    std::memcpy(footer.magic, eventlog::indexMagic, sizeof(footer.magic));
+    _file.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+    _file.flush();
+    if (!_file)
+      M_throw() << "Failed while writing to " << _filename;
+  }
+
+  void
+  OPEventLog::output(magnet::xml::XmlStream& XML)
+  {
+    flush();
+
+    uint64_t records = 0;
+    for (const eventlog::Chunk& chunk : _index)
+      records += chunk.records;
+
+    XML << magnet::xml::tag("EventLog")
+	<< magnet::xml::attr("File") << _filename
+	<< magnet::xml::attr("Chunks") << _index.size()
+	<< magnet::xml::attr("Records") << records
+	<< magnet::xml::endtag("EventLog");
+  }
+}
@@ -0,0 +1,84 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/outputplugins/outputplugin.hpp>
+#include <dynamo/outputplugins/eventlogreader.hpp>
+#include <magnet/thread/threadpool.hpp>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief Writes a compact binary log of every event, for
+      post-processing with EventLogReader (or dynaeventlog).
+
+    Each particle (or pair) change of an event is stored as a fixed
+    size eventlog::Record, holding the event count, time, source and
+    type of the event, the particle IDs and the impulse. Events which
+    do not change any particles (e.g., cell transitions) are not
+    logged.
+
+    The records are collected in chunks of ChunkSize records, which
+    are (optionally, with the Compress attribute) compressed and
+    written to the File by a background thread. The index of the
+    chunks is written when the data is output.
+  */
+  class OPEventLog: public OutputPlugin
+  {
+  public:
+    OPEventLog(const dynamo::Simulation*, const magnet::xml::Node&);
+
+    ~OPEventLog();
+
+    virtual void initialise();
+
+    virtual void eventUpdate(const Event&, const NEventData&);
+
+    virtual void output(magnet::xml::XmlStream&);
+
+    void operator<<(const magnet::xml::Node&);
+
+    //! \brief Write the current chunk and the index to the file.
+    void flush();
+
+  protected:
+    typedef std::vector<eventlog::Record> Buffer;
+
+    //! \brief Queue the current chunk for writing.
+    void writeChunk();
+
+    std::string _filename;
+    bool _compress;
+    size_t _chunkSize;
+
+    std::ofstream _file;
+    //! \brief The file offset of the next chunk (the index follows the last chunk).
+    uint64_t _writeOffset;
+    //! \brief The file offset of the footer written by the last
+    //! flush (zero if there is none), which is invalidated before
+    //! any more chunks are written.
+    uint64_t _footerOffset;
+    std::shared_ptr<Buffer> _buffer;
+    //! \brief The headers of the written chunks, only accessed by the writer thread between flushes.
+    std::vector<eventlog::Chunk> _index;
+    //! \brief A single thread which compresses and writes the chunks in order.
+    magnet::thread::ThreadPool _writer;
+    std::atomic<size_t> _pending;
+  };
+}
@@ -0,0 +1,223 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/outputplugins/eventlogreader.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/eventtypes.hpp>
+#include <dynamo/dynamics/dynamics.hpp>
+#include <dynamo/species/species.hpp>
+#include <magnet/exception.hpp>
+#ifdef DYNAMO_zlib_support
+# include <zlib.h>
+#endif
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+namespace dynamo {
+  EventLogReader::EventLogReader(const std::string& filename):
+    _filename(filename),
+    _file(filename, std::ios::in | std::ios::binary),
+    _indexed(false)
+  {
+    if (!_file)
+      M_throw() << "Could not open the event log " << filename;
+
+    _file.seekg(0, std::ios::end);
+    _fileSize = _file.tellg();
+    _file.seekg(0);
+
+    if (!_file.read(reinterpret_cast<char*>(&_header), sizeof(_header))
+	|| std::memcmp(_header.magic, eventlog::fileMagic, sizeof(eventlog::fileMagic)))
+      M_throw() << filename << " is not a DynamO event log";
+
+    if (_header.byteOrder != eventlog::byteOrderMark)
+      M_throw() << filename << " was written on a machine with a different byte order";
+
+    if ((_header.version != eventlog::formatVersion) || (_header.recordSize != sizeof(eventlog::Record)))
+      M_throw() << filename << " was written by an incompatible version of DynamO (format version "
+		<< _header.version << ", record size " << _header.recordSize << ")";
+
+#ifndef DYNAMO_zlib_support
+    if (_header.flags & eventlog::COMPRESSED)
+      M_throw() << filename << " is compressed, but zlib support was not built in!";
+#endif
+
+    //Try the index at the end of the file
+    eventlog::Footer footer;
+    if (_fileSize >= sizeof(_header) + sizeof(footer))
+      {
+	_file.seekg(_fileSize - sizeof(footer));
+	_file.read(reinterpret_cast<char*>(&footer), sizeof(footer));
+	if (_file && !std::memcmp(footer.magic, eventlog::indexMagic, sizeof(eventlog::indexMagic))
+	    && (footer.indexOffset + footer.chunks * sizeof(eventlog::Chunk) + sizeof(footer) == _fileSize))
+	  {
+	    _chunks.resize(footer.chunks);
+	    _file.seekg(footer.indexOffset);
+	    _file.read(reinterpret_cast<char*>(_chunks.data()), _chunks.size() * sizeof(eventlog::Chunk));
+	    _indexed = bool(_file);
+	  }
+      }
+
+    if (!_indexed)
+      scanChunks();
+  }
+
+  void
+  EventLogReader::scanChunks()
+  {
+    _file.clear();
+    _chunks.clear();
+    uint64_t offset = sizeof(_header);
+    eventlog::Chunk chunk;
+    while (offset + sizeof(chunk) <= _fileSize)
+      {
+	_file.seekg(offset);
+	if (!_file.read(reinterpret_cast<char*>(&chunk), sizeof(chunk))
+	    || (chunk.offset != offset + sizeof(chunk))
+	    || (chunk.offset + chunk.bytes > _fileSize))
+	  //A truncated or partially written chunk ends the log
+	  break;
+	_chunks.push_back(chunk);
+	offset = chunk.offset + chunk.bytes;
+      }
+    _file.clear();
+  }
+
+  uint64_t
+  EventLogReader::getRecordCount() const
+  {
+    uint64_t sum = 0;
+    for (const eventlog::Chunk& chunk : _chunks)
+      sum += chunk.records;
+    return sum;
+  }
+
+  std::vector<eventlog::Record>
+  EventLogReader::readChunk(const size_t i)
+  {
+    const eventlog::Chunk& chunk = _chunks.at(i);
+    std::vector<eventlog::Record> records(chunk.records);
+    const size_t bytes = records.size() * sizeof(eventlog::Record);
+
+    std::vector<char> data(chunk.bytes);
+    _file.seekg(chunk.offset);
+    if (!_file.read(data.data(), data.size()))
+      M_throw() << "Failed to read chunk " << i << " of " << _filename;
+
+    if (_header.flags & eventlog::COMPRESSED)
+      {
+#ifdef DYNAMO_zlib_support
+	uLongf size = bytes;
+	if ((uncompress(reinterpret_cast<Bytef*>(records.data()), &size,
+			reinterpret_cast<const Bytef*>(data.data()), data.size()) != Z_OK)
+	    || (size != bytes))
+	  M_throw() << "Failed to decompress chunk " << i << " of " << _filename;
+#endif
+      }
+    else
+      {
+	if (data.size() != bytes)
+	  M_throw() << "Chunk " << i << " of " << _filename << " has the wrong size";
+	std::memcpy(records.data(), data.data(), bytes);
+      }
+
+    return records;
+  }
+
+  size_t
+  EventLogReader::findChunk(const uint64_t eventCount) const
+  {
+    return std::lower_bound(_chunks.begin(), _chunks.end(), eventCount,
+			    [](const eventlog::Chunk& chunk, const uint64_t event) { return chunk.lastEvent < event; })
+      - _chunks.begin();
+  }
+
+  void
+  EventLogReader::writeText(std::ostream& os, const uint64_t first, const uint64_t last)
+  {
+    os << "#Event Time Source SourceID EventType Index Particle1 Particle2 ChangeType";
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      os << " Impulse" << iDim;
+    os << "\n" << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+
+    forEach([&](const eventlog::Record& record)
+	    {
+	      os << record.eventCount
+		 << " " << record.time / _header.unitTime
+		 << " " << EventSource(record.source)
+		 << " " << record.sourceID
+		 << " " << EEventType(record.eventType)
+		 << " " << int(record.index)
+		 << " " << int64_t((record.particle1 == eventlog::noParticle) ? -1 : record.particle1)
+		 << " " << int64_t((record.particle2 == eventlog::noParticle) ? -1 : record.particle2)
+		 << " " << EEventType(record.changeType);
+	      for (size_t iDim(0); iDim < NDIM; ++iDim)
+		os << " " << record.impulse[iDim] / _header.unitMomentum;
+	      os << "\n";
+	    }, first, last);
+  }
+
+  uint64_t
+  EventLogReader::replay(Simulation& Sim, const uint64_t last)
+  {
+    if (Sim.N() != _header.N)
+      M_throw() << "The event log " << _filename << " is for " << _header.N
+		<< " particles, but the simulation has " << Sim.N();
+
+    //The logged times are relative to the start of the log
+    const double offset = Sim.systemTime - _header.startTime;
+    uint64_t events = 0;
+    uint64_t lastEvent = std::numeric_limits<uint64_t>::max();
+
+    forEach([&](const eventlog::Record& record)
+	    {
+	      const double dt = record.time + offset - Sim.systemTime;
+	      if (dt > 0)
+		{
+		  Sim.systemTime += dt;
+		  Sim.stream(dt);
+		}
+
+	      if (record.eventCount != lastEvent)
+		{
+		  ++events;
+		  lastEvent = record.eventCount;
+		}
+
+	      const Vector impulse{record.impulse[0], record.impulse[1], record.impulse[2]};
+	      Particle& p1 = Sim.particles[record.particle1];
+	      Sim.dynamics->updateParticle(p1);
+	      const double m1 = Sim.species(p1)->getMass(p1.getID());
+	      if (m1 != std::numeric_limits<double>::infinity())
+		p1.getVelocity() += impulse / m1;
+
+	      if (record.particle2 != eventlog::noParticle)
+		{
+		  Particle& p2 = Sim.particles[record.particle2];
+		  Sim.dynamics->updateParticle(p2);
+		  const double m2 = Sim.species(p2)->getMass(p2.getID());
+		  if (m2 != std::numeric_limits<double>::infinity())
+		    p2.getVelocity() -= impulse / m2;
+		}
+	    }, _header.startEvent, last);
+
+    Sim.dynamics->updateAllParticles();
+    Sim.eventCount = (events ? lastEvent : _header.startEvent);
+    return events;
+  }
+}
@@ -0,0 +1,186 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <magnet/math/vector.hpp>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief The layout of the binary event logs written by
+      OPEventLog.
+
+    A log starts with a Header, followed by chunks of Record's. Each
+    chunk is preceded by a Chunk header describing it, and its
+    records may be zlib compressed. When the log is closed, a copy of
+    all of the Chunk headers (the index) is written after the last
+    chunk, followed by a Footer. A log without an index (e.g., from a
+    run which was killed) can still be read by scanning the chunks.
+
+    The data is written in the byte order of the machine, and all
+    values are in simulation units (the header holds the units to
+    convert them).
+  */
+  namespace eventlog {
+    static const char fileMagic[8] = {'D', 'Y', 'N', 'E', 'V', 'L', 'O', 'G'};
+    static const char indexMagic[8] = {'D', 'Y', 'N', 'E', 'V', 'I', 'D', 'X'};
+    static const uint32_t formatVersion = 1;
+    static const uint32_t byteOrderMark = 0x01020304;
+    //! \brief The particle ID of a record without a (second) particle.
+    static const uint32_t noParticle = std::numeric_limits<uint32_t>::max();
+
+    //! \brief Header flag for compressed chunks.
+    static const uint32_t COMPRESSED = 1;
+
+    struct Header
+    {
+      char magic[8];
+      uint32_t version;
+      uint32_t recordSize;
+      uint32_t byteOrder;
+      uint32_t flags;
+      uint64_t N;
+      //! \brief The event count and time of the configuration the log starts from.
+      uint64_t startEvent;
+      double startTime;
+      double unitTime;
+      double unitLength;
+      double unitMomentum;
+    };
+
+    /*! \brief One particle (or pair) change of an event.
+
+      An event with several changes is stored as consecutive records
+      with the same eventCount.
+    */
+    struct Record
+    {
+      uint64_t eventCount;
+      //! \brief The system time of the event.
+      double time;
+      //! \brief The momentum change of particle1 (particle2 receives the opposite).
+      double impulse[NDIM];
+      uint32_t sourceID;
+      uint32_t particle1;
+      uint32_t particle2;
+      //! \brief The EventSource of the event.
+      uint8_t source;
+      //! \brief The EEventType of the event.
+      uint8_t eventType;
+      //! \brief The EEventType of this change.
+      uint8_t changeType;
+      //! \brief The index of this change within its event.
+      uint8_t index;
+    };
+
+    struct Chunk
+    {
+      //! \brief The file offset of the chunk data.
+      uint64_t offset;
+      //! \brief The size of the chunk data in the file.
+      uint64_t bytes;
+      uint64_t records;
+      uint64_t firstEvent;
+      uint64_t lastEvent;
+      double firstTime;
+      double lastTime;
+    };
+
+    struct Footer
+    {
+      uint64_t chunks;
+      uint64_t indexOffset;
+      char magic[8];
+    };
+  }
+
+  class Simulation;
+
+  /*! \brief Reads the binary event logs written by OPEventLog.
+   */
+  class EventLogReader
+  {
+  public:
+    EventLogReader(const std::string& filename);
+
+    const eventlog::Header& getHeader() const { return _header; }
+
+    //! \brief True if the chunks were found from the index of the file.
+    bool hasIndex() const { return _indexed; }
+
+    size_t getChunkCount() const { return _chunks.size(); }
+
+    const eventlog::Chunk& getChunk(size_t i) const { return _chunks[i]; }
+
+    //! \brief The total number of records in the log.
+    uint64_t getRecordCount() const;
+
+    //! \brief Read and (if needed) decompress the records of a chunk.
+    std::vector<eventlog::Record> readChunk(size_t i);
+
+    /*! \brief The first chunk which may hold the event eventCount.
+
+      Returns getChunkCount() if the event is after the end of the log.
+    */
+    size_t findChunk(uint64_t eventCount) const;
+
+    /*! \brief Call func(record) for every record of the events
+        first to last (inclusive).
+     */
+    template<class Func>
+    void forEach(Func func, uint64_t first = 0, uint64_t last = std::numeric_limits<uint64_t>::max())
+    {
+      for (size_t i(findChunk(first)); (i < _chunks.size()) && (_chunks[i].firstEvent <= last); ++i)
+	for (const eventlog::Record& record : readChunk(i))
+	  if ((record.eventCount >= first) && (record.eventCount <= last))
+	    func(record);
+    }
+
+    /*! \brief Write the records as text, one per line, in reduced
+        units.
+     */
+    void writeText(std::ostream&, uint64_t first = 0, uint64_t last = std::numeric_limits<uint64_t>::max());
+
+    /*! \brief Apply the logged events up to the event last to a
+        Simulation.
+
+      The Simulation must be initialised from the configuration the
+      log was started from. The particles are streamed to the time of
+      each event and given the logged impulses, so the translational
+      state of the particles is reconstructed without predicting any
+      events. Any other state (e.g., orientations) is not replayed.
+
+      \return The number of events applied.
+    */
+    uint64_t replay(Simulation& Sim, uint64_t last = std::numeric_limits<uint64_t>::max());
+
+  private:
+    //! \brief Find the chunks by scanning the file, if there is no index.
+    void scanChunks();
+
+    std::string _filename;
+    std::ifstream _file;
+    uint64_t _fileSize;
+    eventlog::Header _header;
+    std::vector<eventlog::Chunk> _chunks;
+    bool _indexed;
+  };
+}
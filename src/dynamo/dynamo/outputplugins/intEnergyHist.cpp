@@ -34,9 +34,11 @@ namespace dynamo {
   }
 
   void 
-  OPIntEnergyHist::eventUpdate(const Event& event, const NEventData&)
+  OPIntEnergyHist::recordUpdate(const EventRecord& record)
   {
-    intEnergyHist.addVal(_ptrOPMisc->getConfigurationalU(), event._dt);
+    //The energy is sampled once per event
+    if (record._index == 0)
+      intEnergyHist.addVal(record._configurationalU, record._dt);
   }
 
   void 
@@ -30,7 +30,12 @@ namespace dynamo {
 
     virtual void initialise();
 
-    virtual void eventUpdate(const Event&, const NEventData&);
+    //! \brief Unused, this plugin is updated through recordUpdate().
+    virtual void eventUpdate(const Event&, const NEventData&) {}
+
+    virtual bool isRecordConsumer() const { return true; }
+
+    virtual void recordUpdate(const EventRecord&);
 
     virtual void output(magnet::xml::XmlStream&);
 
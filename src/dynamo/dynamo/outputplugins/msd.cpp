@@ -24,7 +24,10 @@
 namespace dynamo {
   OPMSD::OPMSD(const dynamo::Simulation* tmp, const magnet::xml::Node&):
     OutputPlugin(tmp,"MSD")
-  {}
+  {
+    //Only the initial and final positions are used
+    _subscription.clear();
+  }
 
   OPMSD::~OPMSD()
   {}
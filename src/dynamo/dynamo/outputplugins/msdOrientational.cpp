@@ -27,7 +27,10 @@ namespace dynamo {
   OPMSDOrientational::OPMSDOrientational(const dynamo::Simulation* tmp, 
 					 const magnet::xml::Node&):
     OutputPlugin(tmp,"MSDOrientational")
-  {}
+  {
+    //Only the initial and final orientations are used
+    _subscription.clear();
+  }
 
   OPMSDOrientational::~OPMSDOrientational()
   {}
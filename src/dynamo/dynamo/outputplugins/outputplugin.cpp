@@ -18,6 +18,8 @@
 #include <dynamo/outputplugins/include.hpp>
 #include <dynamo/include.hpp>
 #include <dynamo/particle.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/ranges/IDRange.hpp>
 #include <magnet/xmlreader.hpp>
 #include <boost/tokenizer.hpp>
 #include <iostream>
@@ -30,6 +32,21 @@ namespace dynamo {
     dout << "Loaded" << std::endl;
   }
 
+  bool
+  OutputPlugin::Subscription::accept(const Event& event, const dynamo::Simulation& sim) const
+  {
+    if ((_sourceID != std::numeric_limits<size_t>::max()) && (event._sourceID != _sourceID))
+      return false;
+
+    if (!_range) return true;
+
+    if ((event._particle1ID < sim.particles.size()) && _range->isInRange(sim.particles[event._particle1ID]))
+      return true;
+
+    return (event._source == INTERACTION) && (event._particle2ID < sim.particles.size())
+      && _range->isInRange(sim.particles[event._particle2ID]);
+  }
+
   void
   OutputPlugin::output(magnet::xml::XmlStream&)
   {}
@@ -135,6 +152,8 @@ namespace dynamo {
       return testGeneratePlugin<OPChainBondAngles>(Sim, XML);
     else if (!Name.compare("Trajectory"))
       return testGeneratePlugin<OPTrajectory>(Sim, XML);
+    else if (!Name.compare("EventLog"))
+      return testGeneratePlugin<OPEventLog>(Sim, XML);
     else if (!Name.compare("ChainBondLength"))
       return testGeneratePlugin<OPChainBondLength>(Sim, XML);
     else if (!Name.compare("VelDist"))
@@ -143,6 +162,8 @@ namespace dynamo {
       return testGeneratePlugin<OPVelProfile>(Sim, XML);
     else if (!Name.compare("RadialDistribution"))
       return testGeneratePlugin<OPRadialDistribution>(Sim, XML);
+    else if (!Name.compare("Structure"))
+      return testGeneratePlugin<OPStructure>(Sim, XML);
     else if (!Name.compare("MSDCorrelator"))
       return testGeneratePlugin<OPMSDCorrelator>(Sim, XML);
     else if (!Name.compare("VACF"))
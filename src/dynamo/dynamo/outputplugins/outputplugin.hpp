@@ -18,6 +18,7 @@
 #pragma once
 #include <dynamo/base.hpp>
 #include <dynamo/eventtypes.hpp>
+#include <cstdint>
 
 namespace magnet { namespace xml { class Node; class XmlStream; } }
 
@@ -32,6 +33,97 @@ namespace dynamo {
   class OutputPlugin: public dynamo::SimBase_const
   {
   public:
+    /*! \brief A description of the events an OutputPlugin receives
+        through eventUpdate().
+
+      By default, a plugin receives every event. Plugins which only
+      require some events (or none at all) should restrict their
+      Subscription in their constructor or initialise(), as the
+      Simulation builds its per event type dispatch lists from the
+      Subscription of each plugin after they are initialised.
+
+      Plugins which stream their data using the Event::_dt of each
+      event must receive all events.
+    */
+    class Subscription
+    {
+      static_assert(FINAL_ENUM_TO_CATCH_THE_COMMA <= 64, "Too many event types for the subscription mask");
+
+    public:
+      Subscription():
+	_sources(~uint32_t(0)),
+	_types(~uint64_t(0)),
+	_sourceID(std::numeric_limits<size_t>::max())
+      {}
+
+      //! \brief Unsubscribe from all event sources and types.
+      void clear() { _sources = 0; _types = 0; }
+
+      void addSource(EventSource source) { _sources |= uint32_t(1) << source; }
+      void addType(EEventType type) { _types |= uint64_t(1) << type; }
+
+      /*! \brief Only accept events from the Interaction, Local,
+          Global or System with this ID.
+      */
+      void setSourceID(size_t ID) { _sourceID = ID; }
+
+      /*! \brief Only accept events involving a particle in this
+          range.
+	  
+	  Events without any particles (e.g., most System events) are
+	  then not accepted.
+      */
+      void setRange(shared_ptr<IDRange> range) { _range = range; }
+
+      //! \brief Test if any events of this source and type are accepted.
+      bool matches(EventSource source, EEventType type) const
+      { return (_sources & (uint32_t(1) << source)) && (_types & (uint64_t(1) << type)); }
+
+      //! \brief Test if accept() must be called for each event.
+      bool isFiltered() const 
+      { return (_sourceID != std::numeric_limits<size_t>::max()) || bool(_range); }
+
+      //! \brief Apply the source ID and particle range filters to an event.
+      bool accept(const Event&, const dynamo::Simulation&) const;
+
+    private:
+      uint32_t _sources;
+      uint64_t _types;
+      size_t _sourceID;
+      shared_ptr<IDRange> _range;
+    };
+
+    /*! \brief A compact, self-contained record of one particle
+        change of an event.
+
+      An event generates one record per particle (or pair) change,
+      and a single record without any particles if no particles were
+      changed. As the record holds all the information required, it
+      may be processed after the Simulation has moved on to later
+      events (see Simulation::asyncOutputPlugins).
+    */
+    struct EventRecord
+    {
+      //! \brief The system time after the event.
+      double _systemTime;
+      //! \brief The time since the previous event, only set in the first record of an event.
+      double _dt;
+      //! \brief The configurational energy after the event (from OPMisc, if loaded).
+      double _configurationalU;
+      size_t _sourceID;
+      //! \brief The changed particle, or std::numeric_limits<size_t>::max() if none.
+      size_t _particle1ID;
+      //! \brief The second particle of a pair change, or std::numeric_limits<size_t>::max() if none.
+      size_t _particle2ID;
+      //! \brief The index of this record within its event.
+      uint32_t _index;
+      EventSource _source;
+      //! \brief The type of the event.
+      EEventType _eventType;
+      //! \brief The type of this particle change.
+      EEventType _type;
+    };
+
     OutputPlugin(const dynamo::Simulation*, const char*, unsigned char order=100);
   
     inline virtual ~OutputPlugin() {}
@@ -39,7 +131,18 @@ namespace dynamo {
     virtual void initialise() = 0;
   
     virtual void eventUpdate(const Event&, const NEventData&) = 0;
-  
+
+    /*! \brief Test if this plugin accumulates its data from
+        EventRecord's.
+
+      Such plugins receive recordUpdate() calls in place of
+      eventUpdate(). As recordUpdate() must only use the record and
+      the plugins own data, it may be called from a worker thread.
+    */
+    virtual bool isRecordConsumer() const { return false; }
+
+    virtual void recordUpdate(const EventRecord&) {}
+
     virtual void output(magnet::xml::XmlStream&);
   
     virtual void periodicOutput();
@@ -58,8 +161,12 @@ namespace dynamo {
     }
   
     virtual void temperatureRescale(const double&) {}
+
+    const Subscription& getSubscription() const { return _subscription; }
   
   protected:
+    Subscription _subscription;
+
     std::ostream& I_Pcout() const;
   
     // This sets the order in which these things are updated
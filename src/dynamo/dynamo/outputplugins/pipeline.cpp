@@ -0,0 +1,102 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/outputplugins/pipeline.hpp>
+#include <magnet/exception.hpp>
+#include <chrono>
+
+namespace dynamo {
+  OutputPipeline::OutputPipeline(size_t capacity):
+    _stop(false),
+    _capacity(capacity)
+  {}
+
+  OutputPipeline::~OutputPipeline()
+  {
+    _stop.store(true, std::memory_order_release);
+    for (auto& channel : _channels)
+      channel->_thread.join();
+  }
+
+  size_t
+  OutputPipeline::addConsumer(OutputPlugin* plugin)
+  {
+    _channels.push_back(std::unique_ptr<Channel>(new Channel(plugin, _capacity)));
+    Channel& channel = *_channels.back();
+    channel._thread = std::thread(&OutputPipeline::worker, this, std::ref(channel));
+    return _channels.size() - 1;
+  }
+
+  void
+  OutputPipeline::push(size_t channelID, const OutputPlugin::EventRecord& record)
+  {
+    Channel& channel = *_channels[channelID];
+    while (!channel._queue.push(record))
+      std::this_thread::yield();
+    ++channel._pushed;
+  }
+
+  void
+  OutputPipeline::flush()
+  {
+    for (auto& channel : _channels)
+      {
+	while (channel->_processed.load(std::memory_order_acquire) != channel->_pushed)
+	  std::this_thread::yield();
+
+	if (!channel->_error.empty())
+	  M_throw() << "Exception caught in the worker thread of an output plugin\n" << channel->_error;
+      }
+  }
+
+  void
+  OutputPipeline::worker(Channel& channel)
+  {
+    OutputPlugin::EventRecord record;
+    size_t idle = 0;
+    while (true)
+      {
+	if (channel._queue.pop(record))
+	  {
+	    idle = 0;
+	    //After an exception, the remaining records are discarded
+	    //so that flush() still returns.
+	    if (channel._error.empty())
+	      try
+		{
+		  channel._plugin->recordUpdate(record);
+		}
+	      catch (std::exception& err)
+		{
+		  channel._error = err.what();
+		}
+	    channel._processed.fetch_add(1, std::memory_order_release);
+	    continue;
+	  }
+
+	if (_stop.load(std::memory_order_acquire) && channel._queue.empty())
+	  return;
+
+	//Back off gradually while the queue is empty, so that an idle
+	//pipeline does not compete with the simulation thread
+	if (++idle < 1024)
+	  std::this_thread::yield();
+	else
+	  std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+  }
+}
@@ -0,0 +1,84 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/outputplugins/outputplugin.hpp>
+#include <magnet/thread/spscQueue.hpp>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief Runs the recordUpdate() of OutputPlugin's on worker
+      threads.
+
+    Each consumer plugin is given its own channel, which is a
+    SPSCQueue of OutputPlugin::EventRecord's filled by the simulation
+    thread and emptied by a dedicated worker thread. The plugins data
+    may only be read by the simulation thread after a call to
+    flush().
+  */
+  class OutputPipeline
+  {
+  public:
+    OutputPipeline(size_t capacity = 16384);
+
+    ~OutputPipeline();
+
+    /*! \brief Start a worker thread for a plugin.
+
+      \return The channel ID to pass to push().
+    */
+    size_t addConsumer(OutputPlugin*);
+
+    //! \brief Queue a record for a channel, blocking while the channel is full.
+    void push(size_t channel, const OutputPlugin::EventRecord&);
+
+    //! \brief Block until all queued records have been processed.
+    void flush();
+
+    //! \brief The number of consumer plugins (and worker threads).
+    size_t size() const { return _channels.size(); }
+
+  private:
+    OutputPipeline(const OutputPipeline&);
+
+    struct Channel
+    {
+      Channel(OutputPlugin* plugin, size_t capacity):
+	_queue(capacity), _plugin(plugin), _pushed(0), _processed(0)
+      {}
+
+      magnet::thread::SPSCQueue<OutputPlugin::EventRecord> _queue;
+      OutputPlugin* _plugin;
+      std::thread _thread;
+      //! \brief Records queued, only accessed by the simulation thread.
+      size_t _pushed;
+      std::atomic<size_t> _processed;
+      //! \brief The message of any exception thrown by the plugin.
+      std::string _error;
+    };
+
+    void worker(Channel&);
+
+    std::vector<std::unique_ptr<Channel> > _channels;
+    std::atomic<bool> _stop;
+    size_t _capacity;
+  };
+}
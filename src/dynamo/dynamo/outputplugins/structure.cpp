@@ -0,0 +1,525 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/outputplugins/structure.hpp>
+#include <dynamo/include.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/NparticleEventData.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/dynamics/gravity.hpp>
+#include <dynamo/dynamics/viscous.hpp>
+#include <dynamo/BC/PBC.hpp>
+#include <dynamo/BC/LEBC.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <magnet/xmlreader.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace dynamo {
+  OPStructure::OPStructure(const dynamo::Simulation* tmp, const magnet::xml::Node& XML):
+    OutputPlugin(tmp,"Structure"),
+    binWidth(0.01),
+    length(0),
+    _skin(0),
+    _kStep(0),
+    _kMax(20),
+    _startTime(0),
+    _updateTime(0),
+    _displacement(0),
+    _vmax(0),
+    _velocityScale(1)
+  { operator<<(XML); }
+
+  void 
+  OPStructure::operator<<(const magnet::xml::Node& XML)
+  {
+    try {
+      if (XML.hasAttribute("BinWidth"))
+	binWidth = XML.getAttribute("BinWidth").as<double>();
+      binWidth *= Sim->units.unitLength();
+    
+      if (XML.hasAttribute("Length"))
+	length = XML.getAttribute("Length").as<size_t>();
+
+      if (XML.hasAttribute("Skin"))
+	_skin = XML.getAttribute("Skin").as<double>() * Sim->units.unitLength();
+
+      if (XML.hasAttribute("KStep"))
+	_kStep = XML.getAttribute("KStep").as<double>() / Sim->units.unitLength();
+
+      if (XML.hasAttribute("KMax"))
+	_kMax = XML.getAttribute("KMax").as<double>();
+      _kMax /= Sim->units.unitLength();
+    }
+    catch (std::exception& excep)
+      {
+	M_throw() << "Error while parsing output plugin options\n" << excep.what();
+      }
+  }
+
+  void 
+  OPStructure::initialise()
+  {
+    if (!std::dynamic_pointer_cast<const DynNewtonian>(Sim->dynamics)
+	|| std::dynamic_pointer_cast<const DynGravity>(Sim->dynamics)
+	|| std::dynamic_pointer_cast<const DynViscous>(Sim->dynamics))
+      M_throw() << "The Structure plugin requires Newtonian dynamics without external fields";
+
+    if (std::dynamic_pointer_cast<const BCLeesEdwards>(Sim->BCs))
+      M_throw() << "The Structure plugin does not support Lees-Edwards boundary conditions";
+
+    if (!length)
+      {
+	//By default, sample out to three times the longest
+	//interaction, but no further than half the box
+	double maxLength = 3 * Sim->getLongestInteraction();
+	for (size_t iDim = 0; iDim < NDIM; ++iDim)
+	  maxLength = std::min(maxLength, 0.5 * Sim->primaryCellSize[iDim]);
+	length = 1 + static_cast<size_t>(maxLength / binWidth + 0.5);
+      }
+
+    //The largest separation which is binned
+    const double rmax = (length - 0.5) * binWidth;
+
+    if (!_skin)
+      _skin = 0.2 * rmax;
+
+    if (!_kStep)
+      _kStep = M_PI / rmax;
+
+    dout << "BinWidth = " << binWidth / Sim->units.unitLength()
+	 << "\nLength = " << length
+	 << "\nSkin = " << _skin / Sim->units.unitLength() << std::endl;
+
+    data.assign(Sim->species.size(), 
+		std::vector<std::vector<double> >(Sim->species.size(), std::vector<double>(length, 0)));
+
+    _speciesID.resize(Sim->N());
+    for (const Particle& part : Sim->particles)
+      _speciesID[part.getID()] = Sim->species(part)->getID();
+
+    _oldVel.clear();
+    _startTime = Sim->systemTime;
+    _lastTime.assign(Sim->N(), Sim->systemTime);
+    rebuildLists(Sim->systemTime);
+  }
+
+  Vector
+  OPStructure::velocity(const size_t ID) const
+  {
+    for (const auto& entry : _oldVel)
+      if (entry.first == ID)
+	return entry.second;
+    return Sim->particles[ID].getVelocity() * _velocityScale;
+  }
+
+  Vector
+  OPStructure::position(const size_t ID, const double t) const
+  {
+    const Particle& part = Sim->particles[ID];
+    //The particles of the current event are already up to date
+    //(their delay is zero), the rest are streamed by their delay
+    const Vector current = part.getPosition() + part.getVelocity() * Sim->dynamics->getParticleDelay(part);
+    return current - velocity(ID) * (Sim->systemTime - t);
+  }
+
+  void 
+  OPStructure::integratePair(const size_t i, const size_t j, double t0, const double t)
+  {
+    t0 = std::max(t0, std::max(_lastTime[i], _lastTime[j]));
+    if (t <= t0) return;
+    const double dt = t - t0;
+
+    Vector rij = position(j, t) - position(i, t);
+    Sim->BCs->applyBC(rij);
+    const Vector vij = velocity(j) - velocity(i);
+    //The separation at the start of the interval
+    const Vector r0 = rij - vij * dt;
+
+    //|r(s)|^2 = A s^2 + B s + C, for s in [0, dt]
+    const double A = vij.nrm2(), B = 2 * (r0 | vij), C = r0.nrm2();
+    const double rmax = (length - 0.5) * binWidth;
+
+    std::vector<double>& bins1 = data[_speciesID[i]][_speciesID[j]];
+    std::vector<double>& bins2 = data[_speciesID[j]][_speciesID[i]];
+    auto add = [&](const size_t bin, const double time) {
+      if (bin < length)
+	{
+	  bins1[bin] += time;
+	  bins2[bin] += time;
+	}
+    };
+
+    if (A == 0)
+      {
+	add(static_cast<size_t>(std::sqrt(C) / binWidth + 0.5), dt);
+	return;
+      }
+
+    //The separation decreases up to the time of closest approach,
+    //then increases
+    const double sMin = std::min(std::max(-B / (2 * A), 0.0), dt);
+    const double dMin2 = std::max(A * sMin * sMin + B * sMin + C, 0.0);
+    if (dMin2 >= rmax * rmax) return;
+
+    //Integrate one monotonic piece of the trajectory, from s0 to s1
+    auto piece = [&](const double s0, const double s1, const bool decreasing)
+      {
+	if (s1 <= s0) return;
+	const double d0 = std::sqrt(std::max(A * s0 * s0 + B * s0 + C, 0.0));
+	const double d1 = std::sqrt(std::max(A * s1 * s1 + B * s1 + C, 0.0));
+	size_t bin = static_cast<size_t>(d0 / binWidth + 0.5);
+	const size_t endBin = static_cast<size_t>(d1 / binWidth + 0.5);
+	double s = s0;
+	if (bin >= length)
+	  {
+	    //Nothing is binned until the pair has approached to within
+	    //range
+	    if (!decreasing || (endBin >= length)) return;
+	    const double disc = std::sqrt(std::max(B * B - 4 * A * (C - rmax * rmax), 0.0));
+	    s = std::min(std::max((-B - disc) / (2 * A), s0), s1);
+	    bin = length - 1;
+	  }
+	while (bin != endBin)
+	  {
+	    //The edge between this bin and the next one along the path
+	    const double edge = (decreasing ? (bin - 0.5) : (bin + 0.5)) * binWidth;
+	    const double disc = std::sqrt(std::max(B * B - 4 * A * (C - edge * edge), 0.0));
+	    const double sCross = std::min(std::max((decreasing ? (-B - disc) : (-B + disc)) / (2 * A), s), s1);
+	    add(bin, sCross - s);
+	    s = sCross;
+	    if (decreasing) --bin; else ++bin;
+	    //Once moving outwards past the last bin, nothing more is binned
+	    if (!decreasing && (bin >= length)) return;
+	  }
+	add(bin, s1 - s);
+      };
+
+    piece(0, sMin, true);
+    piece(sMin, dt, false);
+  }
+
+  void 
+  OPStructure::flushParticle(const size_t ID, const double t)
+  {
+    for (const Neighbour& j : _neighbours[ID])
+      integratePair(ID, j.ID, j.start, t);
+    _lastTime[ID] = t;
+  }
+
+  void 
+  OPStructure::flushAll(const double t)
+  {
+    for (size_t i(0); i < Sim->N(); ++i)
+      for (const Neighbour& j : _neighbours[i])
+	if (j.ID > i)
+	  integratePair(i, j.ID, j.start, t);
+
+    std::fill(_lastTime.begin(), _lastTime.end(), t);
+  }
+
+  void 
+  OPStructure::rebuildLists(const double t)
+  {
+    const size_t N = Sim->N();
+    const double rlist = (length - 0.5) * binWidth + _skin;
+    std::vector<std::vector<Neighbour> > oldNeighbours;
+    std::swap(oldNeighbours, _neighbours);
+    oldNeighbours.resize(N);
+    _neighbours.resize(N);
+
+    std::vector<Vector> positions(N);
+    _vmax = 0;
+    for (size_t i(0); i < N; ++i)
+      {
+	positions[i] = position(i, t);
+	_vmax = std::max(_vmax, velocity(i).nrm());
+      }
+    _updateTime = t;
+    _displacement = 0;
+
+    auto test = [&](const size_t i, const size_t j) {
+      Vector rij = positions[j] - positions[i];
+      Sim->BCs->applyBC(rij);
+      if (rij.nrm2() <= rlist * rlist)
+	{
+	  _neighbours[i].push_back(Neighbour{j, t});
+	  _neighbours[j].push_back(Neighbour{i, t});
+	}
+    };
+
+    //A cell grid is used for periodic systems with at least three
+    //cells of width rlist in each direction, otherwise all pairs are
+    //tested
+    std::array<size_t, NDIM> cells;
+    bool useCells = (typeid(*Sim->BCs) == typeid(BCPeriodic));
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      {
+	cells[iDim] = static_cast<size_t>(Sim->primaryCellSize[iDim] / rlist);
+	useCells = useCells && (cells[iDim] >= 3);
+      }
+
+    if (!useCells)
+      {
+	for (size_t i(0); i < N; ++i)
+	  for (size_t j(i + 1); j < N; ++j)
+	    test(i, j);
+      }
+    else
+      {
+	auto cellIndex = [&](const std::array<size_t, NDIM>& coords) {
+	  size_t index = 0;
+	  for (size_t iDim(NDIM); iDim > 0; --iDim)
+	    index = index * cells[iDim - 1] + coords[iDim - 1];
+	  return index;
+	};
+
+	size_t totalCells = 1;
+	for (const size_t& c : cells) totalCells *= c;
+	std::vector<std::vector<size_t> > cellContents(totalCells);
+	std::vector<std::array<size_t, NDIM> > coords(N);
+	for (size_t i(0); i < N; ++i)
+	  {
+	    Vector pos = positions[i];
+	    Sim->BCs->applyBC(pos);
+	    for (size_t iDim(0); iDim < NDIM; ++iDim)
+	      coords[i][iDim] = std::min(cells[iDim] - 1, static_cast<size_t>(std::max(0.0, (pos[iDim] / Sim->primaryCellSize[iDim] + 0.5) * cells[iDim])));
+	    cellContents[cellIndex(coords[i])].push_back(i);
+	  }
+
+	//Test each particle against the particles of higher ID in the
+	//surrounding cells
+	for (size_t i(0); i < N; ++i)
+	  {
+	    std::array<int, NDIM> offset;
+	    offset.fill(-1);
+	    while (true)
+	      {
+		std::array<size_t, NDIM> neighbour;
+		for (size_t iDim(0); iDim < NDIM; ++iDim)
+		  neighbour[iDim] = (coords[i][iDim] + cells[iDim] + offset[iDim]) % cells[iDim];
+
+		for (const size_t& j : cellContents[cellIndex(neighbour)])
+		  if (j > i)
+		    test(i, j);
+
+		size_t iDim(0);
+		for (; iDim < NDIM; ++iDim)
+		  if (++offset[iDim] <= 1)
+		    break;
+		  else
+		    offset[iDim] = -1;
+		if (iDim == NDIM) break;
+	      }
+	  }
+      }
+
+    //Pairs which stay in the lists keep their start time. Pairs
+    //which leave are integrated up to now, as they cannot come
+    //within range again before they rejoin the lists.
+    for (size_t i(0); i < N; ++i)
+      {
+	std::vector<Neighbour>& list = _neighbours[i];
+	std::sort(list.begin(), list.end(), [](const Neighbour& a, const Neighbour& b) { return a.ID < b.ID; });
+	auto it = list.begin();
+	for (const Neighbour& old : oldNeighbours[i])
+	  {
+	    while ((it != list.end()) && (it->ID < old.ID)) ++it;
+	    if ((it != list.end()) && (it->ID == old.ID))
+	      it->start = old.start;
+	    else if (old.ID > i)
+	      integratePair(i, old.ID, old.start, t);
+	  }
+      }
+  }
+
+  void 
+  OPStructure::updateLists(const double t)
+  {
+    //The lists hold every pair which can come within range until
+    //two particles could have closed the skin distance. If this
+    //happens before the time t, the lists are rebuilt at that time.
+    while (2 * (_displacement + _vmax * (t - _updateTime)) > _skin)
+      {
+	rebuildLists(_updateTime + (0.5 * _skin - _displacement) / _vmax);
+      }
+
+    _displacement += _vmax * (t - _updateTime);
+    _updateTime = t;
+  }
+
+  void 
+  OPStructure::exchangeFlush(const OPStructure& partner)
+  {
+    //The system times were swapped, so the times held by the plugin
+    //are moved onto the new time line of this configuration
+    const double shift = Sim->systemTime - partner.Sim->systemTime;
+    for (double& t : _lastTime)
+      t += shift;
+    for (std::vector<Neighbour>& list : _neighbours)
+      for (Neighbour& j : list)
+	j.start += shift;
+    _updateTime += shift;
+
+    //The ensembles are swapped after the plugins, so these are still
+    //the temperatures the velocities were rescaled between
+    _velocityScale = std::sqrt(Sim->ensemble->getEnsembleVals()[2] / partner.Sim->ensemble->getEnsembleVals()[2]);
+    updateLists(Sim->systemTime);
+    flushAll(Sim->systemTime);
+    _velocityScale = 1;
+  }
+
+  void 
+  OPStructure::replicaExchange(OutputPlugin& plug)
+  {
+    OPStructure& op = static_cast<OPStructure&>(plug);
+    exchangeFlush(op);
+    op.exchangeFlush(*this);
+
+    //The start times are on the time line of the (swapped) system
+    //times, so they follow the data
+    std::swap(data, op.data);
+    std::swap(_startTime, op._startTime);
+  }
+
+  void 
+  OPStructure::temperatureRescale(const double&)
+  {
+    //Nothing is left to integrate after an exchange, but the speed
+    //bound and the lists are only valid for the old velocities. The
+    //rebuild recalculates the speed bound from the new velocities.
+    flushAll(Sim->systemTime);
+    rebuildLists(Sim->systemTime);
+  }
+
+  void 
+  OPStructure::eventUpdate(const Event&, const NEventData& NDat)
+  {
+    const double t = Sim->systemTime;
+
+    auto addOldVel = [&](const ParticleEventData& pData) {
+      //A particle's first change holds its velocity before the event
+      for (const auto& entry : _oldVel)
+	if (entry.first == pData.getParticleID())
+	  return;
+      _oldVel.push_back(std::make_pair(pData.getParticleID(), pData.getOldVel()));
+    };
+
+    for (const ParticleEventData& pData : NDat.L1partChanges)
+      addOldVel(pData);
+
+    for (const PairEventData& pData : NDat.L2partChanges)
+      {
+	addOldVel(pData.particle1_);
+	addOldVel(pData.particle2_);
+      }
+
+    updateLists(t);
+
+    for (const auto& entry : _oldVel)
+      flushParticle(entry.first, t);
+
+    //The new velocities may be faster than any seen before
+    for (const auto& entry : _oldVel)
+      _vmax = std::max(_vmax, Sim->particles[entry.first].getVelocity().nrm());
+
+    _oldVel.clear();
+  }
+
+  std::vector<std::pair<double, double> > 
+  OPStructure::getgrdata(size_t species1ID, size_t species2ID)
+  {
+    updateLists(Sim->systemTime);
+    flushAll(Sim->systemTime);
+
+    std::vector<std::pair<double, double> > retval;
+    const double totalTime = Sim->systemTime - _startTime;
+    const double density = (Sim->species[species2ID]->getCount() - (species1ID == species2ID)) / Sim->getSimVolume();
+    const double origins = totalTime * Sim->species[species1ID]->getCount();
+
+    retval.reserve(length);
+    for (size_t i = 0; i < length; ++i)
+      {
+	const double radius = binWidth * i;
+	const double volshell =  M_PI * (4.0 * binWidth * radius * radius + binWidth * binWidth * binWidth / 3.0);
+	retval.push_back(std::pair<double, double>(radius, (origins > 0) ? data[species1ID][species2ID][i] / (density * origins * volshell) : 0));
+      }
+
+    return retval;
+  }
+
+  void
+  OPStructure::output(magnet::xml::XmlStream& XML)
+  {
+    XML << magnet::xml::tag("Structure")
+	<< magnet::xml::attr("Time") << (Sim->systemTime - _startTime) / Sim->units.unitTime()
+	<< magnet::xml::attr("BinWidth") << binWidth / Sim->units.unitLength();
+
+    std::vector<std::vector<std::vector<std::pair<double, double> > > > gr(Sim->species.size());
+    for (const shared_ptr<Species>& sp1 : Sim->species)
+      for (const shared_ptr<Species>& sp2 : Sim->species)
+	gr[sp1->getID()].push_back(getgrdata(sp1->getID(), sp2->getID()));
+
+    XML << magnet::xml::tag("RadialDistribution");
+    for (const shared_ptr<Species>& sp1 : Sim->species)
+      for (const shared_ptr<Species>& sp2 : Sim->species)
+	{
+	  XML << magnet::xml::tag("Species")
+	      << magnet::xml::attr("Name1") << sp1->getName()
+	      << magnet::xml::attr("Name2") << sp2->getName()
+	      << magnet::xml::chardata();
+
+	  //Skip the zero bin
+	  const std::vector<std::pair<double, double> >& data12 = gr[sp1->getID()][sp2->getID()];
+	  for (size_t i = 1; i < length; ++i)
+	    XML << data12[i].first / Sim->units.unitLength() << " " << data12[i].second << "\n";
+
+	  XML << magnet::xml::endtag("Species");
+	}
+    XML << magnet::xml::endtag("RadialDistribution");
+
+    XML << magnet::xml::tag("StructureFactor");
+    for (const shared_ptr<Species>& sp1 : Sim->species)
+      for (const shared_ptr<Species>& sp2 : Sim->species)
+	{
+	  const double density1 = sp1->getCount() / Sim->getSimVolume();
+	  const double density2 = sp2->getCount() / Sim->getSimVolume();
+	  const std::vector<std::pair<double, double> >& data12 = gr[sp1->getID()][sp2->getID()];
+
+	  XML << magnet::xml::tag("Species")
+	      << magnet::xml::attr("Name1") << sp1->getName()
+	      << magnet::xml::attr("Name2") << sp2->getName()
+	      << magnet::xml::chardata();
+
+	  for (double k = _kStep; k <= _kMax * (1 + 1e-12); k += _kStep)
+	    {
+	      double sum = 0;
+	      for (size_t i = 1; i < length; ++i)
+		{
+		  const double r = data12[i].first;
+		  sum += r * r * (data12[i].second - 1) * std::sin(k * r) / (k * r) * binWidth;
+		}
+	      const double S = (sp1 == sp2) + 4 * M_PI * std::sqrt(density1 * density2) * sum;
+	      XML << k * Sim->units.unitLength() << " " << S << "\n";
+	    }
+
+	  XML << magnet::xml::endtag("Species");
+	}
+    XML << magnet::xml::endtag("StructureFactor")
+	<< magnet::xml::endtag("Structure");
+  }
+}
@@ -0,0 +1,154 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/outputplugins/outputplugin.hpp>
+#include <magnet/math/vector.hpp>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief Time-averaged radial distribution functions and static
+      structure factors, accumulated exactly from the ballistic motion
+      of the particles between events.
+
+    Between two events involving a pair of particles, their
+    separation follows a straight line. The time the pair spends in
+    each radial bin is therefore found by solving for the times at
+    which \f$|{\bf r}_{ij}(t)|\f$ crosses the bin edges. The
+    contribution of a pair is integrated whenever one of its particles
+    has an event, so the cost of each event is proportional to the
+    number of neighbours of its particles, and the accuracy does not
+    depend on any sampling frequency (unlike OPRadialDistribution).
+
+    The pairs which may come within range are held in Verlet lists
+    built with a skin distance. The lists are rebuilt before any
+    particle can have moved far enough to invalidate them. Only the
+    pairs which leave the lists are integrated up to the rebuild time,
+    the pairs which join the lists are integrated from it.
+
+    The isotropic partial structure factors are obtained from the
+    radial distribution functions for the wavenumbers k = KStep,
+    2 KStep, ..., KMax when the data is output, as
+    \f$S_{ab}(k)=\delta_{ab}+4\pi\sqrt{\rho_a\rho_b}\int_0^{R}r^2(g_{ab}(r)-1)\frac{\sin
+    kr}{kr}dr\f$.
+
+    This plugin requires Newtonian dynamics (without external fields)
+    and periodic or no boundary conditions.
+  */
+  class OPStructure: public OutputPlugin
+  {
+  public:
+    OPStructure(const dynamo::Simulation*, const magnet::xml::Node&);
+
+    virtual void initialise();
+
+    virtual void eventUpdate(const Event&, const NEventData&);
+
+    virtual void output(magnet::xml::XmlStream&);
+
+    void operator<<(const magnet::xml::Node&);
+
+    /*! \brief Swap the accumulated distributions, which belong to
+        the exchanged ensembles, while the Verlet lists stay with the
+        configurations.
+
+      The system times have already been swapped and the velocities
+      rescaled by \f$\sqrt{T_{other}/T}\f$ (see
+      Simulation::replexerSwap), so the pairs are first integrated up
+      to the exchange with the velocities and times from before it.
+    */
+    virtual void replicaExchange(OutputPlugin&);
+
+    //! \brief Rebuild the Verlet lists for the rescaled velocities.
+    virtual void temperatureRescale(const double&);
+
+    /*! \brief The time-averaged radial distribution function of a
+        pair of species, as (r, g(r)) pairs.
+
+      All pairs are first integrated up to the current time.
+    */
+    std::vector<std::pair<double, double> > getgrdata(size_t species1ID, size_t species2ID);
+
+  protected:
+    //! \brief The position of a particle at a time t (before or at the current time).
+    Vector position(size_t ID, double t) const;
+
+    //! \brief The velocity of a particle before the event being processed.
+    Vector velocity(size_t ID) const;
+
+    //! \brief Add the time the pair spends in each bin, from the
+    //! time t0 (or later, if either particle is integrated further)
+    //! up to time t.
+    void integratePair(size_t i, size_t j, double t0, double t);
+
+    //! \brief Integrate all pairs of a particle up to the time t.
+    void flushParticle(size_t ID, double t);
+
+    //! \brief Integrate all pairs up to the time t.
+    void flushAll(double t);
+
+    //! \brief Make the Verlet lists valid up to the time t.
+    void updateLists(double t);
+
+    //! \brief Rebuild the Verlet lists from the positions at time t.
+    void rebuildLists(double t);
+
+    //! \brief Integrate all pairs up to a replica exchange with a
+    //! partner plugin (see replicaExchange).
+    void exchangeFlush(const OPStructure& partner);
+
+    double binWidth;
+    size_t length;
+    double _skin;
+    double _kStep;
+    double _kMax;
+
+    double _startTime;
+    //! \brief The time the displacement bound was last updated.
+    double _updateTime;
+    //! \brief An upper bound on the displacement of any particle since the lists were built.
+    double _displacement;
+    //! \brief An upper bound on the current particle speeds.
+    double _vmax;
+    //! \brief The factor between the current velocities and those
+    //! of the pairs being integrated (only differs from one during a
+    //! replica exchange).
+    double _velocityScale;
+
+    //! \brief The time up to which the pairs of each particle are integrated.
+    std::vector<double> _lastTime;
+    std::vector<size_t> _speciesID;
+
+    //! \brief An entry of a Verlet list, with the time the pair was
+    //! added to the lists (it is not integrated before this time).
+    struct Neighbour
+    {
+      size_t ID;
+      double start;
+    };
+
+    //! \brief The Verlet list of each particle, sorted by ID.
+    std::vector<std::vector<Neighbour> > _neighbours;
+
+    //! \brief The velocities before the event being processed (a
+    //! short list, searched linearly).
+    std::vector<std::pair<size_t, Vector> > _oldVel;
+
+    //! \brief The time spent by the pairs of each species pair in each bin.
+    std::vector<std::vector<std::vector<double> > > data;
+  };
+}
@@ -16,9 +16,7 @@
 */
 
 #include <dynamo/outputplugins/tickerproperty/OrientationalOrder.hpp>
-#include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/units/units.hpp>
-#include <dynamo/BC/BC.hpp>
 #include <dynamo/simulation.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
@@ -30,7 +28,7 @@ namespace dynamo {
   OPOrientationalOrder::OPOrientationalOrder(const dynamo::Simulation* tmp, const magnet::xml::Node& XML):
     OPTicker(tmp,"OrientationalOrder"), 
     _axis({1,0,0}),
-    _rg(1)
+    _rg(0)
   {
     operator<<(XML);
   }
@@ -39,99 +37,58 @@ namespace dynamo {
   OPOrientationalOrder::operator<<(const magnet::xml::Node& XML)
   {
     if (XML.hasAttribute("CutOffR"))
-      _rg = XML.getAttribute("CutOffR").as<double>();
-
-    _rg *= Sim->units.unitLength();
-
-    dout << "Cut off radius set to " 
-	 << _rg / Sim->units.unitLength() << std::endl;
+      {
+	_rg = XML.getAttribute("CutOffR").as<double>() * Sim->units.unitLength();
+	dout << "Cut off radius set to " 
+	     << _rg / Sim->units.unitLength() << std::endl;
+      }
   }
 
 
   void 
   OPOrientationalOrder::initialise() 
   { 
-    ticker();
-  }
-
-  namespace {
-    struct Neighbours {
-      void addNeighbour(const Particle& p1, const size_t& p2)
+    if (_rg)
+      _kernel.reset(new NeighbourhoodKernel(Sim, _rg));
+    else
       {
-	if (p1.getID() != p2)
-	  _neighbours.push_back(p2);
+	_kernel.reset(new NeighbourhoodKernel(Sim, Sim->getLongestInteraction()));
+	_kernel->setCutoff(_kernel->getSupportedLength());
       }
-      
-      std::vector<size_t> _neighbours;
-    };
-
-    struct MagVec : public Vector
-    {
-      MagVec(const Vector& vec):
-	Vector(vec)
-      {}
 
-      bool operator<(const MagVec& ovec) const
-      {
-	return nrm() < ovec.nrm();
-      }
-
-      bool operator>(const MagVec& ovec) const
-      {
-	return nrm() > ovec.nrm();
-      }
-    };
+    ticker();
   }
 
   void 
   OPOrientationalOrder::ticker()
   {
+    const size_t tasks = _kernel->getTaskCount();
+    std::vector<size_t> taskCounts(tasks, 0);
+    std::vector<ComplexNum> taskSums(tasks, ComplexNum(0, 0));
+
+    //The bonds arrive sorted by length, so the first six are to the
+    //nearest neighbours
+    (*_kernel)([&](const size_t task, const Particle&, const std::vector<NeighbourhoodKernel::Bond>& bonds)
+	       {
+		 if (bonds.size() < 6) return;
+
+		 for (size_t i(0); i < 6; ++i)
+		   {
+		     const double angle = std::atan2(bonds[i].rij[1], bonds[i].rij[0]);
+		     taskSums[task] += std::exp(ComplexNum(0, 6 * angle));
+		   }
+
+		 ++taskCounts[task];
+	       });
+
     size_t count(0);
     ComplexNum sum(0,0);
-    for (const Particle& part : Sim->particles)
+    for (size_t task(0); task < tasks; ++task)
       {
-	Neighbours nbs;
-	
-	std::unique_ptr<IDRange> ids(Sim->ptrScheduler->getParticleNeighbours(part));
-	for (const size_t& id1 : *ids)
-	  nbs.addNeighbour(part, id1);
-	
-	if (nbs._neighbours.size() >= 6)
-	  {
-	    std::vector<MagVec> bonds;
-	    for (const size_t& id2 : nbs._neighbours)
-	      {
-		Vector bond = Sim->particles[id2].getPosition() - part.getPosition();
-		Sim->BCs->applyBC(bond);
-		bonds.push_back(bond);
-	      }
-	    std::sort(bonds.begin(), bonds.end());
-
-	    if (bonds.size() > 6)
-	      bonds.erase(bonds.begin()+6, bonds.end());
-
-	    //Normalise the vectors.
-	    for (MagVec& vec : bonds)
-	      {
-		vec /= vec.nrm();
-		
-		double angle;
-		if (vec[0] != 0)
-		  angle = atan(vec[1]/vec[0]);
-		else
-		  if (vec[1] > 0)
-		    angle = M_PI / 2;
-		  else
-		    angle = - M_PI / 2;
-		
-		if (vec[0] < 0) angle += M_PI;
-
-		sum += std::exp(ComplexNum(0, 6 * angle));
-	      }
-	    
-	    ++count;
-	  }
+	count += taskCounts[task];
+	sum += taskSums[task];
       }
+
     _history.push_back(sum / ComplexNum(0, 6.0 * count));
   }
 
@@ -17,11 +17,22 @@
 
 #pragma once
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
+#include <dynamo/outputplugins/tickerproperty/neighbourhood.hpp>
 #include <magnet/math/vector.hpp>
 #include <complex>
 #include <vector>
+#include <memory>
 
 namespace dynamo {
+  /*! \brief Measures the hexatic bond orientational order of a
+      system, \f$\psi_6\f$.
+
+    The angles of the bonds to the six nearest neighbours of each
+    particle are used. If CutOffR is given, only neighbours within it
+    are considered, otherwise all the neighbours the neighbour list
+    can find are. The neighbourhoods are processed in parallel on
+    the thread pool of the Simulation.
+  */
   class OPOrientationalOrder: public OPTicker
   {
   public:
@@ -43,5 +54,6 @@ namespace dynamo {
     std::vector<ComplexNum> _history;
     Vector _axis;
     double _rg;
+    std::unique_ptr<NeighbourhoodKernel> _kernel;
   };
 }
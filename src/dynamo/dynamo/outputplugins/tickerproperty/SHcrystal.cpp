@@ -15,25 +15,18 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <boost/math/special_functions/spherical_harmonic.hpp>
 #include <dynamo/outputplugins/tickerproperty/SHcrystal.hpp>
-#include <dynamo/schedulers/scheduler.hpp>
-#include <dynamo/globals/neighbourList.hpp>
 #include <dynamo/units/units.hpp>
-#include <dynamo/BC/BC.hpp>
-#include <boost/math/special_functions/spherical_harmonic.hpp>
-#include <magnet/math/wigner3J.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
-#include <fstream>
 #include <cmath>
 #include <limits>
 
 namespace dynamo {
   OPSHCrystal::OPSHCrystal(const dynamo::Simulation* tmp, const magnet::xml::Node& XML):
-    OPTicker(tmp,"SHCrystal"), rg(1.2), maxl(7),
-    nblistID(std::numeric_limits<size_t>::max()),
-    count(0)
+    OPTicker(tmp,"SHCrystal"), rg(1.2), maxl(7), _local(false),
+    count(0), _localTicks(0), _w6(6),
+    _q4Hist(0.005), _q6Hist(0.005), _w6Hist(0.001)
   {
     operator<<(XML);
   }
@@ -47,6 +40,9 @@ namespace dynamo {
     if (XML.hasAttribute("MaxL"))
       maxl = XML.getAttribute("MaxL").as<size_t>();
 
+    if (XML.hasAttribute("Local"))
+      _local = true;
+
     rg *= Sim->units.unitLength();
 
 
@@ -58,49 +54,88 @@ namespace dynamo {
   void 
   OPSHCrystal::initialise() 
   { 
-    double smallestlength = std::numeric_limits<float>::infinity();
-    for (const shared_ptr<Global>& pGlob : Sim->globals)
-      if (std::dynamic_pointer_cast<GNeighbourList>(pGlob))
-	{
-	  const double l(static_cast<const GNeighbourList*>(pGlob.get())
-			 ->getMaxSupportedInteractionLength());
-	  if ((l >= rg) && (l < smallestlength))
-	    {
-	      //this neighbourlist is better suited
-	      smallestlength = l;
-	      nblistID = pGlob->getID();
-	    }
-	}
+    _kernel.reset(new NeighbourhoodKernel(Sim, rg));
 
-    if (nblistID == std::numeric_limits<size_t>::max())
-      M_throw() << "There is not a suitable neighbourlist for the cut-off radius selected."
-	"\nR_g = " << rg / Sim->units.unitLength();
+    //The local order parameters need the harmonics up to l=6
+    _harmonics.reset(new magnet::math::SphericalHarmonics(_local ? std::max(maxl, size_t(7)) : maxl));
 
     globalcoeff.resize(maxl);
     for (size_t l=0; l < maxl; ++l)
       globalcoeff[l].resize(2*l+1,std::complex<double>(0,0));
 
+    if (_local)
+      _lastLocal.resize(Sim->particles.size());
+
     ticker();
   }
 
   void 
   OPSHCrystal::ticker()
   {
-    sphericalsum ssum(Sim, rg, maxl);
-  
-    for (const Particle& part : Sim->particles)
+    typedef std::complex<double> Complex;
+    const size_t L = _harmonics->getL();
+    const size_t tasks = _kernel->getTaskCount();
+
+    //Each task has its own accumulators, which are summed once all
+    //neighbourhoods are processed
+    std::vector<std::vector<Complex> > taskSums(tasks, std::vector<Complex>(maxl * maxl));
+    std::vector<std::vector<Complex> > taskLocal(tasks, std::vector<Complex>(L * L));
+    std::vector<std::vector<Complex> > taskY(tasks, std::vector<Complex>(L * L));
+    std::vector<size_t> taskCounts(tasks, 0);
+
+    (*_kernel)([&](const size_t task, const Particle& part, const std::vector<NeighbourhoodKernel::Bond>& bonds)
+	       {
+		 std::vector<Complex>& sums = taskSums[task];
+		 std::vector<Complex>& local = taskLocal[task];
+		 std::vector<Complex>& Y = taskY[task];
+		 std::fill(local.begin(), local.end(), Complex(0, 0));
+
+		 for (const NeighbourhoodKernel::Bond& bond : bonds)
+		   {
+		     _harmonics->evaluate(bond.rij / bond.r, Y.data());
+		     for (size_t i(0); i < maxl * maxl; ++i)
+		       sums[i] += Y[i];
+		     if (_local)
+		       for (size_t i(0); i < L * L; ++i)
+			 local[i] += Y[i];
+		   }
+		 taskCounts[task] += bonds.size();
+
+		 if (!_local) return;
+
+		 LocalOrder& order = _lastLocal[part.getID()];
+		 order.neighbours = bonds.size();
+		 order.q4 = order.q6 = order.w6 = 0;
+		 if (bonds.empty()) return;
+
+		 for (Complex& val : local)
+		   val /= double(bonds.size());
+
+		 const Complex* q4m = &local[magnet::math::SphericalHarmonics::index(4, -4)];
+		 const Complex* q6m = &local[magnet::math::SphericalHarmonics::index(6, -6)];
+		 order.q4 = magnet::math::steinhardtQ(4, q4m);
+		 order.q6 = magnet::math::steinhardtQ(6, q6m);
+		 order.w6 = _w6(q6m);
+	       });
+
+    for (size_t task(0); task < tasks; ++task)
       {
-	std::unique_ptr<IDRange> ids(Sim->ptrScheduler->getParticleNeighbours(part));
-	for (const size_t& id1 : *ids)
-	  ssum(part, id1);
-      
 	for (size_t l(0); l < maxl; ++l)
 	  for (int m(-l); m <= static_cast<int>(l); ++m)
-	    globalcoeff[l][m+l] += ssum.coeffsum[l][m+l];
-      
-	count += ssum.count;
+	    globalcoeff[l][m+l] += taskSums[task][magnet::math::SphericalHarmonics::index(l, m)];
+	count += taskCounts[task];
+      }
 
-	ssum.clear();
+    if (_local)
+      {
+	++_localTicks;
+	for (const LocalOrder& order : _lastLocal)
+	  if (order.neighbours)
+	    {
+	      _q4Hist.addVal(order.q4);
+	      _q6Hist.addVal(order.q6);
+	      _w6Hist.addVal(order.w6);
+	    }
       }
   }
 
@@ -144,57 +179,31 @@ namespace dynamo {
 	    << magnet::xml::endtag("W");
       }
 
-    XML << magnet::xml::endtag("SHCrystal");
-  }
-
-  OPSHCrystal::sphericalsum::sphericalsum
-  (const dynamo::Simulation * const nSim, const double& nrg, const size_t& nl):
-    Sim(nSim), rg(nrg), maxl(nl), count(0)
-  {
-    coeffsum.resize(maxl);
-    for (size_t l=0; l < maxl; ++l)
-      coeffsum[l].resize(2*l+1,std::complex<double>(0,0));
-  }
-
-  void 
-  OPSHCrystal::sphericalsum::operator()
-    (const Particle& part, const size_t& ID) const
-  {
-    if (part.getID() == ID) return;
-    Vector rij = part.getPosition() - Sim->particles[ID].getPosition();
-    Sim->BCs->applyBC(rij);
-  
-    double norm = rij.nrm();
-    if (norm <= rg)
+    if (_local)
       {
-	++count;
-	rij /= norm;
-	double theta = std::acos(rij[0]);
-	double sintheta = std::sin(theta);
-	double phi = rij[1] / sintheta;
-      
-	if (fabs(phi) > 1.0)
-	  phi = (phi > 0) ? 0.5 * M_PI : 1.5 * M_PI;
-	else
-	  phi = std::asin(phi);
-
-	if (std::sin(theta) == 0) phi = 0;
-      
-	if (phi < 0) phi += 2.0 * M_PI;
-
-	for (size_t l(0); l < maxl; ++l)
-	  for (int m(-l); m <= static_cast<int>(l); ++m)
-	    coeffsum[l][m+l] += boost::math::spherical_harmonic(l,m,theta,phi);
+	XML << magnet::xml::tag("Local")
+	    << magnet::xml::attr("Ticks") << _localTicks
+	    << magnet::xml::tag("Q4");
+	_q4Hist.outputHistogram(XML, 1.0);
+	XML << magnet::xml::endtag("Q4")
+	    << magnet::xml::tag("Q6");
+	_q6Hist.outputHistogram(XML, 1.0);
+	XML << magnet::xml::endtag("Q6")
+	    << magnet::xml::tag("W6");
+	_w6Hist.outputHistogram(XML, 1.0);
+	XML << magnet::xml::endtag("W6");
+
+	//The ID, neighbour count, q4, q6 and w6 of each particle at
+	//the last tick
+	XML << magnet::xml::tag("Particles")
+	    << magnet::xml::chardata();
+	for (size_t id(0); id < _lastLocal.size(); ++id)
+	  XML << id << " " << _lastLocal[id].neighbours << " " << _lastLocal[id].q4
+	      << " " << _lastLocal[id].q6 << " " << _lastLocal[id].w6 << "\n";
+	XML << magnet::xml::endtag("Particles")
+	    << magnet::xml::endtag("Local");
       }
-  }
 
-  void
-  OPSHCrystal::sphericalsum::clear()
-  {
-    count = 0;
-
-    for (size_t l(0); l < maxl; ++l)
-      for (int m(-l); m <= static_cast<int>(l); ++m)
-	coeffsum[l][m+l] = std::complex<double>(0,0);
+    XML << magnet::xml::endtag("SHCrystal");
   }
 }
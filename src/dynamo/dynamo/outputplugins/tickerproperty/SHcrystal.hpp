@@ -17,11 +17,28 @@
 
 #pragma once
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
+#include <dynamo/outputplugins/tickerproperty/neighbourhood.hpp>
+#include <magnet/math/spherical_harmonics.hpp>
+#include <magnet/math/histogram.hpp>
 #include <vector>
 #include <complex>
+#include <memory>
 
 namespace dynamo {
-  class Particle;
+  /*! \brief Measures the Steinhardt bond order parameters \f$Q_l\f$
+      and \f$\hat{W}_l\f$ of the system.
+
+    The spherical harmonics of every bond shorter than CutOffR are
+    averaged over all bonds and ticks to give the global order
+    parameters, for l < MaxL.
+
+    If the Local attribute is present, the local order parameters
+    \f$q_4\f$, \f$q_6\f$ and \f$\hat{w}_6\f$ of each particle are also
+    calculated from the bonds of that particle alone. Their distributions are collected
+    over all ticks, and the values of each particle at the last tick
+    are written out for crystal detection. The neighbourhoods are
+    processed in parallel on the thread pool of the Simulation.
+  */
   class OPSHCrystal: public OPTicker
   {
   public:
@@ -38,31 +55,32 @@ namespace dynamo {
     virtual void operator<<(const magnet::xml::Node&);
 
   protected:
-
-    std::complex<double> localq(const Particle& part, int l, int m);
-
     //! Cut-off radius 
     double rg;
     size_t maxl;
-    size_t nblistID;
+    bool _local;
     long count;
+    size_t _localTicks;
   
     std::vector<std::vector<std::complex<double> > > globalcoeff;
 
-    struct sphericalsum
+    std::unique_ptr<NeighbourhoodKernel> _kernel;
+    std::unique_ptr<magnet::math::SphericalHarmonics> _harmonics;
+    magnet::math::SteinhardtW _w6;
+
+    magnet::math::Histogram<> _q4Hist;
+    magnet::math::Histogram<> _q6Hist;
+    magnet::math::Histogram<> _w6Hist;
+
+    //! \brief The local order parameters of each particle at the last tick.
+    struct LocalOrder
     {
-      sphericalsum(const dynamo::Simulation * const, 
-		   const double&, const size_t&);
-    
-      void operator()(const Particle&, const size_t&) const;
-    
-      void clear();
-
-      const dynamo::Simulation* const Sim;
-      const double rg;
-      const size_t maxl;
-      mutable size_t count;
-      mutable std::vector<std::vector<std::complex<double> > > coeffsum;
+      size_t neighbours;
+      double q4;
+      double q6;
+      double w6;
     };
+
+    std::vector<LocalOrder> _lastLocal;
   };
 }
@@ -24,13 +24,19 @@
 #include <magnet/xmlreader.hpp>
 
 namespace dynamo {
+  namespace {
+    struct SquaredDisplacement
+    {
+      double operator()(const Vector& r1, const Vector& r2) const
+      { return (r1 - r2).nrm2(); }
+    };
+  }
+
   OPMSDCorrelator::OPMSDCorrelator(const dynamo::Simulation* tmp, 
 				   const magnet::xml::Node& XML):
     OPTicker(tmp,"MSDCorrelator"),
     length(20),
-    currCorrLength(0),
-    ticksTaken(0),
-    notReady(true)
+    scaling(2)
   {
     operator<<(XML);
   }
@@ -40,77 +46,59 @@ namespace dynamo {
   {
     if (XML.hasAttribute("Length"))
       length = XML.getAttribute("Length").as<size_t>();
+
+    if (XML.hasAttribute("Scaling"))
+      scaling = XML.getAttribute("Scaling").as<size_t>();
   }
 
   void 
   OPMSDCorrelator::initialise()
   {
-    dout << "The length of the MSD correlator is " << length << std::endl;
-    posHistory.resize(Sim->N(), boost::circular_buffer<Vector>(length));
-    currCorrLength=1;
+    dout << "The length of the MSD correlator is " << length 
+	 << ", with a scaling of " << scaling << std::endl;
 
+    _particleCorrelator = magnet::math::MultiTauCorrelator<Vector>(length, scaling);
+    std::vector<size_t> groups(Sim->N());
     for (const Particle& part : Sim->particles)
-      posHistory[part.getID()].push_front(part.getPosition());
+      groups[part.getID()] = Sim->species(part)->getID();
+    _particleCorrelator.resize(groups);
 
-    speciesData.resize(Sim->species.size(), std::vector<double>(length, 0.0));
-    structData.resize(Sim->topology.size(), std::vector<double>(length, 0.0));
+    _moleculeCorrelator = magnet::math::MultiTauCorrelator<Vector>(length, scaling);
+    groups.clear();
+    for (const shared_ptr<Topology>& topo : Sim->topology)
+      groups.resize(groups.size() + topo->getMolecules().size(), topo->getID());
+    _moleculeCorrelator.resize(groups);
+
+    ticker();
   }
 
   void 
   OPMSDCorrelator::ticker()
   {
+    _values.resize(Sim->N());
     for (const Particle& part : Sim->particles)
-      posHistory[part.getID()].push_front(part.getPosition());
-  
-    if (notReady)
-      {
-	if (++currCorrLength != length)
-	  return;
-      
-	notReady = false;
-      }
-  
-    accPass();
-  }
+      _values[part.getID()] = part.getPosition();
 
-  void
-  OPMSDCorrelator::accPass()
-  {
-    ++ticksTaken;
-  
-    for (const shared_ptr<Species>& sp : Sim->species)
-      for (const size_t& ID : *sp->getRange())
-      for (size_t step(1); step < length; ++step)
-	speciesData[sp->getID()][step] += (posHistory[ID][step] - posHistory[ID][0]).nrm2();
-  
+    _particleCorrelator.push(_values, SquaredDisplacement());
+
+    _values.clear();
     for (const shared_ptr<Topology>& topo : Sim->topology)
       for (const shared_ptr<IDRange>& range : topo->getMolecules())
-      {
-	Vector  molCOM({0,0,0});
-	double molMass(0);
-
-	for (const size_t& ID : *range)
-	  {
-	    double mass = Sim->species[Sim->particles[ID]]->getMass(ID);
-	    molCOM += posHistory[ID][0] * mass;
-	    molMass += mass;
-	  }
-
-	molCOM /= molMass;
-
-	for (size_t step(1); step < length; ++step)
-	  {
-	    Vector  molCOM2({0,0,0});
-	  
-	    for (const size_t& ID : *range)
-	      molCOM2 += posHistory[ID][step] 
-	      * Sim->species[Sim->particles[ID]]->getMass(ID);
-	  
-	    molCOM2 /= molMass;
-	  
-	    structData[topo->getID()][step] += (molCOM2 - molCOM).nrm2();
-	  }
-      }
+	{
+	  Vector molCOM({0,0,0});
+	  double molMass(0);
+
+	  for (const size_t& ID : *range)
+	    {
+	      const double mass = Sim->species(Sim->particles[ID])->getMass(ID);
+	      molCOM += Sim->particles[ID].getPosition() * mass;
+	      molMass += mass;
+	    }
+
+	  _values.push_back(molCOM / molMass);
+	}
+
+    _moleculeCorrelator.push(_values, SquaredDisplacement());
   }
 
   void
@@ -130,10 +118,10 @@ namespace dynamo {
 	    << sp->getName()
 	    << magnet::xml::chardata();
       
-	for (size_t step(0); step < length; ++step)
-	  XML << dt * step << " "
-	      << speciesData[sp->getID()][step] 
-	    / (static_cast<double>(ticksTaken) 
+	for (const auto& data : _particleCorrelator.getCorrelator(sp->getID()))
+	  XML << dt * data.lag << " "
+	      << data.sum
+	    / (static_cast<double>(data.origins) 
 	       * static_cast<double>(sp->getCount())
 	       * Sim->units.unitArea())
 	      << "\n";
@@ -151,10 +139,10 @@ namespace dynamo {
 	    << topo->getName()
 	    << magnet::xml::chardata();
       
-	for (size_t step(0); step < length; ++step)
-	  XML << dt * step << " "
-	      << structData[topo->getID()][step]
-	    / (static_cast<double>(ticksTaken) 
+	for (const auto& data : _moleculeCorrelator.getCorrelator(topo->getID()))
+	  XML << dt * data.lag << " "
+	      << data.sum
+	    / (static_cast<double>(data.origins) 
 	       * static_cast<double>(topo->getMolecules().size())
 	       * Sim->units.unitArea())
 	      << "\n";
@@ -17,11 +17,20 @@
 
 #pragma once
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
-#include <boost/circular_buffer.hpp>
+#include <magnet/math/correlators.hpp>
 #include <magnet/math/vector.hpp>
 #include <vector>
 
 namespace dynamo {
+  /*! \brief Collects the mean square displacement of the species
+      and molecules (topologies) on each tick.
+
+    The displacements are correlated using a
+    magnet::math::MultiTauCorrelator, so the first Length lags are
+    at the ticker period and the lags then grow by a factor of
+    Scaling every Length/Scaling points. This allows the MSD to be
+    collected over many decades of time at a fixed cost per tick.
+   */
   class OPMSDCorrelator: public OPTicker
   {
   public:
@@ -37,14 +46,10 @@ namespace dynamo {
     virtual void stream(double) {}
     virtual void ticker();
 
-    void accPass();
-
-    std::vector<boost::circular_buffer<Vector> > posHistory;
-    std::vector<std::vector<double> > speciesData;
-    std::vector<std::vector<double> > structData;
+    magnet::math::MultiTauCorrelator<Vector> _particleCorrelator;
+    magnet::math::MultiTauCorrelator<Vector> _moleculeCorrelator;
+    std::vector<Vector> _values;
     size_t length;
-    size_t currCorrLength;
-    size_t ticksTaken;
-    bool notReady;
+    size_t scaling;
   };
 }
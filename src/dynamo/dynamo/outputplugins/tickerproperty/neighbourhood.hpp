@@ -0,0 +1,160 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/simulation.hpp>
+#include <dynamo/globals/neighbourList.hpp>
+#include <dynamo/BC/BC.hpp>
+#include <magnet/thread/threadpool.hpp>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief A parallel loop over the neighbourhoods of all
+      particles, for the structural ticker plugins.
+
+    The neighbours of each particle are collected from the
+    GNeighbourList with the smallest supported interaction length
+    which still covers the cut-off radius. The bonds to the neighbours
+    within the cut-off are then passed to a functor.
+
+    The particles are divided into contiguous blocks, which are
+    processed as tasks on the thread pool of the Simulation (see
+    Simulation::getThreadPool()). Each call of the functor is
+    told which task it belongs to, so a plugin can keep one
+    accumulator per task (see getTaskCount()) and sum them once the
+    loop is complete, without any locking.
+  */
+  class NeighbourhoodKernel
+  {
+  public:
+    //! \brief A neighbour j of a particle i, with the bond
+    //! \f${\bf r}_{ij}={\bf r}_j-{\bf r}_i\f$ and its length.
+    struct Bond
+    {
+      size_t ID;
+      Vector rij;
+      double r;
+    };
+
+    /*! \param rcut The cut-off radius of the bonds.
+     */
+    NeighbourhoodKernel(const dynamo::Simulation* Sim, const double rcut):
+      _Sim(Sim),
+      _rcut(rcut)
+    {
+      _nblist = findNeighbourList(Sim, rcut);
+      if (!_nblist)
+	M_throw() << "There is not a suitable neighbourlist for the cut-off radius selected."
+	  "\nR_g = " << rcut / Sim->units.unitLength();
+
+      const size_t threads = Sim->getThreadPool().getThreadCount();
+      _tasks = threads ? 4 * (threads + 1) : 1;
+    }
+
+    /*! \brief The GNeighbourList with the smallest supported
+        interaction length which is at least rcut.
+
+      \return An empty pointer if there is no such list.
+    */
+    static shared_ptr<GNeighbourList> findNeighbourList(const dynamo::Simulation* Sim, const double rcut)
+    {
+      shared_ptr<GNeighbourList> retval;
+      double smallestlength = std::numeric_limits<double>::infinity();
+      for (const shared_ptr<Global>& pGlob : Sim->globals)
+	{
+	  auto nblist = std::dynamic_pointer_cast<GNeighbourList>(pGlob);
+	  if (!nblist) continue;
+
+	  const double l(nblist->getMaxSupportedInteractionLength());
+	  if ((l >= rcut) && (l < smallestlength))
+	    {
+	      //this neighbourlist is better suited
+	      smallestlength = l;
+	      retval = nblist;
+	    }
+	}
+      return retval;
+    }
+
+    //! \brief The number of tasks the particles are divided between.
+    size_t getTaskCount() const { return _tasks; }
+
+    double getCutoff() const { return _rcut; }
+
+    /*! \brief Change the cut-off radius of the bonds.
+
+      The cut-off must not exceed getSupportedLength().
+    */
+    void setCutoff(const double rcut)
+    {
+      if (rcut > getSupportedLength())
+	M_throw() << "The cut-off radius exceeds the range of the neighbourlist";
+      _rcut = rcut;
+    }
+
+    //! \brief The longest bond the neighbourlist can find.
+    double getSupportedLength() const { return _nblist->getMaxSupportedInteractionLength(); }
+
+    /*! \brief Call func(task, particle, bonds) for every particle.
+
+      The bonds are sorted by their length. The particle positions
+      must be up to date (as they are when a ticker is called).
+    */
+    template<class Func>
+    void operator()(Func func)
+    {
+      const size_t N = _Sim->particles.size();
+      const size_t blockSize = (N + _tasks - 1) / _tasks;
+      _Sim->getThreadPool().parallel_for(0, _tasks, [&](const size_t task) {
+	    std::vector<size_t> neighbours;
+	    std::vector<Bond> bonds;
+	    const size_t end = std::min(N, (task + 1) * blockSize);
+	    for (size_t id1(task * blockSize); id1 < end; ++id1)
+	      {
+		const Particle& part = _Sim->particles[id1];
+		neighbours.clear();
+		bonds.clear();
+		_nblist->getParticleNeighbours(part, neighbours);
+		//Small systems may see the same cell more than once
+		std::sort(neighbours.begin(), neighbours.end());
+		neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+		for (const size_t& id2 : neighbours)
+		  {
+		    if (id2 == id1) continue;
+		    Vector rij = _Sim->particles[id2].getPosition() - part.getPosition();
+		    _Sim->BCs->applyBC(rij);
+		    const double r = rij.nrm();
+		    if (r <= _rcut)
+		      bonds.push_back(Bond{id2, rij, r});
+		  }
+
+		std::sort(bonds.begin(), bonds.end(), [](const Bond& a, const Bond& b) { return a.r < b.r; });
+		func(task, part, bonds);
+	      }
+	}, 1);
+    }
+
+  protected:
+    const dynamo::Simulation* _Sim;
+    shared_ptr<GNeighbourList> _nblist;
+    double _rcut;
+    size_t _tasks;
+  };
+}
@@ -19,6 +19,9 @@
 #include <dynamo/include.hpp>
 #include <dynamo/simulation.hpp>
 #include <dynamo/dynamics/dynamics.hpp>
+#include <dynamo/interactions/interaction.hpp>
+#include <magnet/xmlreader.hpp>
+#include <mutex>
 
 namespace dynamo {
   OPOverlapTest::OPOverlapTest(const dynamo::Simulation* tmp, 
@@ -30,6 +33,12 @@ namespace dynamo {
   void 
   OPOverlapTest::initialise()
   {
+    if (NeighbourhoodKernel::findNeighbourList(Sim, Sim->getLongestInteraction()))
+      {
+	_kernel.reset(new NeighbourhoodKernel(Sim, Sim->getLongestInteraction()));
+	_kernel->setCutoff(_kernel->getSupportedLength());
+      }
+
     dout << "Testing for overlaps in starting configuration" << std::endl;
     ticker();
   }
@@ -44,6 +53,39 @@ namespace dynamo {
   void 
   OPOverlapTest::ticker()
   {
+    if (_kernel)
+      {
+	//Each pair is tested once, from its lower ID particle. The
+	//detailed output of any invalid states is serialised, as are
+	//the tests of interactions which cannot be validated
+	//concurrently.
+	std::mutex serialMutex;
+	(*_kernel)([&](const size_t, const Particle& p1, const std::vector<NeighbourhoodKernel::Bond>& bonds)
+		   {
+		     for (const NeighbourhoodKernel::Bond& bond : bonds)
+		       if (bond.ID > p1.getID())
+			 {
+			   const Particle& p2 = Sim->particles[bond.ID];
+			   const shared_ptr<Interaction>& interaction = Sim->getInteraction(p1, p2);
+			   bool invalid;
+			   if (interaction->parallelValidation())
+			     invalid = interaction->validateState(p1, p2, false);
+			   else
+			     {
+			       std::lock_guard<std::mutex> lock(serialMutex);
+			       invalid = interaction->validateState(p1, p2, false);
+			     }
+
+			   if (invalid)
+			     {
+			       std::lock_guard<std::mutex> lock(serialMutex);
+			       interaction->validateState(p1, p2, true);
+			     }
+			 }
+		   });
+	return;
+      }
+
     for (std::vector<Particle>::const_iterator iPtr = Sim->particles.begin();
 	 iPtr != Sim->particles.end(); ++iPtr)
       for (std::vector<Particle>::const_iterator jPtr = iPtr + 1;
@@ -18,8 +18,19 @@
 #pragma once
 
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
+#include <dynamo/outputplugins/tickerproperty/neighbourhood.hpp>
+#include <memory>
 
 namespace dynamo {
+  /*! \brief Tests every pair of particles for an invalid state
+      (e.g., an overlap) at the start and end of the simulation, and
+      at every tick.
+
+    If a neighbour list covers the longest interaction, only the
+    pairs within each particle's neighbourhood are tested, in
+    parallel on the thread pool of the Simulation. Otherwise all
+    pairs are tested.
+  */
   class OPOverlapTest: public OPTicker
   {
   public:
@@ -34,5 +45,6 @@ namespace dynamo {
     virtual void output(magnet::xml::XmlStream&);
 
   protected:
+    std::unique_ptr<NeighbourhoodKernel> _kernel;
   };
 }
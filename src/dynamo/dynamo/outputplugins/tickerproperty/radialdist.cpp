@@ -20,6 +20,7 @@
 #include <dynamo/include.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
+#include <magnet/thread/threadpool.hpp>
 
 namespace dynamo {
   OPRadialDistribution::OPRadialDistribution(const dynamo::Simulation* tmp, 
@@ -108,17 +109,39 @@ namespace dynamo {
       }
     
     ++sampleCount;
-  
-    for (const shared_ptr<Species>& sp1 : Sim->species)
-      for (const shared_ptr<Species>& sp2 : Sim->species)
-	for (const size_t& p1 : *sp1->getRange())
-	  for (const size_t& p2 : *sp2->getRange())
-	    {
-	      Vector  rij = Sim->particles[p1].getPosition() - Sim->particles[p2].getPosition();
-	      Sim->BCs->applyBC(rij);
-	      const size_t i = static_cast<size_t>(rij.nrm() / binWidth + 0.5);
-	      if (i < length) ++data[sp1->getID()][sp2->getID()][i];
-	    }
+
+    const size_t N = Sim->N();
+    const size_t Nsp = Sim->species.size();
+    std::vector<size_t> speciesIDs(N);
+    for (size_t p(0); p < N; ++p)
+      speciesIDs[p] = Sim->species(Sim->particles[p])->getID();
+
+    //The pairs of each particle are binned in parallel, into a flat
+    //histogram for each chunk of particles
+    typedef std::vector<unsigned long> Histogram;
+    const Histogram counts = Sim->getThreadPool().parallel_reduce
+      (0, N, Histogram(Nsp * Nsp * length, 0),
+       [&](const size_t p1, Histogram& hist) {
+	const Vector pos1 = Sim->particles[p1].getPosition();
+	const size_t offset = speciesIDs[p1] * Nsp;
+	for (size_t p2(0); p2 < N; ++p2)
+	  {
+	    Vector  rij = pos1 - Sim->particles[p2].getPosition();
+	    Sim->BCs->applyBC(rij);
+	    const size_t i = static_cast<size_t>(rij.nrm() / binWidth + 0.5);
+	    if (i < length) ++hist[(offset + speciesIDs[p2]) * length + i];
+	  }
+      },
+       [](Histogram a, const Histogram& b) {
+	for (size_t i(0); i < a.size(); ++i)
+	  a[i] += b[i];
+	return a;
+      });
+
+    for (size_t sp1(0); sp1 < Nsp; ++sp1)
+      for (size_t sp2(0); sp2 < Nsp; ++sp2)
+	for (size_t i(0); i < length; ++i)
+	  data[sp1][sp2][i] += counts[(sp1 * Nsp + sp2) * length + i];
   }
 
   std::vector<std::pair<double, double> > 
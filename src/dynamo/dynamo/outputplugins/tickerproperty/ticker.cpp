@@ -23,7 +23,10 @@
 namespace dynamo {
   OPTicker::OPTicker(const dynamo::Simulation* t1,const char *t2):
     OutputPlugin(t1,t2)
-  {}
+  {
+    //Tickers are only updated by the SysTicker
+    _subscription.clear();
+  }
 
   double 
   OPTicker::getTickerTime() const
@@ -24,13 +24,19 @@
 #include <magnet/xmlreader.hpp>
 
 namespace dynamo {
+  namespace {
+    struct DotProduct
+    {
+      double operator()(const Vector& v1, const Vector& v2) const
+      { return v1 | v2; }
+    };
+  }
+
   OPVACF::OPVACF(const dynamo::Simulation* tmp, 
 				   const magnet::xml::Node& XML):
     OPTicker(tmp,"VACF"),
     length(50),
-    currCorrLength(0),
-    ticksTaken(0),
-    notReady(true)
+    scaling(2)
   {
     operator<<(XML);
   }
@@ -40,49 +46,42 @@ namespace dynamo {
   {
     if (XML.hasAttribute("Length"))
       length = XML.getAttribute("Length").as<size_t>();
+
+    if (XML.hasAttribute("Scaling"))
+      scaling = XML.getAttribute("Scaling").as<size_t>();
   }
 
   void 
   OPVACF::initialise()
   {
-    dout << "The length of the VACF correlator is " << length << std::endl;
+    dout << "The length of the VACF correlator is " << length 
+	 << ", with a scaling of " << scaling << std::endl;
 
-    velHistory.resize(Sim->N(), boost::circular_buffer<Vector>(length));
+    _particleCorrelator = magnet::math::MultiTauCorrelator<Vector>(length, scaling);
+    std::vector<size_t> groups(Sim->N());
+    for (const Particle& part : Sim->particles)
+      groups[part.getID()] = Sim->species(part)->getID();
+    _particleCorrelator.resize(groups);
 
-    currCorrLength=1;
+    _moleculeCorrelator = magnet::math::MultiTauCorrelator<Vector>(length, scaling);
+    groups.clear();
+    for (const shared_ptr<Topology>& topo : Sim->topology)
+      groups.resize(groups.size() + topo->getMolecules().size(), topo->getID());
+    _moleculeCorrelator.resize(groups);
 
-    for (const Particle& part : Sim->particles)
-      velHistory[part.getID()].push_front(part.getPosition());
-    
-    speciesData.resize(Sim->species.size(), std::vector<double>(length, 0.0));
-    structData.resize(Sim->topology.size(), std::vector<double>(length, 0.0));
+    ticker();
   }
 
   void 
   OPVACF::ticker()
   {
+    _values.resize(Sim->N());
     for (const Particle& part : Sim->particles)
-      velHistory[part.getID()].push_front(part.getVelocity());
-  
-    if (notReady)
-      {
-	if (++currCorrLength != length) return;
-	notReady = false;
-      }
-    
-    accPass();
-  }
+      _values[part.getID()] = part.getVelocity();
 
-  void
-  OPVACF::accPass()
-  {
-    ++ticksTaken;
-  
-    for (const shared_ptr<Species>& sp : Sim->species)
-      for (const size_t& ID : *sp->getRange())
-      for (size_t step(0); step < length; ++step)
-	speciesData[sp->getID()][step] += velHistory[ID][step] | velHistory[ID][0];
-  
+    _particleCorrelator.push(_values, DotProduct());
+
+    _values.clear();
     for (const shared_ptr<Topology>& topo : Sim->topology)
       for (const shared_ptr<IDRange>& range : topo->getMolecules())
 	{
@@ -91,23 +90,15 @@ namespace dynamo {
 	  
 	  for (const size_t& ID : *range)
 	    {
-	      double mass = Sim->species[Sim->particles[ID]]->getMass(ID);
-	      COMvelocity += velHistory[ID][0] * mass;
+	      const double mass = Sim->species(Sim->particles[ID])->getMass(ID);
+	      COMvelocity += Sim->particles[ID].getVelocity() * mass;
 	      molMass += mass;
 	    }
 
-	  COMvelocity /= molMass;
-	  
-	  for (size_t step(0); step < length; ++step)
-	    {
-	      Vector COMvelocity2({0,0,0});
-	      
-	      for (const size_t& ID : *range)
-		COMvelocity2 += velHistory[ID][step] * Sim->species[Sim->particles[ID]]->getMass(ID);
-	      COMvelocity2 /= molMass;
-	      structData[topo->getID()][step] += COMvelocity | COMvelocity2;
-	    }
+	  _values.push_back(COMvelocity / molMass);
 	}
+
+    _moleculeCorrelator.push(_values, DotProduct());
   }
 
   void
@@ -125,9 +116,9 @@ namespace dynamo {
 	    << sp->getName()
 	    << magnet::xml::chardata();
       
-	for (size_t step(0); step < length; ++step)
-	  XML << dt * step << " "
-	      << speciesData[sp->getID()][step] / (static_cast<double>(ticksTaken) * static_cast<double>(sp->getCount()) * Sim->units.unitVelocity() * Sim->units.unitVelocity())
+	for (const auto& data : _particleCorrelator.getCorrelator(sp->getID()))
+	  XML << dt * data.lag << " "
+	      << data.sum / (static_cast<double>(data.origins) * static_cast<double>(sp->getCount()) * Sim->units.unitVelocity() * Sim->units.unitVelocity())
 	      << "\n";
       
 	XML << magnet::xml::endtag("Species");
@@ -143,9 +134,9 @@ namespace dynamo {
 	    << topo->getName()
 	    << magnet::xml::chardata();
       
-	for (size_t step(0); step < length; ++step)
-	  XML << dt * step << " "
-	      << structData[topo->getID()][step] / (static_cast<double>(ticksTaken) * static_cast<double>(topo->getMolecules().size()) * Sim->units.unitVelocity() * Sim->units.unitVelocity())
+	for (const auto& data : _moleculeCorrelator.getCorrelator(topo->getID()))
+	  XML << dt * data.lag << " "
+	      << data.sum / (static_cast<double>(data.origins) * static_cast<double>(topo->getMolecules().size()) * Sim->units.unitVelocity() * Sim->units.unitVelocity())
 	      << "\n";
 	
 	XML << magnet::xml::endtag("Structure");
@@ -17,11 +17,17 @@
 
 #pragma once
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
-#include <boost/circular_buffer.hpp>
+#include <magnet/math/correlators.hpp>
 #include <magnet/math/vector.hpp>
 #include <vector>
 
 namespace dynamo {
+  /*! \brief Collects the velocity autocorrelation function of the
+      species and molecules (topologies) on each tick.
+
+    As with the OPMSDCorrelator, a magnet::math::MultiTauCorrelator
+    is used so that long times are reached at a fixed cost per tick.
+   */
   class OPVACF: public OPTicker
   {
   public:
@@ -37,14 +43,10 @@ namespace dynamo {
     virtual void stream(double) {}
     virtual void ticker();
 
-    void accPass();
-
-    std::vector<boost::circular_buffer<Vector> > velHistory;
-    std::vector<std::vector<double> > speciesData;
-    std::vector<std::vector<double> > structData;
+    magnet::math::MultiTauCorrelator<Vector> _particleCorrelator;
+    magnet::math::MultiTauCorrelator<Vector> _moleculeCorrelator;
+    std::vector<Vector> _values;
     size_t length;
-    size_t currCorrLength;
-    size_t ticksTaken;
-    bool notReady;
+    size_t scaling;
   };
 }
@@ -20,6 +20,7 @@
 #include <dynamo/simulation.hpp>
 #include <dynamo/dynamics/dynamics.hpp>
 #include <magnet/xmlwriter.hpp>
+#include <magnet/thread/threadpool.hpp>
 #include <fstream>
 #include <sstream>
 
@@ -27,7 +28,9 @@ namespace dynamo {
   OPVTK::OPVTK(const dynamo::Simulation* tmp, const magnet::xml::Node& XML):
     OPTicker(tmp,"VTK"),
     imageCount(0),
-    _fields(true)
+    _fields(true),
+    _encoding(magnet::vtk::ArrayWriter::ASCII),
+    _compress(false)
   {
     operator<<(XML);
   }
@@ -36,14 +39,40 @@ namespace dynamo {
   OPVTK::operator<<(const magnet::xml::Node& XML) {
     double minBinWidth = 1;
     if (XML.hasAttribute("MinBinWidth"))
-      minBinWidth = XML.getAttribute("MinBinWidth").as<size_t>();
+      minBinWidth = XML.getAttribute("MinBinWidth").as<double>();
     
     _binWidths = Vector{minBinWidth, minBinWidth, minBinWidth};
 
     if (XML.hasAttribute("NoFields"))
       _fields = false;
+
+    if (XML.hasAttribute("Format"))
+      _encoding = magnet::vtk::ArrayWriter::parseEncoding(XML.getAttribute("Format"));
+
+    if (XML.hasAttribute("Compress"))
+      _compress = true;
+
+    //Check the format options now, rather than at the first tick
+    const magnet::vtk::ArrayWriter formatCheck(_encoding, _compress);
+  }
+
+  void
+  OPVTK::FieldGrid::resize(const size_t size)
+  {
+    number.resize(size);
+    mass.resize(size);
+    momentum.resize(size);
+    kineticEnergy.resize(size);
   }
 
+  void
+  OPVTK::FieldGrid::clear()
+  {
+    std::fill(number.begin(), number.end(), 0);
+    std::fill(mass.begin(), mass.end(), 0.0);
+    std::fill(momentum.begin(), momentum.end(), Vector{0,0,0});
+    std::fill(kineticEnergy.begin(), kineticEnergy.end(), 0.0);
+  }
 
   void 
   OPVTK::initialise()
@@ -62,10 +91,13 @@ namespace dynamo {
 	  
 	  vecSize *= _binCounts[iDim];
 	}
-      	_numberField.resize(vecSize, 0);
-      	_massField.resize(vecSize, 0);
-	_kineticEnergyField.resize(vecSize, 0);
-	_momentumField.resize(vecSize, Vector{0,0,0});
+	_grid.resize(vecSize);
+	//Each parallel task bins its particles into a private grid. The
+	//binning is cheap next to writing the files, so only a few
+	//tasks are used to bound the memory held by these grids.
+	_taskGrids.resize(std::min(Sim->getThreadPool().getThreadCount(), _maxGrids - 1));
+	for (FieldGrid& grid : _taskGrids)
+	  grid.resize(vecSize);
 
 	dout << "Number of bins: ";
 	for (size_t iDim(0); iDim < NDIM; ++iDim)
@@ -81,119 +113,126 @@ namespace dynamo {
     ticker();
   }
 
+  void
+  OPVTK::gridFields()
+  {
+    const size_t N = Sim->particles.size();
+    const size_t tasks = _taskGrids.size() + 1;
+    const size_t blockSize = (N + tasks - 1) / tasks;
+    magnet::thread::ThreadPool& pool = Sim->getThreadPool();
+
+    pool.parallel_for(0, tasks, [&](const size_t task) {
+	  FieldGrid& grid = task ? _taskGrids[task - 1] : _grid;
+	  grid.clear();
+	  const size_t end = std::min(N, (task + 1) * blockSize);
+	  for (size_t ID(task * blockSize); ID < end; ++ID)
+	    {
+	      const Particle& p = Sim->particles[ID];
+	      Vector  position = p.getPosition(),
+		velocity = p.getVelocity();
+	      Sim->BCs->applyBC(position, velocity);
+	
+	      size_t cellID(0);
+	      size_t factor(1);
+	      bool inside(true);
+	      for (size_t iDim(0); iDim < NDIM; ++iDim)
+		{
+		  const double coord = (position[iDim] + 0.5 * Sim->primaryCellSize[iDim]) / _binWidths[iDim];
+		  //Particles outside the primary image (without periodic
+		  //boundaries) are not binned
+		  inside = inside && (coord >= 0) && (coord <= _binCounts[iDim]);
+		  cellID += factor * std::min(_binCounts[iDim] - 1, static_cast<size_t>(std::max(coord, 0.0)));
+		  factor *= _binCounts[iDim];
+		}
+	      if (!inside) continue;
+
+	      const double mass = Sim->species(p)->getMass(p.getID());
+	      ++grid.number[cellID];
+	      grid.mass[cellID] += mass;
+	      grid.momentum[cellID] += mass * velocity;
+	      grid.kineticEnergy[cellID] += mass * velocity.nrm2() / 2;
+	    }
+      }, 1);
+
+    //Sum the private grids, in parallel over blocks of cells
+    if (_taskGrids.empty()) return;
+    const size_t cells = _grid.number.size();
+    const size_t cellBlock = (cells + tasks - 1) / tasks;
+    pool.parallel_for(0, tasks, [&](const size_t task) {
+	  const size_t end = std::min(cells, (task + 1) * cellBlock);
+	  for (const FieldGrid& grid : _taskGrids)
+	    for (size_t id(task * cellBlock); id < end; ++id)
+	      {
+		_grid.number[id] += grid.number[id];
+		_grid.mass[id] += grid.mass[id];
+		_grid.momentum[id] += grid.momentum[id];
+		_grid.kineticEnergy[id] += grid.kineticEnergy[id];
+	      }
+      }, 1);
+  }
+
   void 
   OPVTK::ticker()
   {
     using namespace magnet::xml;
+    magnet::vtk::ArrayWriter writer(_encoding, _compress, &Sim->getThreadPool());
     XmlStream XML;
     
     XML << prolog()
 	<< tag("VTKFile")
-	<< attr("type") << "UnstructuredGrid"
-	<< attr("version") << "0.1"
-	<< attr("byte_order") << "LittleEndian"
-	<< tag("UnstructuredGrid")
+	<< attr("type") << "UnstructuredGrid";
+    writer.fileAttributes(XML);
+    XML << tag("UnstructuredGrid")
 	<< tag("Piece") 
 	<< attr("NumberOfPoints") << Sim->particles.size()
 	<< attr("NumberOfCells") << 0
-	<< tag("Points")
-	<< tag("DataArray")
-	<< attr("type") << "Float32"
-	<< attr("format") << "ascii"
-	<< attr("NumberOfComponents") << "3"
-	<< chardata();
-    
+	<< tag("Points");
+
+    std::vector<float> values;
+    values.reserve(NDIM * Sim->particles.size());
     for (const Particle& part: Sim->particles) {
       Vector r = part.getPosition();
       Sim->BCs->applyBC(r);
-      r = r / Sim->units.unitLength();
-      XML << r[0]  << " " << r[1] << " " << r[2] << "\n";
+      for (size_t iDim(0); iDim < NDIM; ++iDim)
+	values.push_back(r[iDim] / Sim->units.unitLength());
     }
+    writer.dataArray(XML, "", NDIM, values);
       
-    XML << endtag("DataArray")
-	<< endtag("Points")
-	<< tag("Cells") 
-
-	<< tag("DataArray")
-	<< attr("type") << "Int32" 
-	<< attr("Name") << "connectivity" 
-	<< attr("format") << "ascii" 
-	<< endtag("DataArray") 
-
-	<< tag("DataArray") 
-	<< attr("type") << "Int32" 
-	<< attr("Name") << "offsets" 
-	<< attr("format") << "ascii" 
-	<< endtag("DataArray")
-
-	<< tag("DataArray") 
-	<< attr("type") << "UInt8" 
-	<< attr("Name") << "types" 
-	<< attr("format") << "ascii" 
-	<< endtag("DataArray") 
-
-	<< endtag("Cells")
+    XML << endtag("Points")
+	<< tag("Cells");
+    writer.dataArray(XML, "connectivity", 1, std::vector<int32_t>());
+    writer.dataArray(XML, "offsets", 1, std::vector<int32_t>());
+    writer.dataArray(XML, "types", 1, std::vector<uint8_t>());
+    XML << endtag("Cells")
 	<< tag("CellData")
 	<< endtag("CellData")
 	<< tag("PointData"); 
 
     //Velocity data    
-    XML << tag("DataArray")
-	<< attr("type") << "Float32"
-	<< attr("Name") << "Velocities"
-	<< attr("NumberOfComponents") << "3"
-	<< attr("format") << "ascii"
-	<< chardata();
-    
+    values.clear();
     for (const Particle& part: Sim->particles)
-      XML << part.getVelocity()[0] / Sim->units.unitVelocity() << " "
-	  << part.getVelocity()[1] / Sim->units.unitVelocity() << " "
-	  << part.getVelocity()[2] / Sim->units.unitVelocity() << "\n";
-    
-    XML << endtag("DataArray");
+      for (size_t iDim(0); iDim < NDIM; ++iDim)
+	values.push_back(part.getVelocity()[iDim] / Sim->units.unitVelocity());
+    writer.dataArray(XML, "Velocities", NDIM, values);
     
     XML << endtag("PointData")
 	<< endtag("Piece")
-	<< endtag("UnstructuredGrid")
-	<< endtag("VTKFile");
+	<< endtag("UnstructuredGrid");
+    writer.appendedData(XML);
+    XML << endtag("VTKFile");
 
     std::ostringstream filename_oss;
     filename_oss << "particles_" << std::setw(5) << std::setfill('0') << imageCount << ".vtu";
     XML.write_file(filename_oss.str());
 
     if (_fields) {
-      std::fill(_numberField.begin(), _numberField.end(), 0);
-      std::fill(_massField.begin(), _massField.end(), 0.0);
-      std::fill(_momentumField.begin(), _momentumField.end(), Vector{0,0,0});
-      std::fill(_kineticEnergyField.begin(), _kineticEnergyField.end(), 0.0);
-
-      for (const Particle& p : Sim->particles) {
-	Vector  position = p.getPosition(),
-	  velocity = p.getVelocity();
-	Sim->BCs->applyBC(position, velocity);
-	
-	size_t cellID(0);
-	size_t factor(1);
-	for (size_t iDim(0); iDim < NDIM; ++iDim)
-	  {
-	    cellID += factor * static_cast<size_t>((position[iDim] + 0.5 * Sim->primaryCellSize[iDim]) / _binWidths[iDim]);
-	    factor *= _binCounts[iDim];
-	  }
-
-	const double mass = Sim->species(p)->getMass(p.getID());
-	++_numberField[cellID];
-	_massField[cellID] += mass;
-	_momentumField[cellID] += mass * velocity;
-	_kineticEnergyField[cellID] += mass * velocity.nrm2() / 2;
-      }
+      gridFields();
       
       XmlStream XML;
       XML << magnet::xml::tag("VTKFile")
-	  << magnet::xml::attr("type") << "ImageData"
-	  << magnet::xml::attr("version") << "0.1"
-	  << magnet::xml::attr("byte_order") << "LittleEndian"
-	  << magnet::xml::attr("compressor") << "vtkZLibDataCompressor"
-	  << magnet::xml::tag("ImageData")
+	  << magnet::xml::attr("type") << "ImageData";
+      writer.fileAttributes(XML);
+      XML << magnet::xml::tag("ImageData")
 	  << magnet::xml::attr("WholeExtent");
   
       for (size_t iDim(0); iDim < NDIM; ++iDim)
@@ -223,68 +262,40 @@ namespace dynamo {
       
       XML << magnet::xml::tag("PointData");
 
-      ////////////Mass field
-      XML << magnet::xml::tag("DataArray")
-	  << magnet::xml::attr("type") << "Float32"
-	  << magnet::xml::attr("Name") << "Number density"
-	  << magnet::xml::attr("NumberOfComponents") << NDIM
-	  << magnet::xml::attr("format") << "ascii"
-	  << magnet::xml::chardata();
-
-      for (size_t id(0); id < _numberField.size(); ++id)
-	for (size_t iDim(0); iDim < NDIM; ++iDim)
-	  XML << _numberField[id] * Sim->units.unitVolume() / cellVol << " ";
+      const size_t cells = _grid.number.size();
 
-      XML << "\n" << magnet::xml::endtag("DataArray");
+      ////////////Number field
+      values.resize(cells);
+      for (size_t id(0); id < cells; ++id)
+	values[id] = _grid.number[id] * Sim->units.unitVolume() / cellVol;
+      writer.dataArray(XML, "Number density", 1, values);
 
       ////////////Mass field
-      XML << magnet::xml::tag("DataArray")
-	  << magnet::xml::attr("type") << "Float32"
-	  << magnet::xml::attr("Name") << "Mass density"
-	  << magnet::xml::attr("NumberOfComponents") << NDIM   
-	  << magnet::xml::attr("format") << "ascii"
-	  << magnet::xml::chardata();
-
-      for (size_t id(0); id < _massField.size(); ++id)
-	for (size_t iDim(0); iDim < NDIM; ++iDim)
-	  XML << _massField[id] * Sim->units.unitVolume() / (cellVol * Sim->units.unitMass()) << " ";
-
-      XML << "\n" << magnet::xml::endtag("DataArray");
+      for (size_t id(0); id < cells; ++id)
+	values[id] = _grid.mass[id] * Sim->units.unitVolume() / (cellVol * Sim->units.unitMass());
+      writer.dataArray(XML, "Mass density", 1, values);
 
       ////////////Momentum field
-      XML << magnet::xml::tag("DataArray")
-	  << magnet::xml::attr("type") << "Float32"
-	  << magnet::xml::attr("Name") << "Momentum density"
-	  << magnet::xml::attr("NumberOfComponents") << NDIM   
-	  << magnet::xml::attr("format") << "ascii"
-	  << magnet::xml::chardata();
-
-      for (size_t id(0); id < _momentumField.size(); ++id)
+      values.resize(NDIM * cells);
+      for (size_t id(0); id < cells; ++id)
 	for (size_t iDim(0); iDim < NDIM; ++iDim)
-	  XML << _momentumField[id][iDim]  * Sim->units.unitVolume() / (cellVol * Sim->units.unitMomentum()) << " ";
-
-      XML << "\n" << magnet::xml::endtag("DataArray");
-  
+	  values[NDIM * id + iDim] = _grid.momentum[id][iDim]  * Sim->units.unitVolume() / (cellVol * Sim->units.unitMomentum());
+      writer.dataArray(XML, "Momentum density", NDIM, values);
 
       ////////////Energy
-      XML << magnet::xml::tag("DataArray")
-	  << magnet::xml::attr("type") << "Float32"
-	  << magnet::xml::attr("Name") << "Temperature"
-	  << magnet::xml::attr("format") << "ascii"
-	  << magnet::xml::chardata();
-
-      for (size_t id(0); id < _kineticEnergyField.size(); ++id)
-	XML << 2 * _kineticEnergyField[id] / (NDIM * (_numberField[id] + (_numberField[id] == 1)) * Sim->units.unitEnergy()) << " ";
-
-      XML << "\n" << magnet::xml::endtag("DataArray");
+      values.resize(cells);
+      for (size_t id(0); id < cells; ++id)
+	values[id] = 2 * _grid.kineticEnergy[id] / (NDIM * (_grid.number[id] + (_grid.number[id] == 1)) * Sim->units.unitEnergy());
+      writer.dataArray(XML, "Temperature", 1, values);
 
       ////////////Postamble
       XML << magnet::xml::endtag("PointData")
 	  << magnet::xml::tag("CellData")
 	  << magnet::xml::endtag("CellData")
 	  << magnet::xml::endtag("Piece")
-	  << magnet::xml::endtag("ImageData")
-	  << magnet::xml::endtag("VTKFile");
+	  << magnet::xml::endtag("ImageData");
+      writer.appendedData(XML);
+      XML << magnet::xml::endtag("VTKFile");
 
       std::ostringstream filename_oss;
       filename_oss << "fields_" << std::setw(5) << std::setfill('0') << imageCount << ".vti";
@@ -18,9 +18,20 @@
 #pragma once
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
 #include <magnet/math/vector.hpp>
+#include <magnet/vtk.hpp>
 #include <vector>
 
 namespace dynamo {
+  /*! \brief Writes VTK files of the particles and of their coarse
+      grained number, mass, momentum and temperature fields.
+
+    Every tick, the particle positions and velocities are written to
+    particles_XXXXX.vtu and the fields to fields_XXXXX.vti. The Format
+    attribute selects ascii (the default), base64 or binary data, and
+    the binary formats may be compressed with zlib using the Compress
+    attribute. The fields are gridded, and the data compressed, in
+    parallel on the thread pool of the Simulation.
+  */
   class OPVTK: public OPTicker
   {
   public:
@@ -37,15 +48,32 @@ namespace dynamo {
     virtual void output(magnet::xml::XmlStream&);
   
   protected:
+    //! \brief The fields summed over each cell of the grid.
+    struct FieldGrid
+    {
+      std::vector<size_t> number;
+      std::vector<double> mass;
+      std::vector<Vector> momentum;
+      std::vector<double> kineticEnergy;
+
+      void resize(size_t);
+      void clear();
+    };
+
+    void gridFields();
+
     Vector  _binWidths;
     std::array<size_t, 3>  _binCounts;
-    std::vector<size_t> _numberField;
-    std::vector<double> _massField;
-    std::vector<Vector> _momentumField;
-    std::vector<double> _kineticEnergyField;
+    FieldGrid _grid;
+    //! \brief The grids of the parallel tasks after the first.
+    std::vector<FieldGrid> _taskGrids;
+    //! \brief The most grids (including _grid) binned into in
+    //! parallel, as each one is as large as the field grid.
+    static const size_t _maxGrids = 4;
     
     size_t imageCount;
     bool _fields;
-    
+    magnet::vtk::ArrayWriter::Encoding _encoding;
+    bool _compress;
   };
 }
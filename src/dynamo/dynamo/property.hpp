@@ -41,15 +41,32 @@ namespace dynamo {
   public:
     typedef magnet::units::Units Units;
 
-    inline Property(Units units): _units(units) {}
+    inline Property(Units units): _units(units), _storage(nullptr), _stride(0) {}
+
+    //! Derived classes which call setStorage() must re-point it in their copy constructors
+    Property(const Property&) = default;
+    Property& operator=(const Property&) = delete;
 
     //! Fetch the value of this property for a particle with a certain ID
     inline virtual const double getProperty(size_t ID) const 
     { M_throw() << "Unimplemented"; }
 
-    //! Fetch the value of this property for a particle pairing
+    /*! \brief Fetch the value of this property for a particle pairing
+      
+      This is called several times for every pair event, so
+      properties which store their values in memory (see \ref
+      setStorage()) are read directly here without any virtual
+      calls. Other properties fall back to the virtual getProperty().
+     */
     inline const double getProperty(size_t ID1, size_t ID2) const 
-    { return (getProperty(ID1) + getProperty(ID2)) / 2; }
+    { 
+#ifndef DYNAMO_DEBUG
+      //Debug builds take the virtual path for its bounds checks
+      if (_storage)
+	return (_storage[ID1 * _stride] + _storage[ID2 * _stride]) / 2;
+#endif
+      return (getProperty(ID1) + getProperty(ID2)) / 2; 
+    }
 
     //! Fetch the maximum value of this property
     inline virtual const double getMaxValue() const
@@ -93,8 +110,23 @@ namespace dynamo {
     virtual void outputXML(magnet::xml::XmlStream& XML) const 
     { M_throw() << "Unimplemented"; }
 
+    /*! \brief Allow the pair lookups to read the values of this
+      property directly.
+
+      The value of particle ID must be at storage[ID * stride], so a
+      single value for all particles has a stride of zero. The
+      storage must remain valid (and be updated if it moves) for the
+      lifetime of the Property.
+     */
+    void setStorage(const double* storage, size_t stride)
+    { _storage = storage; _stride = stride; }
+
     //! The Units of the property.
     magnet::units::Units _units;
+
+  private:
+    const double* _storage;
+    size_t _stride;
   };
 
   /*! \brief A class where the name is the value of the property.
@@ -108,7 +140,12 @@ namespace dynamo {
   {
   public:
     inline NumericProperty(double val, const Property::Units& units):
-      Property(units), _val(val) {}
+      Property(units), _val(val) 
+    { setStorage(&_val, 0); }
+
+    inline NumericProperty(const NumericProperty& other):
+      Property(other), _val(other._val)
+    { setStorage(&_val, 0); }
   
     //! Always returns a single value.
     inline virtual const double getProperty(size_t ID) const { return _val; }
@@ -155,7 +192,12 @@ namespace dynamo {
 			    std::string name,
 			    double initalval):
       Property(units), _name(name),
-      _values(N, initalval) {}
+      _values(N, initalval) 
+    { setStorage(_values.data(), 1); }
+
+    inline ParticleProperty(const ParticleProperty& other):
+      Property(other), _name(other._name), _values(other._values)
+    { setStorage(_values.data(), 1); }
   
     inline ParticleProperty(const magnet::xml::Node& node):
       Property(Property::Units(node.getAttribute("Units").getValue())),
@@ -166,6 +208,8 @@ namespace dynamo {
 	     .getNode("ParticleData").findNode("Pt");
 	   pNode.valid(); ++pNode)
 	_values.push_back(pNode.getAttribute(_name).as<double>());
+
+      setStorage(_values.data(), 1);
     }
   
     inline virtual const double getProperty(size_t ID) const 
@@ -21,10 +21,11 @@
 #include <magnet/exception.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
+#include <magnet/memory/pool.hpp>
 #include <vector>
 
 namespace dynamo {
-  class IDRangeList: public IDRange
+  class IDRangeList: public IDRange, public magnet::memory::PoolAllocated
   {
   public:
     IDRangeList(const magnet::xml::Node& XML) 
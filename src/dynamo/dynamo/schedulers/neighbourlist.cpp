@@ -72,6 +72,20 @@ namespace dynamo {
   void
   SNeighbourList::initialise()
   {    
+    connectNBlist();
+    Scheduler::initialise();
+  }
+
+  void
+  SNeighbourList::loadCheckpoint(CheckpointReader& in)
+  {
+    connectNBlist();
+    Scheduler::loadCheckpoint(in);
+  }
+
+  void
+  SNeighbourList::connectNBlist()
+  {
     shared_ptr<GNeighbourList> nblist = std::dynamic_pointer_cast<GNeighbourList>(Sim->globals[NBListID]);
 
     if (!nblist)
@@ -85,7 +99,6 @@ namespace dynamo {
 
     nblist->_sigNewNeighbour.connect<Scheduler, &Scheduler::addInteractionEvent>(this);
     nblist->_sigReInitialise.connect<SNeighbourList, &SNeighbourList::initialise>(this);
-    Scheduler::initialise();
   }
 
   void 
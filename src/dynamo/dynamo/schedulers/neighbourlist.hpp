@@ -28,6 +28,7 @@ namespace dynamo {
 
     virtual void initialise();
     virtual void initialiseNBlist();
+    virtual void loadCheckpoint(CheckpointReader&);
 
     virtual double getNeighbourhoodDistance() const;
     virtual std::unique_ptr<IDRange> getParticleNeighbours(const Particle&) const;
@@ -36,6 +37,9 @@ namespace dynamo {
 
   protected:
     virtual void outputXML(magnet::xml::XmlStream&) const;
+
+    //! \brief Check the neighbour list and register for its signals.
+    void connectNBlist();
   
     size_t NBListID;
   };
@@ -26,6 +26,7 @@
 #include <dynamo/simulation.hpp>
 #include <dynamo/units/units.hpp>
 #include <dynamo/NparticleEventData.hpp>
+#include <dynamo/checkpoint.hpp>
 #ifdef DYNAMO_DEBUG
 #include <dynamo/globals/neighbourList.hpp>
 #include <dynamo/NparticleEventData.hpp>
@@ -98,6 +99,92 @@ namespace dynamo {
   }
 
 
+  void
+  Scheduler::saveCheckpoint(CheckpointWriter& out) const
+  {
+    out.tag("Scheduler");
+    out.write(uint64_t(_interactionRejectionCounter));
+    out.write(uint64_t(_localRejectionCounter));
+    sorter->saveCheckpoint(out);
+  }
+
+  void
+  Scheduler::loadCheckpoint(CheckpointReader& in)
+  {
+    in.tag("Scheduler");
+    _interactionRejectionCounter = in.read<uint64_t>();
+    _localRejectionCounter = in.read<uint64_t>();
+
+    sorter->clear();
+    sorter->init(Sim->N() + 1);
+    sorter->loadCheckpoint(in);
+    rebuildSystemEvents();
+  }
+
+  size_t
+  Scheduler::validateEvents(const double tolerance)
+  {
+    //The earliest queued event involving each particle
+    std::vector<double> queued(Sim->N(), std::numeric_limits<double>::infinity());
+    std::vector<Event> events;
+    sorter->getEvents(events);
+    for (const Event& event : events)
+      {
+	if (event._particle1ID < Sim->N())
+	  queued[event._particle1ID] = std::min(queued[event._particle1ID], event._dt);
+
+	if ((event._source == INTERACTION) && (event._particle2ID < Sim->N()))
+	  queued[event._particle2ID] = std::min(queued[event._particle2ID], event._dt);
+      }
+
+    size_t errors = 0;
+    for (Particle& part : Sim->particles)
+      {
+	Sim->dynamics->updateParticle(part);
+	//The earliest event which the queue would miss
+	Event missed;
+
+	for (const shared_ptr<Global>& glob : Sim->globals)
+	  if (glob->isInteraction(part))
+	    {
+	      const Event event = glob->getEvent(part);
+	      if (event._dt < queued[part.getID()] - tolerance)
+		missed = std::min(missed, event);
+	    }
+
+	std::unique_ptr<IDRange> ids(getParticleLocals(part));
+	for (const size_t id : *ids)
+	  if (Sim->locals[id]->isInteraction(part))
+	    {
+	      const Event event = Sim->locals[id]->getEvent(part);
+	      if (event._dt < queued[part.getID()] - tolerance)
+		missed = std::min(missed, event);
+	    }
+
+	ids = getParticleNeighbours(part);
+	for (const size_t id : *ids)
+	  if (id != part.getID())
+	    {
+	      Sim->dynamics->updateParticle(Sim->particles[id]);
+	      //Pair events are also recalculated when the other particle is processed
+	      const Event event = Sim->getEvent(part, Sim->particles[id]);
+	      if (event._dt < std::min(queued[part.getID()], queued[id]) - tolerance)
+		missed = std::min(missed, event);
+	    }
+
+	if (missed._source != NOSOURCE)
+	  {
+	    if (errors < 10)
+	      derr << "Particle " << part.getID() << " has an event at dt = " << missed._dt / Sim->units.unitTime()
+		   << " which is not in the queue (its next queued event is at dt = "
+		   << queued[part.getID()] / Sim->units.unitTime() << ")\n" << missed << std::endl;
+	    ++errors;
+	  }
+      }
+
+    return errors;
+  }
+
   void 
   Scheduler::addEvents(Particle& part)
   {  
@@ -114,10 +201,34 @@ namespace dynamo {
     for (const size_t id2 : *ids)
       addLocalEvent(part, id2);
 
-    //Now add the interaction events
+    //Now add the interaction events. The neighbours are brought up
+    //to date, then handed to their interactions in runs which share
+    //an interaction, so that their events may be predicted together
+    //(see Interaction::getEvents). The events are pushed in the
+    //order of the neighbours, as addInteractionEvent would.
     ids = getParticleNeighbours(part);
+    _neighbours.clear();
     for (const size_t id2 : *ids)
-      addInteractionEvent(part, id2);
+      if (id2 != part.getID())
+	{
+	  Particle& part2 = Sim->particles[id2];
+	  Sim->dynamics->updateParticle(part2);
+	  _neighbours.push_back(&part2);
+	}
+
+    _neighbourEvents.resize(_neighbours.size());
+    for (size_t start(0); start < _neighbours.size();)
+      {
+	const shared_ptr<Interaction>& interaction = Sim->getInteraction(part, *_neighbours[start]);
+	size_t end = start + 1;
+	while ((end < _neighbours.size()) && (Sim->getInteraction(part, *_neighbours[end]) == interaction))
+	  ++end;
+	interaction->getEvents(part, &_neighbours[start], &_neighbourEvents[start], end - start);
+	start = end;
+      }
+
+    for (const Event& event : _neighbourEvents)
+      sorter->push(event);
   }
 
   shared_ptr<Scheduler>
@@ -321,8 +432,7 @@ namespace dynamo {
 	  
 	  Sim->_sigParticleUpdate(eventdata);
 	  Sim->ptrScheduler->fullUpdate(p1, p2);
-	  for (shared_ptr<OutputPlugin> & Ptr : Sim->outputPlugins)
-	    Ptr->eventUpdate(Event, eventdata);
+	  Sim->eventUpdate(Event, eventdata);
 	  break;
 	}
       case GLOBAL:
@@ -389,8 +499,7 @@ namespace dynamo {
 	  const ParticleEventData data = Sim->locals[localID]->runEvent(part, iEvent);
 	  Sim->_sigParticleUpdate(data);	  
 	  Sim->ptrScheduler->fullUpdate(part);
-	  for (shared_ptr<OutputPlugin> & Ptr : Sim->outputPlugins)
-	    Ptr->eventUpdate(iEvent, data);
+	  Sim->eventUpdate(iEvent, data);
 	  break;
 	}
       case SYSTEM:
@@ -420,8 +529,7 @@ namespace dynamo {
 	    for (const auto& d2 : data.L2partChanges)
 	      this->fullUpdate(Sim->particles[d2.particle1_.getParticleID()], Sim->particles[d2.particle2_.getParticleID()]);
 	    
-	    for (shared_ptr<OutputPlugin>& Ptr : Sim->outputPlugins)
-	      Ptr->eventUpdate(next_event, data);
+	    Sim->eventUpdate(next_event, data);
 	  }
 
 	  const size_t systemParticleID = Sim->N();
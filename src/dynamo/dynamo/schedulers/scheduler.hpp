@@ -29,6 +29,8 @@ namespace magnet { namespace xml { class Node; } }
 namespace dynamo {
   class Particle;
   class Event;
+  class CheckpointWriter;
+  class CheckpointReader;
   
   class Scheduler: public dynamo::SimBase
   {
@@ -41,6 +43,33 @@ namespace dynamo {
     virtual void initialiseNBlist() = 0;
 
     void rebuildList();
+
+    /*! \brief Write the event queue to a checkpoint.
+     */
+    void saveCheckpoint(CheckpointWriter&) const;
+
+    /*! \brief Restore the event queue from a checkpoint, in place of
+        a call to initialise().
+
+      The System events are rebuilt from the (restored) Systems, as a
+      resumed simulation may have a different set of Systems (e.g.,
+      a new snapshot or halting time). Derived schedulers must also
+      make any connections which are otherwise made in initialise().
+     */
+    virtual void loadCheckpoint(CheckpointReader&);
+
+    /*! \brief Check that the queued events are consistent with the
+        current configuration.
+
+      The events of every particle are recalculated and compared
+      against the queue. A particle is inconsistent if one of its
+      events occurs more than \p tolerance before the queue next
+      processes that particle (or, for pair events, either
+      particle). This brings all particles up to date.
+
+      \return The number of inconsistent particles.
+     */
+    size_t validateEvents(const double tolerance);
   
     /*! \brief Retest for events for a single particle.
      */
@@ -111,6 +140,11 @@ namespace dynamo {
     size_t _interactionRejectionCounter;
     size_t _localRejectionCounter;
 
+    //! \brief Scratch space for the neighbours of a particle in addEvents.
+    std::vector<const Particle*> _neighbours;
+    //! \brief Scratch space for the neighbour events in addEvents.
+    std::vector<Event> _neighbourEvents;
+
     virtual void outputXML(magnet::xml::XmlStream&) const = 0;
   };
 }
@@ -18,6 +18,7 @@
 #pragma once
 #include <dynamo/eventtypes.hpp>
 #include <dynamo/schedulers/sorters/FEL.hpp>
+#include <dynamo/checkpoint.hpp>
 #include <magnet/exception.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <vector>
@@ -128,9 +129,77 @@ namespace dynamo {
       _pecTime *= factor;
     }
 
+    virtual void saveCheckpoint(CheckpointWriter& out) const
+    {
+      out.tag("FEL");
+      out.write(PEL::name());
+      out.write(uint64_t(_N));
+      out.write(_pecTime);
+      out.write(uint64_t(_nUpdate));
+      out.write(_eventCount);
+      for (const PEL& pel : _Min)
+	out.write(pel.getEvents());
+
+      //The layout of the tree decides the order of simultaneous
+      //events, so it is stored rather than rebuilt
+      out.write(_CBT);
+      out.write(_Leaf);
+      out.write(uint64_t(_NP));
+      out.write(uint64_t(_activeID));
+      saveQueue(out);
+    }
+
+    virtual void loadCheckpoint(CheckpointReader& in)
+    {
+      in.tag("FEL");
+      const std::string pelName = in.read<std::string>();
+      if (pelName != PEL::name())
+	M_throw() << "The checkpoint " << in.getName() << " was written with a " << pelName
+		  << " particle event list, but this sorter uses " << PEL::name();
+
+      if (in.read<uint64_t>() != _N)
+	M_throw() << "The event queue of the checkpoint " << in.getName() << " is for a different number of particles";
+
+      in.read(_pecTime);
+      _nUpdate = in.read<uint64_t>();
+      in.readFixed(_eventCount);
+
+      std::vector<Event> events;
+      for (PEL& pel : _Min)
+	{
+	  in.read(events);
+	  pel.setEvents(events);
+	}
+
+      in.readFixed(_CBT);
+      in.readFixed(_Leaf);
+      _NP = in.read<uint64_t>();
+      _activeID = in.read<uint64_t>();
+      loadQueue(in);
+    }
+
+    virtual void getEvents(std::vector<Event>& events)
+    {
+      flushChanges();
+      for (const PEL& pel : _Min)
+	for (Event event : pel.getEvents())
+	  //Skip the events awaiting lazy deletion
+	  if ((event._source != INTERACTION) || (event._particle2eventcounter == _eventCount[event._particle2ID]))
+	    {
+	      event._dt -= _pecTime;
+	      events.push_back(event);
+	    }
+    }
+
     protected:
     size_t _activeID;
 
+    //! \brief Write the state of a derived queue to a checkpoint.
+    virtual void saveQueue(CheckpointWriter&) const {}
+
+    //! \brief Restore the state written by saveQueue().
+    virtual void loadQueue(CheckpointReader&) {}
+
     virtual void flushChanges(const size_t ID = std::numeric_limits<size_t>::max()) {
       if ((_activeID != ID) && (_activeID !=std::numeric_limits<size_t>::max()))
 	{
@@ -18,10 +18,14 @@
 #pragma once
 #include <dynamo/base.hpp>
 #include <dynamo/eventtypes.hpp>
+#include <vector>
 
 namespace magnet { namespace xml { class Node; class XmlStream; } }
 
 namespace dynamo {
+  class CheckpointWriter;
+  class CheckpointReader;
+
   /*! \brief Future Event Lists (FEL) sort the Particle Event Lists
       (PEL) to determine the next event to occur.
 
@@ -95,6 +99,30 @@ namespace dynamo {
     virtual void stream(const double) = 0;
     
     virtual Event top() = 0;
+
+    /*! \brief Write the queued events to a checkpoint.
+
+      The events are stored with the internal layout of the FEL, so
+      that loadCheckpoint() reproduces the queue exactly (including
+      any invalidated events still awaiting lazy deletion). This
+      allows a simulation to resume without recalculating its events.
+     */
+    virtual void saveCheckpoint(CheckpointWriter&) const = 0;
+
+    /*! \brief Restore the queue from a checkpoint.
+
+      The FEL must already be initialised with init() for the same
+      number of particles.
+     */
+    virtual void loadCheckpoint(CheckpointReader&) = 0;
+
+    /*! \brief Collect all valid events in the queue, with their times
+        relative to the current time.
+
+      This is only used to check the queue (e.g., after a checkpoint
+      is loaded), and is not efficient.
+     */
+    virtual void getEvents(std::vector<Event>&) = 0;
  
     static shared_ptr<FEL> getClass(const magnet::xml::Node&);
     friend ::magnet::xml::XmlStream& operator<<(::magnet::xml::XmlStream&, const FEL&);
@@ -19,6 +19,7 @@
 #include <dynamo/eventtypes.hpp>
 #include <magnet/containers/MinMaxHeap.hpp>
 #include <string>
+#include <vector>
 
 namespace dynamo {
   /*! A MinMax heap used for Particle Event Lists
@@ -96,6 +97,22 @@ namespace dynamo {
       _store.swap(rhs._store);
     }
 
+    //! \brief The stored events, in their heap order.
+    inline std::vector<Event> getEvents() const {
+      return std::vector<Event>(_store.begin(), _store.end());
+    }
+
+    /*! \brief Restore the events returned by getEvents().
+
+      As the events are already in heap order, inserting them in turn
+      reproduces the original heap exactly.
+     */
+    inline void setEvents(const std::vector<Event>& events) {
+      clear();
+      for (const Event& event : events)
+	_store.insert(event);
+    }
+
     static inline std::string name()
     { return "MinMax" + std::to_string(Size); }
   };
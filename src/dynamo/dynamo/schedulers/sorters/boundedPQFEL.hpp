@@ -93,6 +93,47 @@ namespace dynamo {
     }
 
   private: 
+    virtual void saveQueue(CheckpointWriter& out) const
+    {
+      out.write(linearLists);
+      out.write(uint64_t(currentIndex));
+      out.write(scale);
+      out.write(uint64_t(nlists));
+      out.write(uint64_t(exceptionCount));
+      out.write(uint64_t(_optimizeCounter));
+
+      std::vector<size_t> links;
+      links.reserve(3 * Base::_Min.size());
+      for (const auto& dat : Base::_Min)
+	{
+	  links.push_back(dat.next);
+	  links.push_back(dat.previous);
+	  links.push_back(dat.qIndex);
+	}
+      out.write(links);
+    }
+
+    virtual void loadQueue(CheckpointReader& in)
+    {
+      in.read(linearLists);
+      currentIndex = in.read<uint64_t>();
+      in.read(scale);
+      nlists = in.read<uint64_t>();
+      exceptionCount = in.read<uint64_t>();
+      _optimizeCounter = in.read<uint64_t>();
+      if (linearLists.size() != nlists + 1)
+	M_throw() << "The checkpoint " << in.getName() << " is corrupt";
+
+      std::vector<size_t> links(3 * Base::_Min.size());
+      in.readFixed(links);
+      for (size_t i(0); i < Base::_Min.size(); ++i)
+	{
+	  Base::_Min[i].next = links[3 * i];
+	  Base::_Min[i].previous = links[3 * i + 1];
+	  Base::_Min[i].qIndex = links[3 * i + 2];
+	}
+    }
+
     virtual void flushChanges(const size_t ID = std::numeric_limits<size_t>::max()) {
       if ((Base::_activeID != ID) && (Base::_activeID !=std::numeric_limits<size_t>::max()))
 	{
@@ -78,6 +78,16 @@ namespace dynamo {
       std::swap(_store, rhs._store);
     }
 
+    //! \brief The stored events, in their heap order.
+    inline const std::vector<Event>& getEvents() const {
+      return _store;
+    }
+
+    //! \brief Restore the events returned by getEvents().
+    inline void setEvents(const std::vector<Event>& events) {
+      _store = events;
+    }
+
     static inline std::string name()
     { return "Heap"; }
   };
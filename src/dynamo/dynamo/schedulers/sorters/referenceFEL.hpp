@@ -17,6 +17,7 @@
 
 #pragma once
 #include <dynamo/schedulers/sorters/FEL.hpp>
+#include <dynamo/checkpoint.hpp>
 
 namespace dynamo {
   /*! \brief A slow, but exact FEL implementation.
@@ -59,6 +60,23 @@ namespace dynamo {
     virtual void pop() {
       _store.erase(std::min_element(_store.begin(), _store.end()));
     }
+
+    virtual void saveCheckpoint(CheckpointWriter& out) const {
+      out.tag("FEL");
+      out.write(std::string("Reference"));
+      out.write(_store);
+    }
+
+    virtual void loadCheckpoint(CheckpointReader& in) {
+      in.tag("FEL");
+      if (in.read<std::string>() != "Reference")
+	M_throw() << "The checkpoint " << in.getName() << " was not written by a reference sorter";
+      in.read(_store);
+    }
+
+    virtual void getEvents(std::vector<Event>& events) {
+      events.insert(events.end(), _store.begin(), _store.end());
+    }
   private:
     virtual void outputXML(magnet::xml::XmlStream&) const {}
   
@@ -28,15 +28,29 @@
 #include <dynamo/globals/global.hpp>
 #include <dynamo/interactions/interaction.hpp>
 #include <dynamo/outputplugins/misc.hpp>
+#include <dynamo/outputplugins/pipeline.hpp>
+#include <dynamo/NparticleEventData.hpp>
 #include <dynamo/globals/PBCSentinel.hpp>
+#include <dynamo/globals/neighbourList.hpp>
+#include <magnet/thread/threadpool.hpp>
 #include <boost/filesystem.hpp>
 #include <dynamo/BC/BC.hpp>
+#include <dynamo/checkpoint.hpp>
+#include <fstream>
 #include <iomanip>
 #include <set>
+#include <sstream>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 //! The configuration file version, a version mismatch prevents an XML file load.
 static const std::string configFileVersion("1.5.0");
 
+//! The magic string and format version at the start of a checkpoint file.
+static const std::array<char, 8> checkpointMagic{{'D', 'Y', 'N', 'C', 'H', 'K', 'P', 'T'}};
+static const uint32_t checkpointVersion = 2;
+
 namespace dynamo
 {
   Simulation::Simulation():
@@ -48,11 +62,16 @@ namespace dynamo
     nextPrintEvent(0),
     primaryCellSize({1,1,1}),
     ranGenerator(std::random_device()()),
+    randomStreamSeed(std::random_device()()),
+    asyncOutputPlugins(false),
     lastRunMFT(0.0),
     simID(0),
     stateID(0),
     replexExchangeNumber(0),
-    status(START)
+    status(START),
+    _threadPool(nullptr),
+    _validateCheckpoint(false),
+    _miscPlugin(nullptr)
   {}
 
   namespace {
@@ -69,6 +88,37 @@ namespace dynamo
 	return (*lhs) < (*rhs);
       }
     };
+
+    /*! \brief Restores the delayed states of the particles when it
+        goes out of scope.
+
+      Bringing the particles up to date (e.g., to write a
+      configuration file) changes the rounding of the rest of the
+      simulation. This is used to keep a checkpointed simulation
+      identical to a resumed one.
+     */
+    class DelayedStateGuard
+    {
+    public:
+      DelayedStateGuard(Simulation& sim):
+	_sim(sim), _particles(sim.particles)
+      {
+	CheckpointWriter out(_dynamics);
+	_sim.dynamics->saveCheckpoint(out);
+      }
+
+      ~DelayedStateGuard()
+      {
+	_sim.particles = _particles;
+	CheckpointReader in(_dynamics, "state");
+	_sim.dynamics->loadCheckpoint(in);
+      }
+
+    private:
+      Simulation& _sim;
+      const std::vector<Particle> _particles;
+      std::stringstream _dynamics;
+    };
   }
 
   void
@@ -77,6 +127,9 @@ namespace dynamo
     if (status != INITIALISED)
       M_throw() << "Cannot reinitialise an un-initialised simulation";
     status = START;
+    //Stop the worker threads before the plugins are destroyed
+    _outputPipeline.reset();
+    _eventPlugins.clear();
     outputPlugins.clear();
     dynamics->updateAllParticles();
     systemTime = 0.0;
@@ -226,7 +279,9 @@ namespace dynamo
       M_throw() << "The scheduler has not been set!";      
 
     dout << "Initialising Scheduler" << std::endl;
-    if (endEventCount) 
+    if (_checkpoint)
+      restoreCheckpoint();
+    else if (endEventCount) 
       //Only initialise the scheduler if we're simulating
       ptrScheduler->initialise();
 
@@ -240,12 +295,128 @@ namespace dynamo
     for (shared_ptr<OutputPlugin> & Ptr : outputPlugins)
       Ptr->initialise();
 
+    buildEventPluginLists();
+
     status = OUTPUTPLUGIN_INIT;
 
     _nextPrint = eventCount + eventPrintInterval;
     status = INITIALISED;
   }
 
+  void
+  Simulation::buildEventPluginLists()
+  {
+    _outputPipeline.reset();
+    _eventPlugins.clear();
+    _eventPlugins.resize((NOSOURCE + 1) * FINAL_ENUM_TO_CATCH_THE_COMMA);
+    _miscPlugin = getOutputPlugin<OPMisc>().get();
+
+    for (shared_ptr<OutputPlugin>& Ptr : outputPlugins)
+      {
+	EventPluginEntry entry;
+	entry._plugin = Ptr.get();
+	entry._channel = std::numeric_limits<size_t>::max();
+	entry._filtered = Ptr->getSubscription().isFiltered();
+	entry._records = Ptr->isRecordConsumer();
+
+	if (entry._records && asyncOutputPlugins)
+	  {
+	    if (!_outputPipeline)
+	      _outputPipeline = shared_ptr<OutputPipeline>(new OutputPipeline());
+	    entry._channel = _outputPipeline->addConsumer(Ptr.get());
+	  }
+
+	for (size_t source(0); source <= NOSOURCE; ++source)
+	  for (size_t type(0); type < FINAL_ENUM_TO_CATCH_THE_COMMA; ++type)
+	    if (Ptr->getSubscription().matches(EventSource(source), EEventType(type)))
+	      _eventPlugins[source * FINAL_ENUM_TO_CATCH_THE_COMMA + type].push_back(entry);
+      }
+
+    if (_outputPipeline)
+      dout << "Running " << _outputPipeline->size() << " output plugins on worker threads" << std::endl;
+  }
+
+  void
+  Simulation::buildEventRecords(const Event& event, const NEventData& data)
+  {
+    _eventRecords.clear();
+
+    OutputPlugin::EventRecord record;
+    record._systemTime = systemTime;
+    record._dt = event._dt;
+    record._configurationalU = _miscPlugin ? _miscPlugin->getConfigurationalU() : 0;
+    record._sourceID = event._sourceID;
+    record._particle1ID = std::numeric_limits<size_t>::max();
+    record._particle2ID = std::numeric_limits<size_t>::max();
+    record._index = 0;
+    record._source = event._source;
+    record._eventType = event._type;
+    record._type = event._type;
+
+    for (const ParticleEventData& pData : data.L1partChanges)
+      {
+	record._particle1ID = pData.getParticleID();
+	record._type = pData.getType();
+	_eventRecords.push_back(record);
+	record._dt = 0;
+	++record._index;
+      }
+
+    record._particle1ID = std::numeric_limits<size_t>::max();
+    for (const PairEventData& pData : data.L2partChanges)
+      {
+	record._particle1ID = pData.particle1_.getParticleID();
+	record._particle2ID = pData.particle2_.getParticleID();
+	record._type = pData.getType();
+	_eventRecords.push_back(record);
+	record._dt = 0;
+	++record._index;
+      }
+
+    //Events without particle changes still pass time
+    if (_eventRecords.empty())
+      _eventRecords.push_back(record);
+  }
+
+  void
+  Simulation::eventUpdate(const Event& event, const NEventData& data)
+  {
+    bool recorded = false;
+    for (const EventPluginEntry& entry : _eventPlugins[event._source * FINAL_ENUM_TO_CATCH_THE_COMMA + event._type])
+      {
+	if (entry._filtered && !entry._plugin->getSubscription().accept(event, *this))
+	  continue;
+
+	if (!entry._records)
+	  {
+	    entry._plugin->eventUpdate(event, data);
+	    continue;
+	  }
+
+	//The records are only built if a plugin needs them, and only
+	//once per event
+	if (!recorded)
+	  {
+	    buildEventRecords(event, data);
+	    recorded = true;
+	  }
+
+	if (entry._channel != std::numeric_limits<size_t>::max())
+	  for (const OutputPlugin::EventRecord& record : _eventRecords)
+	    _outputPipeline->push(entry._channel, record);
+	else
+	  for (const OutputPlugin::EventRecord& record : _eventRecords)
+	    entry._plugin->recordUpdate(record);
+      }
+  }
+
+  void
+  Simulation::flushOutputPlugins()
+  {
+    if (_outputPipeline)
+      _outputPipeline->flush();
+  }
+
   Event 
   Simulation::getEvent(const Particle& p1, const Particle& p2) const
   {
@@ -360,6 +531,9 @@ namespace dynamo
     } catch (std::exception&)
       {}
 
+    if (simNode.hasAttribute("RandomStreamSeed"))
+      randomStreamSeed = simNode.getAttribute("RandomStreamSeed").as<uint32_t>();
+
     _properties << mainNode;
 
     //Load the Primary cell's size
@@ -453,6 +627,8 @@ namespace dynamo
 	  XML << xml::attr("lastMFT") << lastRunMFT;
       }
 
+    XML << xml::attr("RandomStreamSeed") << randomStreamSeed;
+
     XML << xml::tag("Scheduler")
 	<< ptrScheduler
 	<< xml::endtag("Scheduler")
@@ -524,9 +700,179 @@ namespace dynamo
     XML.write_file(fileName);
   }
   
+  void
+  Simulation::writeCheckpoint(std::string configFile, std::string stateFile, bool applyBC)
+  {
+    if (status != INITIALISED)
+      M_throw() << "Cannot checkpoint an un-initialised simulation";
+
+    //The System events are rebuilt when a checkpoint is restored, so
+    //they are also rebuilt here for the rounding of their event times
+    //to match the resumed simulation
+    ptrScheduler->rebuildSystemEvents();
+
+    {
+      std::ofstream of(stateFile, std::ios::out | std::ios::trunc | std::ios::binary);
+      if (!of)
+	M_throw() << "Failed to open " << stateFile << " for writing";
+
+      CheckpointWriter out(of);
+      out.write(checkpointMagic);
+      out.write(checkpointVersion);
+      out.write(uint64_t(N()));
+      out.write(uint64_t(eventCount));
+      out.write(systemTime);
+      out.write(units.unitLength());
+      out.write(units.unitTime());
+
+      out.tag("Particles");
+      out.write(particles);
+      dynamics->saveCheckpoint(out);
+      BCs->saveCheckpoint(out);
+
+      out.tag("Globals");
+      out.write(uint64_t(globals.size()));
+      for (const shared_ptr<Global>& glob : globals)
+	{
+	  out.write(glob->getName());
+	  glob->saveCheckpoint(out);
+	}
+
+      //Each System is stored as a separate block, so that Systems
+      //which are missing from a resumed simulation can be skipped
+      out.tag("Systems");
+      out.write(uint64_t(systems.size()));
+      for (const shared_ptr<System>& sys : systems)
+	{
+	  std::ostringstream os;
+	  CheckpointWriter block(os);
+	  sys->saveCheckpoint(block);
+	  out.write(sys->getName());
+	  out.write(os.str());
+	}
+
+      ptrScheduler->saveCheckpoint(out);
+
+      out.tag("RNG");
+      std::ostringstream rng;
+      rng << ranGenerator;
+      out.write(rng.str());
+      out.write(randomStreamSeed);
+      out.tag("End");
+
+      if (!out.good())
+	M_throw() << "Failed while writing the checkpoint " << stateFile;
+    }
+
+    DelayedStateGuard guard(*this);
+    writeXMLfile(configFile, applyBC);
+    dout << "Checkpoint written to " << stateFile << std::endl;
+  }
+
+  void
+  Simulation::loadCheckpoint(std::string fileName, bool validate)
+  {
+    if (status != START)
+      M_throw() << "Loading a checkpoint at wrong time, status = " << status;
+
+    shared_ptr<std::ifstream> file(new std::ifstream(fileName, std::ios::in | std::ios::binary));
+    if (!*file)
+      M_throw() << "Could not open the checkpoint " << fileName;
+
+    CheckpointReader in(*file, fileName);
+    if (in.read<std::array<char, 8> >() != checkpointMagic)
+      M_throw() << fileName << " is not a DynamO checkpoint";
+
+    if (in.read<uint32_t>() != checkpointVersion)
+      M_throw() << "The checkpoint " << fileName << " was written by an incompatible version of DynamO";
+
+    const uint64_t checkpointN = in.read<uint64_t>();
+    if (checkpointN != N())
+      M_throw() << "The checkpoint " << fileName << " has " << checkpointN
+		<< " particles, but the configuration has " << N();
+
+    eventCount = in.read<uint64_t>();
+    in.read(systemTime);
+
+    const double unitLength = in.read<double>();
+    const double unitTime = in.read<double>();
+    if ((unitLength != units.unitLength()) || (unitTime != units.unitTime()))
+      M_throw() << "The checkpoint " << fileName << " was written using different simulation units";
+
+    _checkpoint = file;
+    _checkpointName = fileName;
+    _validateCheckpoint = validate;
+  }
+
+  void
+  Simulation::restoreCheckpoint()
+  {
+    dout << "Restoring the checkpoint " << _checkpointName << std::endl;
+    CheckpointReader in(*_checkpoint, _checkpointName);
+
+    in.tag("Particles");
+    in.readFixed(particles);
+    dynamics->loadCheckpoint(in);
+    BCs->loadCheckpoint(in);
+
+    in.tag("Globals");
+    if (in.read<uint64_t>() != globals.size())
+      M_throw() << "The Globals of the checkpoint " << _checkpointName << " do not match the configuration";
+    for (shared_ptr<Global>& glob : globals)
+      {
+	if (in.read<std::string>() != glob->getName())
+	  M_throw() << "The Globals of the checkpoint " << _checkpointName << " do not match the configuration";
+	glob->loadCheckpoint(in);
+      }
+
+    in.tag("Systems");
+    const uint64_t systemCount = in.read<uint64_t>();
+    for (uint64_t i(0); i < systemCount; ++i)
+      {
+	const std::string name = in.read<std::string>();
+	std::istringstream is(in.read<std::string>());
+	auto it = std::find_if(systems.begin(), systems.end(), 
+			       [&](const shared_ptr<System>& sys) { return sys->getName() == name; });
+	if (it == systems.end())
+	  {
+	    derr << "The System \"" << name << "\" of the checkpoint is not in the configuration, and was discarded" << std::endl;
+	    continue;
+	  }
+	CheckpointReader block(is, _checkpointName);
+	(*it)->loadCheckpoint(block);
+      }
+
+    ptrScheduler->loadCheckpoint(in);
+
+    in.tag("RNG");
+    std::istringstream rng(in.read<std::string>());
+    rng >> ranGenerator;
+    if (!rng)
+      M_throw() << "Failed to restore the random number generator from the checkpoint " << _checkpointName;
+    in.read(randomStreamSeed);
+    in.tag("End");
+    _checkpoint.reset();
+
+    if (_validateCheckpoint)
+      {
+	dout << "Validating the restored event queue" << std::endl;
+	size_t errors;
+	{
+	  DelayedStateGuard guard(*this);
+	  errors = ptrScheduler->validateEvents(1e-8 * units.unitTime());
+	}
+	if (errors)
+	  M_throw() << errors << " particles have events missing from the event queue of the checkpoint " << _checkpointName;
+	dout << "The restored event queue is consistent" << std::endl;
+      }
+  }
+
   void 
   Simulation::replexerSwap(Simulation& other)
   {
+    flushOutputPlugins();
+    other.flushOutputPlugins();
+
     //Get all particles up to date and zero the pecTimes
     dynamics->updateAllParticles();
     other.dynamics->updateAllParticles();
@@ -692,38 +1038,133 @@ namespace dynamo
   }
 
   size_t
-  Simulation::checkSystem()
+  Simulation::checkSystem(size_t max_reports)
   {
     dynamics->updateAllParticles();
 
     size_t errors = 0;
-    std::vector<Particle>::const_iterator iPtr1, iPtr2;
   
     for (const shared_ptr<Interaction>& interaction_ptr : interactions)
       {
 	dout << "Checking Interaction \"" << interaction_ptr->getName() << "\"" << std::endl;
-	errors += interaction_ptr->validateState();
+	errors += interaction_ptr->validateState(errors < max_reports, (errors < max_reports) ? max_reports - errors : 0);
       }
 
-    dout << "Testing all particle pairs for invalid states" << std::endl;
-    for (iPtr1 = particles.begin(); iPtr1 != particles.end(); ++iPtr1)
-      for (iPtr2 = iPtr1 + 1; iPtr2 != particles.end(); ++iPtr2)
-	errors += getInteraction(*iPtr1, *iPtr2)->validateState(*iPtr1, *iPtr2);
+    //If the scheduler has a neighbour list covering all the
+    //particles, use it to only test the pairs in each particles
+    //neighbourhood. Otherwise fall back to testing all pairs.
+    shared_ptr<GNeighbourList> nblist;
+    if (status >= INITIALISED)
+      {
+	auto it = globals.find("SchedulerNBList");
+	if (it != globals.end())
+	  nblist = std::dynamic_pointer_cast<GNeighbourList>(*it);
+
+	if (nblist)
+	  for (const Particle& part : particles)
+	    if (!nblist->isInteraction(part))
+	      {
+		nblist.reset();
+		break;
+	      }
+      }
 
-    for (const Particle& part : particles)
-      for (const shared_ptr<Local>& lcl : locals)
-	if (lcl->isInteraction(part))
-	  errors += lcl->validateState(part);
+    if (nblist)
+      dout << "Testing all particle neighbourhoods for invalid states" << std::endl;
+    else
+      dout << "Testing all particle pairs for invalid states" << std::endl;
+
+    //The particles are dealt out to the tasks in an interleaved
+    //fashion, which balances the triangular all-pairs loop. Each
+    //task has its own error counter, and the (serialised) text output
+    //is limited to max_reports in total. Interactions which cannot be
+    //validated concurrently are tested under the same lock.
+    const size_t tasks = 4 * (getThreadPool().getThreadCount() + 1);
+    std::vector<size_t> taskErrors(tasks, 0);
+    std::atomic<size_t> reports(errors);
+    std::mutex serialMutex;
+
+    getThreadPool().parallel_for(0, tasks, [&](const size_t task) {
+	  std::vector<size_t> neighbours;
+	  size_t& localErrors = taskErrors[task];
+	  for (size_t id1(task); id1 < particles.size(); id1 += tasks)
+	    {
+	      const Particle& p1 = particles[id1];
+
+	      neighbours.clear();
+	      if (nblist)
+		{
+		  nblist->getParticleNeighbours(p1, neighbours);
+		  std::sort(neighbours.begin(), neighbours.end());
+		  neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+		}
+	      else
+		for (size_t id2(id1 + 1); id2 < particles.size(); ++id2)
+		  neighbours.push_back(id2);
+
+	      for (const size_t id2 : neighbours)
+		if (id2 > id1)
+		  {
+		    const Particle& p2 = particles[id2];
+		    const shared_ptr<Interaction>& interaction = getInteraction(p1, p2);
+		    bool invalid;
+		    if (interaction->parallelValidation())
+		      invalid = interaction->validateState(p1, p2, false);
+		    else
+		      {
+			std::lock_guard<std::mutex> lock(serialMutex);
+			invalid = interaction->validateState(p1, p2, false);
+		      }
+
+		    if (invalid)
+		      {
+			++localErrors;
+			if (reports++ < max_reports)
+			  {
+			    std::lock_guard<std::mutex> lock(serialMutex);
+			    interaction->validateState(p1, p2, true);
+			  }
+		      }
+		  }
+
+	      for (const shared_ptr<Local>& lcl : locals)
+		if (lcl->isInteraction(p1) && lcl->validateState(p1, false))
+		  {
+		    ++localErrors;
+		    if (reports++ < max_reports)
+		      {
+			std::lock_guard<std::mutex> lock(serialMutex);
+			lcl->validateState(p1, true);
+		      }
+		  }
+	    }
+      }, 1);
+
+    for (const size_t& count : taskErrors)
+      errors += count;
+
+    if (errors > max_reports)
+      derr << "Over " << max_reports << " invalid states, further output was suppressed (total of " << errors << " invalid states detected)" << std::endl;
     
     return errors;
   }
 
+  magnet::thread::ThreadPool&
+  Simulation::getThreadPool() const
+  {
+    if (_threadPool) return *_threadPool;
+    static magnet::thread::ThreadPool serialPool;
+    return serialPool;
+  }
+
   void
   Simulation::outputData(std::string filename)
   {
     if (status < INITIALISED)
       M_throw() << "Cannot output data when not initialised!";
 
+    flushOutputPlugins();
+
     namespace xml = magnet::xml;
     xml::XmlStream XML;
     XML.setFormatXML(true);
@@ -801,6 +1242,7 @@ namespace dynamo
 	if ((eventCount >= _nextPrint) && !silentMode && outputPlugins.size())
 	  {
 	    //Print the screen data plugins
+	    flushOutputPlugins();
 	    for (shared_ptr<OutputPlugin> & Ptr : outputPlugins)
 	      Ptr->periodicOutput();
 	    
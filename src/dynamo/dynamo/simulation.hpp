@@ -22,14 +22,21 @@
 #include <dynamo/ensemble.hpp>
 #include <dynamo/property.hpp>
 #include <dynamo/units/units.hpp>
+#include <dynamo/outputplugins/outputplugin.hpp>
 #include <magnet/function/delegate.hpp>
+#include <magnet/math/philox.hpp>
+#include <iosfwd>
 #include <random>
 #include <vector>
 
+namespace magnet { namespace thread { class ThreadPool; } }
+
 namespace dynamo
 {  
   class Scheduler;
   class OutputPlugin;
+  class OutputPipeline;
+  class OPMisc;
   class Species;
   class BoundaryCondition;
   class Topology;
@@ -64,6 +71,9 @@ namespace dynamo
     } ESimulationStatus;
   
   typedef std::mt19937 baseRNG;
+
+  //! \brief The counter-based generator of Simulation::getRandomStream().
+  typedef magnet::math::Philox streamRNG;
   
   /*! \brief Fundamental collection of the Simulation data.
    
@@ -211,8 +221,20 @@ namespace dynamo
       overlapped state, but this error state is a minor precision
       error. Therefore, there may be around 2 errors which are just
       minor precision errors and can be discounted.
+
+      Once the Simulation is initialised, the neighbour list of the
+      scheduler is used to only test the pairs of particles in each
+      others neighbourhood. Pairs beyond the range of the neighbour
+      list (e.g., broken bonds) are then not reported.
+
+      The pair tests are run in parallel on the thread pool of the
+      Simulation (see getThreadPool()).
+
+      \param max_reports The maximum number of invalid states which
+      are described in the output. All invalid states are still
+      counted.
     */
-    size_t checkSystem();
+    size_t checkSystem(size_t max_reports = 100);
 
     void addSystemTicker();
     
@@ -278,6 +300,39 @@ namespace dynamo
     */
     void writeXMLfile(std::string filename, bool applyBC = true, bool round = false);
 
+    /*! \brief Writes the configuration file along with a checkpoint
+        of the dynamic state of the Simulation.
+
+      The configuration file alone cannot resume a simulation exactly,
+      as the event queue, neighbour lists and random number generator
+      are rebuilt (or reseeded) when it is loaded. The checkpoint
+      stores this state in a binary file, so that loading both (see
+      loadCheckpoint()) continues the simulation exactly as this
+      Simulation continues after the checkpoint is written. Unlike
+      writeXMLfile(), the particles are not left up to date by this
+      call, as that would change the rounding of the rest of the run.
+
+      \param configFile The path of the XML configuration file.
+      \param stateFile The path of the binary checkpoint file.
+      \param applyBC If the particle positions of the configuration
+      file are wrapped into the primary image.
+    */
+    void writeCheckpoint(std::string configFile, std::string stateFile, bool applyBC = true);
+
+    /*! \brief Loads a checkpoint written by writeCheckpoint().
+
+      This must be called after loadXMLfile() (with the configuration
+      file written with the checkpoint) but before initialise(). The
+      event count and system time are set immediately, the remaining
+      state is restored by initialise() in place of building the
+      event queue.
+
+      \param filename The path of the binary checkpoint file.
+      \param validate If true, the restored event queue is checked
+      against freshly calculated events for every particle.
+    */
+    void loadCheckpoint(std::string filename, bool validate = false);
+
     /*! \brief The Ensemble of the Simulation. */
     shared_ptr<Ensemble> ensemble;
 
@@ -360,11 +415,61 @@ namespace dynamo
 
     /*! \brief The random number generator of the system. */
     mutable baseRNG ranGenerator;
+
+    /*! \brief The seed of the random number streams returned by
+        getRandomStream().
+
+      This is stored in the configuration file and the checkpoint,
+      but dynarun reseeds it for every run (see Engine::setupSim()),
+      so repeated runs and the replicas of a replica exchange draw
+      independent streams. Only a resumed checkpoint continues the
+      streams of the run that wrote it.
+     */
+    uint32_t randomStreamSeed;
+
+    /*! \brief Returns a counter-based random number stream.
+
+      Unlike ranGenerator, the numbers of a stream depend only on
+      its key and not on the order in which the streams are used. A
+      parallel loop which takes a stream for every item therefore
+      gives identical results for any number of threads.
+
+      \param stream Identifies the user of the stream (e.g., the ID
+      of a System).
+      \param id The particle or cell the numbers are drawn for.
+      \param count The event (or step) count of the user, which
+      must not repeat for the same stream and id.
+     */
+    streamRNG getRandomStream(uint32_t stream, uint32_t id, uint64_t count) const
+    { return streamRNG((uint64_t(randomStreamSeed) << 32) | stream, id, uint32_t(count), uint32_t(count >> 32)); }
     
     /*! \brief The collection of OutputPlugin's operating on this system.
      */
     std::vector<shared_ptr<OutputPlugin> > outputPlugins; 
 
+    /*! \brief If true, the OutputPlugin's which consume
+        OutputPlugin::EventRecord's are updated on worker threads.
+
+      This must be set before the Simulation is initialised. The data
+      of these plugins is only up to date after a call to
+      flushOutputPlugins(), which is done automatically before any
+      output or replica exchange.
+     */
+    bool asyncOutputPlugins;
+
+    /*! \brief The thread pool for the parallel analysis of the
+        system (e.g., by output plugins and checkSystem()).
+
+      The pool is shared with the Coordinator and any other
+      Simulations it runs, so that they do not oversubscribe the
+      processors. If no pool has been set, a pool without any threads
+      is returned, which does all of the work in the calling thread.
+     */
+    magnet::thread::ThreadPool& getThreadPool() const;
+
+    //! \brief Set the pool returned by getThreadPool().
+    void setThreadPool(magnet::thread::ThreadPool* pool) { _threadPool = pool; }
+
     /*! \brief The mean free time of the previous simulation run
      
       This is zero in the case that there is no previous simulation
@@ -410,8 +515,60 @@ namespace dynamo
      */
     magnet::Signal<void(const NEventData&)> _sigParticleUpdate;
 
+    /*! \brief Pass an event to the OutputPlugin's which are
+        subscribed to it.
+
+      The plugins are called in their update order, using the
+      dispatch lists built from each OutputPlugin::Subscription when
+      the Simulation is initialised.
+     */
+    void eventUpdate(const Event&, const NEventData&);
+
+    /*! \brief Wait for any OutputPlugin's running on worker threads
+        to process all of the events so far.
+     */
+    void flushOutputPlugins();
+
   private:
     size_t _nextPrint;
+
+    magnet::thread::ThreadPool* _threadPool;
+
+    //! \brief Restore the checkpoint opened by loadCheckpoint().
+    void restoreCheckpoint();
+
+    //! \brief The checkpoint to restore when the Simulation is initialised.
+    shared_ptr<std::istream> _checkpoint;
+    std::string _checkpointName;
+    bool _validateCheckpoint;
+
+    void buildEventPluginLists();
+
+    //! \brief Fill _eventRecords with the records of an event.
+    void buildEventRecords(const Event&, const NEventData&);
+
+    struct EventPluginEntry
+    {
+      OutputPlugin* _plugin;
+      //! \brief The OutputPipeline channel of the plugin, if it is run asynchronously.
+      size_t _channel;
+      //! \brief If the subscription must be tested for each event.
+      bool _filtered;
+      //! \brief If the plugin is updated using EventRecord's.
+      bool _records;
+    };
+
+    /*! \brief The OutputPlugin's subscribed to each combination of
+        EventSource and EEventType.
+    */
+    std::vector<std::vector<EventPluginEntry> > _eventPlugins;
+
+    std::vector<OutputPlugin::EventRecord> _eventRecords;
+
+    const OPMisc* _miscPlugin;
+
+    //! \brief The worker threads for the asynchronous OutputPlugin's.
+    shared_ptr<OutputPipeline> _outputPipeline;
   };
 
 }
@@ -28,11 +28,16 @@
 #include <dynamo/outputplugins/outputplugin.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
+#include <magnet/thread/threadpool.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace dynamo {
   SysDSMCSpheres::SysDSMCSpheres(const magnet::xml::Node& XML, dynamo::Simulation* tmp): 
     System(tmp),
-    maxprob(0.0)
+    maxprob(0.0),
+    _cellWidth(0),
+    _step(0)
   {
     dt = std::numeric_limits<float>::infinity();
     operator<<(XML);
@@ -40,7 +45,7 @@ namespace dynamo {
   }
 
   SysDSMCSpheres::SysDSMCSpheres(dynamo::Simulation* nSim, double nd, double ntstp, double nChi, 
-			       double ne, std::string nName, IDRange* r1, IDRange* r2):
+			       double ne, std::string nName, IDRange* r1, IDRange* r2, double cellWidth):
     System(nSim),
     tstep(ntstp),
     chi(nChi),
@@ -49,16 +54,52 @@ namespace dynamo {
     maxprob(0.0),
     e(ne),
     range1(r1),
-    range2(r2)
+    range2(r2),
+    _cellWidth(cellWidth),
+    _step(0)
   {
     sysName = nName;
     type = DSMC;
   }
 
+  template<class RNG>
+  Vector
+  SysDSMCSpheres::randomContact(std::normal_distribution<>& norm_sampler, RNG& ranGenerator) const
+  {
+    Vector rij;
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      rij[iDim] = norm_sampler(ranGenerator);
+	
+    //This is the extra diameter term missing from the "factor" variable
+    return rij * (diameter / rij.nrm());
+  }
+
+  template<class RNG>
+  bool
+  SysDSMCSpheres::collisionTest(Particle& p1, Particle& p2, const Vector& rij, double& maxprobability, RNG& ranGenerator) const
+  {
+    const double prob = Sim->dynamics->DSMCSpheresProbability(p1, p2, factor, rij);
+
+    //Receding pairs do not collide
+    if (prob < 0) return false;
+
+    if (prob > maxprobability)
+      maxprobability = prob;
+
+    std::uniform_real_distribution<> uniform_dist;
+    return prob > uniform_dist(ranGenerator) * maxprobability;
+  }
+
   NEventData
   SysDSMCSpheres::runEvent()
   {
     dt = tstep;
+    return _cellWidth ? runCells() : runGlobal();
+  }
+
+  NEventData
+  SysDSMCSpheres::runGlobal()
+  {
     std::normal_distribution<> norm_sampler;
     std::uniform_real_distribution<> uniform_sampler;
     std::uniform_int_distribution<size_t> id1sampler(0, range1->size() - 1);
@@ -86,14 +127,9 @@ namespace dynamo {
 	
 	Sim->dynamics->updateParticlePair(p1, p2);
       
-	Vector rij;
-	for (size_t iDim(0); iDim < NDIM; ++iDim)
-	  rij[iDim] = norm_sampler(Sim->ranGenerator);
-	
-	//This is the extra diameter term missing from the "factor" variable
-	rij *= diameter / rij.nrm();
+	const Vector rij = randomContact(norm_sampler, Sim->ranGenerator);
       
-	if (Sim->dynamics->DSMCSpheresTest(p1, p2, maxprob, factor, rij))
+	if (collisionTest(p1, p2, rij, maxprob, Sim->ranGenerator))
 	  {
 	    ++Sim->eventCount;
 	    retval.L2partChanges.push_back(PairEventData(Sim->dynamics->DSMCSpheresRun(p1, p2, e, rij)));
@@ -102,6 +138,114 @@ namespace dynamo {
     return retval;
   }
 
+  size_t
+  SysDSMCSpheres::getCellID(Vector pos) const
+  {
+    Sim->BCs->applyBC(pos);
+
+    size_t cellID = 0;
+    for (size_t iDim(NDIM); iDim-- > 0;)
+      {
+	const long coord = std::floor((pos[iDim] / Sim->primaryCellSize[iDim] + 0.5) * _cellCount[iDim]);
+	//Particles outside of the primary image (if it is not
+	//periodic) are placed in the outermost cells
+	cellID = cellID * _cellCount[iDim] + std::min(size_t(std::max(coord, 0l)), _cellCount[iDim] - 1);
+      }
+    return cellID;
+  }
+
+  void
+  SysDSMCSpheres::binParticles(const IDRange& range, std::vector<size_t>& start, std::vector<size_t>& contents) const
+  {
+    //A counting sort of the particles into the cells
+    std::vector<size_t> cellIDs;
+    cellIDs.reserve(range.size());
+    start.assign(_cellCount[0] * _cellCount[1] * _cellCount[2] + 1, 0);
+    for (const size_t& id : range)
+      {
+	Particle& part = Sim->particles[id];
+	Sim->dynamics->updateParticle(part);
+	cellIDs.push_back(getCellID(part.getPosition()));
+	++start[cellIDs.back() + 1];
+      }
+
+    for (size_t cell(1); cell < start.size(); ++cell)
+      start[cell] += start[cell - 1];
+
+    contents.resize(range.size());
+    std::vector<size_t> end(start.begin(), start.end() - 1);
+    auto cellID = cellIDs.begin();
+    for (const size_t& id : range)
+      contents[end[*(cellID++)]++] = id;
+  }
+
+  NEventData
+  SysDSMCSpheres::runCells()
+  {
+    binParticles(*range1, _cellStart1, _cellContents1);
+    binParticles(*range2, _cellStart2, _cellContents2);
+
+    //The number of pairs to test in a cell is scaled by the local
+    //density of range2, relative to the density used in the factor
+    const size_t cells = _cellStart1.size() - 1;
+    const double pairFactor = 0.5 * maxprob * cells / range2->size();
+
+    //Each cell draws from its own random number stream for this
+    //step, and the events are collected in cell order, so the
+    //results do not depend on the number of threads.
+    magnet::thread::ThreadPool& pool = Sim->getThreadPool();
+    const size_t tasks = 4 * (pool.getThreadCount() + 1);
+    std::vector<double> taskMaxprob(tasks, maxprob);
+    std::vector<std::vector<PairEventData> > taskEvents(tasks);
+
+    pool.parallel_for(0, tasks, [&](const size_t task) {
+	//Each task takes a contiguous block of cells
+	for (size_t cell(cells * task / tasks); cell < cells * (task + 1) / tasks; ++cell)
+	  {
+	    const size_t N1 = _cellStart1[cell + 1] - _cellStart1[cell];
+	    const size_t N2 = _cellStart2[cell + 1] - _cellStart2[cell];
+	    if (!N1 || !N2) continue;
+
+	    streamRNG ranGenerator = Sim->getRandomStream(ID, cell, _step);
+	    std::normal_distribution<> norm_sampler;
+	    std::uniform_real_distribution<> uniform_sampler;
+	    //The maximum probability is only shared between the cells
+	    //at the end of the step, so that the acceptance of a pair
+	    //does not depend on which cells share a task
+	    double cellMaxprob = maxprob;
+	    std::uniform_int_distribution<size_t> id1sampler(_cellStart1[cell], _cellStart1[cell + 1] - 1);
+	    std::uniform_int_distribution<size_t> id2sampler(_cellStart2[cell], _cellStart2[cell + 1] - 1);
+	    const size_t nmax = static_cast<size_t>(pairFactor * N1 * N2 + uniform_sampler(ranGenerator));
+	    for (size_t n = 0; n < nmax; ++n)
+	      {
+		Particle& p1(Sim->particles[_cellContents1[id1sampler(ranGenerator)]]);
+		Particle& p2(Sim->particles[_cellContents2[id2sampler(ranGenerator)]]);
+
+		//Self pairs are rejected (not redrawn), so that the
+		//partners are sampled at the density of the other
+		//particles in the cell
+		if (p1.getID() == p2.getID()) continue;
+
+		const Vector rij = randomContact(norm_sampler, ranGenerator);
+		if (collisionTest(p1, p2, rij, cellMaxprob, ranGenerator))
+		  taskEvents[task].push_back(PairEventData(Sim->dynamics->DSMCSpheresRun(p1, p2, e, rij)));
+	      }
+	    taskMaxprob[task] = std::max(taskMaxprob[task], cellMaxprob);
+	  }
+      });
+
+    ++_step;
+
+    NEventData retval;
+    for (size_t task(0); task < tasks; ++task)
+      {
+	maxprob = std::max(maxprob, taskMaxprob[task]);
+	Sim->eventCount += taskEvents[task].size();
+	retval.L2partChanges.insert(retval.L2partChanges.end(), taskEvents[task].begin(), taskEvents[task].end());
+      }
+    return retval;
+  }
+
   void
   SysDSMCSpheres::initialise(size_t nID)
   {
@@ -134,13 +278,7 @@ namespace dynamo {
 	  
 	    Sim->dynamics->updateParticlePair(p1, p2);
 	  
-	    Vector rij;
-	    for (size_t iDim(0); iDim < NDIM; ++iDim)
-	      rij[iDim] = norm_sampler(Sim->ranGenerator);
-	
-	    rij *= diameter / rij.nrm();
-	  
-	    Sim->dynamics->DSMCSpheresTest(p1, p2, maxprob, factor, rij);
+	    collisionTest(p1, p2, randomContact(norm_sampler, Sim->ranGenerator), maxprob, Sim->ranGenerator);
 	  }
       }
 
@@ -153,6 +291,14 @@ namespace dynamo {
   
     if (0.5 * range1->size() * maxprob < 2.0)
       derr << "This probability is low" << std::endl;
+
+    if (_cellWidth)
+      {
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  _cellCount[iDim] = std::max(size_t(Sim->primaryCellSize[iDim] / _cellWidth), size_t(1));
+
+	dout << "Collision cells " << _cellCount[0] << "," << _cellCount[1] << "," << _cellCount[2] << std::endl;
+      }
   }
 
   void
@@ -170,6 +316,10 @@ namespace dynamo {
     range2 = shared_ptr<IDRange>(IDRange::getClass(subRangeXML, Sim));
     if (XML.hasAttribute("MaxProbability"))
       maxprob = XML.getAttribute("MaxProbability").as<double>();
+    if (XML.hasAttribute("CellWidth"))
+      _cellWidth = XML.getAttribute("CellWidth").as<double>() * Sim->units.unitLength();
+    if (XML.hasAttribute("Step"))
+      _step = XML.getAttribute("Step").as<uint64_t>();
   }
 
   void 
@@ -182,8 +332,13 @@ namespace dynamo {
 	<< magnet::xml::attr("Diameter") << diameter / Sim->units.unitLength()
 	<< magnet::xml::attr("Inelasticity") << e
 	<< magnet::xml::attr("Name") << sysName
-	<< magnet::xml::attr("MaxProbability") << maxprob
-	<< range1
+	<< magnet::xml::attr("MaxProbability") << maxprob;
+
+    if (_cellWidth)
+      XML << magnet::xml::attr("CellWidth") << _cellWidth / Sim->units.unitLength()
+	  << magnet::xml::attr("Step") << _step;
+
+    XML << range1
 	<< range2
 	<< magnet::xml::endtag("System");
   }
@@ -21,12 +21,27 @@
 #include <dynamo/ranges/IDRange.hpp>
 
 namespace dynamo {
+  /*! \brief An Enskog DSMC (ESMC) collision event for spheres.
+
+    Every tStep, random pairs of particles are tested for collisions
+    with probabilities given by the Enskog collision frequency.
+
+    By default, the pairs are drawn from the whole of the two ID
+    ranges, which is only correct if the system is homogeneous. If a
+    CellWidth is set, the particles are instead binned into
+    collision cells every step and the pairs are drawn from within a
+    cell, so that the collisions follow the local density. The cells
+    are processed in parallel on the thread pool of the Simulation,
+    and each cell draws from its own counter-based random number
+    stream (see Simulation::getRandomStream()), so the results are
+    identical for any number of threads.
+   */
   class SysDSMCSpheres: public System
   {
   public:
     SysDSMCSpheres(const magnet::xml::Node& XML, dynamo::Simulation*);
 
-    SysDSMCSpheres(dynamo::Simulation*, double, double, double, double, std::string, IDRange*, IDRange*);
+    SysDSMCSpheres(dynamo::Simulation*, double, double, double, double, std::string, IDRange*, IDRange*, double cellWidth = 0);
   
     virtual NEventData runEvent();
 
@@ -37,6 +52,20 @@ namespace dynamo {
   protected:
     virtual void outputXML(magnet::xml::XmlStream&) const;
 
+    NEventData runGlobal();
+
+    NEventData runCells();
+
+    size_t getCellID(Vector) const;
+
+    void binParticles(const IDRange&, std::vector<size_t>&, std::vector<size_t>&) const;
+
+    template<class RNG>
+    Vector randomContact(std::normal_distribution<>&, RNG&) const;
+
+    template<class RNG>
+    bool collisionTest(Particle&, Particle&, const Vector&, double&, RNG&) const;
+
     double tstep;
     double chi;
     double d2;
@@ -47,5 +76,21 @@ namespace dynamo {
 
     shared_ptr<IDRange> range1;
     shared_ptr<IDRange> range2;
+
+    //! \brief The target width of the collision cells (zero if not used).
+    double _cellWidth;
+    std::array<size_t, 3> _cellCount;
+
+    //! \brief The number of collision cell steps run, which keys the random number streams.
+    uint64_t _step;
+
+    /*! \brief The particles of each range, sorted by their
+        collision cell.
+
+      The particles of cell i are the entries [start[i], start[i+1])
+      of the contents.
+     */
+    std::vector<size_t> _cellStart1, _cellContents1;
+    std::vector<size_t> _cellStart2, _cellContents2;
   };
 }
@@ -26,8 +26,10 @@
 #include <dynamo/dynamics/dynamics.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/outputplugins/outputplugin.hpp>
+#include <dynamo/checkpoint.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
+#include <algorithm>
 
 namespace dynamo {
 
@@ -41,7 +43,8 @@ namespace dynamo {
     setPoint(0.05),
     eventCount(0),
     lastlNColl(0),
-    setFrequency(100)
+    setFrequency(100),
+    _particlesPerEvent(0)
   {
     dt = std::numeric_limits<float>::infinity();
     operator<<(XML);
@@ -58,6 +61,7 @@ namespace dynamo {
     eventCount(0),
     lastlNColl(0),
     setFrequency(100),
+    _particlesPerEvent(0),
     range(new IDRangeAll(Sim))
   {
     sysName = nName;
@@ -68,24 +72,75 @@ namespace dynamo {
   SysAndersen::runEvent()
   {
     ++Sim->eventCount;
-    ++eventCount;
 
+    std::uniform_int_distribution<size_t> id_sampler(0, _ids.size() - 1);
+    std::normal_distribution<> norm_dist;
+    NEventData SDat;
+
+    if (!_particlesPerEvent)
+      {
+	++eventCount;
+	tuneMeanFreeTime();
+	dt = getGhostt();
+
+	Vector normal{0, 0, 0};
+	Particle& part = Sim->particles[_ids[id_sampler(Sim->ranGenerator)]];
+	for (size_t iDim(0); iDim < dimensions; ++iDim)
+	  normal[iDim] = norm_dist(Sim->ranGenerator);
+	SDat.L1partChanges.push_back(Sim->dynamics->randomGaussianEvent(part, sqrtTemp, normal, dimensions));
+	return SDat;
+      }
+
+    const size_t hits = std::poisson_distribution<size_t>(_particlesPerEvent)(Sim->ranGenerator);
+    //The tuning counts every hit, as the mean free time sets the
+    //rate of hits (not of thermalised particles)
+    eventCount += hits;
+    tuneMeanFreeTime();
+    dt = getGhostt();
+
+    _batchIDs.clear();
+    for (size_t i(0); i < hits; ++i)
+      _batchIDs.push_back(_ids[id_sampler(Sim->ranGenerator)]);
+
+    //Thermalising a particle more than once in an event is the
+    //same as thermalising it once
+    std::sort(_batchIDs.begin(), _batchIDs.end());
+    _batchIDs.erase(std::unique(_batchIDs.begin(), _batchIDs.end()), _batchIDs.end());
+
+    //The Gaussian numbers of all the particles are drawn together
+    _normals.resize(_batchIDs.size());
+    for (Vector& normal : _normals)
+      for (size_t iDim(0); iDim < dimensions; ++iDim)
+	normal[iDim] = norm_dist(Sim->ranGenerator);
+
+    for (size_t i(0); i < _batchIDs.size(); ++i)
+      SDat.L1partChanges.push_back(Sim->dynamics->randomGaussianEvent(Sim->particles[_batchIDs[i]], sqrtTemp, _normals[i], dimensions));
+    return SDat;
+  }
+
+  void
+  SysAndersen::tuneMeanFreeTime()
+  {
     if (tune && (eventCount > setFrequency))
       {
 	meanFreeTime *= static_cast<double>(eventCount) / ((Sim->eventCount - lastlNColl) * setPoint);
 	lastlNColl = Sim->eventCount;
 	eventCount = 0;
       }
-
-    dt = getGhostt();
-    const size_t step = std::uniform_int_distribution<size_t>(0, range->size() - 1)(Sim->ranGenerator);
-    return Sim->dynamics->randomGaussianEvent(Sim->particles[*(range->begin() + step)], sqrtTemp, dimensions);
   }
 
   void 
   SysAndersen::initialise(size_t nID)
   {
     ID = nID;
+    _ids.clear();
+    _ids.reserve(range->size());
+    for (const size_t& id : *range)
+      _ids.push_back(id);
+
+    if (_ids.empty())
+      M_throw() << "The thermostat \"" << sysName << "\" has no particles to thermalise";
+
     dt = getGhostt();
     sqrtTemp = sqrt(Temp);
     eventCount = 0;
@@ -102,6 +157,9 @@ namespace dynamo {
     if (XML.hasAttribute("Dimensions"))
       dimensions = XML.getAttribute("Dimensions").as<size_t>();
 
+    if (XML.hasAttribute("ParticlesPerEvent"))
+      _particlesPerEvent = XML.getAttribute("ParticlesPerEvent").as<double>();
+
     if (XML.hasAttribute("SetFrequency") && XML.hasAttribute("SetPoint"))
       {
 	tune = true;
@@ -112,6 +170,25 @@ namespace dynamo {
     range = shared_ptr<IDRange>(IDRange::getClass(XML.getNode("IDRange"),Sim));
   }
 
+  void
+  SysAndersen::saveCheckpoint(CheckpointWriter& out) const
+  {
+    System::saveCheckpoint(out);
+    //The tuning state of the thermostat
+    out.write(meanFreeTime);
+    out.write(uint64_t(eventCount));
+    out.write(uint64_t(lastlNColl));
+  }
+
+  void
+  SysAndersen::loadCheckpoint(CheckpointReader& in)
+  {
+    System::loadCheckpoint(in);
+    in.read(meanFreeTime);
+    eventCount = in.read<uint64_t>();
+    lastlNColl = in.read<uint64_t>();
+  }
+
   void 
   SysAndersen::outputXML(magnet::xml::XmlStream& XML) const
   {
@@ -129,6 +206,9 @@ namespace dynamo {
     if (dimensions != NDIM)
       XML << magnet::xml::attr("Dimensions") << dimensions;
 
+    if (_particlesPerEvent)
+      XML << magnet::xml::attr("ParticlesPerEvent") << _particlesPerEvent;
+
     XML << range
 	<< magnet::xml::endtag("System");
   }
@@ -136,6 +216,11 @@ namespace dynamo {
   double 
   SysAndersen::getGhostt() const
   { 
+    //The batched events are evenly spaced, as the number of
+    //particles of each is Poisson distributed instead
+    if (_particlesPerEvent)
+      return _particlesPerEvent * meanFreeTime;
+
     return  - meanFreeTime * std::log(1.0 - std::uniform_real_distribution<>()(Sim->ranGenerator));
   }
 
@@ -149,6 +234,6 @@ namespace dynamo {
   void 
   SysAndersen::setReducedTemperature(double nT)
   {
-    Temp = nT * Sim->units.unitEnergy(); 
+    setTemperature(nT * Sim->units.unitEnergy());
   }
 }
@@ -21,6 +21,18 @@
 #include <dynamo/ranges/IDRange.hpp>
 
 namespace dynamo {
+  /*! \brief An Andersen thermostat, which reassigns the velocities
+    of randomly chosen particles from the Maxwell-Boltzmann
+    distribution.
+
+    By default, a single particle is thermalised at each event and
+    the events are a Poisson process. If ParticlesPerEvent is set,
+    the events are instead evenly spaced, and each thermalises a
+    Poisson distributed number of randomly chosen particles with
+    this mean. This samples the same Poisson process of
+    thermalisations (only delayed to the next event), but with
+    fewer events.
+   */
   class SysAndersen: public System
   {
   public:
@@ -34,10 +46,15 @@ namespace dynamo {
 
     virtual void operator<<(const magnet::xml::Node&);
 
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    virtual void loadCheckpoint(CheckpointReader&);
+
     double getTemperature() const { return Temp; }
     double getReducedTemperature() const;
     void setTemperature(double nT) { Temp = nT; sqrtTemp = std::sqrt(Temp); }
     void setReducedTemperature(double nT);
+    void setParticlesPerEvent(double n) { _particlesPerEvent = n; }
 
     virtual void replicaExchange(System& os) { 
       SysAndersen& s = static_cast<SysAndersen&>(os);
@@ -51,6 +68,7 @@ namespace dynamo {
       std::swap(eventCount, s.eventCount);
       std::swap(lastlNColl, s.lastlNColl);
       std::swap(setFrequency, s.setFrequency);
+      std::swap(_particlesPerEvent, s._particlesPerEvent);
     }
   
   protected:
@@ -64,8 +82,23 @@ namespace dynamo {
     size_t lastlNColl;
     size_t setFrequency;
 
+    //! \brief The mean number of particles thermalised per event (zero for one per event).
+    double _particlesPerEvent;
+
     double getGhostt() const;
+
+    //! \brief Adjust the mean free time towards the SetPoint
+    //! fraction of thermostat hits, every SetFrequency hits.
+    void tuneMeanFreeTime();
   
     shared_ptr<IDRange> range;
+
+    //! \brief The IDs of the range, as an IDRange may be slow to index.
+    std::vector<size_t> _ids;
+
+    //! \brief Scratch space for the particles of a batched event.
+    std::vector<size_t> _batchIDs;
+    //! \brief Scratch space for the Gaussian numbers of a batched event.
+    std::vector<Vector> _normals;
   };
 }
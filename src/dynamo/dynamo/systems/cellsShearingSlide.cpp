@@ -0,0 +1,61 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/systems/cellsShearingSlide.hpp>
+#include <dynamo/globals/cellsShearing.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/NparticleEventData.hpp>
+
+namespace dynamo {
+  SysCellsShearingSlide::SysCellsShearingSlide(dynamo::Simulation* nSim, size_t nblistID):
+    System(nSim),
+    cellID(nblistID)
+  {
+    sysName = Sim->globals[cellID]->getName() + "Slide";
+    type = NON_EVENT;
+  }
+
+  GCellsShearing&
+  SysCellsShearingSlide::getCells() const
+  {
+    if (!std::dynamic_pointer_cast<GCellsShearing>(Sim->globals[cellID]))
+      M_throw() << "Have the globals been shuffled? The cellID is no longer a GCellsShearing.";
+
+    return static_cast<GCellsShearing&>(*Sim->globals[cellID]);
+  }
+
+  void
+  SysCellsShearingSlide::initialise(size_t nID)
+  {
+    ID = nID;
+    reschedule();
+  }
+
+  void
+  SysCellsShearingSlide::reschedule()
+  {
+    dt = getCells().getSlideTime();
+  }
+
+  NEventData
+  SysCellsShearingSlide::runEvent()
+  {
+    getCells().slide();
+    reschedule();
+    return NEventData();
+  }
+}
@@ -0,0 +1,59 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/systems/system.hpp>
+
+namespace dynamo {
+  class GCellsShearing;
+
+  /*! \brief The event at which the images of a Lees-Edwards system
+      have slid past each other by another cell width.
+
+    This is added by \ref GCellsShearing to keep its neighbourhoods
+    across the sheared boundary in step with the boundary
+    displacement. It is not written to the configuration file, as it
+    is recreated by the neighbour list when the configuration is
+    loaded.
+   */
+  class SysCellsShearingSlide: public System
+  {
+  public:
+    SysCellsShearingSlide(dynamo::Simulation*, size_t);
+
+    virtual NEventData runEvent();
+
+    virtual void initialise(size_t);
+
+    virtual void operator<<(const magnet::xml::Node&) {}
+
+    /*! \brief The slides only depend on the boundary displacement
+        of this simulation, which is not exchanged.
+     */
+    virtual void replicaExchange(System&) {}
+
+    //! \brief Recalculate the time of the next slide.
+    void reschedule();
+
+  protected:
+    virtual void outputXML(magnet::xml::XmlStream&) const {}
+
+    GCellsShearing& getCells() const;
+
+    size_t cellID;
+  };
+}
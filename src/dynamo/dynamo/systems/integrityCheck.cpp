@@ -0,0 +1,93 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <dynamo/systems/integrityCheck.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/NparticleEventData.hpp>
+#include <dynamo/units/units.hpp>
+#include <dynamo/schedulers/scheduler.hpp>
+#include <magnet/xmlwriter.hpp>
+
+namespace dynamo {
+  SysIntegrityCheck::SysIntegrityCheck(dynamo::Simulation* nSim, double nPeriod, std::string nName, size_t max_reports):
+    System(nSim),
+    _maxReports(max_reports),
+    _checks(0),
+    _totalErrors(0),
+    _lastErrors(0)
+  {
+    if (nPeriod <= 0.0)
+      nPeriod = 1.0;
+
+    nPeriod *= Sim->units.unitTime();
+
+    dt = nPeriod;
+    _period = nPeriod;
+    sysName = nName;
+
+    dout << "Integrity check set for a period of " << _period / Sim->units.unitTime() << std::endl;
+  }
+
+  NEventData
+  SysIntegrityCheck::runEvent()
+  {
+    dt += _period;
+
+    _lastErrors = Sim->checkSystem(_maxReports);
+    _totalErrors += _lastErrors;
+    ++_checks;
+
+    if (_lastErrors)
+      derr << "Found " << _lastErrors << " invalid states at t = " 
+	   << Sim->systemTime / Sim->units.unitTime()
+	   << ", event " << Sim->eventCount << std::endl;
+
+    return NEventData();
+  }
+
+  void 
+  SysIntegrityCheck::initialise(size_t nID)
+  { 
+    ID = nID;
+  }
+
+  void
+  SysIntegrityCheck::outputData(magnet::xml::XmlStream& XML) const
+  {
+    XML << magnet::xml::tag("System")
+	<< magnet::xml::attr("Name") << sysName
+	<< magnet::xml::attr("Type") << "IntegrityCheck"
+	<< magnet::xml::attr("Checks") << _checks
+	<< magnet::xml::attr("InvalidStates") << _totalErrors
+	<< magnet::xml::endtag("System");
+  }
+
+  void 
+  SysIntegrityCheck::setTickerPeriod(const double& nP)
+  { 
+    dout << "Setting integrity check period to " 
+	 << nP / Sim->units.unitTime() << std::endl;
+
+    _period = nP; 
+
+    dt = nP;
+
+    if ((Sim->status >= INITIALISED) && Sim->endEventCount)
+      Sim->ptrScheduler->rebuildSystemEvents();
+  }
+}
@@ -0,0 +1,66 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+#include <dynamo/systems/system.hpp>
+
+namespace dynamo {
+  /*! \brief A System Event which periodically validates the state of
+      the system.
+
+    This calls Simulation::checkSystem() at a fixed period of
+    simulation time, and reports (but does not correct) any invalid
+    states found. As the check is performed over the neighbourhoods
+    of the particles (on the thread pool of the Simulation), it is
+    cheap enough to use in long production runs to catch errors
+    shortly after they occur.
+   */
+  class SysIntegrityCheck: public System
+  {
+  public:
+    SysIntegrityCheck(dynamo::Simulation*, double, std::string, size_t max_reports = 10);
+
+    virtual NEventData runEvent();
+
+    virtual void initialise(size_t);
+
+    virtual void operator<<(const magnet::xml::Node&) {}
+
+    virtual void outputData(magnet::xml::XmlStream&) const;
+
+    void setTickerPeriod(const double&);
+
+    //! \brief The number of invalid states found by the last check.
+    size_t getLastErrorCount() const { return _lastErrors; }
+
+    virtual void replicaExchange(System& os) { 
+      SysIntegrityCheck& s = static_cast<SysIntegrityCheck&>(os);
+      std::swap(dt, s.dt);
+      std::swap(_period, s._period);
+    }
+
+  protected:
+    virtual void outputXML(magnet::xml::XmlStream&) const {}
+
+    double _period;
+    size_t _maxReports;
+    size_t _checks;
+    size_t _totalErrors;
+    size_t _lastErrors;
+  };
+}
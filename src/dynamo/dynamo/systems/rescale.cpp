@@ -26,6 +26,7 @@
 #include <dynamo/dynamics/dynamics.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/outputplugins/outputplugin.hpp>
+#include <dynamo/checkpoint.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
 #include <fstream>
@@ -81,9 +82,8 @@ namespace dynamo {
 	 << " To " << _kT / Sim->units.unitEnergy() <<  std::endl;
 
     NEventData SDat;
-    for (const shared_ptr<Species>& species : Sim->species)
-      for (const unsigned long& partID : *species->getRange())
-	SDat.L1partChanges.push_back(ParticleEventData(Sim->particles[partID], *species, RESCALE));
+    for (const auto& part : _particles)
+      SDat.L1partChanges.push_back(ParticleEventData(Sim->particles[part.first], *Sim->species[part.second], RESCALE));
     
     Sim->dynamics->updateAllParticles();
     Sim->dynamics->rescaleSystemKineticEnergy(_kT / currentkT);
@@ -106,6 +106,12 @@ namespace dynamo {
 
     dt = _timestep;
 
+    _particles.clear();
+    _particles.reserve(Sim->N());
+    for (const shared_ptr<Species>& species : Sim->species)
+      for (const unsigned long& partID : *species->getRange())
+	_particles.push_back(std::make_pair(size_t(partID), species->getID()));
+
     if (_frequency != std::numeric_limits<size_t>::max())
       Sim->_sigParticleUpdate.connect<SysRescale, &SysRescale::checker>(this);
   
@@ -127,6 +133,24 @@ namespace dynamo {
     sysName = XML.getAttribute("Name");
   }
 
+  void
+  SysRescale::saveCheckpoint(CheckpointWriter& out) const
+  {
+    System::saveCheckpoint(out);
+    out.write(scaleFactor);
+    out.write(LastTime);
+    out.write(RealTime);
+  }
+
+  void
+  SysRescale::loadCheckpoint(CheckpointReader& in)
+  {
+    System::loadCheckpoint(in);
+    in.read(scaleFactor);
+    in.read(LastTime);
+    in.read(RealTime);
+  }
+
   void 
   SysRescale::outputXML(magnet::xml::XmlStream& XML) const
   {
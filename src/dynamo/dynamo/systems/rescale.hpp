@@ -43,6 +43,10 @@ namespace dynamo {
     virtual void operator<<(const magnet::xml::Node&);
 
     void checker(const NEventData&);
+
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    virtual void loadCheckpoint(CheckpointReader&);
   
     inline const long double& getScaleFactor() const {return scaleFactor; }
 
@@ -56,6 +60,11 @@ namespace dynamo {
     mutable long double scaleFactor;
 
     mutable long double LastTime, RealTime;
+
+    /*! \brief The IDs of the particles and their species, as
+        iterating over the IDRange of each species may be slow.
+     */
+    std::vector<std::pair<size_t, size_t> > _particles;
   
   };
 }
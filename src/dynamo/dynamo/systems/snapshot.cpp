@@ -22,6 +22,7 @@
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
 #include <dynamo/units/units.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
+#include <dynamo/checkpoint.hpp>
 #include <magnet/string/searchreplace.hpp>
 
 namespace dynamo {
@@ -100,6 +101,21 @@ namespace dynamo {
     return NEventData();
   }
 
+  void
+  SysSnapshot::saveCheckpoint(CheckpointWriter& out) const
+  {
+    System::saveCheckpoint(out);
+    //Continue the numbering of the snapshots
+    out.write(uint64_t(_saveCounter));
+  }
+
+  void
+  SysSnapshot::loadCheckpoint(CheckpointReader& in)
+  {
+    System::loadCheckpoint(in);
+    _saveCounter = in.read<uint64_t>();
+  }
+
   void 
   SysSnapshot::initialise(size_t nID)
   { 
@@ -49,6 +49,10 @@ namespace dynamo {
 
     void setTickerPeriod(const double&);
 
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    virtual void loadCheckpoint(CheckpointReader&);
+
   protected:
     void eventCallback(const NEventData&);
     virtual void outputXML(magnet::xml::XmlStream&) const {}
@@ -26,6 +26,7 @@
 #include <dynamo/systems/sleep.hpp>
 #include <dynamo/particle.hpp>
 #include <dynamo/ranges/IDRangeAll.hpp>
+#include <dynamo/checkpoint.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
 #include <cstring>
@@ -45,6 +46,18 @@ namespace dynamo {
     return XML;
   }
 
+  void
+  System::saveCheckpoint(CheckpointWriter& out) const
+  {
+    out.write(dt);
+  }
+
+  void
+  System::loadCheckpoint(CheckpointReader& in)
+  {
+    in.read(dt);
+  }
+
   shared_ptr<System>
   System::getClass(const magnet::xml::Node& XML, dynamo::Simulation* Sim)
   {
@@ -22,6 +22,8 @@
 namespace magnet { namespace xml { class Node; class XmlStream; } }
 namespace dynamo {
   class NEventData;
+  class CheckpointWriter;
+  class CheckpointReader;
 
   class System: public dynamo::SimBase
   {
@@ -58,6 +60,14 @@ namespace dynamo {
 
     virtual void outputData(magnet::xml::XmlStream&) const {}
 
+    /*! \brief Write the time until the next event, and any other state
+        which is not stored in the configuration file, to a checkpoint.
+     */
+    virtual void saveCheckpoint(CheckpointWriter&) const;
+
+    /*! \brief Restore the state written by saveCheckpoint(). */
+    virtual void loadCheckpoint(CheckpointReader&);
+
   protected:
     virtual void outputXML(magnet::xml::XmlStream&) const = 0;
 
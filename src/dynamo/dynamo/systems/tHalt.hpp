@@ -34,6 +34,13 @@ namespace dynamo {
 
     void increasedt(double);
 
+    /*! \brief The halt time is an option of each run, so it is not
+        stored in checkpoints.
+     */
+    virtual void saveCheckpoint(CheckpointWriter&) const {}
+
+    virtual void loadCheckpoint(CheckpointReader&) {}
+
     virtual void replicaExchange(System& os) {
       auto s = static_cast<SystHalt&>(os);
       std::swap(dt, s.dt);
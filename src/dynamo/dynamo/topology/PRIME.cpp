@@ -250,12 +250,12 @@ namespace dynamo {
 	      M_throw() << "Unrecognised PRIME group type " << *it;
 	    }
 
-	    _types->insert(BeadTypeMap::value_type(ID++, BeadData(NH, residue, restype, location)));
-	    _types->insert(BeadTypeMap::value_type(ID++, BeadData(CH, residue, restype, location)));
-	    _types->insert(BeadTypeMap::value_type(ID++, BeadData(CO, residue, restype, location)));
+	    addBead(ID++, BeadData(NH, residue, restype, location));
+	    addBead(ID++, BeadData(CH, residue, restype, location));
+	    addBead(ID++, BeadData(CO, residue, restype, location));
 
 	    if (restype != TPRIME::G)
-	      _types->insert(BeadTypeMap::value_type(ID++, BeadData(restype, residue, restype, location)));
+	      addBead(ID++, BeadData(restype, residue, restype, location));
 
 	    ++residue;
 	  }
@@ -269,6 +269,24 @@ namespace dynamo {
       }
   }
 
+  void
+  TPRIME::addBead(size_t ID, const BeadData& data)
+  {
+    _types->insert(BeadTypeMap::value_type(ID, data));
+
+    if (ID >= _beads.size())
+      _beads.resize(ID + 1, BeadData(GROUP_COUNT, 0));
+    _beads[ID] = data;
+
+    if (data.bead_type <= CO)
+      {
+	const size_t loc = 3 * data.residue + data.bead_type;
+	if (loc >= _backbone.size())
+	  _backbone.resize(loc + 1, std::numeric_limits<size_t>::max());
+	_backbone[loc] = ID;
+      }
+  }
+
   void 
   TPRIME::outputXML(magnet::xml::XmlStream& XML) const 
   {
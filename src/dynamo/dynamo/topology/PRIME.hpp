@@ -19,6 +19,7 @@
 #include <dynamo/topology/topology.hpp>
 #include <boost/bimap/bimap.hpp>
 #include <boost/bimap/unordered_set_of.hpp>
+#include <limits>
 #include <vector>
 
 namespace dynamo {
@@ -203,16 +204,21 @@ namespace dynamo {
   
     virtual void operator<<(const magnet::xml::Node&);
 
-    BeadData getBeadInfo(size_t ID) const { 
-      const auto it = _types->left.find(ID);
+    const BeadData& getBeadInfo(size_t ID) const { 
 #ifdef DYNAMO_DEBUG
-      if (it == _types->left.end())
+      if ((ID >= _beads.size()) || (_beads[ID].bead_type == GROUP_COUNT))
 	M_throw() << "Particle " << ID << " has no bead data for " << getName();
 #endif
-      return it->second;
+      return _beads[ID];
     }
     
     size_t getBeadID(BeadData data) const { 
+      if (data.bead_type <= CO)
+	{
+	  const size_t loc = 3 * data.residue + data.bead_type;
+	  return (loc < _backbone.size()) ? _backbone[loc] : std::numeric_limits<size_t>::max();
+	}
+
       const auto it = _types->right.find(data);
 #ifdef DYNAMO_DEBUG
       if (it == _types->right.end())
@@ -223,6 +229,23 @@ namespace dynamo {
 
   protected:
     std::shared_ptr<BeadTypeMap> _types;
+
+    /*! \brief The bead data of each particle, indexed by particle ID.
+
+      Particles which are not in this topology have a bead_type of
+      GROUP_COUNT.
+    */
+    std::vector<BeadData> _beads;
+
+    /*! \brief The ID of each backbone bead, indexed by 3 * residue +
+      bead_type.
+
+      The gaps between the residues of separate molecules hold
+      std::numeric_limits<size_t>::max().
+    */
+    std::vector<size_t> _backbone;
+
+    void addBead(size_t ID, const BeadData& data);
     std::vector<std::pair<size_t, std::string> > _configData;
     virtual void outputXML(magnet::xml::XmlStream&) const;
   };
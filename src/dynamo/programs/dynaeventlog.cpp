@@ -0,0 +1,137 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/simulation.hpp>
+#include <dynamo/eventtypes.hpp>
+#include <dynamo/outputplugins/eventlogreader.hpp>
+#include <magnet/exception.hpp>
+#include <boost/program_options.hpp>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <tuple>
+
+int
+main(int argc, char *argv[])
+{
+  namespace po = boost::program_options;
+
+  try {
+    po::options_description systemopts("Program Options");
+    systemopts.add_options()
+      ("help", "Produces this message")
+      ("log-file", po::value<std::string>(), "The event log written by the EventLog output plugin")
+      ("text,t", po::value<std::string>(), "Export the events to a text file (- for the screen)")
+      ("stats,s", "Print the number of events and their mean free time for each source and type")
+      ("replay,r", po::value<std::string>(), "Replay the events into the configuration file the log was started from")
+      ("out-config-file,o", po::value<std::string>()->default_value("config.replay.xml.bz2"), "The file to write the replayed configuration to")
+      ("first", po::value<uint64_t>()->default_value(0), "The first event to export or count")
+      ("last", po::value<uint64_t>()->default_value(std::numeric_limits<uint64_t>::max()), "The last event to export, count or replay")
+      ;
+
+    po::positional_options_description p;
+    p.add("log-file", 1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(systemopts).positional(p).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help") || !vm.count("log-file"))
+      {
+	std::cerr << "Usage : dynaeventlog <OPTION>...<log-file>\n"
+		  << "Exports, summarises or replays a binary event log\n"
+		  << systemopts << "\n";
+	return 1;
+      }
+
+    const uint64_t first = vm["first"].as<uint64_t>(), last = vm["last"].as<uint64_t>();
+    dynamo::EventLogReader log(vm["log-file"].as<std::string>());
+    const dynamo::eventlog::Header& header = log.getHeader();
+
+    std::cerr << "Event log of " << header.N << " particles, starting at event " << header.startEvent
+	      << "\n" << log.getChunkCount() << " chunks, " << log.getRecordCount() << " records"
+	      << ((header.flags & dynamo::eventlog::COMPRESSED) ? ", compressed" : "")
+	      << (log.hasIndex() ? "" : " (no index, the run may not have completed)") << "\n";
+    if (log.getChunkCount())
+      std::cerr << "Events " << log.getChunk(0).firstEvent << " to " << log.getChunk(log.getChunkCount() - 1).lastEvent
+		<< ", time " << log.getChunk(0).firstTime / header.unitTime
+		<< " to " << log.getChunk(log.getChunkCount() - 1).lastTime / header.unitTime << "\n";
+
+    if (vm.count("text"))
+      {
+	const std::string fileName = vm["text"].as<std::string>();
+	if (fileName == "-")
+	  log.writeText(std::cout, first, last);
+	else
+	  {
+	    std::ofstream of(fileName);
+	    if (!of)
+	      M_throw() << "Failed to open " << fileName << " for writing";
+	    log.writeText(of, first, last);
+	  }
+      }
+
+    if (vm.count("stats"))
+      {
+	//The events of each source, source ID and type, and the
+	//number of particle collisions they contain
+	typedef std::tuple<int, uint32_t, int> Key;
+	std::map<Key, std::pair<uint64_t, uint64_t> > counts;
+	uint64_t lastEvent = std::numeric_limits<uint64_t>::max(), total = 0;
+	double firstTime = 0, lastTime = 0;
+	log.forEach([&](const dynamo::eventlog::Record& record)
+		    {
+		      std::pair<uint64_t, uint64_t>& count = counts[Key(record.source, record.sourceID, record.eventType)];
+		      count.second += (record.particle2 == dynamo::eventlog::noParticle) ? 1 : 2;
+		      if (record.eventCount == lastEvent) return;
+		      if (!total) firstTime = record.time;
+		      lastTime = record.time;
+		      lastEvent = record.eventCount;
+		      ++total;
+		      ++count.first;
+		    }, first, last);
+
+	//The mean time between the events of this kind for each particle
+	const double duration = (lastTime - firstTime) / header.unitTime;
+	std::cout << "Source SourceID EventType Count MeanFreeTime\n";
+	for (const auto& entry : counts)
+	  std::cout << dynamo::EventSource(std::get<0>(entry.first)) << " "
+		    << std::get<1>(entry.first) << " "
+		    << dynamo::EEventType(std::get<2>(entry.first)) << " "
+		    << entry.second.first << " "
+		    << duration * header.N / entry.second.second << "\n";
+	std::cout << "Total " << total << " events over a time of " << duration << "\n";
+      }
+
+    if (vm.count("replay"))
+      {
+	dynamo::Simulation Sim;
+	Sim.loadXMLfile(vm["replay"].as<std::string>());
+	Sim.initialise();
+	const uint64_t events = log.replay(Sim, last);
+	std::cerr << "Replayed " << events << " events, to a time of " << Sim.systemTime / Sim.units.unitTime() << "\n";
+	Sim.writeXMLfile(vm["out-config-file"].as<std::string>());
+      }
+  }
+  catch (std::exception& cep)
+    {
+      std::cout.flush();
+      std::cerr << cep.what() << "\nMAIN: Reached Main Error Loop\n";
+      return 1;
+    }
+}
@@ -17,6 +17,7 @@
 
 #include <magnet/xmlreader.hpp>
 #include <magnet/exception.hpp>
+#include <magnet/thread/threadpool.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -32,6 +33,9 @@
 #include <iomanip>
 #include <iosfwd>
 #include <array>
+#include <algorithm>
+#include <functional>
+#include <map>
 
 using namespace std;
 using namespace boost;
@@ -40,8 +44,11 @@ const size_t NGamma = 1;
 
 //Set in the main function
 static long double alpha;
-static long double minErr = 1e-16;
+//The largest residual of the WHAM equations accepted as converged
+static double minErr = 1e-11;
+static size_t maxIterations = 1000;
 static size_t NStepsPerStep = 0;
+static magnet::thread::ThreadPool threadPool;
 static boost::program_options::variables_map vm;
 
 long double betaMax;
@@ -53,7 +60,7 @@ std::vector<SimulationData> SimulationDataData;
 
 struct SimulationData
 {
-  SimulationData(std::string nfn):fileName(nfn), logZ(0.0), new_logZ(0.0), refZ(false)
+  SimulationData(std::string nfn):fileName(nfn), logZ(0.0)
   {
     using namespace magnet::xml;
 
@@ -124,9 +131,7 @@ struct SimulationData
   std::string fileName;
   std::vector<long double> gamma;
   long double logZ;
-  long double new_logZ;
   long double binWidth;
-  bool refZ;
 
   //Contains the histogram, first axis is bin entry
   //second axis is value of X with the final entry being the probability
@@ -141,70 +146,6 @@ struct SimulationData
   std::unordered_map<int, double> _W;
 
 
-  //Bottom and top contain the window of systems used for the calculation
-  long double calc_logZ(size_t bottom=0, size_t top=0) const
-  {
-    long double sum1 = 0.0;
-    
-    //If top = 0, then use all systems
-    if (top == 0) top = SimulationDataData.size() - 1;
-
-    for (size_t i(bottom); i <= top; ++i)
-      for (const histogramEntry& simdat : SimulationDataData[i].data)
-	{
-	  long double sum2 = 0.0;
-
-	  for (size_t j(bottom); j <= top; ++j)
-	    {
-	      //Determine (\gamma_i- \gamma) \cdot X 
-	      long double dot = 0.0;
-
-	      if (NGamma != 1) 
-		M_throw() << "For multiple gamma reweighting, one must be designated as E and used in the W lookup";
-
-	      { const int i = 0;
-		dot += (SimulationDataData[j].gamma[i] - gamma[i]) * simdat.X[i]
-		  + SimulationDataData[j].W(simdat.X[i]) - W(simdat.X[i]);
-	      }
-
-	      //This is Z^{-1} \exp[(\gamma_i- \gamma) \cdot X + W_i(X) - W(X)]
-	      sum2 += exp(dot - SimulationDataData[j].logZ);
-	    }
-	  
-	  //simdat.Probability is H(X,\gamma), in the input H is
-	  //normalised. Thus this assumes that all simulations are of
-	  //the same statistical weight! (This is true for results
-	  //from a single replica exchange simulation)
-	  sum1 += simdat.Probability / sum2;
-	}
-   
-    return log(sum1);
-  }
-  
-  void recalc_newlogZ(size_t bottom, size_t top) 
-  { 
-    if (!refZ) new_logZ = calc_logZ(bottom, top); 
-  }
-
-  long double calc_error()
-  { 
-    //Return an error of 0 if this is the reference simulation!
-    if (refZ) return 0;
-
-    //In case of new_logZ going to zero don't use relative values
-    if (new_logZ == 0)
-      {
-	if (logZ == 0)
-	  return 0;
-	else
-	  return fabs((new_logZ - logZ) / logZ);
-      }
-    else
-      return fabs((new_logZ - logZ) / new_logZ);
-  }
-
-  void iterate_logZ() { logZ = new_logZ; }
-
   inline double W(double E) const 
   { 
     std::unordered_map<int, double>::const_iterator 
@@ -231,133 +172,382 @@ typedef std::vector<densOStatesPair> densOStatesType;
 densOStatesType densOStates;
   
 
-void
-solveWeightsInRange(size_t bottom = 0, size_t top = 0)
+/*! \brief The histograms of all the simulations, combined for each
+    value of X.
+
+  The WHAM equations only depend on the total probability P(X) of
+  each X, summed over all the simulations. The exponents
+  a_j(X)=\gamma_j \cdot X + W_j(X) of every simulation j are
+  precomputed and stored contiguously for each X, so the solver
+  never performs the W lookups.
+*/
+struct PooledHistogram
+{
+  std::vector<SimulationData::histogramEntry::Xtype> X;
+  std::vector<long double> P;
+  std::vector<double> logP;
+  //! The exponents a_j(X), stored as [x * NSims + j]
+  std::vector<double> exponent;
+};
+
+PooledHistogram pooled;
+
+//! The number of X values processed by each task of the thread pool.
+const size_t chunkSize = 256;
+
+/*! \brief Exponentials of arguments below this are taken as zero.
+
+  Floating point underflow is trapped (see main), and these terms are
+  negligible in every sum they appear in.
+*/
+const double minExponent = -300;
+
+inline double cutExp(double x) { return (x < minExponent) ? 0 : std::exp(x); }
+
+//! \brief Calculates \ln\sum_j \exp(a_j - f_j) without overflow.
+template<class T>
+T logSumExp(const double* a, const double* f, size_t N)
+{
+  T max = a[0] - f[0];
+  for (size_t j(1); j < N; ++j)
+    max = std::max<T>(max, a[j] - f[j]);
+
+  T sum = 0;
+  for (size_t j(0); j < N; ++j)
+    {
+      const T arg = a[j] - f[j] - max;
+      if (arg > minExponent) sum += std::exp(arg);
+    }
+
+  return max + std::log(sum);
+}
+
+void poolHistograms()
 {
-  //If top = 0, then use all systems
-  if (top == 0) top = SimulationDataData.size() - 1;
+  densOStatesMap accumilator;
+  for (const SimulationData& dat : SimulationDataData)
+    for (const SimulationData::histogramEntry& simdat : dat.data)
+      accumilator[simdat.X] += simdat.Probability;
 
-  double err = 0.0;
+  if (NGamma != 1) 
+    M_throw() << "For multiple gamma reweighting, one must be designated as E and used in the W lookup";
 
-  do
+  for (const auto& dat : accumilator)
     {
-      for (size_t i = NStepsPerStep; i != 0; --i)
-	{
-	  for (size_t i(bottom); i <= top; ++i)
-	    SimulationDataData[i].recalc_newlogZ(bottom, top);
-	  
-	  for (size_t i(bottom); i <= top; ++i)
-	    SimulationDataData[i].iterate_logZ();
-	}
+      //Empty bins do not contribute to any of the sums
+      if (dat.second <= 0) continue;
 
-      //Now the error checking run
-      err = 0.0;
-      for (size_t i(bottom); i <= top; ++i)
+      pooled.X.push_back(dat.first);
+      pooled.P.push_back(dat.second);
+      pooled.logP.push_back(std::log(dat.second));
+
+      for (const SimulationData& sim : SimulationDataData)
 	{
-	  SimulationDataData[i].recalc_newlogZ(bottom, top);
-	  
-	  if (SimulationDataData[i].calc_error() > err)
-	    err = SimulationDataData[i].calc_error();
+	  long double tmp = sim.W(dat.first[0]);
+	  for (size_t i(0); i < NGamma; ++i)
+	    tmp += sim.gamma[i] * dat.first[i];
+	  pooled.exponent.push_back(tmp);
 	}
+    }
+}
 
-      //May as well use this as an iteration too
-      for (size_t i(bottom); i <= top; ++i)
-	SimulationDataData[i].iterate_logZ();
+size_t chunkCount() { return (pooled.X.size() + chunkSize - 1) / chunkSize; }
 
-      printf("\r%E", err);
-      fflush(stdout);
+/*! \brief Calls func(chunk, begin, end) for each chunk of the X
+    values on the thread pool.
+
+  The chunks do not depend on the number of threads, so reductions
+  carried out in chunk order give identical results for any number
+  of threads.
+*/
+template<class Func>
+void forEachChunk(Func func)
+{
+  const size_t N = pooled.X.size();
+  for (size_t chunk(0); chunk < chunkCount(); ++chunk)
+    threadPool.queueTask(std::bind(func, chunk, chunk * chunkSize, std::min(N, (chunk + 1) * chunkSize)));
+  threadPool.wait();
+}
+
+/*! \brief Calculates the log of the WHAM denominator for every X,
+    D(X)=\ln\sum_j \exp(a_j(X) - \ln Z_j), and returns the objective
+    F=\sum_X P(X) D(X) + \sum_j \ln Z_j.
+
+  F is convex in the \ln Z_j and its stationary point is the solution
+  of the WHAM equations. As in the original equations, this assumes
+  all the simulations are of the same statistical weight (this is
+  true for results from a single replica exchange simulation).
+*/
+double calcObjective(const std::vector<double>& logZ, std::vector<double>& D)
+{
+  const size_t NSims = logZ.size();
+  D.resize(pooled.X.size());
+  std::vector<double> partial(chunkCount(), 0);
+
+  forEachChunk([&](size_t chunk, size_t begin, size_t end)
+	       {
+		 double sum = 0;
+		 for (size_t x(begin); x < end; ++x)
+		   {
+		     D[x] = logSumExp<double>(&pooled.exponent[x * NSims], logZ.data(), NSims);
+		     sum += pooled.P[x] * D[x];
+		   }
+		 partial[chunk] = sum;
+	       });
+
+  double F = 0;
+  for (const double& val : partial) F += val;
+  for (const double& val : logZ) F += val;
+  return F;
+}
+
+/*! \brief The direct WHAM iteration, \ln Z_k = \ln\sum_X P(X)
+    \exp(a_k(X) - D(X)), under-relaxed by alpha.
+
+  The first (reference) simulation is held at \ln Z = 0.
+*/
+void selfConsistentStep(std::vector<double>& logZ, const std::vector<double>& D)
+{
+  const size_t NSims = logZ.size();
+  std::vector<double> chunkMax(chunkCount() * NSims), chunkSum(chunkCount() * NSims, 0);
+
+  forEachChunk([&](size_t chunk, size_t begin, size_t end)
+	       {
+		 double* max = &chunkMax[chunk * NSims];
+		 double* sum = &chunkSum[chunk * NSims];
+		 for (size_t k(0); k < NSims; ++k)
+		   max[k] = pooled.logP[begin] + pooled.exponent[begin * NSims + k] - D[begin];
+
+		 for (size_t x(begin + 1); x < end; ++x)
+		   for (size_t k(0); k < NSims; ++k)
+		     max[k] = std::max(max[k], pooled.logP[x] + pooled.exponent[x * NSims + k] - D[x]);
+
+		 for (size_t x(begin); x < end; ++x)
+		   for (size_t k(0); k < NSims; ++k)
+		     sum[k] += cutExp(pooled.logP[x] + pooled.exponent[x * NSims + k] - D[x] - max[k]);
+	       });
+
+  for (size_t k(1); k < NSims; ++k)
+    {
+      double max = chunkMax[k];
+      for (size_t chunk(1); chunk < chunkCount(); ++chunk)
+	max = std::max(max, chunkMax[chunk * NSims + k]);
+
+      double sum = 0;
+      for (size_t chunk(0); chunk < chunkCount(); ++chunk)
+	sum += chunkSum[chunk * NSims + k] * cutExp(chunkMax[chunk * NSims + k] - max);
+
+      logZ[k] += alpha * (max + std::log(sum) - logZ[k]);
     }
-  while(err > minErr);
 }
 
-void
-solveWeightsPiecemeal()
+/*! \brief Calculates the gradient g and Hessian H (row-major) of the
+    objective with respect to the \ln Z_k.
+
+  With \pi_k(X)=\exp(a_k(X) - \ln Z_k - D(X)), these are
+  g_k=1-\sum_X P(X)\pi_k(X) and H_{kl}=\sum_X P(X)(\delta_{kl}\pi_k(X)
+  - \pi_k(X)\pi_l(X)).
+*/
+void calcDerivatives(const std::vector<double>& logZ, const std::vector<double>& D, 
+		     std::vector<double>& g, std::vector<double>& H)
 {
-  std::cout << "##################################################\n";
-  std::cout << "Solving for Z's, in a rolling piecemeal fashion\n";
+  const size_t NSims = logZ.size();
+  std::vector<double> chunkG(chunkCount() * NSims, 0), chunkH(chunkCount() * NSims * NSims, 0);
+
+  forEachChunk([&](size_t chunk, size_t begin, size_t end)
+	       {
+		 double* gc = &chunkG[chunk * NSims];
+		 double* Hc = &chunkH[chunk * NSims * NSims];
+		 //u_k = \sqrt{P(X)}\pi_k(X)
+		 std::vector<double> u(NSims);
+		 for (size_t x(begin); x < end; ++x)
+		   {
+		     const double sqrtP = cutExp(0.5 * pooled.logP[x]);
+		     for (size_t k(0); k < NSims; ++k)
+		       u[k] = cutExp(0.5 * pooled.logP[x] + pooled.exponent[x * NSims + k] - logZ[k] - D[x]);
+
+		     for (size_t k(0); k < NSims; ++k)
+		       {
+			 const double Ppi = sqrtP * u[k];
+			 gc[k] += Ppi;
+			 Hc[k * NSims + k] += Ppi;
+			 for (size_t l(0); l <= k; ++l)
+			   Hc[k * NSims + l] -= u[k] * u[l];
+		       }
+		   }
+	       });
+
+  g.assign(NSims, 1);
+  H.assign(NSims * NSims, 0);
+  for (size_t chunk(0); chunk < chunkCount(); ++chunk)
+    for (size_t k(0); k < NSims; ++k)
+      {
+	g[k] -= chunkG[chunk * NSims + k];
+	for (size_t l(0); l <= k; ++l)
+	  H[k * NSims + l] += chunkH[(chunk * NSims + k) * NSims + l];
+      }
 
-  size_t startingPieceSize = 5;
+  for (size_t k(0); k < NSims; ++k)
+    for (size_t l(0); l < k; ++l)
+      H[l * NSims + k] = H[k * NSims + l];
+}
 
-  size_t stoppingPieceSize = SimulationDataData.size() / 2 + 1;
-  
-  if (startingPieceSize > SimulationDataData.size()) startingPieceSize = SimulationDataData.size();
+/*! \brief Solves A x = b in place for a symmetric positive definite
+    A (row-major, N x N) by Cholesky decomposition.
 
-  for (size_t pieceSize = startingPieceSize; pieceSize < stoppingPieceSize; pieceSize += 5)
+  \return false if A is not positive definite.
+*/
+bool choleskySolve(std::vector<double> A, std::vector<double>& b, size_t N)
+{
+  for (size_t j(0); j < N; ++j)
     {
-      for (SimulationData& simdat : SimulationDataData)
-	simdat.refZ = false;
+      double diag = A[j * N + j];
+      for (size_t k(0); k < j; ++k)
+	diag -= A[j * N + k] * A[j * N + k];
 
-      //Set the first system as the reference point
-      SimulationDataData.front().refZ = true;
-      
-      std::cout << "\rSolving 0 to " << pieceSize << ", Long iteration step\n";
-      //Now solve the first piece.
-      solveWeightsInRange(0, pieceSize);
-      
-      for (size_t bottom(1), top(pieceSize + 1); top < SimulationDataData.size(); ++bottom, ++top)
+      if (!(diag > 0)) return false;
+      A[j * N + j] = std::sqrt(diag);
+
+      for (size_t i(j + 1); i < N; ++i)
 	{
-	  //Freeze the lower half of the last set of systems 
-	  
-	  //This is required for the first iterations but only one system
-	  //is frozen per further iteration
-	  for (size_t i = bottom-1; i < bottom + (top-bottom)/2; ++i )
-	    SimulationDataData[i].refZ = true;
-	  
-	  std::cout << "\rSolving " << bottom << " to " << top << "\n";
-	  solveWeightsInRange(bottom, top);
+	  double val = A[i * N + j];
+	  for (size_t k(0); k < j; ++k)
+	    val -= A[i * N + k] * A[j * N + k];
+	  A[i * N + j] = val / A[j * N + j];
 	}
     }
-  
-  for (SimulationData& simdat : SimulationDataData)
-    simdat.refZ = false;
 
-  //Set the first system as the reference point
-  SimulationDataData.front().refZ = true;
+  for (size_t i(0); i < N; ++i)
+    {
+      for (size_t k(0); k < i; ++k)
+	b[i] -= A[i * N + k] * b[k];
+      b[i] /= A[i * N + i];
+    }
 
-  std::cout << "\rFinal Solution step 0 to " << SimulationDataData.size()-1 << "\n";
-  solveWeightsInRange();
+  for (size_t i(N); i-- > 0;)
+    {
+      for (size_t k(i + 1); k < N; ++k)
+	b[i] -= A[k * N + i] * b[k];
+      b[i] /= A[i * N + i];
+    }
 
-  std::cout << "\nIteration complete\n";
+  return true;
 }
 
+/*! \brief Solves the WHAM equations for the \ln Z of all the
+    simulations at once.
 
-void calcDensityOfStates()
+  After NStepsPerStep direct iterations, the convex objective of
+  calcObjective() is minimised by Newton-Raphson with a backtracking
+  line search, which converges quadratically where the direct
+  iteration slows to a crawl for poorly overlapping histograms. The
+  first simulation is the reference point with \ln Z = 0.
+*/
+void solveWeights()
 {
-  densOStates.clear();
-
-  densOStatesMap accumilator;
   std::cout << "##################################################\n";
-  std::cout << "Density of states\n";
+  std::cout << "Solving for Z's, " << NStepsPerStep << " direct iterations then Newton-Raphson\n";
 
-  //Sum up the histogram entries for each value of X
-  for (const SimulationData& dat : SimulationDataData)
-    for (const SimulationData::histogramEntry& simdat : dat.data)
-    accumilator[simdat.X] += simdat.Probability;
+  const size_t NSims = SimulationDataData.size();
+  std::vector<double> logZ(NSims, 0), D;
+
+  double F = calcObjective(logZ, D);
+  for (size_t i(0); i < NStepsPerStep; ++i)
+    {
+      selfConsistentStep(logZ, D);
+      F = calcObjective(logZ, D);
+    }
 
-  //For each X, calculate the density of states
-  for (const densOStatesPair& dat : accumilator)
+  const size_t N = NSims - 1;
+  std::vector<double> g, H, A, step, trial, trialD;
+  for (size_t iteration(0); N; ++iteration)
     {
-      //First work out the divisor
-      long double sum = 0.0;
-      for (const SimulationData& dat2 : SimulationDataData)
+      calcDerivatives(logZ, D, g, H);
+
+      double err = 0;
+      for (size_t k(1); k < NSims; ++k)
+	err = std::max(err, std::fabs(g[k]));
+
+      printf("\r%E", err);
+      fflush(stdout);
+
+      if (err < minErr) break;
+
+      if (iteration == maxIterations)
+	M_throw() << "The WHAM equations did not converge after " << maxIterations << " iterations, the remaining error is " << err;
+
+      //Solve for the Newton step of the free \ln Z's, adding a ridge
+      //to the Hessian if it is numerically singular
+      double ridge = 0;
+      do
 	{
-	  long double tmp = 0;
+	  A.resize(N * N);
+	  step.resize(N);
+	  for (size_t i(0); i < N; ++i)
+	    {
+	      for (size_t j(0); j < N; ++j)
+		A[i * N + j] = H[(i + 1) * NSims + j + 1];
+	      A[i * N + i] += ridge;
+	      step[i] = -g[i + 1];
+	    }
+	  ridge = (ridge == 0) ? 1e-12 * A[0] + minErr : ridge * 10;
+	}
+      while (!choleskySolve(A, step, N));
 
-	  //Adding in the W factor
-	  if (NGamma != 1) 
-	    M_throw() << "For multiple gamma reweighting, one must be designated as E and used in the W lookup";
+      double slope = 0;
+      for (size_t i(0); i < N; ++i)
+	slope += g[i + 1] * step[i];
 
-	  tmp += dat2.W(dat.first[0]);
+      //Backtracking line search, the full step is also taken if the
+      //change in the objective is lost in its rounding error
+      bool accepted = false;
+      for (double t = 1; t > 1e-10; t *= 0.5)
+	{
+	  trial = logZ;
+	  for (size_t i(0); i < N; ++i)
+	    trial[i + 1] += t * step[i];
 
-	  for (size_t i(0); i < NGamma; ++i)
-	    tmp += dat2.gamma[i] * dat.first[i];
+	  const double trialF = calcObjective(trial, trialD);
+	  if ((trialF <= F + 1e-4 * t * slope) 
+	      || ((t == 1) && (std::fabs(trialF - F) <= 1e-14 * std::fabs(F))))
+	    {
+	      logZ.swap(trial);
+	      D.swap(trialD);
+	      F = trialF;
+	      accepted = true;
+	      break;
+	    }
+	}
 
-	  sum += exp(tmp - dat2.logZ);
+      if (!accepted)
+	{
+	  selfConsistentStep(logZ, D);
+	  F = calcObjective(logZ, D);
 	}
-      
-      //The sum of the histogram entries is already calculated so just push it on
-      densOStates.push_back(std::make_pair(dat.first, dat.second / sum));
     }
+
+  for (size_t k(0); k < NSims; ++k)
+    SimulationDataData[k].logZ = logZ[k];
+
+  std::cout << "\nIteration complete\n";
+}
+
+void calcDensityOfStates()
+{
+  densOStates.clear();
+
+  std::cout << "##################################################\n";
+  std::cout << "Density of states\n";
+
+  const size_t NSims = SimulationDataData.size();
+  std::vector<double> logZ;
+  for (const SimulationData& dat : SimulationDataData)
+    logZ.push_back(dat.logZ);
+
+  //The density of states may exceed the range of a double, so this
+  //is carried out in long double precision
+  for (size_t x(0); x < pooled.X.size(); ++x)
+    densOStates.push_back(std::make_pair(pooled.X[x], std::exp(std::log(pooled.P[x]) - logSumExp<long double>(&pooled.exponent[x * NSims], logZ.data(), NSims))));
 }
 
 void outputDensityOfStates()
@@ -548,8 +738,9 @@ main(int argc, char *argv[])
     systemopts.add_options()
       ("help", "Produces this message")   
       ("data-file", po::value<std::vector<std::string> >(), "Specify a config file to load, or just list them on the command line")
-      ("alpha", po::value<long double>()->default_value(1), "A fraction of the difference between the old and new logZ's to use, use to stop divergence")
-      ("NSteps,N", po::value<size_t>()->default_value(10), "Number of steps to take before testing the error and spitting out the current vals")
+      ("alpha", po::value<long double>()->default_value(1), "A fraction of the difference between the old and new logZ's to use in the direct iterations, use to stop divergence")
+      ("NSteps,N", po::value<size_t>()->default_value(10), "Number of direct iterations to take before switching to the Newton-Raphson solver")
+      ("n-threads", po::value<unsigned int>(), "Number of threads to use when solving for the weights")
       ("Tmin", po::value<double>(), "Set the coldest temperature to output calculated data for (Cv.out, Energy.out) etc. If unset this defaults to the temperature of the coldest simulation.")
       ("Tmax", po::value<double>(), "Set the hottest temperature to output calculated data for (Cv.out, Energy.out) etc. If unset this defaults to the temperature of the hottest simulation.")
       ;
@@ -570,6 +761,8 @@ main(int argc, char *argv[])
 
     alpha = vm["alpha"].as<long double>();
     NStepsPerStep = vm["NSteps"].as<size_t>();
+    if (vm.count("n-threads"))
+      threadPool.setThreadCount(vm["n-threads"].as<unsigned int>());
 
     //Data load
     for (std::string fileName : vm["data-file"].as<std::vector<std::string> >())
@@ -606,7 +799,8 @@ main(int argc, char *argv[])
     for (const SimulationData& dat : SimulationDataData)
       std::cout << dat.fileName << " NData = " << dat.data.size() << " gamma[0] = " << dat.gamma[0] << "\n";
 
-    solveWeightsPiecemeal();
+    poolHistograms();
+    solveWeights();
     
     std::cout << "##################################################\n";
     for (const SimulationData& dat : SimulationDataData)
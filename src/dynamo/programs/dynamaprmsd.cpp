@@ -0,0 +1,247 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <magnet/xmlreader.hpp>
+#include <magnet/exception.hpp>
+#include <magnet/math/rmsd.hpp>
+#include <magnet/thread/threadpool.hpp>
+#include "structureimages.hpp"
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+
+struct FileData
+{
+  std::string fileName;
+  double temperature;
+  std::vector<Structure> structures;
+  std::vector<magnet::math::ContactMap> cmaps;
+  //! \brief The contact map overlap of every pair of structures, stored row-major.
+  std::vector<double> overlap;
+  //! \brief The structure with the lowest total overlap with all others.
+  size_t minimum;
+  double minimumAverage;
+
+  double operator()(size_t i, size_t j) const { return overlap[i * structures.size() + j]; }
+};
+
+/*! \brief Write a structure as an OOGL VECT file and a Tinker xyz
+    file.
+
+  If a configuration file is given, the atoms of a SquareWellSeq
+  sequence with a letter containing a "1" are written as oxygen.
+*/
+void printStructure(const Structure& structure, const std::string& fileName, const std::vector<std::string>& letters)
+{
+  std::ofstream f(fileName.c_str()), g((fileName + ".txyz").c_str());
+  f.precision(12);
+  f << "{VECT 1 " << structure.size() << " 0 \n" << structure.size() << "\n0\n";
+  g << structure.size() << " RMSDimage\n";
+  for (size_t i(0); i < structure.size(); ++i)
+    {
+      f << structure[i][0] << " " << structure[i][1] << " " << structure[i][2] << "\n";
+      const char* atom = ((i < letters.size()) && (letters[i].find('1') != std::string::npos)) ? "O" : "C";
+      char coords[64];
+      std::snprintf(coords, sizeof(coords), "%15.10f %15.10f %15.10f", structure[i][0], structure[i][1], structure[i][2]);
+      //Each atom is bonded to the previous one, the first to the third
+      g << i + 1 << " " << atom << " " << coords << " " << atom << " " << (i ? i : 2) << "\n";
+    }
+  f << "}\n";
+}
+
+//! \brief Write the fraction of the structures of a cluster with each contact.
+void contactHistogram(const std::vector<size_t>& members, const std::vector<magnet::math::ContactMap>& cmaps, const size_t name)
+{
+  std::ofstream f(("CMapHist." + std::to_string(name) + ".dat").c_str());
+  f.precision(12);
+  const size_t N = cmaps.front().size();
+  for (size_t i(0); i < N; ++i)
+    {
+      for (size_t j(0); j < N; ++j)
+	{
+	  size_t count = 0;
+	  if (i != j)
+	    for (const size_t& member : members)
+	      count += cmaps[member](i, j);
+	  f << double(count) / members.size() << " ";
+	}
+      f << "\n";
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+  namespace po = boost::program_options;
+
+  try {
+    po::options_description systemopts("Program Options");
+    systemopts.add_options()
+      ("help", "Produces this message")
+      ("data-file", po::value<std::vector<std::string> >(), "Specify an output file with StructureImages to load, or just list them on the command line")
+      ("sigma", po::value<double>()->default_value(1.0), "The diameter of the atoms")
+      ("lambda", po::value<double>()->default_value(1.5), "The well width of the atoms, in units of sigma")
+      ("skip", po::value<size_t>()->default_value(0), "The number of neighbours along the chain of each atom to exclude from the contact map overlap")
+      ("cutoff", po::value<double>()->default_value(0.8), "Lower value of the contact map overlap to be within the same cluster")
+      ("threshold", po::value<size_t>()->default_value(5), "Set minimum number of configurations to form a cluster")
+      ("maxstructs", po::value<size_t>()->default_value(100), "The maximum number of structures to load from each file")
+      ("config", po::value<std::string>(), "A configuration file with a SquareWellSeq interaction, to label the atoms of the cluster structures")
+      ("n-threads", po::value<unsigned int>(), "Number of threads to use when calculating the contact map overlaps")
+      ;
+
+    po::positional_options_description p;
+    p.add("data-file", -1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(systemopts).positional(p).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help") || !vm.count("data-file"))
+      {
+	std::cerr << "Usage : dynamaprmsd <OPTION>...<data-file(s)>\n"
+		  << "Clusters the StructureImages of DynamO output files by the overlap of their contact maps\n"
+		  << systemopts << "\n";
+	return 1;
+      }
+
+    const double cutoff = vm["cutoff"].as<double>();
+    const double sigma = vm["sigma"].as<double>();
+    const double lambda = vm["lambda"].as<double>();
+    const size_t threshold = vm["threshold"].as<size_t>();
+
+    magnet::thread::ThreadPool pool;
+    if (vm.count("n-threads"))
+      pool.setThreadCount(vm["n-threads"].as<unsigned int>());
+
+    const std::vector<std::string> letters = getSequenceLetters(vm.count("config") ? vm["config"].as<std::string>() : std::string());
+
+    std::vector<FileData> filedata;
+    for (const std::string& fileName : vm["data-file"].as<std::vector<std::string> >())
+      {
+	std::cout << "Processing file " << fileName << "\n";
+	if (!boost::filesystem::exists(fileName))
+	  M_throw() << "Could not find the file " << fileName;
+
+	FileData data;
+	{
+	  magnet::xml::Document doc(fileName);
+	  magnet::xml::Node mainNode = doc.getNode("OutputData");
+	  data.fileName = fileName;
+	  data.temperature = getTemperature(mainNode);
+	  data.structures = getStructures(mainNode, vm["maxstructs"].as<size_t>());
+	}
+
+	//The separations are compared against (lambda sigma)^2, which is
+	//kept for consistency with earlier results of this analysis
+	for (const Structure& structure : data.structures)
+	  data.cmaps.push_back(magnet::math::ContactMap(structure, lambda * lambda * sigma * sigma));
+
+	const size_t N = data.structures.size();
+	const std::vector<uint64_t> mask = magnet::math::ContactMap::mask(N ? data.structures.front().size() : 0, vm["skip"].as<size_t>());
+	data.overlap.assign(N * N, 0);
+	magnet::math::forEachPair(N, pool, [&](size_t i, size_t j)
+				  {
+				    data.overlap[i * N + j] = data.overlap[j * N + i] 
+				      = magnet::math::ContactMap::overlap(data.cmaps[i], data.cmaps[j], mask);
+				  });
+
+	const std::pair<size_t, double> minimum = lowestRowSum(data.overlap, N);
+	data.minimum = minimum.first;
+	data.minimumAverage = minimum.second;
+
+	filedata.push_back(data);
+      }
+
+    std::stable_sort(filedata.begin(), filedata.end(),
+		     [](const FileData& a, const FileData& b) { return a.temperature < b.temperature; });
+
+    for (const FileData& data : filedata)
+      {
+	const double delx = 1.0 / 100;
+	std::ofstream f((data.fileName + ".crmsdhist").c_str()), g((data.fileName + ".crmsdarray").c_str());
+	f.precision(12);
+	g.precision(12);
+
+	for (size_t i(0); i < data.structures.size(); ++i)
+	  {
+	    for (size_t j(0); j < data.structures.size(); ++j)
+	      g << data(i, j) << " ";
+	    g << "\n";
+	  }
+
+	const std::vector<double> hist = pairHistogram(data.overlap, data.structures.size(), 100, delx);
+	for (size_t i(0); i < hist.size(); ++i)
+	  f << (i + 0.5) * delx << " " << hist[i] << "\n";
+      }
+
+    {
+      const double delx = 5.0 / 100;
+      std::ofstream f("crmsdhistsurface.dat");
+      f.precision(12);
+      for (const FileData& data : filedata)
+	{
+	  const std::vector<double> hist = pairHistogram(data.overlap, data.structures.size(), 101, delx);
+	  for (size_t i(0); i < hist.size(); ++i)
+	    f << data.temperature << " " << (i + 0.5) * delx << " " << hist[i] << "\n";
+	  f << " \n";
+	}
+    }
+
+    std::ofstream f("cclusters.dat"), g("cclusterfraction.dat"), h("cavgrmsd.dat");
+    f.precision(12);
+    g.precision(12);
+    h.precision(12);
+    for (const FileData& data : filedata)
+      {
+	const std::vector<magnet::math::Cluster> clusters
+	  = magnet::math::greedyClusters(data.structures.size(),
+					 [&](size_t i, size_t j) { return data(i, j) > cutoff; }, threshold);
+
+	if (filedata.size() == 1)
+	  for (const magnet::math::Cluster& cluster : clusters)
+	    {
+	      std::cout << "Printing structure number " << cluster.centre << "\n";
+	      printStructure(data.structures[cluster.centre], "Cluster" + std::to_string(cluster.centre) + ".list", letters);
+	      contactHistogram(cluster.members, data.cmaps, cluster.centre);
+	      for (const magnet::math::Cluster& cluster2 : clusters)
+		std::cout << "  Struct " << cluster.centre << " rmsd vs struct " << cluster2.centre
+			  << " = " << data(cluster.centre, cluster2.centre) << "\n";
+	    }
+
+	size_t sum = 0;
+	for (const magnet::math::Cluster& cluster : clusters)
+	  sum += cluster.members.size();
+
+	f << data.temperature << " " << clusters.size() << "\n";
+	g << data.temperature << " " << double(sum) / data.structures.size() << "\n";
+	h << data.temperature << " " << data.minimumAverage << " " << data.minimum << "\n";
+      }
+  }
+  catch (std::exception& cep)
+    {
+      std::cout.flush();
+      std::cerr << cep.what() << "\nMAIN: Reached Main Error Loop\n";
+      return 1;
+    }
+}
@@ -0,0 +1,82 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <magnet/xmlreader.hpp>
+#include <magnet/exception.hpp>
+#include <iostream>
+#include <string>
+
+int
+main(int argc, char *argv[])
+{
+  if (argc == 1)
+    {
+      std::cout << "dynamo2xyz CONFIG-FILE-NAME1 [CONFIG-FILE-NAME2]\n"
+		<< " This program converts a dynamo configuration file to xyz format\n"
+		<< " and prints it on the screen. To save this conversion, just\n"
+		<< "redirect it to a file. For example,\n"
+		<< "  dynamo2xyz config.out.xml.bz2 > config.xyz\n"
+		<< "If multiple file names are given, they are stitched together,\n"
+		<< "in order, to make an animation file.\n";
+      return 1;
+    }
+
+  try {
+    size_t particleCount = 0;
+    for (int arg(1); arg < argc; ++arg)
+      {
+	const std::string fileName(argv[arg]);
+	magnet::xml::Document doc(fileName);
+	magnet::xml::Node particleData = doc.getNode("DynamOconfig").getNode("ParticleData");
+
+	//All files need the same number of particles inside them
+	size_t currentParticleCount = 0;
+	for (magnet::xml::Node node = particleData.findNode("Pt"); node.valid(); ++node)
+	  ++currentParticleCount;
+
+	if (arg == 1)
+	  particleCount = currentParticleCount;
+
+	if (particleCount != currentParticleCount)
+	  M_throw() << "input file " << fileName << " has " << currentParticleCount
+		    << " particles, but all files must have the same number of particles. The first file has "
+		    << particleCount;
+
+	//line 1: number of particles, line 2: molecule name, then the
+	//atom name, position and velocity of each particle. The values
+	//are copied verbatim from the configuration file.
+	std::cout << particleCount << "\nDynamOdata\n";
+	for (magnet::xml::Node node = particleData.findNode("Pt"); node.valid(); ++node)
+	  {
+	    const magnet::xml::Node pos = node.getNode("P"), vel = node.getNode("V");
+	    std::cout << "H "
+		      << pos.getAttribute("x").getValue() << " "
+		      << pos.getAttribute("y").getValue() << " "
+		      << pos.getAttribute("z").getValue() << " "
+		      << vel.getAttribute("x").getValue() << " "
+		      << vel.getAttribute("y").getValue() << " "
+		      << vel.getAttribute("z").getValue() << "\n";
+	  }
+      }
+  }
+  catch (std::exception& cep)
+    {
+      std::cout.flush();
+      std::cerr << cep.what() << "\nMAIN: Reached Main Error Loop\n";
+      return 1;
+    }
+}
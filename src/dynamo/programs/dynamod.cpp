@@ -157,6 +157,9 @@ main(int argc, char *argv[])
       else
 	sim.loadXMLfile(vm["config-file"].as<string>());
 
+      if (vm.count("random-seed"))
+	sim.randomStreamSeed = vm["random-seed"].as<unsigned int>();
+
       sim.endEventCount = 0;
 
       if (vm.count("thermostat"))
@@ -0,0 +1,286 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <magnet/xmlreader.hpp>
+#include <magnet/exception.hpp>
+#include <magnet/thread/threadpool.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <cmath>
+
+/*! \brief A linear fit of the running integral of a correlator
+    against time.
+
+  The slope of the Einstein form of a correlator is the transport
+  coefficient.
+*/
+struct Fit
+{
+  double slope;
+  double intercept;
+  double R2;
+};
+
+//! \brief The population variance of a set of values.
+double variance(const std::vector<double>& vals)
+{
+  if (vals.empty())
+    M_throw() << "Can only find the average of a list with non-zero length";
+
+  double mean = 0;
+  for (const double& val : vals) mean += val;
+  mean /= vals.size();
+
+  double var = 0;
+  for (const double& val : vals) var += (val - mean) * (val - mean);
+  return var / vals.size();
+}
+
+double average(const std::vector<double>& vals)
+{
+  if (vals.empty())
+    M_throw() << "Can only find the average of a list with non-zero length";
+
+  double sum = 0;
+  for (const double& val : vals) sum += val;
+  return sum / vals.size();
+}
+
+/*! \brief The rows of a correlator, with the values of all its
+    Component's (the CC, CI, IC and II terms) summed.
+
+  Each row holds the time, the sample count and the values. Only rows
+  with a time within [startTime, cutoffTime] are kept.
+*/
+typedef std::vector<std::vector<double> > CorrelatorData;
+
+CorrelatorData parseCorrelator(const magnet::xml::Node& correlator, const double startTime, const double cutoffTime)
+{
+  CorrelatorData data;
+  bool first = true;
+  for (magnet::xml::Node component = correlator.findNode("Component"); component.valid(); ++component)
+    {
+      std::istringstream text(component.getValue());
+      CorrelatorData componentData;
+      for (std::string line; std::getline(text, line);)
+	{
+	  std::istringstream lineStream(line);
+	  std::vector<double> row;
+	  for (double val; lineStream >> val;)
+	    row.push_back(val);
+
+	  if ((row.size() > 1) && (row[0] >= startTime) && (row[0] <= cutoffTime))
+	    componentData.push_back(row);
+	}
+
+      if (first)
+	{
+	  data = componentData;
+	  first = false;
+	  continue;
+	}
+
+      if (componentData.size() != data.size())
+	M_throw() << "Mismatched Component lengths in the correlator at " << correlator.getPath();
+
+      for (size_t r(0); r < data.size(); ++r)
+	for (size_t c(2); c < std::min(data[r].size(), componentData[r].size()); ++c)
+	  data[r][c] += componentData[r][c];
+    }
+
+  return data;
+}
+
+//! \brief Least squares fit of the average of the columns against time.
+Fit fitData(const std::vector<size_t>& columns, const CorrelatorData& data)
+{
+  if (data.empty())
+    M_throw() << "No correlator data remains to be fitted, check the --start-time and --cutoff-time";
+
+  std::vector<double> x, y;
+  for (const std::vector<double>& row : data)
+    {
+      double sum = 0;
+      for (const size_t& column : columns)
+	{
+	  if (column >= row.size())
+	    M_throw() << "Correlator row has too few columns";
+	  sum += row[column];
+	}
+      x.push_back(row[0]);
+      y.push_back(sum / columns.size());
+    }
+
+  const double xmean = average(x), ymean = average(y);
+  double sxx = 0, sxy = 0;
+  for (size_t i(0); i < x.size(); ++i)
+    {
+      sxx += (x[i] - xmean) * (x[i] - xmean);
+      sxy += (x[i] - xmean) * (y[i] - ymean);
+    }
+
+  Fit fit;
+  fit.slope = (sxx == 0) ? 0 : sxy / sxx;
+  fit.intercept = ymean - fit.slope * xmean;
+
+  std::vector<double> residuals;
+  for (size_t i(0); i < x.size(); ++i)
+    residuals.push_back(fit.slope * x[i] + fit.intercept - y[i]);
+
+  const double SSreg = variance(residuals), SStot = variance(y);
+  fit.R2 = ((SSreg == 0) && (SStot == 0)) ? 1.0 : 1.0 - SSreg / SStot;
+  return fit;
+}
+
+struct TransportData
+{
+  std::vector<Fit> shearViscosity;
+  std::vector<Fit> bulkViscosity;
+  std::vector<Fit> thermalConductivity;
+  std::map<std::string, std::vector<Fit> > thermalDiffusion;
+  std::map<std::string, std::vector<Fit> > mutualDiffusion;
+};
+
+void output(const std::string& title, const std::vector<Fit>& fits)
+{
+  std::vector<double> slopes, R2s;
+  for (const Fit& fit : fits)
+    {
+      slopes.push_back(fit.slope);
+      R2s.push_back(fit.R2);
+    }
+
+  std::cout << title << " " << average(slopes) << " +- " << std::sqrt(variance(slopes))
+	    << " <R>^2= " << average(R2s) << "\n";
+}
+
+int
+main(int argc, char *argv[])
+{
+  namespace po = boost::program_options;
+
+  try {
+    po::options_description systemopts("Program Options");
+    systemopts.add_options()
+      ("help", "Produces this message")
+      ("data-file", po::value<std::vector<std::string> >(), "Specify an output file to load, or just list them on the command line")
+      ("cutoff-time,c", po::value<double>()->default_value(1e300), "The time beyond which data from the correlators are discarded.")
+      ("start-time,s", po::value<double>()->default_value(0), "The amount of time to discard data at the start of the correlator.")
+      ("n-threads", po::value<unsigned int>(), "Number of threads to use when loading the output files")
+      ;
+
+    po::positional_options_description p;
+    p.add("data-file", -1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(systemopts).positional(p).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help") || !vm.count("data-file"))
+      {
+	std::cerr << "Usage : dynatransport <OPTION>...<data-file(s)>\n"
+		  << "Fits the Einstein correlators of the transport coefficients in DynamO output files\n"
+		  << systemopts << "\n";
+	return 1;
+      }
+
+    const double startTime = vm["start-time"].as<double>();
+    const double cutoffTime = vm["cutoff-time"].as<double>();
+    const std::vector<std::string> fileNames = vm["data-file"].as<std::vector<std::string> >();
+
+    for (const std::string& fileName : fileNames)
+      if (!boost::filesystem::exists(fileName))
+	M_throw() << "Could not find the passed datafile! (" << fileName << ")";
+
+    //The files are parsed concurrently, but their fits are stored in
+    //file order, so the output does not depend on the thread count.
+    std::vector<TransportData> fileData(fileNames.size());
+    magnet::thread::ThreadPool pool;
+    if (vm.count("n-threads"))
+      pool.setThreadCount(vm["n-threads"].as<unsigned int>());
+
+    for (size_t f(0); f < fileNames.size(); ++f)
+      pool.queueTask([&, f]()
+		     {
+		       magnet::xml::Document doc(fileNames[f]);
+		       magnet::xml::Node mainNode = doc.getNode("OutputData");
+		       if (!mainNode.hasNode("Misc"))
+			 return;
+		       magnet::xml::Node misc = mainNode.getNode("Misc");
+		       TransportData& data = fileData[f];
+
+		       if (misc.hasNode("Viscosity"))
+			 for (magnet::xml::Node node = misc.getNode("Viscosity").findNode("Correlator"); node.valid(); ++node)
+			   {
+			     const CorrelatorData corr = parseCorrelator(node, startTime, cutoffTime);
+			     data.shearViscosity.push_back(fitData({3, 4, 7}, corr));
+			     data.bulkViscosity.push_back(fitData({2, 6, 10}, corr));
+			   }
+
+		       if (misc.hasNode("ThermalConductivity"))
+			 for (magnet::xml::Node node = misc.getNode("ThermalConductivity").findNode("Correlator"); node.valid(); ++node)
+			   data.thermalConductivity.push_back(fitData({2, 3, 4}, parseCorrelator(node, startTime, cutoffTime)));
+
+		       if (misc.hasNode("ThermalDiffusion"))
+			 for (magnet::xml::Node node = misc.getNode("ThermalDiffusion").findNode("Correlator"); node.valid(); ++node)
+			   data.thermalDiffusion[node.getAttribute("Species").as<std::string>()]
+			     .push_back(fitData({2, 3, 4}, parseCorrelator(node, startTime, cutoffTime)));
+
+		       if (misc.hasNode("MutualDiffusion"))
+			 for (magnet::xml::Node node = misc.getNode("MutualDiffusion").findNode("Correlator"); node.valid(); ++node)
+			   data.mutualDiffusion[node.getAttribute("Species1").as<std::string>() + "," + node.getAttribute("Species2").as<std::string>()]
+			     .push_back(fitData({2, 3, 4}, parseCorrelator(node, startTime, cutoffTime)));
+		     });
+    pool.wait();
+
+    TransportData total;
+    for (const TransportData& data : fileData)
+      {
+	total.shearViscosity.insert(total.shearViscosity.end(), data.shearViscosity.begin(), data.shearViscosity.end());
+	total.bulkViscosity.insert(total.bulkViscosity.end(), data.bulkViscosity.begin(), data.bulkViscosity.end());
+	total.thermalConductivity.insert(total.thermalConductivity.end(), data.thermalConductivity.begin(), data.thermalConductivity.end());
+	for (const auto& entry : data.thermalDiffusion)
+	  total.thermalDiffusion[entry.first].insert(total.thermalDiffusion[entry.first].end(), entry.second.begin(), entry.second.end());
+	for (const auto& entry : data.mutualDiffusion)
+	  total.mutualDiffusion[entry.first].insert(total.mutualDiffusion[entry.first].end(), entry.second.begin(), entry.second.end());
+      }
+
+    std::cout.precision(12);
+    output("ShearViscosityL_{\\eta,\\eta}=", total.shearViscosity);
+    output("BulkViscosityL_{\\kappa,\\kappa}=", total.bulkViscosity);
+    output("ThermalConductivityL_{\\lambda,\\lambda}=", total.thermalConductivity);
+
+    for (const auto& entry : total.thermalDiffusion)
+      output("ThermalDiffusionL_{\\lambda," + entry.first + "}=", entry.second);
+
+    for (const auto& entry : total.mutualDiffusion)
+      output("MutualDiffusionL_{" + entry.first + "}=", entry.second);
+  }
+  catch (std::exception& cep)
+    {
+      std::cout.flush();
+      std::cerr << cep.what() << "\nMAIN: Reached Main Error Loop\n";
+      return 1;
+    }
+}
@@ -0,0 +1,140 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*! \file structureimages.hpp
+  \brief Loading and analysis of the StructureImages output, shared
+  by dynarmsd and dynamaprmsd.
+*/
+
+#pragma once
+#include <magnet/xmlreader.hpp>
+#include <magnet/exception.hpp>
+#include <magnet/math/vector.hpp>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef magnet::math::NVector<double, 3> Vec3;
+typedef std::vector<Vec3> Structure;
+
+inline double getTemperature(const magnet::xml::Node& mainNode)
+{
+  if (mainNode.hasNode("Misc") && mainNode.getNode("Misc").hasNode("Temperature"))
+    return mainNode.getNode("Misc").getNode("Temperature").getAttribute("Mean").as<double>();
+  if (mainNode.hasNode("KEnergy"))
+    return mainNode.getNode("KEnergy").getNode("T").getAttribute("val").as<double>();
+  M_throw() << "Could not find the temperature in the output file";
+}
+
+/*! \brief Load the StructureImages of an output file, keeping at
+    most maxStructures evenly spaced images.
+*/
+inline std::vector<Structure> getStructures(const magnet::xml::Node& mainNode, const size_t maxStructures)
+{
+  std::vector<Structure> structures;
+  for (magnet::xml::Node image = mainNode.getNode("StructureImages").findNode("Image"); image.valid(); ++image)
+    {
+      structures.push_back(Structure());
+      for (magnet::xml::Node atom = image.findNode("Atom"); atom.valid(); ++atom)
+	{
+	  Vec3 pos;
+	  pos << atom;
+	  structures.back().push_back(pos);
+	}
+    }
+
+  std::cout << "Number of structures is " << structures.size() << "\n";
+  if (structures.size() > maxStructures)
+    {
+      std::cout << "Truncating to " << maxStructures << "\n";
+      //Keep the last structure of every stride
+      const size_t stride = structures.size() / maxStructures;
+      std::vector<Structure> kept;
+      for (size_t i(0); i < maxStructures; ++i)
+	kept.push_back(structures[(i + 1) * stride - 1]);
+      structures.swap(kept);
+    }
+
+  return structures;
+}
+
+inline std::vector<std::string> getSequenceLetters(const std::string& configFile)
+{
+  std::vector<std::string> letters;
+  if (configFile.empty()) return letters;
+
+  magnet::xml::Document doc(configFile);
+  magnet::xml::Node interactions = doc.getNode("DynamOconfig").getNode("Simulation").getNode("Interactions");
+  for (magnet::xml::Node node = interactions.findNode("Interaction"); node.valid(); ++node)
+    if (node.getAttribute("Type").getValue() == "SquareWellSeq")
+      for (magnet::xml::Node element = node.getNode("Sequence").findNode("Element"); element.valid(); ++element)
+	{
+	  const size_t ID = element.getAttribute("seqID").as<size_t>();
+	  if (letters.size() <= ID) letters.resize(ID + 1);
+	  letters[ID] = element.getAttribute("Letter").getValue();
+	}
+  return letters;
+}
+
+/*! \brief Histogram the values of each pair i < j of a row-major N x
+    N matrix into bins of width delx.
+
+  Pairs beyond the first 100 bins are discarded, any further bins
+  are left empty.
+*/
+inline std::vector<double> pairHistogram(const std::vector<double>& matrix, const size_t N, const size_t bins, const double delx)
+{
+  std::vector<double> hist(bins, 0);
+  size_t count = 0;
+  for (size_t i(0); i < N; ++i)
+    for (size_t j(i + 1); j < N; ++j)
+      if (matrix[i * N + j] / delx < 100)
+	{
+	  hist[size_t(matrix[i * N + j] / delx)] += 1;
+	  ++count;
+	}
+
+  if (count)
+    for (double& val : hist)
+      val /= count;
+  return hist;
+}
+
+/*! \brief Find the row of a row-major N x N matrix with the lowest
+    sum.
+
+  \return The index of the row and its sum divided by N.
+*/
+inline std::pair<size_t, double> lowestRowSum(const std::vector<double>& matrix, const size_t N)
+{
+  size_t minimum = 0;
+  double minsum = 1e308;
+  for (size_t i(0); i < N; ++i)
+    {
+      double localsum = 0;
+      for (size_t j(0); j < N; ++j)
+	localsum += matrix[i * N + j];
+      if (localsum < minsum)
+	{
+	  minimum = i;
+	  minsum = localsum;
+	}
+    }
+  return std::make_pair(minimum, minsum / N);
+}
@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+#   dynamo:- Event driven molecular dynamics simulator 
+#   http://www.dynamomd.org
+#   Copyright (C) 2009  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+#
+#   This program is free software: you can redistribute it and/or
+#   modify it under the terms of the GNU General Public License
+#   version 3 as published by the Free Software Foundation.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Runs one of the analysis programs on the inputs in
+# tests/analysis/ and compares every file of a reference directory
+# (the output of the Python script the program replaced) against
+# the files the program writes.
+import os
+import sys
+import getopt
+import shutil
+import tempfile
+import subprocess
+
+shortargs=""
+longargs=["exe=", "fixtures=", "reference=", "stdout=", "exact"]
+try:
+    options, args = getopt.gnu_getopt(sys.argv[1:], shortargs, longargs)
+except getopt.GetoptError as err:
+    print(str(err))
+    sys.exit(2)
+
+exe="NOT SET"
+fixtures="NOT SET"
+reference="NOT SET"
+stdout_file=None
+exact=False
+
+for o,a in options:
+    if o == "--exe":
+        exe = a
+    if o == "--fixtures":
+        fixtures = a
+    if o == "--reference":
+        reference = a
+    if o == "--stdout":
+        stdout_file = a
+    if o == "--exact":
+        exact = True
+
+if not(os.path.isfile(exe) and os.access(exe, os.X_OK)):
+    raise RuntimeError("Failed to find the executable at "+exe)
+
+def isclose(a, b):
+    return abs(a-b) <= 1e-9 * max(abs(a), abs(b)) + 1e-12
+
+def compare(reffile, newfile):
+    if not os.path.isfile(newfile):
+        raise RuntimeError("The program did not write "+os.path.basename(newfile))
+    ref = open(reffile, 'rb').read()
+    new = open(newfile, 'rb').read()
+    if exact:
+        if ref != new:
+            raise RuntimeError(os.path.basename(newfile)+" differs from the reference")
+        return
+    #The scripts and programs print numbers with different
+    #formatting, so the files are compared value by value
+    reftokens = ref.split()
+    newtokens = new.split()
+    if len(reftokens) != len(newtokens):
+        raise RuntimeError(os.path.basename(newfile)+" has "+str(len(newtokens))+" values, the reference has "+str(len(reftokens)))
+    for i, (r, n) in enumerate(zip(reftokens, newtokens)):
+        try:
+            same = isclose(float(r), float(n))
+        except ValueError:
+            same = (r == n)
+        if not same:
+            raise RuntimeError(os.path.basename(newfile)+" value "+str(i)+" is "+n.decode()+", the reference is "+r.decode())
+
+workdir = tempfile.mkdtemp()
+try:
+    for name in os.listdir(fixtures):
+        if os.path.isfile(os.path.join(fixtures, name)):
+            shutil.copy(os.path.join(fixtures, name), workdir)
+
+    out = subprocess.check_output([exe] + args, cwd=workdir)
+    if stdout_file is not None:
+        open(os.path.join(workdir, stdout_file), 'wb').write(out)
+
+    for name in sorted(os.listdir(reference)):
+        compare(os.path.join(reference, name), os.path.join(workdir, name))
+        print("Matched "+name)
+finally:
+    shutil.rmtree(workdir)
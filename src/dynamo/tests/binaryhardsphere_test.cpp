@@ -13,6 +13,7 @@
 #include <dynamo/inputplugins/include.hpp>
 #include <dynamo/inputplugins/compression.hpp>
 #include <dynamo/interactions/hardsphere.hpp>
+#include <dynamo/globals/multicells.hpp>
 #include <dynamo/outputplugins/misc.hpp>
 #include <dynamo/outputplugins/msd.hpp>
 #include <random>
@@ -32,7 +33,7 @@ dynamo::Vector getRandVelVec()
   return tmpVec;
 }
 
-void init(dynamo::Simulation& Sim, const double density)
+void init(dynamo::Simulation& Sim, const double density, const bool multicells = false)
 {
   RNG.seed(std::random_device()());
   Sim.ranGenerator.seed(std::random_device()());
@@ -43,6 +44,8 @@ void init(dynamo::Simulation& Sim, const double density)
   Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
   Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
   Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+  if (multicells)
+    Sim.globals.push_back(dynamo::shared_ptr<dynamo::Global>(new dynamo::GMultiCells(&Sim, "SchedulerNBList")));
 
   std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{10, 10, 10}}, dynamo::Vector{1, 1, 1}, new dynamo::UParticle()));
   packptr->initialise();
@@ -136,6 +139,45 @@ BOOST_AUTO_TEST_CASE( Equilibrium_Simulation )
   BOOST_CHECK_MESSAGE(Sim.checkSystem() <= 1, "There are more than two invalid states in the final configuration");
 }
 
+BOOST_AUTO_TEST_CASE( MultiCells_Simulation )
+{
+  {
+    dynamo::Simulation Sim;
+    init(Sim, 1.4, true);
+    Sim.writeXMLfile("BHSMultiCellsequil.xml");
+  }
+
+  dynamo::Simulation Sim;
+  Sim.loadXMLfile("BHSMultiCellsequil.xml");
+
+  Sim.endEventCount = 1000000;
+  Sim.addOutputPlugin("Misc");
+  Sim.initialise();
+  while (Sim.runSimulationStep()) {}
+
+  Sim.reset();
+  Sim.endEventCount = 1000000;
+  Sim.addOutputPlugin("Misc");
+  Sim.initialise();
+
+  //The large and small particles should be in separate levels
+  dynamo::shared_ptr<dynamo::GMultiCells> nblist = std::dynamic_pointer_cast<dynamo::GMultiCells>(Sim.globals["SchedulerNBList"]);
+  BOOST_REQUIRE(nblist);
+  BOOST_CHECK_EQUAL(nblist->getLevelCount(), 2);
+
+  while (Sim.runSimulationStep()) {}
+
+  //The neighbour list must not change the dynamics
+  const double expectedMFT = 0.0098213311089127;
+  dynamo::OPMisc& opMisc = *Sim.getOutputPlugin<dynamo::OPMisc>();
+  BOOST_CHECK_CLOSE(opMisc.getMFT(), expectedMFT, 1);
+
+  const double Temperature = opMisc.getCurrentkT() / Sim.units.unitEnergy();
+  BOOST_CHECK_CLOSE(Temperature, 1.0, 0.000000001);
+
+  BOOST_CHECK_MESSAGE(Sim.checkSystem() <= 1, "There are more than two invalid states in the final configuration");
+}
+
 //BOOST_AUTO_TEST_CASE( Compression_Simulation )
 //{
 //  dynamo::Simulation Sim;
@@ -0,0 +1,117 @@
+#define BOOST_TEST_MODULE CaptureMap_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/dynamics/multicanonical_contactmap.hpp>
+#include <algorithm>
+#include <random>
+
+using namespace dynamo::detail;
+
+std::mt19937 RNG;
+
+PairKey randomPair(size_t N)
+{
+  std::uniform_int_distribution<size_t> dist(0, N - 1);
+  size_t p1 = dist(RNG), p2;
+  do { p2 = dist(RNG); } while (p2 == p1);
+  return PairKey(p1, p2);
+}
+
+BOOST_AUTO_TEST_CASE( Incremental_hash )
+{
+  RNG.seed(1);
+  const size_t N = 20;
+  CaptureMap map;
+
+  for (size_t i(0); i < 2000; ++i)
+    {
+      const PairKey key = randomPair(N);
+      const size_t state = RNG() % 3;
+      const uint64_t predicted = map.hash(key, state);
+      map[key] = state;
+      BOOST_CHECK_EQUAL(map.hash(), predicted);
+    }
+
+  //The hash depends only on the final entries, not the order or
+  //route they were reached by
+  CaptureMap rebuilt;
+  std::vector<std::pair<PairKey, size_t> > entries(map.begin(), map.end());
+  std::reverse(entries.begin(), entries.end());
+  for (const auto& entry : entries)
+    rebuilt[entry.first] = entry.second;
+  BOOST_CHECK_EQUAL(rebuilt.hash(), map.hash());
+  BOOST_CHECK(CaptureMapKey(rebuilt) == CaptureMapKey(map));
+
+  //Releasing every pair returns the hash of the empty map
+  for (const auto& entry : entries)
+    rebuilt[entry.first] = 0;
+  BOOST_CHECK_EQUAL(rebuilt.size(), 0);
+  BOOST_CHECK_EQUAL(rebuilt.hash(), 0);
+
+  map.clear();
+  BOOST_CHECK_EQUAL(map.hash(), 0);
+}
+
+//The distance between two maps, as the original merge-walk in
+//DynNewtonianMCCMap::W calculated it
+size_t distance(const CaptureMapKey& a, const CaptureMapKey& b)
+{
+  size_t distance = 0;
+  for (const auto& entry : a)
+    distance += std::find_if(b.begin(), b.end(), [&](const CaptureMapKey::value_type& o) { return o.first == entry.first; }) == b.end();
+  for (const auto& entry : b)
+    distance += std::find_if(a.begin(), a.end(), [&](const CaptureMapKey::value_type& o) { return o.first == entry.first; }) == a.end();
+  return distance;
+}
+
+BOOST_AUTO_TEST_CASE( Tether_index )
+{
+  RNG.seed(2);
+  const size_t N = 8;
+  std::vector<std::pair<CaptureMapKey, std::pair<size_t, double> > > tethers;
+  TetherIndex index;
+  for (size_t t(0); t < 50; ++t)
+    {
+      CaptureMap tether;
+      for (size_t i(0), n = RNG() % 10; i < n; ++i)
+	tether[randomPair(N)] = 1;
+      const size_t maxdist = 1 + RNG() % 6;
+      const double W = std::uniform_real_distribution<>(-5, 5)(RNG);
+      tethers.push_back(std::make_pair(CaptureMapKey(tether), std::make_pair(maxdist, W)));
+      index.addTether(tethers.back().first, maxdist, W);
+    }
+
+  CaptureMap map;
+  index.reset(map);
+
+  size_t mismatches = 0;
+  for (size_t step(0); step < 5000; ++step)
+    {
+      const PairKey key = randomPair(N);
+      const bool captured = !map[key];
+
+      const std::pair<size_t, double> trial = index.trial(key, captured);
+      index.update(key, captured);
+      map[key] = captured;
+
+      size_t applicable = 0;
+      double W = 0;
+      const CaptureMapKey current(map);
+      for (const auto& tether : tethers)
+	if (distance(tether.first, current) <= tether.second.first)
+	  {
+	    ++applicable;
+	    W += tether.second.second;
+	  }
+
+      mismatches += (trial.first != applicable) || (index.applicable() != applicable)
+	|| (std::abs(trial.second - W) > 1e-8) || (std::abs(index.applicableW() - W) > 1e-8);
+    }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+
+  //A rebuild from the map gives the same result
+  const size_t applicable = index.applicable();
+  const double W = index.applicableW();
+  index.reset(map);
+  BOOST_CHECK_EQUAL(index.applicable(), applicable);
+  BOOST_CHECK_SMALL(index.applicableW() - W, 1e-8);
+}
@@ -0,0 +1,133 @@
+#define BOOST_TEST_MODULE Checkpoint_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/inputplugins/include.hpp>
+#include <dynamo/interactions/squarewell.hpp>
+#include <dynamo/systems/andersenThermostat.hpp>
+#include <random>
+
+std::mt19937 RNG;
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+dynamo::Vector getRandVelVec()
+{
+  std::normal_distribution<> normal_dist(0.0, (1.0 / sqrt(double(NDIM))));
+
+  dynamo::Vector tmpVec;
+  for (size_t iDim = 0; iDim < NDIM; iDim++)
+    tmpVec[iDim] = normal_dist(RNG);
+
+  return tmpVec;
+}
+
+//A square well fluid with an Andersen thermostat, so that the
+//resumed run depends on the captured pairs and the random number
+//generator
+void init(dynamo::Simulation& Sim, long cells = 5, double density = 0.5)
+{
+  RNG.seed(std::random_device()());
+  Sim.ranGenerator.seed(std::random_device()());
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{cells, cells, cells}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+  Sim.primaryCellSize = dynamo::Vector{1,1,1};
+
+  double particleDiam = std::cbrt(density / latticeSites.size());
+
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::ISquareWell(&Sim, particleDiam, 1.5, 1.0, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+  Sim.units.setUnitLength(particleDiam);
+  Sim.units.setUnitTime(particleDiam);
+
+  unsigned long nParticles = 0;
+  Sim.particles.reserve(latticeSites.size());
+  for (const dynamo::Vector & position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position, getRandVelVec() * Sim.units.unitVelocity(), nParticles++));
+
+  Sim.systems.push_back(dynamo::shared_ptr<dynamo::System>(new dynamo::SysAndersen(&Sim, 0.036 / Sim.N(), 1.0 * Sim.units.unitEnergy(), "Thermostat")));
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+
+  dynamo::InputPlugin(&Sim, "Rescaler").zeroMomentum();
+  dynamo::InputPlugin(&Sim, "Rescaler").rescaleVels(1.0);
+}
+
+BOOST_AUTO_TEST_CASE( Exact_Resume )
+{
+  {
+    dynamo::Simulation Sim;
+    init(Sim);
+    Sim.writeXMLfile("CPstart.xml");
+  }
+
+  //A run which is checkpointed half way through
+  dynamo::Simulation Sim;
+  Sim.loadXMLfile("CPstart.xml");
+  Sim.endEventCount = 20000;
+  Sim.initialise();
+  while (Sim.runSimulationStep(true)) {}
+  Sim.writeCheckpoint("CPhalf.xml", "CPhalf.state");
+  Sim.endEventCount = 40000;
+  while (Sim.runSimulationStep(true)) {}
+
+  //The same run, resumed from the checkpoint, must be identical
+  dynamo::Simulation Resumed;
+  Resumed.loadXMLfile("CPhalf.xml");
+  Resumed.loadCheckpoint("CPhalf.state", true);
+  BOOST_CHECK_EQUAL(Resumed.eventCount, 20000);
+  Resumed.endEventCount = 40000;
+  Resumed.initialise();
+  while (Resumed.runSimulationStep(true)) {}
+
+  BOOST_CHECK_EQUAL(Resumed.eventCount, Sim.eventCount);
+  BOOST_CHECK_EQUAL(Resumed.systemTime, Sim.systemTime);
+
+  Sim.dynamics->updateAllParticles();
+  Resumed.dynamics->updateAllParticles();
+  size_t mismatches = 0;
+  for (size_t i(0); i < Sim.N(); ++i)
+    if ((Resumed.particles[i].getPosition() != Sim.particles[i].getPosition())
+	|| (Resumed.particles[i].getVelocity() != Sim.particles[i].getVelocity()))
+      ++mismatches;
+  BOOST_CHECK_EQUAL(mismatches, 0);
+}
+
+BOOST_AUTO_TEST_CASE( Mismatched_Checkpoint )
+{
+  {
+    dynamo::Simulation Sim;
+    init(Sim);
+    Sim.endEventCount = 1000;
+    Sim.initialise();
+    while (Sim.runSimulationStep(true)) {}
+    Sim.writeCheckpoint("CPlarge.xml", "CPlarge.state");
+  }
+
+  //A checkpoint cannot be loaded with a different configuration
+  {
+    dynamo::Simulation Sim;
+    init(Sim, 4);
+    Sim.writeXMLfile("CPsmall.xml");
+  }
+
+  dynamo::Simulation Sim;
+  Sim.loadXMLfile("CPsmall.xml");
+  BOOST_CHECK_THROW(Sim.loadCheckpoint("CPlarge.state"), std::exception);
+
+  //Nor can a file which is not a checkpoint
+  dynamo::Simulation Other;
+  Other.loadXMLfile("CPlarge.xml");
+  BOOST_CHECK_THROW(Other.loadCheckpoint("CPlarge.xml"), std::exception);
+}
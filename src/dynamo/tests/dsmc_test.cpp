@@ -0,0 +1,110 @@
+#define BOOST_TEST_MODULE DSMC_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/heapPEL.hpp>
+#include <dynamo/schedulers/sorters/CBTFEL.hpp>
+#include <dynamo/systems/DSMCspheres.hpp>
+#include <dynamo/interactions/nullInteraction.hpp>
+#include <dynamo/NparticleEventData.hpp>
+#include <magnet/thread/threadpool.hpp>
+#include <random>
+
+std::mt19937 RNG;
+
+const double density = 0.1;
+const double boxLength = 30;
+const double tij = 1.0 / (4.0 * std::sqrt(M_PI) * density);
+
+//An ideal gas at unit temperature with Enskog DSMC collisions
+//between unit spheres. The particles are uniformly placed in the
+//fraction of the box (along x) given, at the density above.
+void init(dynamo::Simulation& Sim, const double fraction, const double cellWidth)
+{
+  RNG.seed(1);
+  Sim.ranGenerator.seed(2);
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SDumb>(new dynamo::SDumb(&Sim, new dynamo::CBTFEL<dynamo::HeapPEL>()));
+  Sim.primaryCellSize = dynamo::Vector{boxLength, boxLength, boxLength};
+
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::INull(&Sim, new dynamo::IDPairRangeAll(), "Catchall")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+
+  const size_t N = density * fraction * boxLength * boxLength * boxLength;
+  std::uniform_real_distribution<> xpos(-0.5 * boxLength, (fraction - 0.5) * boxLength);
+  std::uniform_real_distribution<> pos(-0.5 * boxLength, 0.5 * boxLength);
+  std::normal_distribution<> vel;
+  for (size_t i(0); i < N; ++i)
+    Sim.particles.push_back(dynamo::Particle(dynamo::Vector{xpos(RNG), pos(RNG), pos(RNG)}, dynamo::Vector{vel(RNG), vel(RNG), vel(RNG)}, i));
+
+  Sim.systems.push_back(dynamo::shared_ptr<dynamo::System>(new dynamo::SysDSMCSpheres(&Sim, 1.0, 0.1 * tij, 1.0, 1.0, "DSMC", new dynamo::IDRangeAll(&Sim), new dynamo::IDRangeAll(&Sim), cellWidth)));
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+  Sim.initialise();
+}
+
+//The collisions per particle per mean free time of the gas at the
+//density above, measured over some DSMC steps (the particles are
+//not moved between the steps)
+double collisionRate(dynamo::Simulation& Sim)
+{
+  const size_t steps = 200;
+  size_t collisions = 0;
+  for (size_t step(0); step < steps; ++step)
+    collisions += Sim.systems["DSMC"]->runEvent().L2partChanges.size();
+  return 2.0 * collisions * tij / (Sim.N() * steps * 0.1 * tij);
+}
+
+BOOST_AUTO_TEST_CASE( Homogeneous_Rate )
+{
+  dynamo::Simulation global;
+  init(global, 1.0, 0);
+  BOOST_CHECK_CLOSE(collisionRate(global), 1.0, 3);
+
+  dynamo::Simulation cells;
+  init(cells, 1.0, 5);
+  BOOST_CHECK_CLOSE(collisionRate(cells), 1.0, 3);
+}
+
+BOOST_AUTO_TEST_CASE( Inhomogeneous_Rate )
+{
+  //The particles fill half of the box at the same density, which
+  //only the collision cells see
+  dynamo::Simulation global;
+  init(global, 0.5, 0);
+  BOOST_CHECK_CLOSE(collisionRate(global), 0.5, 4);
+
+  dynamo::Simulation cells;
+  init(cells, 0.5, 5);
+  BOOST_CHECK_CLOSE(collisionRate(cells), 1.0, 4);
+}
+
+BOOST_AUTO_TEST_CASE( Parallel_Cells )
+{
+  magnet::thread::ThreadPool pool;
+
+  //The cells use counter-based random number streams, so the runs
+  //are identical for any number of threads
+  std::vector<dynamo::Particle> particles[2];
+  size_t collisions[2];
+  for (size_t run(0); run < 2; ++run)
+    {
+      pool.setThreadCount(2 * run);
+      dynamo::Simulation Sim;
+      Sim.setThreadPool(&pool);
+      Sim.randomStreamSeed = 3;
+      init(Sim, 0.5, 5);
+      BOOST_CHECK_CLOSE(collisionRate(Sim), 1.0, 4);
+      collisions[run] = Sim.eventCount;
+      particles[run] = Sim.particles;
+    }
+
+  BOOST_CHECK_EQUAL(collisions[0], collisions[1]);
+  for (size_t i(0); i < particles[0].size(); ++i)
+    BOOST_CHECK(particles[0][i].getVelocity() == particles[1][i].getVelocity());
+}
@@ -24,7 +24,7 @@ import xml.etree.ElementTree as ET
 run=True
 
 shortargs=""
-longargs=["dynarun=", "dynamod=", "dynahist_rw=", "dynatransport=", "python="]
+longargs=["dynarun=", "dynamod=", "dynatransport="]
 try:
     options, args = getopt.gnu_getopt(sys.argv[1:], shortargs, longargs)
 except getopt.GetoptError as err:
@@ -34,23 +34,17 @@ except getopt.GetoptError as err:
 
 dynarun_cmd="NOT SET"
 dynamod_cmd="NOT SET"
-dynahist_rw_cmd="NOT SET"
 dynatransport_cmd="NOT SET"
-python_cmd="NOT SET"
 
 for o,a in options:
     if o == "--dynarun":
         dynarun_cmd = a
     if o == "--dynamod":
         dynamod_cmd = a
-    if o == "--dynahist_rw":
-        dynahist_rw_cmd = a
     if o == "--dynatransport":
         dynatransport_cmd = a
-    if o == "--python":
-        python_cmd = a
 
-for name,exe in [("dynahist_rw", dynahist_rw_cmd), ("dynamod", dynamod_cmd), ("dynarun", dynarun_cmd), ("dynatransport", dynatransport_cmd), ("python", python_cmd)]:
+for name,exe in [("dynamod", dynamod_cmd), ("dynarun", dynarun_cmd), ("dynatransport", dynatransport_cmd)]:
     if not(os.path.isfile(exe) and os.access(exe, os.X_OK)):
         raise RuntimeError("Failed to find "+name+" executabe at "+exe)
         
@@ -70,7 +64,7 @@ cmd=[dynarun_cmd, "c.xml", "-oc.xml", "--out-data-file=o.xml", "-c2000000"]
 if run:
     subprocess.call(cmd)
 
-cmd=[python_cmd, dynatransport_cmd, "o.xml", "-c1.0", "-s0.3"]
+cmd=[dynatransport_cmd, "o.xml", "-c1.0", "-s0.3"]
 out = subprocess.check_output(cmd)
 visc=float(out.split("\n")[0].split()[1])
 thermal=float(out.split("\n")[2].split()[1])
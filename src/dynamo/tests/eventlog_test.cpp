@@ -0,0 +1,207 @@
+#define BOOST_TEST_MODULE EventLog_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/inputplugins/include.hpp>
+#include <dynamo/interactions/squarewell.hpp>
+#include <dynamo/systems/andersenThermostat.hpp>
+#include <dynamo/outputplugins/eventlog.hpp>
+#include <dynamo/outputplugins/eventlogreader.hpp>
+#include <random>
+
+std::mt19937 RNG;
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+dynamo::Vector getRandVelVec()
+{
+  std::normal_distribution<> normal_dist(0.0, (1.0 / sqrt(double(NDIM))));
+
+  dynamo::Vector tmpVec;
+  for (size_t iDim = 0; iDim < NDIM; iDim++)
+    tmpVec[iDim] = normal_dist(RNG);
+
+  return tmpVec;
+}
+
+//A square well fluid with an Andersen thermostat, so that the log
+//holds both pair and single particle events
+void init(dynamo::Simulation& Sim, double density = 0.5)
+{
+  RNG.seed(std::random_device()());
+  Sim.ranGenerator.seed(std::random_device()());
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{5,5,5}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+  Sim.primaryCellSize = dynamo::Vector{1,1,1};
+
+  double particleDiam = std::cbrt(density / latticeSites.size());
+
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::ISquareWell(&Sim, particleDiam, 1.5, 1.0, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+  Sim.units.setUnitLength(particleDiam);
+  Sim.units.setUnitTime(particleDiam);
+
+  unsigned long nParticles = 0;
+  Sim.particles.reserve(latticeSites.size());
+  for (const dynamo::Vector & position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position, getRandVelVec() * Sim.units.unitVelocity(), nParticles++));
+
+  Sim.systems.push_back(dynamo::shared_ptr<dynamo::System>(new dynamo::SysAndersen(&Sim, 0.036 / Sim.N(), 1.0 * Sim.units.unitEnergy(), "Thermostat")));
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+
+  dynamo::InputPlugin(&Sim, "Rescaler").zeroMomentum();
+  dynamo::InputPlugin(&Sim, "Rescaler").rescaleVels(1.0);
+}
+
+void replayTest(const std::string& options)
+{
+  {
+    dynamo::Simulation Sim;
+    init(Sim);
+    Sim.writeXMLfile("ELstart.xml");
+  }
+
+  //Run the simulation, logging the events
+  dynamo::Simulation Sim;
+  Sim.loadXMLfile("ELstart.xml");
+  Sim.endEventCount = 50000;
+  Sim.addOutputPlugin("EventLog:File=test.evlog,ChunkSize=1000" + options);
+  Sim.initialise();
+  while (Sim.runSimulationStep(true)) {}
+  Sim.getOutputPlugin<dynamo::OPEventLog>()->flush();
+  Sim.dynamics->updateAllParticles();
+
+  dynamo::EventLogReader log("test.evlog");
+  BOOST_CHECK(log.hasIndex());
+  BOOST_CHECK(log.getChunkCount() >= 50);
+  BOOST_CHECK_EQUAL(log.getHeader().N, Sim.N());
+
+  //The chunks are in order, and the index finds the chunk of an event
+  for (size_t i(1); i < log.getChunkCount(); ++i)
+    BOOST_CHECK(log.getChunk(i).firstEvent >= log.getChunk(i - 1).lastEvent);
+  const size_t chunk = log.findChunk(25000);
+  BOOST_REQUIRE(chunk < log.getChunkCount());
+  BOOST_CHECK(log.getChunk(chunk).firstEvent <= 25000);
+  BOOST_CHECK(log.getChunk(chunk).lastEvent >= 25000);
+
+  size_t thermostatEvents = 0, pairEvents = 0;
+  log.forEach([&](const dynamo::eventlog::Record& record)
+	      {
+		if (record.particle2 == dynamo::eventlog::noParticle)
+		  ++thermostatEvents;
+		else
+		  ++pairEvents;
+	      });
+  BOOST_CHECK(thermostatEvents > 0);
+  BOOST_CHECK(pairEvents > 0);
+
+  //Replaying the log from the starting configuration reproduces the
+  //final state of the simulation
+  dynamo::Simulation Replay;
+  Replay.loadXMLfile("ELstart.xml");
+  Replay.initialise();
+  log.replay(Replay);
+  BOOST_CHECK_EQUAL(Replay.eventCount, log.getChunk(log.getChunkCount() - 1).lastEvent);
+  BOOST_CHECK_CLOSE(Replay.systemTime, log.getChunk(log.getChunkCount() - 1).lastTime, 1e-10);
+
+  double maxPosError = 0, maxVelError = 0;
+  for (size_t i(0); i < Sim.N(); ++i)
+    {
+      //Stream the original particle to the time of the last logged event
+      const double dt = Replay.systemTime - Sim.systemTime;
+      dynamo::Vector rij = Sim.particles[i].getPosition() + Sim.particles[i].getVelocity() * dt - Replay.particles[i].getPosition();
+      Sim.BCs->applyBC(rij);
+      maxPosError = std::max(maxPosError, rij.nrm() / Sim.units.unitLength());
+      maxVelError = std::max(maxVelError, (Sim.particles[i].getVelocity() - Replay.particles[i].getVelocity()).nrm() / Sim.units.unitVelocity());
+    }
+  BOOST_CHECK_SMALL(maxPosError, 1e-6);
+  BOOST_CHECK_SMALL(maxVelError, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( Replay_Uncompressed )
+{
+  replayTest("");
+}
+
+#ifdef DYNAMO_zlib_support
+BOOST_AUTO_TEST_CASE( Replay_Compressed )
+{
+  replayTest(",Compress");
+}
+#endif
+
+BOOST_AUTO_TEST_CASE( Truncated_Log )
+{
+  //A log without its index (from a killed run) is read by scanning
+  //the chunks, ignoring a partially written last chunk
+  {
+    dynamo::Simulation Sim;
+    init(Sim);
+    Sim.endEventCount = 10000;
+    Sim.addOutputPlugin("EventLog:File=truncated.evlog,ChunkSize=1000");
+    Sim.initialise();
+    while (Sim.runSimulationStep(true)) {}
+    Sim.getOutputPlugin<dynamo::OPEventLog>()->flush();
+  }
+
+  dynamo::EventLogReader full("truncated.evlog");
+  BOOST_REQUIRE(full.getChunkCount() > 2);
+  const dynamo::eventlog::Chunk& lastChunk = full.getChunk(full.getChunkCount() - 1);
+
+  std::ifstream in("truncated.evlog", std::ios::binary);
+  std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  data.resize(lastChunk.offset + lastChunk.bytes / 2);
+  std::ofstream("truncated.evlog", std::ios::binary | std::ios::trunc).write(data.data(), data.size());
+
+  dynamo::EventLogReader truncated("truncated.evlog");
+  BOOST_CHECK(!truncated.hasIndex());
+  BOOST_CHECK_EQUAL(truncated.getChunkCount(), full.getChunkCount() - 1);
+  BOOST_CHECK_EQUAL(truncated.getRecordCount(), full.getRecordCount() - lastChunk.records);
+}
+
+BOOST_AUTO_TEST_CASE( Flushed_Log )
+{
+  //Chunks written after a mid-run flush overwrite its index. If they
+  //are smaller than the index, the footer of the flush must not be
+  //left valid at the end of the file.
+  size_t flushedChunks;
+  {
+    dynamo::Simulation Sim;
+    init(Sim);
+    Sim.endEventCount = 2000;
+    Sim.addOutputPlugin("EventLog:File=flushed.evlog,ChunkSize=4");
+    Sim.initialise();
+    while (Sim.runSimulationStep(true)) {}
+    Sim.getOutputPlugin<dynamo::OPEventLog>()->flush();
+
+    dynamo::EventLogReader flushed("flushed.evlog");
+    BOOST_CHECK(flushed.hasIndex());
+    flushedChunks = flushed.getChunkCount();
+
+    //At most four chunks are queued for writing, so the first of
+    //the later chunks are written by the time these events are run
+    Sim.endEventCount += 100;
+    while (Sim.runSimulationStep(true)) {}
+
+    dynamo::EventLogReader unflushed("flushed.evlog");
+    BOOST_CHECK(!unflushed.hasIndex());
+    BOOST_CHECK(unflushed.getChunkCount() > flushedChunks);
+  }
+
+  //The plugin writes a new index when it is destroyed
+  dynamo::EventLogReader full("flushed.evlog");
+  BOOST_CHECK(full.hasIndex());
+  BOOST_CHECK(full.getChunkCount() > flushedChunks);
+}
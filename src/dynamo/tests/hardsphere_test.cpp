@@ -12,8 +12,11 @@
 #include <dynamo/inputplugins/include.hpp>
 #include <dynamo/inputplugins/compression.hpp>
 #include <dynamo/interactions/hardsphere.hpp>
+#include <dynamo/globals/verletlist.hpp>
 #include <dynamo/outputplugins/misc.hpp>
 #include <dynamo/outputplugins/msd.hpp>
+#include <dynamo/outputplugins/collMatrix.hpp>
+#include <magnet/thread/threadpool.hpp>
 #include <random>
 
 std::mt19937 RNG;
@@ -31,7 +34,7 @@ dynamo::Vector getRandVelVec()
   return tmpVec;
 }
 
-void init(dynamo::Simulation& Sim, const double density)
+void init(dynamo::Simulation& Sim, const double density, const bool verlet = false)
 {
   RNG.seed(std::random_device()());
   Sim.ranGenerator.seed(std::random_device()());
@@ -41,6 +44,8 @@ void init(dynamo::Simulation& Sim, const double density)
   Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
   Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
   Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+  if (verlet)
+    Sim.globals.push_back(dynamo::shared_ptr<dynamo::Global>(new dynamo::GVerletList(&Sim, "SchedulerNBList")));
 
   std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{7,7,7}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
   packptr->initialise();
@@ -122,6 +127,104 @@ BOOST_AUTO_TEST_CASE( Equilibrium_Simulation )
   BOOST_CHECK_MESSAGE(Sim.checkSystem() <= 1, "There are more than two invalid states in the final configuration");
 }
 
+BOOST_AUTO_TEST_CASE( VerletList_Simulation )
+{
+  {
+    dynamo::Simulation Sim;
+    init(Sim, 0.5, true);
+    Sim.writeXMLfile("HSVerletequil.xml");
+  }
+
+  dynamo::Simulation Sim;
+  Sim.loadXMLfile("HSVerletequil.xml");
+
+  Sim.endEventCount = 100000;
+  Sim.addOutputPlugin("Misc");
+  Sim.initialise();
+  while (Sim.runSimulationStep()) {}
+
+  Sim.reset();
+  Sim.endEventCount = 400000;
+  Sim.addOutputPlugin("Misc"); 
+  Sim.addOutputPlugin("MSD");
+  Sim.initialise();
+
+  BOOST_REQUIRE(std::dynamic_pointer_cast<dynamo::GVerletList>(Sim.globals["SchedulerNBList"]));
+
+  while (Sim.runSimulationStep()) {}
+
+  //The neighbour list must not change the dynamics
+  const double expectedMFT = 0.13031;
+  const double expectedD = 0.247;
+
+  dynamo::OPMisc& opMisc = *Sim.getOutputPlugin<dynamo::OPMisc>();
+  dynamo::OPMSD& opMSD = *Sim.getOutputPlugin<dynamo::OPMSD>();
+  BOOST_CHECK_CLOSE(opMisc.getMFT(), expectedMFT, 1);
+  BOOST_CHECK_CLOSE(opMSD.calcD(*Sim.species[0]->getRange()) / Sim.units.unitDiffusion(), expectedD, 6);
+
+  double Temperature = opMisc.getCurrentkT() / Sim.units.unitEnergy();
+  BOOST_CHECK_CLOSE(Temperature, 1.0, 0.000000001);
+  
+  BOOST_CHECK_MESSAGE(Sim.checkSystem() <= 1, "There are more than two invalid states in the final configuration");
+}
+
+BOOST_AUTO_TEST_CASE( CheckSystem_Overlap )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 0.5);
+  Sim.initialise();
+
+  //The checks are repeated in parallel on a pool with three threads
+  magnet::thread::ThreadPool pool;
+  pool.setThreadCount(3);
+
+  BOOST_CHECK_EQUAL(Sim.checkSystem(100), 0);
+  Sim.setThreadPool(&pool);
+  BOOST_CHECK_EQUAL(Sim.checkSystem(100), 0);
+  Sim.setThreadPool(nullptr);
+
+  //Move a particle halfway towards its nearest neighbour on the
+  //lattice so that the pair is overlapping
+  dynamo::Vector& pos1 = Sim.particles[1].getPosition();
+  pos1 = 0.5 * (pos1 + Sim.particles[0].getPosition());
+
+  const size_t errors = Sim.checkSystem(100);
+  BOOST_CHECK(errors >= 1);
+  Sim.setThreadPool(&pool);
+  BOOST_CHECK_EQUAL(Sim.checkSystem(100), errors);
+  BOOST_CHECK_EQUAL(Sim.checkSystem(0), errors);
+}
+
+BOOST_AUTO_TEST_CASE( AsyncOutputPlugins )
+{
+  {
+    dynamo::Simulation Sim;
+    init(Sim, 0.5);
+    Sim.writeXMLfile("HSasync.xml");
+  }
+
+  //The same run must give the same results with the collision
+  //matrix updated on the simulation thread or a worker thread
+  size_t counts[2];
+  for (size_t async = 0; async < 2; ++async)
+    {
+      dynamo::Simulation Sim;
+      Sim.loadXMLfile("HSasync.xml");
+      Sim.asyncOutputPlugins = async;
+      Sim.endEventCount = 100000;
+      Sim.addOutputPlugin("Misc");
+      Sim.addOutputPlugin("CollisionMatrix");
+      Sim.initialise();
+      while (Sim.runSimulationStep(true)) {}
+
+      Sim.flushOutputPlugins();
+      counts[async] = Sim.getOutputPlugin<dynamo::OPCollMatrix>()->getTotalCount();
+    }
+
+  BOOST_CHECK(counts[0] > 0);
+  BOOST_CHECK_EQUAL(counts[0], counts[1]);
+}
+
 BOOST_AUTO_TEST_CASE( Compression_Simulation )
 {
   dynamo::Simulation Sim;
@@ -0,0 +1,63 @@
+#define BOOST_TEST_MODULE PRIME_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/dynamics/dynamics.hpp>
+#include <dynamo/outputplugins/misc.hpp>
+
+//The directory of the PRIME configurations (test/PRIME_helper_files)
+//is the first argument of the test
+std::string configFile(const std::string& name)
+{
+  const boost::unit_test::master_test_suite_t& suite = boost::unit_test::framework::master_test_suite();
+  const std::string dir = (suite.argc > 1) ? suite.argv[1] : "test/PRIME_helper_files";
+  return dir + "/" + name;
+}
+
+//The state after running a PRIME configuration for some events with
+//a fixed seed. The reference values were recorded before the PRIME
+//pair parameters were tabulated and the hydrogen bonds indexed by
+//residue; the trajectories must be unchanged.
+struct Reference
+{
+  std::string config;
+  double time;
+  double internalEnergy;
+  double meanInternalEnergy;
+  double kineticEnergy;
+  double MFT;
+};
+
+void runPRIME(const Reference& ref)
+{
+  const size_t events = 20000;
+  dynamo::Simulation Sim;
+  Sim.loadXMLfile(configFile(ref.config));
+  Sim.ranGenerator.seed(1);
+  Sim.endEventCount = events;
+  Sim.addOutputPlugin("Misc");
+  Sim.initialise();
+  while (Sim.runSimulationStep(true)) {}
+
+  const dynamo::OPMisc& misc = *Sim.getOutputPlugin<dynamo::OPMisc>();
+  BOOST_CHECK_EQUAL(Sim.eventCount, events);
+  BOOST_CHECK_CLOSE(Sim.systemTime, ref.time, 1e-8);
+  BOOST_CHECK_CLOSE(Sim.calcInternalEnergy(), ref.internalEnergy, 1e-8);
+  BOOST_CHECK_CLOSE(misc.getMeanUConfigurational(), ref.meanInternalEnergy, 1e-8);
+  BOOST_CHECK_CLOSE(Sim.dynamics->getSystemKineticEnergy(), ref.kineticEnergy, 1e-8);
+  BOOST_CHECK_CLOSE(misc.getMFT(), ref.MFT, 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( GNNQQNY )
+{
+  runPRIME(Reference{"15-GNNQQNY.xml.bz2", 1.8385335349603264, -85.371000000000222, -83.542733561159608, 618.18413734604212, 0.019199290453521704});
+}
+
+BOOST_AUTO_TEST_CASE( KLVFFAE )
+{
+  runPRIME(Reference{"48-KLVFFAE.xml.bz2", 1.3155168589668245, -84.740000000000364, -84.486520165059531, 340.04137098798623, 0.045356831750119599});
+}
+
+BOOST_AUTO_TEST_CASE( Alphabet )
+{
+  runPRIME(Reference{"alphabet.xml.bz2", 8.9997400260727888, -9.9680000000000124, -9.9074867417143935, 124.19984955363987, 0.018314772335387693});
+}
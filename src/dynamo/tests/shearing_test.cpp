@@ -12,8 +12,10 @@
 #include <dynamo/inputplugins/include.hpp>
 #include <dynamo/inputplugins/compression.hpp>
 #include <dynamo/interactions/hardsphere.hpp>
+#include <dynamo/globals/neighbourList.hpp>
 #include <dynamo/outputplugins/misc.hpp>
 #include <dynamo/outputplugins/msd.hpp>
+#include <algorithm>
 #include <random>
 
 std::mt19937 RNG;
@@ -131,3 +133,44 @@ BOOST_AUTO_TEST_CASE( Compression_Simulation )
 
   BOOST_CHECK_MESSAGE(Sim.checkSystem() <= 1, "After compression, there are more than one invalid states in the final configuration");
 }
+
+BOOST_AUTO_TEST_CASE( Sliding_Neighbourhoods )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 0.5);
+  Sim.endEventCount = std::numeric_limits<size_t>::max();
+  Sim.initialise();
+
+  const dynamo::GNeighbourList& nblist = dynamic_cast<const dynamo::GNeighbourList&>(*Sim.globals["SchedulerNBList"]);
+  const double range = nblist.getMaxSupportedInteractionLength();
+
+  //As the images slide, every pair within the supported range
+  //(including pairs across the sheared boundary) must remain in the
+  //neighbourhood of each other
+  size_t missing = 0;
+  std::vector<size_t> neighbours;
+  for (size_t block(0); block < 10; ++block)
+    {
+      for (size_t i(0); i < 20000; ++i)
+	Sim.runSimulationStep();
+
+      Sim.dynamics->updateAllParticles();
+      for (const dynamo::Particle& p1 : Sim.particles)
+	{
+	  neighbours.clear();
+	  nblist.getParticleNeighbours(p1, neighbours);
+	  std::sort(neighbours.begin(), neighbours.end());
+	  for (const dynamo::Particle& p2 : Sim.particles)
+	    {
+	      if (p1.getID() == p2.getID()) continue;
+	      dynamo::Vector rij = p1.getPosition() - p2.getPosition();
+	      Sim.BCs->applyBC(rij);
+	      if ((rij.nrm() < range) && !std::binary_search(neighbours.begin(), neighbours.end(), p2.getID()))
+		++missing;
+	    }
+	}
+    }
+
+  BOOST_CHECK_EQUAL(missing, 0);
+  BOOST_CHECK_MESSAGE(Sim.checkSystem() <= 1, "There are more than two invalid states in the final configuration");
+}
@@ -0,0 +1,138 @@
+#define BOOST_TEST_MODULE SteppedPotential_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/interactions/potentials/lennard_jones.hpp>
+#include <dynamo/interactions/stepped.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <magnet/thread/threadpool.hpp>
+#include <random>
+
+using namespace dynamo;
+
+std::mt19937 RNG;
+
+//The linear walk over the steps which the binary search replaced
+size_t linearStepID(const Potential& pot, const double r)
+{
+  size_t retval(0);
+  if (pot.direction())
+    for (; (retval < pot.steps()) && (r > pot[retval].first); ++retval) {}
+  else
+    for (; (retval < pot.steps()) && (r < pot[retval].first); ++retval) {}
+  return retval;
+}
+
+size_t checkLookups(const Potential& pot, const double rmin, const double rmax)
+{
+  std::uniform_real_distribution<> dist(rmin, rmax);
+  size_t mismatches = 0;
+  for (size_t i(0); i < 10000; ++i)
+    {
+      const double r = dist(RNG);
+      const size_t ID = linearStepID(pot, r);
+      mismatches += (pot.calculateStepID(r) != ID);
+      mismatches += (pot.calculateStepIDSq(r * r) != ID);
+
+      //The radius must lie within the bounds of the step found
+      const std::pair<double, double> bounds = pot.getStepBounds(ID);
+      mismatches += (r < bounds.first) || (r > bounds.second);
+    }
+
+  //Lookups exactly on the discontinuities
+  for (size_t i(0); i < std::min<size_t>(pot.cached_steps(), 100); ++i)
+    mismatches += (pot.calculateStepID(pot[i].first) != linearStepID(pot, pot[i].first));
+
+  return mismatches;
+}
+
+BOOST_AUTO_TEST_CASE( Stepped_lookup )
+{
+  RNG.seed(1);
+  std::vector<std::pair<double, double> > steps;
+  for (size_t i(1); i <= 50; ++i)
+    steps.push_back(std::make_pair(0.5 + 0.02 * i, -1.0 / i));
+
+  PotentialStepped left(steps, false);
+  BOOST_CHECK_EQUAL(checkLookups(left, 0, 2), 0);
+  PotentialStepped right(steps, true);
+  BOOST_CHECK_EQUAL(checkLookups(right, 0, 2), 0);
+}
+
+BOOST_AUTO_TEST_CASE( LennardJones_lookup )
+{
+  RNG.seed(2);
+  const int rmodes[] = {PotentialLennardJones::DELTAR, PotentialLennardJones::DELTAU, PotentialLennardJones::DELTAV};
+  for (const int rmode : rmodes)
+    {
+      //Lookups on a lazily extended cache
+      PotentialLennardJones lazy(1, 1, 3, PotentialLennardJones::MIDPOINT, rmode, 300);
+      BOOST_CHECK_EQUAL(checkLookups(lazy, 0.9, 3.5), 0);
+
+      //And on a fully materialised one
+      PotentialLennardJones full(1, 1, 3, PotentialLennardJones::MIDPOINT, rmode, 300);
+      full.materialise();
+      if (full.steps() != std::numeric_limits<size_t>::max())
+	BOOST_CHECK_EQUAL(full.cached_steps(), full.steps());
+      BOOST_CHECK_EQUAL(checkLookups(full, 0.9, 3.5), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( LennardJones_CheckSystem )
+{
+  //An energy stepped Lennard-Jones fluid, whose step table is
+  //extended as closer pairs are looked up
+  dynamo::Simulation Sim;
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> >()));
+  Sim.primaryCellSize = dynamo::Vector{12, 12, 12};
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{6,6,6}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+
+  dynamo::shared_ptr<Potential> potential(new PotentialLennardJones(1, 1, 3, PotentialLennardJones::MIDPOINT, PotentialLennardJones::DELTAU, 300));
+  BOOST_REQUIRE(!potential->materialisable());
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IStepped(&Sim, potential, new dynamo::IDPairRangeAll(), "Bulk", 1.0, 1.0)));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+
+  for (const dynamo::Vector& position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position * 12, dynamo::Vector{0, 0, 0}, Sim.particles.size()));
+
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+  Sim.endEventCount = 0;
+  Sim.initialise();
+
+  //The lookups may grow the step table, so the pairs must be
+  //validated serially
+  BOOST_CHECK(!Sim.interactions[0]->parallelValidation());
+
+  magnet::thread::ThreadPool pool;
+  pool.setThreadCount(3);
+  Sim.setThreadPool(&pool);
+  BOOST_CHECK_EQUAL(Sim.checkSystem(0), 0);
+
+  //Move one particle of each lattice cell towards a neighbour in
+  //the same cell, pushing the pairs into steps which are not yet
+  //cached. The parallel check runs first, so it extends the step
+  //table, and it must agree with the serial check.
+  const std::vector<dynamo::Vector> sites(latticeSites);
+  for (const double fraction : {0.1, 0.2, 0.3, 0.35})
+    {
+      for (size_t i(1); i < Sim.particles.size(); i += 4)
+	Sim.particles[i].getPosition() = 12 * (sites[i] + fraction * (sites[i - 1] - sites[i]));
+
+      const size_t errors = Sim.checkSystem(0);
+      BOOST_CHECK(errors >= Sim.N() / 4);
+      Sim.setThreadPool(nullptr);
+      BOOST_CHECK_EQUAL(Sim.checkSystem(0), errors);
+      Sim.setThreadPool(&pool);
+    }
+}
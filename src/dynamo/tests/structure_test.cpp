@@ -0,0 +1,152 @@
+#define BOOST_TEST_MODULE Structure_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/inputplugins/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/interactions/hardsphere.hpp>
+#include <dynamo/systems/andersenThermostat.hpp>
+#include <dynamo/outputplugins/structure.hpp>
+#include <random>
+
+std::mt19937 RNG;
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+const double boxLength = 7;
+const double binWidth = 0.1;
+const size_t length = 30;
+//The interval between the brute force samples of the pair
+//separations
+const double sampleInterval = 0.005;
+
+//A dilute hard sphere fluid of 108 unit spheres, held at a
+//temperature by an Andersen thermostat
+void init(dynamo::Simulation& Sim, const double kT)
+{
+  Sim.ranGenerator.seed(RNG());
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+  Sim.primaryCellSize = dynamo::Vector{boxLength, boxLength, boxLength};
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{3,3,3}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IHardSphere(&Sim, 1.0, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+
+  std::normal_distribution<> vel;
+  for (const dynamo::Vector& position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position * boxLength, dynamo::Vector{vel(RNG), vel(RNG), vel(RNG)}, Sim.particles.size()));
+
+  Sim.systems.push_back(dynamo::shared_ptr<dynamo::System>(new dynamo::SysAndersen(&Sim, 0.5, kT, "Thermostat")));
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+  dynamo::InputPlugin(&Sim, "Rescaler").zeroMomentum();
+  dynamo::InputPlugin(&Sim, "Rescaler").rescaleVels(kT);
+
+  Sim.addOutputPlugin("Structure:BinWidth=" + std::to_string(binWidth) + ",Length=" + std::to_string(length));
+  Sim.endEventCount = std::numeric_limits<size_t>::max();
+  Sim.initialise();
+}
+
+//A histogram of the pair separations, sampled at regular intervals
+struct BruteForce
+{
+  BruteForce(): hist(length, 0), samples(0), nextSample(0) {}
+
+  std::vector<double> hist;
+  size_t samples;
+  //The time of the next sample, on the time line of the system
+  double nextSample;
+
+  //Sample the separations up to the next event
+  void sample(const dynamo::Simulation& Sim)
+  {
+    const double nextEvent = Sim.systemTime + Sim.ptrScheduler->getSorter()->top()._dt;
+    for (; nextSample < nextEvent; nextSample += sampleInterval, ++samples)
+      {
+	std::vector<dynamo::Vector> positions;
+	for (const dynamo::Particle& part : Sim.particles)
+	  positions.push_back(part.getPosition() + part.getVelocity() * (Sim.dynamics->getParticleDelay(part) + nextSample - Sim.systemTime));
+
+	for (size_t i(0); i < positions.size(); ++i)
+	  for (size_t j(i + 1); j < positions.size(); ++j)
+	    {
+	      dynamo::Vector rij = positions[j] - positions[i];
+	      Sim.BCs->applyBC(rij);
+	      const size_t bin = static_cast<size_t>(rij.nrm() / binWidth + 0.5);
+	      if (bin < length)
+		hist[bin] += 2;
+	    }
+      }
+  }
+
+  //Compare against the radial distribution function of the plugin
+  void check(dynamo::Simulation& Sim) const
+  {
+    std::vector<std::pair<double, double> > gr = Sim.getOutputPlugin<dynamo::OPStructure>()->getgrdata(0, 0);
+    BOOST_REQUIRE_EQUAL(gr.size(), length);
+    const double density = (Sim.N() - 1) / Sim.getSimVolume();
+    for (size_t i(0); i < length; ++i)
+      {
+	const double radius = binWidth * i;
+	const double volshell = M_PI * (4.0 * binWidth * radius * radius + binWidth * binWidth * binWidth / 3.0);
+	const double expected = hist[i] / (density * samples * Sim.N() * volshell);
+	//The hard cores are never sampled
+	if (i < 10)
+	  BOOST_CHECK_EQUAL(gr[i].second, 0);
+	BOOST_CHECK_SMALL(gr[i].second - expected, 0.01);
+      }
+  }
+};
+
+void run(dynamo::Simulation& Sim, BruteForce& brute, const size_t events)
+{
+  for (size_t event(0); event < events; ++event)
+    {
+      brute.sample(Sim);
+      Sim.runSimulationStep(true);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( Brute_Force_RDF )
+{
+  RNG.seed(1);
+  dynamo::Simulation Sim;
+  init(Sim, 1.0);
+  BruteForce brute;
+  run(Sim, brute, 25000);
+  brute.check(Sim);
+}
+
+BOOST_AUTO_TEST_CASE( Replica_Exchange )
+{
+  RNG.seed(2);
+  dynamo::Simulation Sim1, Sim2;
+  init(Sim1, 1.0);
+  init(Sim2, 2.0);
+  BruteForce brute1, brute2;
+
+  run(Sim1, brute1, 10000);
+  run(Sim2, brute2, 15000);
+
+  //The distributions follow the ensembles, and the sample times
+  //follow the (swapped) system times
+  Sim1.replexerSwap(Sim2);
+  std::swap(brute1, brute2);
+
+  run(Sim1, brute1, 15000);
+  run(Sim2, brute2, 10000);
+
+  BOOST_CHECK_CLOSE(Sim1.ensemble->getEnsembleVals()[2], 2.0, 1e-10);
+  brute1.check(Sim1);
+  brute2.check(Sim2);
+}
@@ -0,0 +1,81 @@
+#define BOOST_TEST_MODULE Thermostat_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/heapPEL.hpp>
+#include <dynamo/schedulers/sorters/CBTFEL.hpp>
+#include <dynamo/systems/andersenThermostat.hpp>
+#include <dynamo/interactions/nullInteraction.hpp>
+#include <dynamo/NparticleEventData.hpp>
+#include <algorithm>
+#include <cmath>
+
+const size_t N = 1000;
+
+//An ideal gas, initially at rest, with an Andersen thermostat at
+//unit temperature
+void init(dynamo::Simulation& Sim, const double particlesPerEvent)
+{
+  Sim.ranGenerator.seed(1);
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SDumb>(new dynamo::SDumb(&Sim, new dynamo::CBTFEL<dynamo::HeapPEL>()));
+  Sim.primaryCellSize = dynamo::Vector{10, 10, 10};
+
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::INull(&Sim, new dynamo::IDPairRangeAll(), "Catchall")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+
+  for (size_t i(0); i < N; ++i)
+    Sim.particles.push_back(dynamo::Particle(dynamo::Vector{0, 0, 0}, dynamo::Vector{0, 0, 0}, i));
+
+  dynamo::shared_ptr<dynamo::SysAndersen> thermostat(new dynamo::SysAndersen(&Sim, 1.0, 1.0, "Thermostat"));
+  thermostat->setParticlesPerEvent(particlesPerEvent);
+  Sim.systems.push_back(thermostat);
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+  Sim.initialise();
+}
+
+BOOST_AUTO_TEST_CASE( Single_Particle_Events )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 0);
+
+  const size_t events = 10 * N;
+  for (size_t event(0); event < events; ++event)
+    BOOST_CHECK_EQUAL(Sim.systems["Thermostat"]->runEvent().L1partChanges.size(), 1u);
+
+  BOOST_CHECK_CLOSE(Sim.dynamics->getkT(), 1.0, 5);
+}
+
+BOOST_AUTO_TEST_CASE( Batched_Events )
+{
+  const double batch = 20;
+  dynamo::Simulation Sim;
+  init(Sim, batch);
+
+  //Each particle is hit a Poisson distributed number of times, and
+  //is only thermalised once however many times it is hit
+  const double expected = N * (1 - std::exp(-batch / N));
+  const size_t events = 500;
+  size_t thermalised = 0;
+  for (size_t event(0); event < events; ++event)
+    {
+      const dynamo::NEventData data = Sim.systems["Thermostat"]->runEvent();
+      thermalised += data.L1partChanges.size();
+
+      std::vector<size_t> IDs;
+      for (const dynamo::ParticleEventData& pdat : data.L1partChanges)
+	IDs.push_back(pdat.getParticleID());
+      BOOST_CHECK(std::adjacent_find(IDs.begin(), IDs.end()) == IDs.end());
+    }
+
+  BOOST_CHECK_CLOSE(double(thermalised) / events, expected, 2);
+  BOOST_CHECK_CLOSE(Sim.dynamics->getkT(), 1.0, 5);
+  //Only one event is counted per batch
+  BOOST_CHECK_EQUAL(Sim.eventCount, events);
+}
@@ -20,6 +20,7 @@
 #include <magnet/math/bisect.hpp>
 #include <array>
 #include <limits>
+#include <type_traits>
 
 namespace magnet {
   namespace intersection {
@@ -52,6 +53,25 @@ namespace magnet {
 	{ return _f.template eval<0>(dt).front(); }
       };      
 
+      /*! \brief The highest derivative which an overlap function
+	provides a bound for through its max<d>() member.
+
+	Overlap functions must bound their second derivative. Those
+	which can also bound their third derivative declare a static
+	member \c max_bounded_derivative, which allows the root search
+	to use tighter, local bounds (see \ref boundaryStep).
+      */
+      template<class F, class = void>
+      struct MaxBoundedDerivative { static const size_t value = 2; };
+
+      template<class F>
+      struct MaxBoundedDerivative<F, typename std::enable_if<(F::max_bounded_derivative > 0)>::type>
+      { static const size_t value = F::max_bounded_derivative; };
+
+      template <class Base, int derivative>
+      struct MaxBoundedDerivative<FDerivative<Base, derivative>, void>
+      { static const size_t value = (MaxBoundedDerivative<Base>::value > size_t(derivative) + 2) ? MaxBoundedDerivative<Base>::value - derivative : 2; };
+
       /*! \brief A numerical root finder based on Halley's method.
 
 	This is losely based around the boost implementation of
@@ -152,6 +172,47 @@ namespace magnet {
       }
       
 
+      /*! \brief Calculate how far a search boundary at t may be
+	moved without passing over a root of f.
+
+	The worst-case quadratic, built from the maximum of the second
+	derivative over the whole search window, has roots either side
+	of t and f cannot have a root closer than these. The step is
+	the root of the worst-case quadratic in the requested direction
+	(positive if forward).
+
+	If the overlap function also bounds its third derivative, a
+	Taylor model is tried as well. Over a trial window of a few
+	times the worst-case step, the second derivative is bounded by
+	|f''(t)| + window * max|f'''|. If this is tighter than the
+	global bound, the corresponding (longer) step is taken, limited
+	to the trial window where the local bound holds. This lets the
+	search skip quickly over root-free regions where the function
+	is locally flat, instead of crawling across them.
+
+	\param fval The function and its derivatives at t (the second
+	derivative is only required if the third is bounded).
+       */
+      template<class F, size_t N>
+      double boundaryStep(const F& f, const std::array<double, N>& fval, const double f2max, const bool forward)
+      {
+	std::pair<double, double> roots = math::quadraticEquation(- 0.5 * std::copysign(f2max, fval[0]), fval[1], fval[0]);
+	double step = forward ? std::max(roots.first, roots.second) : std::min(roots.first, roots.second);
+
+	if (N > 2)
+	  {
+	    const double window = 4 * std::abs(step);
+	    const double f2local = std::abs(fval[N - 1]) + window * f.template max<3>();
+	    if ((f2local < f2max) && math::quadraticSolve(fval[0], fval[1], - 0.5 * std::copysign(f2local, fval[0]), roots.first, roots.second))
+	      {
+		const double local_step = forward ? std::max(roots.first, roots.second) : std::min(roots.first, roots.second);
+		step = std::copysign(std::min(std::abs(local_step), window), step);
+	      }
+	  }
+
+	return step;
+      }
+
       template<class F> std::pair<bool, double> nextDecreasingRoot(const F& f, double t_min, double t_max, 
 								   double fprecision = 1e-10,
 								   size_t restarts = std::numeric_limits<size_t>::max() - 1,
@@ -179,11 +240,11 @@ namespace magnet {
 	while ((t_min < t_max) && (--restarts))
 	  {
 	    double& t_current = (active_boundary == HIGH) ? t_max : t_min;
-	    const auto fval = f.template eval<0,2>(t_current);
+	    const auto fval = f.template eval<0, (MaxBoundedDerivative<F>::value > 2) ? 3 : 2>(t_current);
 
 	    //Improve the boundary. The copysign should guarantee that
 	    //we have roots either side of t_current.
-	    auto boundary_roots = math::quadraticEquation(- 0.5 * std::copysign(f2max, fval[0]), fval[1], fval[0]);
+	    const double boundary_step = boundaryStep(f, fval, f2max, active_boundary == LOW);
 	    
 	    //Check that the last update didn't cause a sign change on
 	    //at the boundary (indicating it skipped over a root). If
@@ -193,7 +254,7 @@ namespace magnet {
 		if (std::signbit(fval[0]) == t_max_sign)
 		  {
 		    old_t_max = t_max;
-		    t_max += std::min(boundary_roots.first, boundary_roots.second);
+		    t_max += boundary_step;
 		  }
 		else
 		  return std::pair<bool,double>(true, magnet::math::bisect(FBisect_Wrapper<F>(f), old_t_max, t_max, fprecision));
@@ -203,7 +264,7 @@ namespace magnet {
 		if (std::signbit(fval[0]) == t_min_sign)
 		  {
 		    old_t_min = t_min;
-		    t_min += std::max(boundary_roots.first, boundary_roots.second);
+		    t_min += boundary_step;
 		  }
 		else
 		  return std::pair<bool,double>(true, magnet::math::bisect(FBisect_Wrapper<F>(f), old_t_min, t_min, fprecision));
@@ -229,7 +290,7 @@ namespace magnet {
 	      const double current_root = search_result.second;
 	      const double f1 = f.template eval<1>(current_root).front();
 	      const double inner_t_max = current_root - 2.0 * std::abs(f1 / f2max);
-	      auto check_result = nextDecreasingRoot(f, t_min, inner_t_max, halley_binary_digits, halley_iterations);
+	      auto check_result = nextDecreasingRoot(f, t_min, inner_t_max, fprecision, restarts, halley_binary_digits, halley_iterations);
 	      if (check_result.second != HUGE_VAL)
 		//We have found an earlier root. Return this one instead.
 		return check_result;
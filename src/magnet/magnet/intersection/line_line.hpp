@@ -34,10 +34,13 @@ namespace magnet {
 			 const double& length):
 	  w1(nw1), w2(nw2), q1(nq1), q2(nq2),
 	  w12(nw1 - nw2), r12(nr12), v12(nv12),
-	  _length(length)
+	  _length(length), _w1xw2(nw1 ^ nw2),
+	  _f1max(length * w12.nrm() + v12.nrm()),
+	  _f2max(w12.nrm() * ((2 * v12.nrm()) + (length * (nw1.nrm() + nw2.nrm()))))
 	{
 	  u1 = q1 * math::Quaternion::initialDirector();
 	  u2 = q2 * math::Quaternion::initialDirector();
+	  _u1xu2 = u1 ^ u2;
 	}
 
 	void stream(const double& dt)
@@ -49,6 +52,7 @@ namespace magnet {
 	  r12 += v12 * dt;
 	  u1 = q1 * math::Quaternion::initialDirector();
 	  u2 = q2 * math::Quaternion::initialDirector();
+	  _u1xu2 = u1 ^ u2;
 	}
   
 	std::pair<double, double> getCollisionPoints() const
@@ -67,20 +71,20 @@ namespace magnet {
 	  switch (deriv)
 	    {
 	    case 0:
-	      return ((u1 ^ u2) | r12);
+	      return (_u1xu2 | r12);
 	    case 1:
 	      return ((u1 | r12) * (w12 | u2)) 
 		+ ((u2 | r12) * (w12 | u1)) 
 		- ((w12 | r12) * (u1 | u2)) 
-		+ (((u1 ^ u2) | v12));
+		+ ((_u1xu2 | v12));
 	    case 2:
 	      return 2.0 
 		* (((u1 | v12) * (w12 | u2)) 
 		   + ((u2 | v12) * (w12 | u1))
 		   - ((u1 | u2) * (w12 | v12)))
-		- ((w12 | r12) * (w12 | (u1 ^ u2))) 
-		+ ((u1 | r12) * (u2 | (w1 ^ w2))) 
-		+ ((u2 | r12) * (u1 | (w1 ^ w2)))
+		- ((w12 | r12) * (w12 | _u1xu2)) 
+		+ ((u1 | r12) * (u2 | _w1xw2)) 
+		+ ((u2 | r12) * (u1 | _w1xw2))
 		+ ((w12 | u1) * (r12 | (w2 ^ u2)))
 		+ ((w12 | u2) * (r12 | (w1 ^ u1))); 
 	    default:
@@ -94,10 +98,9 @@ namespace magnet {
 	  switch (deriv)
 	    {
 	    case 1:
-	      return _length * w12.nrm() + v12.nrm();
+	      return _f1max;
 	    case 2:
-	      return w12.nrm() 
-		* ((2 * v12.nrm()) + (_length * (w1.nrm() + w2.nrm())));
+	      return _f2max;
 	    default:
 	      M_throw() << "Invalid access";
 	    }
@@ -144,6 +147,12 @@ namespace magnet {
 	math::Vector u1, u2;
 
 	const double _length;
+	//Terms which are constant or shared between the derivatives,
+	//calculated once per stream as the root search evaluates the
+	//function many times
+	const math::Vector _w1xw2;
+	math::Vector _u1xu2;
+	const double _f1max, _f2max;
       };
     }
 
@@ -29,14 +29,18 @@ namespace magnet {
       class OffcentreSpheresOverlapFunction
       {
       public:
+	static const size_t max_bounded_derivative = 3;
+
 	OffcentreSpheresOverlapFunction(const math::Vector& rij, const math::Vector& vij, const math::Vector& omegai, const math::Vector& omegaj,
 					const math::Vector& nu1, const math::Vector& nu2, const double diameter1, const double diameter2, 
 					const double maxdist, const double t, const double invgamma, const double t_min, const double t_max):
-	  w1(omegai), w2(omegaj), u1(nu1), u2(nu2), r12(rij), v12(vij), _diameter1(diameter1), _diameter2(diameter2), _invgamma(invgamma), _t(t), _t_min(t_min), _t_max(t_max)
+	  w1(omegai), w2(omegaj), u1(nu1), u2(nu2), r12(rij), v12(vij), _diameter1(diameter1), _diameter2(diameter2), _invgamma(invgamma), _t(t), _t_min(t_min), _t_max(t_max),
+	  _rot1(omegai, nu1), _rot2(omegaj, nu2)
 	{
 	  double Gmax = std::max(1 + t * invgamma, 1 + (t + t_max) * invgamma);
 	  const double sigmaij = 0.5 * (_diameter1 + _diameter2);
 	  const double sigmaij2 = sigmaij * sigmaij;
+	  _sigmaij2 = sigmaij2;
 	  double magw1 = w1.nrm(), magw2 = w2.nrm();
 	  double rijmax = Gmax * std::max(maxdist, rij.nrm());
 #ifdef MAGNET_DEBUG
@@ -53,25 +57,42 @@ namespace magnet {
 	  _f3max = 6 * vijmax * aijmax + 2 * rijmax * dotaijmax;
 	}
 
+	/*! \brief Evaluate the overlap function and its derivatives.
+
+	  Only the relative vectors required by the requested
+	  derivatives are calculated, as this is the innermost call of
+	  the root search.
+	 */
 	template<size_t first_deriv=0, size_t nderivs = 1>
 	std::array<double, nderivs> eval(const double dt = 0) const
 	{
-	  math::Vector u1new = Rodrigues(w1 * dt) * math::Vector(u1);
-	  math::Vector u2new = Rodrigues(w2 * dt) * math::Vector(u2);
+	  const size_t last_deriv = first_deriv + nderivs - 1;
+	  const math::Vector u1new = _rot1(dt);
+	  const math::Vector u2new = _rot2(dt);
 
-	  const double colldiam = 0.5 * (_diameter1 + _diameter2);
 	  const double growthfactor = 1 + _invgamma * (_t + dt);
 	  const math::Vector rij = r12 + dt * v12 + growthfactor * (u1new - u2new);
-	  const math::Vector vij = v12 + growthfactor * ((w1 ^ u1new) - (w2 ^ u2new)) + _invgamma * (u1new - u2new);
-	  const math::Vector aij = growthfactor * (-w1.nrm2() * u1new + w2.nrm2() * u2new) + 2 * _invgamma * ((w1 ^ u1new) - (w2 ^ u2new));
-	  const math::Vector dotaij = growthfactor * (-w1.nrm2() * (w1 ^ u1new) + w2.nrm2() * (w2 ^ u2new)) + 3 * _invgamma * (-w1.nrm2() * u1new + w2.nrm2() * u2new);
+
+	  math::Vector vij, aij, dotaij;
+	  if (last_deriv >= 1)
+	    {
+	      const math::Vector w1u1 = w1 ^ u1new, w2u2 = w2 ^ u2new;
+	      vij = v12 + growthfactor * (w1u1 - w2u2) + _invgamma * (u1new - u2new);
+	      if (last_deriv >= 2)
+		{
+		  const math::Vector wwu = - _rot1.w2 * u1new + _rot2.w2 * u2new;
+		  aij = growthfactor * wwu + 2 * _invgamma * (w1u1 - w2u2);
+		  if (last_deriv >= 3)
+		    dotaij = growthfactor * (-_rot1.w2 * w1u1 + _rot2.w2 * w2u2) + 3 * _invgamma * wwu;
+		}
+	    }
 
 	  std::array<double, nderivs> retval;
 	  for (size_t i(0); i < nderivs; ++i)
 	    switch (first_deriv + i) {
-	    case 0: retval[i] = (rij | rij) - growthfactor * growthfactor * colldiam * colldiam; break;
-	    case 1: retval[i] = 2 * (rij | vij) - 2 * _invgamma * growthfactor * colldiam * colldiam; break;
-	    case 2: retval[i] = 2 * vij.nrm2() + 2 * (rij | aij) - 2 * _invgamma * _invgamma * colldiam * colldiam; break;
+	    case 0: retval[i] = (rij | rij) - growthfactor * growthfactor * _sigmaij2; break;
+	    case 1: retval[i] = 2 * (rij | vij) - 2 * _invgamma * growthfactor * _sigmaij2; break;
+	    case 2: retval[i] = 2 * vij.nrm2() + 2 * (rij | aij) - 2 * _invgamma * _invgamma * _sigmaij2; break;
 	    case 3: retval[i] = 6 * (vij | aij) + 2 * (rij | dotaij); break;
 	    default:
 	      M_throw() << "Invalid access";
@@ -97,6 +118,33 @@ namespace magnet {
 	}
   
       private:
+	/*! \brief The offset of a sphere from its centre of rotation,
+	  rotated by Rodrigues' formula.
+
+	  The components of the offset parallel and perpendicular to
+	  the rotation axis are precomputed, so each evaluation only
+	  needs a single sine and cosine.
+	*/
+	struct Rotor {
+	  Rotor(const math::Vector& w, const math::Vector& u):
+	    par{0, 0, 0}, perp(u), cross{0, 0, 0}, magw(w.nrm()), w2(w.nrm2())
+	  {
+	    if (magw == 0) return;
+	    const math::Vector axis = w / magw;
+	    par = (axis | u) * axis;
+	    perp = u - par;
+	    cross = axis ^ u;
+	  }
+
+	  math::Vector operator()(const double dt) const {
+	    if (magw == 0) return perp;
+	    return par + std::cos(magw * dt) * perp + std::sin(magw * dt) * cross;
+	  }
+
+	  math::Vector par, perp, cross;
+	  double magw, w2;
+	};
+
 	const math::Vector w1;
 	const math::Vector w2;
 	const math::Vector u1;
@@ -105,8 +153,9 @@ namespace magnet {
 	const math::Vector v12;
 
 	const double _diameter1, _diameter2, _invgamma;
-	double _t, _f1max, _f2max, _f3max;
+	double _t, _f1max, _f2max, _f3max, _sigmaij2;
 	const double _t_min, _t_max;
+	const Rotor _rot1, _rot2;
       };
     }
   }
@@ -36,5 +36,35 @@ namespace magnet {
       if (inverse) f.flipSign();
       return detail::nextEvent(f, r * r);
     }
+
+    /*! \brief A batched form of the parabolic(ray)-sphere
+        intersection test, for N rays.
+
+      The times until intersection (or HUGE_VAL) are written to
+      t. The results are identical to calling parabola_sphere for
+      each ray, but the overlap functions are solved together (see
+      \ref detail::nextEvent).
+    */
+    template<bool inverse = false>
+    inline void parabola_sphere(const math::Vector* R, const math::Vector* V, const math::Vector* A, const double* r,
+				double* t, const size_t N)
+    {
+      const size_t blocksize = 64;
+      std::array<detail::PolynomialFunction<4>, blocksize> f;
+      double f0char[blocksize];
+
+      for (size_t start(0); start < N; start += blocksize)
+	{
+	  const size_t end = std::min(N, start + blocksize);
+	  for (size_t i(start); i < end; ++i)
+	    {
+	      const size_t l = i - start;
+	      f[l] = detail::PolynomialFunction<4>{R[i].nrm2() - r[i] * r[i], 2 * (V[i] | R[i]), 2 * (V[i].nrm2() + (A[i] | R[i])), 6 * (A[i] | V[i]), 6 * A[i].nrm2()};
+	      if (inverse) f[l].flipSign();
+	      f0char[l] = r[i] * r[i];
+	    }
+	  detail::nextEvent(f.data(), f0char, t + start, end - start);
+	}
+    }
   }
 }
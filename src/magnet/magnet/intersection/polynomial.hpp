@@ -117,15 +117,12 @@ namespace magnet {
 	}
       }
 
-      inline double nextEvent(const PolynomialFunction<4>& f, double f0char, double precision=1e-16)
+      /*! \brief Determine the next event of a quartic overlap
+          function, given the sorted real roots of its derivative.
+       */
+      inline double quarticNextEvent(const PolynomialFunction<4>& f, const std::array<double, 3>& roots, const size_t rootCount,
+				     double f0char, double precision)
       {
-	if (f[4] == 0) return nextEvent(f.lowerOrder());
-	
-	//Determine and sort the roots of the derivative
-	std::array<double, 3> roots;
-	const size_t rootCount = magnet::math::cubicSolve(3 * f[3] / f[4], 6 * f[2] / f[4], 6 * f[1] / f[4], roots[0], roots[1], roots[2]);
-	std::sort(roots.begin(), roots.begin() + rootCount);
-
 	const double rootthreshold = f0char * precision;
 	
 	auto bisectFunc = [&] (double t) { return f.eval(t).front(); };
@@ -176,6 +173,58 @@ namespace magnet {
 	  return magnet::math::bisect(bisectFunc, t0, t0+deltate, rootthreshold);
 	}
       }
+
+      inline double nextEvent(const PolynomialFunction<4>& f, double f0char, double precision=1e-16)
+      {
+	if (f[4] == 0) return nextEvent(f.lowerOrder());
+	
+	//Determine and sort the roots of the derivative
+	std::array<double, 3> roots;
+	const size_t rootCount = magnet::math::cubicSolve(3 * f[3] / f[4], 6 * f[2] / f[4], 6 * f[1] / f[4], roots[0], roots[1], roots[2]);
+	std::sort(roots.begin(), roots.begin() + rootCount);
+
+	return quarticNextEvent(f, roots, rootCount, f0char, precision);
+      }
+
+      /*! \brief Determine the next events of N quartic overlap
+          functions at once.
+
+	  The roots of the derivatives of all the functions are found
+	  with the batched cubicSolve, before each event is located.
+	  The times returned in t are identical to calling nextEvent
+	  on each function.
+       */
+      inline void nextEvent(const PolynomialFunction<4>* f, const double* f0char, double* t, const size_t N, double precision=1e-16)
+      {
+	const size_t blocksize = 64;
+	double p[blocksize], q[blocksize], r[blocksize], roots[3 * blocksize];
+	size_t rootCounts[blocksize], lanes[blocksize];
+
+	for (size_t start(0); start < N; start += blocksize)
+	  {
+	    const size_t end = std::min(N, start + blocksize);
+	    size_t n = 0;
+	    for (size_t i(start); i < end; ++i)
+	      if (f[i][4] == 0)
+		t[i] = nextEvent(f[i].lowerOrder());
+	      else
+		{
+		  p[n] = 3 * f[i][3] / f[i][4];
+		  q[n] = 6 * f[i][2] / f[i][4];
+		  r[n] = 6 * f[i][1] / f[i][4];
+		  lanes[n++] = i;
+		}
+
+	    magnet::math::cubicSolve(n, p, q, r, roots, rootCounts);
+
+	    for (size_t k(0); k < n; ++k)
+	      {
+		std::array<double, 3> sorted{{roots[3 * k], roots[3 * k + 1], roots[3 * k + 2]}};
+		std::sort(sorted.begin(), sorted.begin() + rootCounts[k]);
+		t[lanes[k]] = quarticNextEvent(f[lanes[k]], sorted, rootCounts[k], f0char[lanes[k]], precision);
+	      }
+	  }
+      }
     }
   }
 }
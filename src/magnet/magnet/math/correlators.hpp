@@ -22,6 +22,7 @@
 #include <vector>
 #include <utility>
 #include <tuple>
+#include <algorithm>
 
 namespace magnet {
   namespace math {    
@@ -455,6 +456,164 @@ namespace magnet {
       
       Container _correlators;
     };
+
+    /*! \brief An order-n (multiple-tau) correlator for a set of
+        time series which are sampled together at a regular interval.
+
+	Each time series (or "channel", e.g., the position of a
+	particle) is stored in a hierarchy of levels. Level \f$l\f$ is
+	sampled every \f$m^l\f$ samples, where \f$m\f$ is the scaling,
+	and holds the last \f$p\f$ samples of its level (\f$p\f$ is the
+	number of points). Whenever a level is sampled, the new sample
+	is correlated against the stored samples of that level, giving
+	the correlation at the lags \f$k\,m^l\f$ for
+	\f$k\in[0,p)\f$. The lags already resolved by the finer level
+	below are skipped.
+
+	This is the "order-n" algorithm of Frenkel and Smit
+	("Understanding Molecular Simulation," Algorithm 9), but with
+	the stored samples decimated instead of block averaged. This
+	makes the correlation of positions (the MSD) exact. The memory
+	required is \f$\mathcal{O}(N\,p\log T)\f$ and the work per
+	sample is \f$\mathcal{O}(N\,p)\f$, independent of the longest
+	lag \f$T\f$. The levels are only created once they are needed.
+
+	The correlations of the channels are summed into groups (e.g.,
+	species) as they are collected.
+
+	\tparam T The type of the sampled values.
+     */
+    template<class T>
+    class MultiTauCorrelator
+    {
+    public:
+      /*! \brief Constructor.
+
+	\param points The number of lags per level, \f$p\f$.
+	\param scaling The ratio of the sample intervals of
+	successive levels, \f$m\f$.
+	\param maxLevels The maximum number of levels.
+       */
+      MultiTauCorrelator(size_t points = 16, size_t scaling = 2, size_t maxLevels = 32):
+	_points(points), _scaling(scaling), _maxLevels(maxLevels), _groupCount(0), _samples(0)
+      {
+	if ((scaling < 2) || (points < scaling) || !maxLevels)
+	  M_throw() << "MultiTauCorrelator requires scaling >= 2, points >= scaling and at least one level, points="
+		    << points << ", scaling=" << scaling << ", maxLevels=" << maxLevels;
+      }
+
+      /*! \brief Set the number of channels and the group each one
+          is summed into, discarding all collected data.
+       */
+      void resize(const std::vector<size_t>& groups)
+      {
+	_groups = groups;
+	_groupCount = 0;
+	for (const size_t& group : _groups)
+	  _groupCount = std::max(_groupCount, group + 1);
+	clear();
+      }
+
+      //! \brief Discard all collected data.
+      void clear()
+      {
+	_levels.clear();
+	_samples = 0;
+      }
+
+      /*! \brief Add a new sample of every channel.
+
+	\param values The new value of each channel.
+	\param op A functor taking the current and a previous value
+	of a channel, and returning their (scalar) correlation.
+       */
+      template<class Op>
+      void push(const std::vector<T>& values, Op op)
+      {
+	if (values.size() != _groups.size())
+	  M_throw() << "Pushed " << values.size() << " values to a correlator with " << _groups.size() << " channels";
+
+	const size_t sample = _samples++;
+	size_t interval = 1;
+	for (size_t l(0); l < _maxLevels; ++l, interval *= _scaling)
+	  {
+	    //Each level is sampled at a multiple of the interval of the
+	    //level below
+	    if (sample % interval) break;
+
+	    if (l == _levels.size())
+	      _levels.push_back(Level(_groups.size() * _points, _groupCount * _points));
+
+	    Level& level = _levels[l];
+	    const size_t s = level._samples++;
+	    const size_t slot = s % _points;
+	    const size_t kmin = l ? minLag() : 0;
+	    const size_t kmax = std::min(s, _points - 1);
+
+	    for (size_t c(0); c < _groups.size(); ++c)
+	      {
+		T* history = &level._history[c * _points];
+		double* sums = &level._sums[_groups[c] * _points];
+		history[slot] = values[c];
+		for (size_t k(kmin); k <= kmax; ++k)
+		  sums[k] += op(values[c], history[(s - k) % _points]);
+	      }
+	  }
+      }
+
+      //! \brief The returned data type for getCorrelator().
+      struct Data
+      {
+	Data(size_t l, size_t o, double s): lag(l), origins(o), sum(s) {}
+
+	//! \brief The lag, in number of samples.
+	size_t lag;
+	//! \brief The number of time origins averaged over, per channel.
+	size_t origins;
+	//! \brief The sum of the correlation over all origins and all channels of the group.
+	double sum;
+      };
+
+      /*! \brief Returns the collected correlation of a group, for
+          every lag with at least one time origin, in order of
+          increasing lag.
+       */
+      std::vector<Data> getCorrelator(size_t group) const
+      {
+	std::vector<Data> retval;
+	size_t interval = 1;
+	for (size_t l(0); l < _levels.size(); ++l, interval *= _scaling)
+	  for (size_t k(l ? minLag() : 0); (k < _points) && (k < _levels[l]._samples); ++k)
+	    retval.push_back(Data(k * interval, _levels[l]._samples - k, _levels[l]._sums[group * _points + k]));
+	return retval;
+      }
+
+      //! \brief The number of samples taken.
+      size_t getSampleCount() const { return _samples; }
+
+    protected:
+      //! \brief The smallest lag of a level (above the first) not resolved by the level below.
+      size_t minLag() const { return (_points + _scaling - 1) / _scaling; }
+
+      struct Level
+      {
+	Level(size_t historySize, size_t sumsSize):
+	  _history(historySize), _sums(sumsSize, 0.0), _samples(0)
+	{}
+
+	std::vector<T> _history;
+	std::vector<double> _sums;
+	size_t _samples;
+      };
+
+      std::vector<Level> _levels;
+      std::vector<size_t> _groups;
+      size_t _points;
+      size_t _scaling;
+      size_t _maxLevels;
+      size_t _groupCount;
+      size_t _samples;
+    };
   }
 }
 
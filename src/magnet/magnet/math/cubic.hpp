@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <magnet/math/quadratic.hpp>
@@ -54,237 +55,316 @@ namespace magnet {
 	    double dderiv = 6 * root + 2 * p;
 	    
 	    //Try to use a quadratic scheme to improve the root
-	    std::pair<double, double> roots;
-	    try {
-	      roots = quadraticEquation(0.5 * dderiv, deriv, error);	    
-	      root += (std::abs(roots.first) < std::abs(roots.second)) ? roots.first : roots.second;
-	    } catch (NoQuadraticRoots&) { 
-	      //Switch to a linear scheme if the quadratic fails
-	      if (deriv == 0) return;
-	      root -= error / deriv;
-	    }
+	    double root1, root2;
+	    if (quadraticSolve(error, deriv, 0.5 * dderiv, root1, root2))
+	      root += (std::abs(root1) < std::abs(root2)) ? root1 : root2;
+	    else
+	      {
+		//Switch to a linear scheme if the quadratic fails
+		if (deriv == 0) return;
+		root -= error / deriv;
+	      }
 
 	    error = ((root + p)*root + q) * root + r;
 	  }
       }
-    }
 
-    //Please read  http://linus.it.uts.edu.au/~don/pubs/solving.html
-    //For solving cubics like x^3 + p * x^2 + q * x + r == 0
-    inline size_t 
-    cubicSolve(const double& p, const double& q, const double& r, double& root1, double& root2, double& root3)
-    {
-      static const double maxSqrt = std::sqrt(std::numeric_limits<double>::max());
+      //! \brief Returned by cubicSpecialCases if the cubic must be
+      //! solved by the general method.
+      const size_t cubicGeneralCase = std::numeric_limits<size_t>::max();
 
-      if (r == 0)
-	{
-	  //no constant term, so divide by x and the result is a
-	  //quadratic, but we must include the trivial x = 0 root
-	  try 
-	    {
-	      std::pair<double, double> roots = quadraticEquation(1.0, p, q);
-	      root1 = roots.first;
-	      root2 = roots.second;
-	      root3 = 0;
-	      if (root1 < root2) std::swap(root1,root2);
-	      if (root2 < 0) 
-		{
-		  std::swap(root2,root3);
-		  if (root1 < 0) std::swap(root1,root2);
-		}
-	      return 3;
-	    }
-	  catch (NoQuadraticRoots&)
-	    {}
+      /*! \brief Solves the special and degenerate cases of a cubic
+          \f$x^3 + p\,x^2 + q\,x + r = 0\f$.
 
-	  root1 = 0;
-	  return 1;
-	}
+	  \return The number of roots found, or cubicGeneralCase if
+	  the cubic must be solved with cubicOneRoot (if j > 0) or
+	  cubicThreeRoots, using the v, uo3 and j values calculated
+	  here.
+       */
+      inline size_t 
+      cubicSpecialCases(const double& p, const double& q, const double& r, double& root1, double& root2, double& root3,
+			double& v, double& uo3, double& j)
+      {
+	static const double maxSqrt = std::sqrt(std::numeric_limits<double>::max());
 
-      if ((p == 0) && (q == 0))
-	{
-	  //Special case
-	  //Equation is x^3 == -r
-	  if (r > 0) return 0;
-	  root1 = std::cbrt(-r);
-	  return 1;
-	}
+	if (r == 0)
+	  {
+	    //no constant term, so divide by x and the result is a
+	    //quadratic, but we must include the trivial x = 0 root
+	    if (quadraticSolve(q, p, 1.0, root1, root2))
+	      {
+		root3 = 0;
+		if (root1 < root2) std::swap(root1,root2);
+		if (root2 < 0) 
+		  {
+		    std::swap(root2,root3);
+		    if (root1 < 0) std::swap(root1,root2);
+		  }
+		return 3;
+	      }
+
+	    root1 = 0;
+	    return 1;
+	  }
 
-      if ((p > maxSqrt) || (p < -maxSqrt))
-	{
-	  //Equation limits to x^3 + p * x^2 == 0
-	  root1 = -p;
-	  return 1;
-	}
+	if ((p == 0) && (q == 0))
+	  {
+	    //Special case
+	    //Equation is x^3 == -r
+	    if (r > 0) return 0;
+	    root1 = std::cbrt(-r);
+	    return 1;
+	  }
 
-      if (q > maxSqrt)
-	{
-	  //Special case, if q is large and the root is -r/q,
-	  //The x^3 term is negligble, and all other terms cancel.
-	  root1 = -r / q;
-	  return 1;
-	}
+	if ((p > maxSqrt) || (p < -maxSqrt))
+	  {
+	    //Equation limits to x^3 + p * x^2 == 0
+	    root1 = -p;
+	    return 1;
+	  }
 
-      if (q < -maxSqrt)
-	{
-	  //Special case, equation is x^3 + q x == 0
-	  root1 = -std::sqrt(-q);
-	  return 1;
-	}
+	if (q > maxSqrt)
+	  {
+	    //Special case, if q is large and the root is -r/q,
+	    //The x^3 term is negligble, and all other terms cancel.
+	    root1 = -r / q;
+	    return 1;
+	  }
 
-      if ((r > maxSqrt) || (r < -maxSqrt))
-	{
-	  //Another special case
-	  //Equation is x^3 == -r
-	  root1 = -std::cbrt(r);
-	  return 1;
-	}
+	if (q < -maxSqrt)
+	  {
+	    //Special case, equation is x^3 + q x == 0
+	    root1 = -std::sqrt(-q);
+	    return 1;
+	  }
 
-      double v = r + (2.0 * p * p / 9.0 - q) * (p / 3.0);
+	if ((r > maxSqrt) || (r < -maxSqrt))
+	  {
+	    //Another special case
+	    //Equation is x^3 == -r
+	    root1 = -std::cbrt(r);
+	    return 1;
+	  }
 
-      if ((v > maxSqrt) || (v < -maxSqrt))
-	{
-	  root1 = -p;
-	  return 1;
-	}
+	v = r + (2.0 * p * p / 9.0 - q) * (p / 3.0);
 
-      double uo3 = q / 3.0 - p * p / 9.0;
-      double u2o3 = uo3 + uo3;
-      
-      if ((u2o3 > maxSqrt) || (u2o3 < -maxSqrt))
-	{
-	  if (p==0)
-	    {
-	      if (q > 0)
-		{
-		  root1 = -r / q;
-		  return 1;
-		}
-	      
-	      if (q < 0)
-		{
-		  root1 = -std::sqrt(-q);
-		  return 1;
-		}
-		
-	      root1 = 0;
-	      return 1;
-	    }
+	if ((v > maxSqrt) || (v < -maxSqrt))
+	  {
+	    root1 = -p;
+	    return 1;
+	  }
 
-	  root1 = -q/p;
-	  return 1;
-	}
+	uo3 = q / 3.0 - p * p / 9.0;
+	double u2o3 = uo3 + uo3;
 
-      double uo3sq4 = u2o3 * u2o3;
-      if (uo3sq4 > maxSqrt)
-	{
-	  if (p == 0)
-	    {
-	      if (q > 0)
-		{
-		  root1 = -r / q;
-		  return 1;
-		}
-
-	      if (q < 0)
-		{
-		  root1 = -std::sqrt(-q);
-		  return 1;
-		}
-
-	      root1 = 0;
-	      return 1;
-	    }
+	if ((u2o3 > maxSqrt) || (u2o3 < -maxSqrt))
+	  {
+	    if (p==0)
+	      {
+		if (q > 0)
+		  {
+		    root1 = -r / q;
+		    return 1;
+		  }
+
+		if (q < 0)
+		  {
+		    root1 = -std::sqrt(-q);
+		    return 1;
+		  }
+
+		root1 = 0;
+		return 1;
+	      }
+
+	    root1 = -q/p;
+	    return 1;
+	  }
 
-	  root1 = -q / p;
-	  return 1;
-	}
+	double uo3sq4 = u2o3 * u2o3;
+	if (uo3sq4 > maxSqrt)
+	  {
+	    if (p == 0)
+	      {
+		if (q > 0)
+		  {
+		    root1 = -r / q;
+		    return 1;
+		  }
+
+		if (q < 0)
+		  {
+		    root1 = -std::sqrt(-q);
+		    return 1;
+		  }
+
+		root1 = 0;
+		return 1;
+	      }
+
+	    root1 = -q / p;
+	    return 1;
+	  }
 
-      double j = (uo3sq4 * uo3) + v * v;
-  
-      if (j > 0) 
-	{//Only one root (but this test can be wrong due to a
-	  //catastrophic cancellation in j 
-	  //(i.e. (uo3sq4 * uo3) == v * v)
-	  double w = std::sqrt(j);
-	  if (v < 0)
-	    root1 = std::cbrt(0.5*(w-v)) - (uo3) * std::cbrt(2.0 / (w-v)) - p / 3.0;
-	  else
-	    root1 = uo3 * std::cbrt(2.0 / (w+v)) - std::cbrt(0.5*(w+v)) - p / 3.0;
-
-	  //We now polish the root up before we use it in other calculations
-	  detail::cubicNewtonRootPolish(p, q, r, root1);
-	 
-	  //We double check that there are no more roots by using a
-	  //quadratic formula on the factored problem, this helps when
-	  //the j test is wrong due to numerical error.
-	  
-	  //We have a choice of either -r/root1, or q -
-	  //(p+root1)*root1 for the constant term of the quadratic. 
-	  //
-	  //The division one usually results in more accurate roots
-	  //when it finds them but fails to detect real roots more
-	  //often than the multiply.
-	  try 
-	    {
-	      std::pair<double, double> roots = quadraticEquation(1.0, p + root1, -r/root1);
-	      root2 = roots.first;
-	      root3 = roots.second;
-	      return 3;
-	    } 
-	  catch (NoQuadraticRoots&)
-	    {}
-
-	  //However, the multiply detects roots where there are none,
-	  //the division does not. So we must either accept missing
-	  //roots or extra roots, here we choose missing roots
-	  //
-	  //if (quadSolve(q-(p+root1)*root1, p + root1, 1.0, root2, root3)) 
-	  //  return 3;
-
-	  return 1;
-	}
-  
-      if (uo3 >= 0)
-	{//Multiple root detected	  
-	  root1 = root2 = root3 = std::cbrt(v) - p / 3.0;
+	j = (uo3sq4 * uo3) + v * v;
+
+	if ((j <= 0) && (uo3 >= 0))
+	  {//Multiple root detected
+	    root1 = root2 = root3 = std::cbrt(v) - p / 3.0;
+	    return 3;
+	  }
+
+	return cubicGeneralCase;
+      }
+
+      //! \brief The general case of a cubic with a single real root.
+      inline size_t
+      cubicOneRoot(const double& p, const double& q, const double& r, double& root1, double& root2, double& root3,
+		   const double& v, const double& uo3, const double& j)
+      {
+	//Only one root (but this test can be wrong due to a
+	//catastrophic cancellation in j 
+	//(i.e. (uo3sq4 * uo3) == v * v)
+	double w = std::sqrt(j);
+	if (v < 0)
+	  root1 = std::cbrt(0.5*(w-v)) - (uo3) * std::cbrt(2.0 / (w-v)) - p / 3.0;
+	else
+	  root1 = uo3 * std::cbrt(2.0 / (w+v)) - std::cbrt(0.5*(w+v)) - p / 3.0;
+
+	//We now polish the root up before we use it in other calculations
+	detail::cubicNewtonRootPolish(p, q, r, root1);
+
+	//We double check that there are no more roots by using a
+	//quadratic formula on the factored problem, this helps when
+	//the j test is wrong due to numerical error.
+
+	//We have a choice of either -r/root1, or q -
+	//(p+root1)*root1 for the constant term of the quadratic. 
+	//
+	//The division one usually results in more accurate roots
+	//when it finds them but fails to detect real roots more
+	//often than the multiply.
+	if (quadraticSolve(-r/root1, p + root1, 1.0, root2, root3))
 	  return 3;
-	}
 
-      double muo3 = - uo3;
-      double s;
-      if (muo3 > 0)
-	{
-	  s = std::sqrt(muo3);
-	  if (p > 0) s = -s;
-	}
-      else
-	s = 0;
-      
-      double scube = s * muo3;
-      if (scube == 0)
-	{
-	  root1 = - p / 3.0;
-	  return 1;
-	}
-      
-      double t = - v / (scube + scube);
-      double k = std::acos(t) / 3.0;
-      double cosk = std::cos(k);
-      root1 = (s + s) * cosk - p / 3.0;
-      
-      double sinsqk = 1.0 - cosk * cosk;
-      if (sinsqk < 0) return 1;
+	//However, the multiply detects roots where there are none,
+	//the division does not. So we must either accept missing
+	//roots or extra roots, here we choose missing roots
+	//
+	//if (quadSolve(q-(p+root1)*root1, p + root1, 1.0, root2, root3)) 
+	//  return 3;
+
+	return 1;
+      }
+
+      //! \brief The general case of a cubic with three real roots.
+      inline size_t
+      cubicThreeRoots(const double& p, const double& q, const double& r, double& root1, double& root2, double& root3,
+		      const double& v, const double& uo3)
+      {
+	double muo3 = - uo3;
+	double s;
+	if (muo3 > 0)
+	  {
+	    s = std::sqrt(muo3);
+	    if (p > 0) s = -s;
+	  }
+	else
+	  s = 0;
+
+	double scube = s * muo3;
+	if (scube == 0)
+	  {
+	    root1 = - p / 3.0;
+	    return 1;
+	  }
+
+	double t = - v / (scube + scube);
+	double k = std::acos(t) / 3.0;
+	double cosk = std::cos(k);
+	root1 = (s + s) * cosk - p / 3.0;
 
-      double rt3sink = std::sqrt(3.0) * std::sqrt(sinsqk);
-      root2 = s * (-cosk + rt3sink) - p / 3.0;
-      root3 = s * (-cosk - rt3sink) - p / 3.0;
+	double sinsqk = 1.0 - cosk * cosk;
+	if (sinsqk < 0) return 1;
 
-      detail::cubicNewtonRootPolish(p, q, r, root1);
-      detail::cubicNewtonRootPolish(p, q, r, root2);
-      detail::cubicNewtonRootPolish(p, q, r, root3);
+	double rt3sink = std::sqrt(3.0) * std::sqrt(sinsqk);
+	root2 = s * (-cosk + rt3sink) - p / 3.0;
+	root3 = s * (-cosk - rt3sink) - p / 3.0;
 
-      return 3;
+	detail::cubicNewtonRootPolish(p, q, r, root1);
+	detail::cubicNewtonRootPolish(p, q, r, root2);
+	detail::cubicNewtonRootPolish(p, q, r, root3);
+
+	return 3;
+      }
+    }
+
+    //Please read  http://linus.it.uts.edu.au/~don/pubs/solving.html
+    //For solving cubics like x^3 + p * x^2 + q * x + r == 0
+    inline size_t 
+    cubicSolve(const double& p, const double& q, const double& r, double& root1, double& root2, double& root3)
+    {
+      double v, uo3, j;
+      const size_t nroots = detail::cubicSpecialCases(p, q, r, root1, root2, root3, v, uo3, j);
+      if (nroots != detail::cubicGeneralCase)
+	return nroots;
+
+      if (j > 0)
+	return detail::cubicOneRoot(p, q, r, root1, root2, root3, v, uo3, j);
+
+      return detail::cubicThreeRoots(p, q, r, root1, root2, root3, v, uo3);
+    }
+
+    /*! \brief Solves a batch of N cubics of the form
+        \f$x^3 + p_i\,x^2 + q_i\,x + r_i = 0\f$.
+
+	The roots of the i-th cubic are written to roots[3*i],
+	roots[3*i+1] and roots[3*i+2], and the number of roots found
+	to nroots[i]. The roots are identical to those of the scalar
+	cubicSolve.
+
+	The cubics are classified in blocks, and the lanes which need
+	the single-root or three-root general solution are gathered
+	into separate lists. Each list is then solved in a loop
+	without data dependent branches between the two methods,
+	which keeps the branch predictor (and any vectorisation of the
+	loop bodies) effective when many differently shaped cubics are
+	solved together.
+     */
+    inline void
+    cubicSolve(const size_t N, const double* p, const double* q, const double* r, double* roots, size_t* nroots)
+    {
+      const size_t blocksize = 64;
+      double v[blocksize], uo3[blocksize], j[blocksize];
+      size_t one[blocksize], three[blocksize];
+
+      for (size_t start(0); start < N; start += blocksize)
+	{
+	  const size_t end = std::min(N, start + blocksize);
+	  size_t nOne = 0, nThree = 0;
+	  for (size_t i(start); i < end; ++i)
+	    {
+	      const size_t l = i - start;
+	      nroots[i] = detail::cubicSpecialCases(p[i], q[i], r[i], roots[3 * i], roots[3 * i + 1], roots[3 * i + 2], v[l], uo3[l], j[l]);
+	      if (nroots[i] != detail::cubicGeneralCase) continue;
+	      if (j[l] > 0)
+		one[nOne++] = i;
+	      else
+		three[nThree++] = i;
+	    }
+
+	  for (size_t k(0); k < nOne; ++k)
+	    {
+	      const size_t i = one[k], l = i - start;
+	      nroots[i] = detail::cubicOneRoot(p[i], q[i], r[i], roots[3 * i], roots[3 * i + 1], roots[3 * i + 2], v[l], uo3[l], j[l]);
+	    }
+
+	  for (size_t k(0); k < nThree; ++k)
+	    {
+	      const size_t i = three[k], l = i - start;
+	      nroots[i] = detail::cubicThreeRoots(p[i], q[i], r[i], roots[3 * i], roots[3 * i + 1], roots[3 * i + 2], v[l], uo3[l]);
+	    }
+	}
     }
   }
 }
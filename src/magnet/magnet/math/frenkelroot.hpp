@@ -82,14 +82,10 @@ namespace magnet {
 	    if (f0 > 0) halff2max = -halff2max;
 	    
 	    std::pair<double, double> worst_case_roots;
-	    try {
-	      worst_case_roots = quadraticEquation(halff2max, f1, f0);
-	    } catch (NoQuadraticRoots&)
-	      {
-		M_throw() << "When trying to improve the bounds using worst-case estimates, it was "
-		  "found that they could not be improved. This implies there is "
-		  "implementation error (zero max 2nd deriv?) in the passed function.";
-	      }
+	    if (!quadraticSolve(f0, f1, halff2max, worst_case_roots.first, worst_case_roots.second))
+	      M_throw() << "When trying to improve the bounds using worst-case estimates, it was "
+		"found that they could not be improved. This implies there is "
+		"implementation error (zero max 2nd deriv?) in the passed function.";
 
 	    //Sort the roots
 	    if (worst_case_roots.first > worst_case_roots.second) std::swap(worst_case_roots.first, worst_case_roots.second);
@@ -106,13 +102,11 @@ namespace magnet {
 	    else
 	      t_high += worst_case_roots.first;
 	    
-	    //Now perform the first step of the shooting
+	    //Now perform the first step of the shooting. If the
+	    //shooting fails, restart from the other boundary
 	    std::pair<double, double> estimate_roots;
-	    try {
-	      estimate_roots = quadraticEquation(halff2, f1, f0);
-	    } catch (NoQuadraticRoots&)
-	      //If the shooting fails, restart from the other boundary
-	      { continue; }
+	    if (!quadraticSolve(f0, f1, halff2, estimate_roots.first, estimate_roots.second))
+	      continue;
 	    
 	    //Sort the roots
 	    if (estimate_roots.first > estimate_roots.second) std::swap(estimate_roots.first, estimate_roots.second);
@@ -154,15 +148,15 @@ namespace magnet {
 
 	      tempfL.stream(deltaT);
 
-	      try {
-		std::pair<double, double> estimate_roots = quadraticEquation(0.5 * tempfL.template eval<2>(), tempfL.template eval<1>(), tempfL.template eval<0>());
-		if (std::abs(estimate_roots.first) < std::abs(estimate_roots.second))
-		  deltaT = estimate_roots.first;
-		else
-		  deltaT = estimate_roots.second;
-	      } catch (NoQuadraticRoots&)
-		//If the shooting fails, quit the loop
-		{ break; }
+	      //If the shooting fails, quit the loop
+	      std::pair<double, double> estimate_roots;
+	      if (!quadraticSolve(tempfL.template eval<0>(), tempfL.template eval<1>(), 0.5 * tempfL.template eval<2>(), estimate_roots.first, estimate_roots.second))
+		break;
+
+	      if (std::abs(estimate_roots.first) < std::abs(estimate_roots.second))
+		deltaT = estimate_roots.first;
+	      else
+		deltaT = estimate_roots.second;
 
 	      if (fabs(deltaT) <  timescale)
 		return std::pair<bool,double>(true, working_time + deltaT);
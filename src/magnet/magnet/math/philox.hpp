@@ -0,0 +1,159 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <istream>
+#include <ostream>
+
+namespace magnet {
+  namespace math {
+    /*! \brief The Philox4x32-10 counter-based random number
+        generator.
+
+      This is the generator of "Parallel random numbers: as easy as
+      1, 2, 3," by J. K. Salmon, M. A. Moraes, R. O. Dror and
+      D. E. Shaw. Each block of four numbers is a bijection (ten
+      rounds of multiplications and xors) of a 128 bit counter under
+      a 64 bit key. There is no state other than the counter, so a
+      generator for any key and counter may be created (or jumped to
+      any position) at no cost, and independent streams can be
+      handed out to threads without any communication between them.
+
+      The first word of the counter is the position of the block in
+      the stream, the other three words (and the key) identify the
+      stream. Each stream therefore holds \f$2^{34}\f$ numbers.
+
+      This satisfies the UniformRandomBitGenerator concept, so it
+      can be used with the distributions of the standard library.
+     */
+    class Philox
+    {
+    public:
+      typedef uint32_t result_type;
+      typedef std::array<uint32_t, 4> counter_type;
+      typedef std::array<uint32_t, 2> key_type;
+
+      /*! \brief Constructs the start of a stream.
+
+	\param key The key of the generator.
+	\param c1 The second word of the counter.
+	\param c2 The third word of the counter.
+	\param c3 The fourth word of the counter.
+      */
+      Philox(uint64_t key = 0, uint32_t c1 = 0, uint32_t c2 = 0, uint32_t c3 = 0)
+      { seed(key, c1, c2, c3); }
+
+      //! \brief Moves the generator to the start of another stream.
+      void seed(uint64_t key, uint32_t c1 = 0, uint32_t c2 = 0, uint32_t c3 = 0)
+      {
+	_key = key_type{{uint32_t(key), uint32_t(key >> 32)}};
+	_counter = counter_type{{0, c1, c2, c3}};
+	_index = 4;
+      }
+
+      static constexpr result_type min() { return 0; }
+      static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+      result_type operator()()
+      {
+	if (_index == 4)
+	  {
+	    _block = generate(_counter, _key);
+	    ++_counter[0];
+	    _index = 0;
+	  }
+	return _block[_index++];
+      }
+
+      //! \brief The number of values drawn from the stream so far.
+      uint64_t position() const
+      { return 4 * uint64_t(_counter[0]) + _index - 4; }
+
+      //! \brief Jumps to a position in the stream.
+      void setPosition(uint64_t pos)
+      {
+	_counter[0] = uint32_t(pos / 4);
+	_index = 4;
+	if (pos % 4)
+	  {
+	    _block = generate(_counter, _key);
+	    ++_counter[0];
+	    _index = pos % 4;
+	  }
+      }
+
+      //! \brief Skips the next n values of the stream.
+      void discard(unsigned long long n) { setPosition(position() + n); }
+
+      /*! \brief Calculates the block of four numbers for a counter
+	  and key.
+       */
+      static counter_type generate(counter_type ctr, key_type key)
+      {
+	for (size_t round(0); round < 10; ++round)
+	  {
+	    const uint64_t prod0 = uint64_t(0xD2511F53) * ctr[0];
+	    const uint64_t prod1 = uint64_t(0xCD9E8D57) * ctr[2];
+	    ctr = counter_type{{uint32_t(prod1 >> 32) ^ ctr[1] ^ key[0], uint32_t(prod1),
+				uint32_t(prod0 >> 32) ^ ctr[3] ^ key[1], uint32_t(prod0)}};
+	    key[0] += 0x9E3779B9;
+	    key[1] += 0xBB67AE85;
+	  }
+	return ctr;
+      }
+
+      bool operator==(const Philox& o) const
+      { return (_key == o._key) && (_counter == o._counter) && (_index == o._index); }
+
+      bool operator!=(const Philox& o) const { return !(*this == o); }
+
+      friend std::ostream& operator<<(std::ostream& os, const Philox& rng)
+      {
+	return os << rng._key[0] << " " << rng._key[1] << " " << rng._counter[0] << " " << rng._counter[1]
+		  << " " << rng._counter[2] << " " << rng._counter[3] << " " << rng._index;
+      }
+
+      friend std::istream& operator>>(std::istream& is, Philox& rng)
+      {
+	key_type key;
+	counter_type counter;
+	unsigned index;
+	if (is >> key[0] >> key[1] >> counter[0] >> counter[1] >> counter[2] >> counter[3] >> index)
+	  {
+	    rng._key = key;
+	    rng._counter = counter;
+	    rng._index = index;
+	    if (index != 4)
+	      {
+		--counter[0];
+		rng._block = generate(counter, key);
+	      }
+	  }
+	return is;
+      }
+
+    private:
+      key_type _key;
+      counter_type _counter;
+      counter_type _block;
+      unsigned _index;
+    };
+  }
+}
@@ -62,6 +62,37 @@ namespace magnet {
 			      std::complex<double>(real, imag));
     }
 
+    /*! \brief Solves a quadratic equation of the form
+      \f$A\,x^2+B\,x+C=0\f$ for the real roots, without throwing.
+
+      This gives the same roots as \ref quadraticEquation, but
+      reports a missing root through the return value. Root solvers
+      which call this in their inner loops (e.g., \ref cubicSolve)
+      should use this form, as unwinding an exception is orders of
+      magnitude more expensive than the solution itself.
+
+      \return True if the roots are real and were written to root1
+      and root2.
+    */
+    inline bool 
+    quadraticSolve(const double& C, const double& B, const double& A, double& root1, double& root2)
+    {
+      if (A == 0)
+	{
+	  if (B == 0) return false;
+	  root1 = root2 = - C / B;
+	  return true;
+	}
+      
+      const double discriminant = B * B - 4 * A * C;
+      if (discriminant < 0) return false;
+      const double arg = std::sqrt(discriminant);
+      const double q = -0.5 * ( B + ((B < 0) ? -arg : arg));
+      root1 = q / A;
+      root2 = C / q;
+      return true;
+    }
+
     /*! \brief Solves a quadratic equation of the form
       \f$a\,x^2+b\,x+c=0\f$ for the real roots.
 
@@ -82,19 +113,10 @@ namespace magnet {
     inline std::pair<double, double>
     quadraticEquation(const double a, const double b, const double c)
     {
-      if (a == 0)
-	{
-	  if (b == 0) throw NoQuadraticRoots();
-	  double root = - c / b;
-	  return std::make_pair(root, root);
-	}
-      
-      double discriminant = b * b - 4 * a * c;
-      if (discriminant < 0) throw NoQuadraticRoots();
-      double arg = std::sqrt(discriminant);
-      double q = -0.5 * ( b + ((b < 0) ? -arg : arg));
-      
-      return std::make_pair(q / a, c / q);
+      std::pair<double, double> roots;
+      if (!quadraticSolve(c, b, a, roots.first, roots.second))
+	throw NoQuadraticRoots();
+      return roots;
     }
 
     /*! \brief Solve the equation $f2\,x^2 / 2 + f1\,x + f0 = 0$. */
@@ -108,17 +130,5 @@ namespace magnet {
       root2 = 2 * f0 / q;
       return 2;
     }
-
-    inline bool 
-    quadraticSolve(const double& C, const double& B, const double& A, double& root1, double& root2)
-    {
-      try {
-	std::pair<double, double> roots = magnet::math::quadraticEquation(A, B, C);
-	root1 = roots.first; root2 = roots.second;
-	return true;
-      }
-      catch (magnet::math::NoQuadraticRoots&)
-	{ return false; }
-    }
   }
 }
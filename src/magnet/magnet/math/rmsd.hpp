@@ -0,0 +1,229 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <magnet/math/matrix.hpp>
+#include <magnet/thread/threadpool.hpp>
+#include <magnet/exception.hpp>
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace magnet {
+  namespace math {
+    /*! \brief The root mean square deviation between two sets of
+        points, minimised over all rotations of the second set.
+
+      This is evaluated from the singular values \f$s_i\f$ of the
+      correlation matrix \f$\sum_n {\bf a}_n\,{\bf b}_n^T\f$ as
+      \f$\sqrt{(\sum_n a_n^2 + \sum_n b_n^2 - 2\sum_i s_i)/N}\f$. The
+      points are not translated, so both sets should already share a
+      common centre (e.g., their centre of mass).
+
+      \param reverse Compare the points of a against the points of b
+      taken in reverse order.
+    */
+    inline double rotationalRMSD(const std::vector<NVector<double,3> >& a,
+				 const std::vector<NVector<double,3> >& b,
+				 const bool reverse = false)
+    {
+      if (a.size() != b.size())
+	M_throw() << "Cannot calculate the RMSD of structures with different numbers of points ("
+		  << a.size() << " and " << b.size() << ")";
+
+      NMatrix<double,3> corr;
+      double norms = 0;
+      for (size_t n(0); n < a.size(); ++n)
+	{
+	  const NVector<double,3>& bn = reverse ? b[b.size() - 1 - n] : b[n];
+	  norms += a[n].nrm2() + bn.nrm2();
+	  corr += Dyadic(a[n], bn);
+	}
+
+      //The singular values of corr are the square roots of the
+      //eigenvalues of corr^T corr
+      const std::array<double, 3> eigenvals = symmetric_eigen_decomposition(corr.transpose() * corr).second;
+      double singularSum = 0;
+      for (const double& val : eigenvals)
+	singularSum += std::sqrt(std::max(val, 0.0));
+
+      return std::sqrt(std::max((norms - 2 * singularSum) / a.size(), 0.0));
+    }
+
+    /*! \brief A bit-packed contact map of a chain of points.
+
+      The bit of each pair i < j in the upper triangle of the map is
+      set if the points are within the contact distance of each
+      other.
+    */
+    class ContactMap
+    {
+    public:
+      ContactMap(const std::vector<NVector<double,3> >& points, const double contactDistance):
+	_N(points.size()),
+	_bits((pairCount(points.size()) + 63) / 64, 0)
+      {
+	for (size_t i(0); i < _N; ++i)
+	  for (size_t j(i + 1); j < _N; ++j)
+	    if ((points[i] - points[j]).nrm() <= contactDistance)
+	      _bits[index(i, j) / 64] |= uint64_t(1) << (index(i, j) % 64);
+      }
+
+      //! \brief The number of points in the chain.
+      size_t size() const { return _N; }
+
+      //! \brief Test if the points i and j (i != j) are in contact.
+      bool operator()(size_t i, size_t j) const
+      {
+	if (i > j) std::swap(i, j);
+	return (_bits[index(i, j) / 64] >> (index(i, j) % 64)) & 1;
+      }
+
+      /*! \brief A mask selecting the pairs (i, j > i + skip) of a
+          chain of N points, for overlap().
+      */
+      static std::vector<uint64_t> mask(const size_t N, const size_t skip)
+      {
+	std::vector<uint64_t> retval((pairCount(N) + 63) / 64, 0);
+	for (size_t i(0); i < N; ++i)
+	  for (size_t j(i + 1 + skip); j < N; ++j)
+	    retval[index(i, j, N) / 64] |= uint64_t(1) << (index(i, j, N) % 64);
+	return retval;
+      }
+
+      /*! \brief The normalised overlap of the masked contacts of two
+          maps, \f$\sum c_1 c_2 / \sqrt{\sum c_1 \sum c_2}\f$.
+
+	  \return 0 if either map has no contacts.
+      */
+      static double overlap(const ContactMap& c1, const ContactMap& c2, const std::vector<uint64_t>& mask)
+      {
+	size_t common = 0, count1 = 0, count2 = 0;
+	for (size_t w(0); w < mask.size(); ++w)
+	  {
+	    const uint64_t b1 = c1._bits[w] & mask[w], b2 = c2._bits[w] & mask[w];
+	    count1 += std::bitset<64>(b1).count();
+	    count2 += std::bitset<64>(b2).count();
+	    common += std::bitset<64>(b1 & b2).count();
+	  }
+
+	const double norm = std::sqrt(double(count1)) * std::sqrt(double(count2));
+	if (norm == 0) return 0;
+	return common / norm;
+      }
+
+    private:
+      static size_t pairCount(const size_t N) { return N * (N - (N > 0)) / 2; }
+
+      //! \brief The bit index of the pair i < j, stored row by row.
+      static size_t index(const size_t i, const size_t j, const size_t N)
+      { return i * (2 * N - i - 1) / 2 + (j - i - 1); }
+
+      size_t index(const size_t i, const size_t j) const { return index(i, j, _N); }
+
+      size_t _N;
+      std::vector<uint64_t> _bits;
+    };
+
+    /*! \brief Calls func(i, j) for every pair i < j of N items,
+        sharing the work out over a ThreadPool.
+
+      The pairs are processed in square tiles of blockSize by
+      blockSize items, so that the data of the items of a tile remain
+      in cache. Each pair is visited exactly once, so func may write
+      to storage for the pair without locking.
+    */
+    template<class Func>
+    void forEachPair(const size_t N, thread::ThreadPool& pool, Func func, const size_t blockSize = 32)
+    {
+      std::vector<std::pair<size_t, size_t> > tiles;
+      for (size_t iStart(0); iStart < N; iStart += blockSize)
+	for (size_t jStart(iStart); jStart < N; jStart += blockSize)
+	  tiles.push_back(std::make_pair(iStart, jStart));
+
+      pool.parallel_for(0, tiles.size(), [&](const size_t tile)
+			{
+			  const size_t iStart = tiles[tile].first, jStart = tiles[tile].second;
+			  const size_t iEnd = std::min(N, iStart + blockSize);
+			  const size_t jEnd = std::min(N, jStart + blockSize);
+			  for (size_t i(iStart); i < iEnd; ++i)
+			    for (size_t j(std::max(jStart, i + 1)); j < jEnd; ++j)
+			      func(i, j);
+			}, 1);
+    }
+
+    //! \brief A cluster found by greedyClusters().
+    struct Cluster
+    {
+      //! \brief The item the cluster was formed around.
+      size_t centre;
+      //! \brief The members of the cluster (including the centre), in ascending order.
+      std::vector<size_t> members;
+    };
+
+    /*! \brief Greedy clustering of N items.
+
+      Each item i starts with a list of itself and its neighbours j,
+      where neighbour(i, j) is true. The item with the longest list
+      (ties are broken by comparing the lists, then the item indices)
+      forms a cluster, and its members are removed from the lists of
+      every item. This repeats while the longest list has more than
+      threshold members.
+    */
+    template<class Pred>
+    std::vector<Cluster> greedyClusters(const size_t N, Pred neighbour, const size_t threshold)
+    {
+      std::vector<std::vector<size_t> > lists(N);
+      for (size_t i(0); i < N; ++i)
+	{
+	  lists[i].push_back(i);
+	  for (size_t j(0); j < N; ++j)
+	    if ((i != j) && neighbour(i, j))
+	      lists[i].push_back(j);
+	}
+
+      std::vector<Cluster> clusters;
+      std::vector<bool> clustered(N, false);
+      while (N)
+	{
+	  size_t best = 0;
+	  for (size_t i(1); i < N; ++i)
+	    if ((lists[i].size() > lists[best].size())
+		|| ((lists[i].size() == lists[best].size()) && !(lists[i] < lists[best])))
+	      best = i;
+
+	  if (lists[best].size() <= threshold) break;
+
+	  Cluster cluster;
+	  cluster.centre = best;
+	  cluster.members = lists[best];
+	  std::sort(cluster.members.begin(), cluster.members.end());
+	  for (const size_t& member : cluster.members)
+	    clustered[member] = true;
+	  clusters.push_back(cluster);
+
+	  for (std::vector<size_t>& list : lists)
+	    list.erase(std::remove_if(list.begin(), list.end(), [&](const size_t& id) { return clustered[id]; }), list.end());
+	}
+
+      return clusters;
+    }
+  }
+}
@@ -0,0 +1,182 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <magnet/math/vector.hpp>
+#include <magnet/math/wigner3J.hpp>
+#include <complex>
+#include <cmath>
+#include <vector>
+
+namespace magnet {
+  namespace math {
+    /*! \brief Evaluates all of the spherical harmonics \f$Y_l^m\f$
+        with \f$l<L\f$ for a direction.
+
+      The associated Legendre functions are generated by the standard
+      three term recurrence in \f$l\f$, with the \f$\sin^m\theta\,
+      e^{i\,m\,\phi}\f$ factor of each harmonic formed directly as
+      \f$(\hat{x}+i\,\hat{y})^m\f$. The recurrence and normalisation
+      coefficients are computed once on construction, so evaluating
+      the harmonics of a direction needs no trigonometric functions.
+
+      The harmonics are stored flat, with \f$Y_l^m\f$ at index
+      \f$l^2+l+m\f$. They include the Condon-Shortley phase and match
+      boost::math::spherical_harmonic with \f$z\f$ as the polar axis.
+    */
+    class SphericalHarmonics
+    {
+    public:
+      typedef std::complex<double> Complex;
+
+      SphericalHarmonics(const size_t L):
+	_L(L),
+	_norm(L * L),
+	_a(L * L),
+	_b(L * L),
+	_pmm(L)
+      {
+	for (size_t m(0); m < L; ++m)
+	  {
+	    //P_m^m(z) = (-1)^m (2m-1)!! sin^m(theta)
+	    _pmm[m] = (m == 0) ? 1 : -_pmm[m - 1] * (2.0 * m - 1);
+	    for (size_t l(m); l < L; ++l)
+	      {
+		_norm[index(l, m)] = std::exp(0.5 * (std::log((2.0 * l + 1) / (4 * M_PI))
+						     + std::lgamma(l - m + 1.0) - std::lgamma(l + m + 1.0)));
+		if (l > m)
+		  {
+		    _a[index(l, m)] = (2.0 * l - 1) / (l - m);
+		    _b[index(l, m)] = (l + m - 1.0) / (l - m);
+		  }
+	      }
+	  }
+      }
+
+      //! \brief The number of l values evaluated.
+      size_t getL() const { return _L; }
+
+      //! \brief The number of harmonics stored by evaluate().
+      size_t size() const { return _L * _L; }
+
+      //! \brief The flat index of \f$Y_l^m\f$.
+      static size_t index(const size_t l, const int m) { return l * l + l + m; }
+
+      /*! \brief Evaluate the harmonics of a unit vector.
+
+	\param out Storage for size() values.
+      */
+      void evaluate(const NVector<double, 3>& unit, Complex* out) const
+      {
+	const double z = unit[2];
+	const Complex xy(unit[0], unit[1]);
+	//(x + i y)^m = sin^m(theta) e^{i m phi}
+	Complex xym(1, 0);
+	for (size_t m(0); m < _L; ++m)
+	  {
+	    double pl2 = 0, pl1 = _pmm[m];
+	    for (size_t l(m); l < _L; ++l)
+	      {
+		double pl = pl1;
+		if (l > m)
+		  {
+		    pl = _a[index(l, m)] * z * pl1 - _b[index(l, m)] * pl2;
+		    pl2 = pl1;
+		    pl1 = pl;
+		  }
+
+		const Complex val = _norm[index(l, m)] * pl * xym;
+		out[index(l, m)] = val;
+		//Y_l^{-m} = (-1)^m conj(Y_l^m)
+		if (m)
+		  out[index(l, -int(m))] = ((m % 2) ? -1.0 : 1.0) * std::conj(val);
+	      }
+	    xym *= xy;
+	  }
+      }
+
+    private:
+      size_t _L;
+      std::vector<double> _norm;
+      std::vector<double> _a;
+      std::vector<double> _b;
+      std::vector<double> _pmm;
+    };
+
+    /*! \brief The Steinhardt rotational invariant \f$Q_l\f$ of a set
+        of averaged harmonics \f$\bar{q}_{lm}\f$.
+
+      \f$Q_l=\sqrt{\frac{4\pi}{2l+1}\sum_m|\bar{q}_{lm}|^2}\f$, where
+      qlm points to the \f$2l+1\f$ values for m=-l to l.
+    */
+    inline double steinhardtQ(const int l, const std::complex<double>* qlm)
+    {
+      double sum = 0;
+      for (int m(-l); m <= l; ++m)
+	sum += std::norm(qlm[m + l]);
+      return std::sqrt(sum * 4 * M_PI / (2.0 * l + 1));
+    }
+
+    /*! \brief The normalised Steinhardt invariant \f$\hat{W}_l\f$.
+
+      \f$\hat{W}_l=\sum_{m_1+m_2+m_3=0}\begin{pmatrix}l&l&l\\m_1&m_2&m_3\end{pmatrix}
+      \bar{q}_{lm_1}\bar{q}_{lm_2}\bar{q}_{lm_3}/(\sum_m|\bar{q}_{lm}|^2)^{3/2}\f$.
+      The Wigner 3j symbols are tabulated on construction.
+    */
+    class SteinhardtW
+    {
+    public:
+      SteinhardtW(const int l):
+	_l(l),
+	_coeffs((2 * l + 1) * (2 * l + 1), 0)
+      {
+	for (int m1(-l); m1 <= l; ++m1)
+	  for (int m2(-l); m2 <= l; ++m2)
+	    if (std::abs(m1 + m2) <= l)
+	      _coeffs[(m1 + l) * (2 * l + 1) + (m2 + l)] = wignerThreej(l, l, l, m1, m2, -(m1 + m2));
+      }
+
+      //! \brief qlm points to the 2l+1 values for m=-l to l.
+      double operator()(const std::complex<double>* qlm) const
+      {
+	double norm = 0;
+	for (int m(-_l); m <= _l; ++m)
+	  norm += std::norm(qlm[m + _l]);
+
+	if (norm == 0) return 0;
+
+	std::complex<double> sum(0, 0);
+	for (int m1(-_l); m1 <= _l; ++m1)
+	  for (int m2(-_l); m2 <= _l; ++m2)
+	    {
+	      const int m3 = -(m1 + m2);
+	      if (std::abs(m3) <= _l)
+		sum += _coeffs[(m1 + _l) * (2 * _l + 1) + (m2 + _l)] * qlm[m1 + _l] * qlm[m2 + _l] * qlm[m3 + _l];
+	    }
+
+	//The imaginary part cancels for any real set of bonds
+	return sum.real() * std::pow(norm, -1.5);
+      }
+
+      int getL() const { return _l; }
+
+    private:
+      int _l;
+      std::vector<double> _coeffs;
+    };
+  }
+}
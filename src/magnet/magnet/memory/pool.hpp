@@ -1,4 +1,4 @@
-/*  dynamo:- Event driven molecular dynamics simulator 
+/*  dynamo:- Event driven molecular dynamics simulator
     http://www.dynamomd.org
     Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
 
@@ -17,90 +17,282 @@
 #pragma once
 
 #ifndef MAX_SMALL_OBJECT_SIZE
-#define MAX_SMALL_OBJECT_SIZE 64
+#define MAX_SMALL_OBJECT_SIZE 256
 #endif
 
-#include <boost/pool/pool.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <mutex>
+#include <new>
+#include <vector>
 
 namespace magnet {
   /*! \brief Namespace for memory management classes.*/
-  namespace memory {    
+  namespace memory {
     /*! \brief Namespace for memory management implementation details.
      */
     namespace detail {
-      /*! \brief Singleton class to manage the memory pools.
-	
-        This class manages several boost memory pools. Any classes
-        deriving from the \ref PoolAllocated class will use this class
-        to access memory pools to allocate their memory.
+      //! \brief The granularity (and alignment) of the pooled blocks.
+      static const size_t poolGranularity = 16;
+      //! \brief The number of block size classes.
+      static const size_t poolClasses = (MAX_SMALL_OBJECT_SIZE + poolGranularity - 1) / poolGranularity;
+      //! \brief The size (and alignment) of the slabs blocks are carved from.
+      static const size_t slabSize = 64 * 1024;
+      //! \brief The number of slabs requested from the system at once.
+      static const size_t slabsPerArena = 16;
+      //! \brief The space reserved at the start of each slab for its header.
+      static const size_t slabHeaderSize = 64;
+
+      static_assert(MAX_SMALL_OBJECT_SIZE * 16 <= slabSize - slabHeaderSize, "MAX_SMALL_OBJECT_SIZE is too large for the slab size");
+
+      class ThreadCache;
+
+      /*! \brief The header of a slab, which is found from the
+          address of any block in the slab by masking.
+
+        Every block in a slab has the same size class and belongs to
+        the same ThreadCache.
        */
-      class PoolManager {
+      struct SlabHeader {
+	ThreadCache* owner;
+	size_t sizeClass;
+      };
+
+      static_assert(sizeof(SlabHeader) <= slabHeaderSize, "The slab header does not fit");
+
+      //! \brief A free block, linked into a free list.
+      struct FreeBlock {
+	FreeBlock* next;
+      };
+
+      inline size_t sizeClass(const size_t size)
+      { return size ? (size - 1) / poolGranularity : 0; }
+
+      inline SlabHeader* slabOf(void* ptr)
+      { return reinterpret_cast<SlabHeader*>(reinterpret_cast<std::uintptr_t>(ptr) & ~std::uintptr_t(slabSize - 1)); }
+
+      /*! \brief The free lists of a single thread.
+
+        Each thread allocates from and frees to its own free lists
+        without any locking. Blocks freed by a thread other than the
+        owner of their slab are pushed onto a lock-free stack of the
+        owning cache, which the owner collects in one batch when one
+        of its free lists runs dry.
+       */
+      class ThreadCache {
       public:
-	/*! \brief Singleton access function. */
-	inline static PoolManager& getPool()
+	ThreadCache(): _remote(nullptr)
 	{
-	  static PoolManager pool;
-	  return pool;
+	  for (size_t i(0); i < poolClasses; ++i)
+	    {
+	      _free[i] = nullptr;
+	      _bump[i] = _bumpEnd[i] = nullptr;
+	    }
 	}
-	
-	/*! \brief Singleton pool lock access. */
-	inline static std::mutex& getLock()
-	{  
-	  static std::mutex poolLock;
-	  return poolLock;
+
+	inline void* allocate(const size_t cls)
+	{
+	  FreeBlock* block = _free[cls];
+	  if (!block) return refill(cls);
+	  _free[cls] = block->next;
+	  return block;
 	}
-	
-	/*! \brief Request some memory from a suitable pool. */
-	inline void* allocateMemory(size_t size) 
+
+	inline void release(void* ptr)
 	{
-	  thread::ScopedLock lock(PoolManager::getLock());
-	  
-	  if (size > MAX_SMALL_OBJECT_SIZE)
-	    return ::operator new(size);
-	  
-	  return m_pools[size - 1]->malloc();
+	  SlabHeader* slab = slabOf(ptr);
+	  if (slab->owner == this)
+	    push(ptr, slab->sizeClass);
+	  else
+	    slab->owner->remoteRelease(ptr);
 	}
-	
-	/*! \brief Release some allocated memory from a suitable
-	  pool. 
-	 */
-	inline void releaseMemory(void* deletable, size_t size) 
+
+	/*! \brief Return a block to this cache from another thread. */
+	inline void remoteRelease(void* ptr)
 	{
-	  thread::ScopedLock lock(PoolManager::getLock());
-	  
-	  if (size > MAX_SMALL_OBJECT_SIZE) 
-	    ::operator delete(deletable);
-	  else 
-	    //use pool free. Don't delete null pointers
-	    if (deletable)
-	      m_pools[size - 1]->free(deletable);
+	  FreeBlock* block = static_cast<FreeBlock*>(ptr);
+	  block->next = _remote.load(std::memory_order_relaxed);
+	  while (!_remote.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {}
 	}
-	
+
       private:
-	
-	inline PoolManager() {
-	  for (int i = 0; i < MAX_SMALL_OBJECT_SIZE; ++i)
-	    m_pools[i] = new boost::pool<>(i + 1);
+	inline void push(void* ptr, const size_t cls)
+	{
+	  FreeBlock* block = static_cast<FreeBlock*>(ptr);
+	  block->next = _free[cls];
+	  _free[cls] = block;
 	}
-	
-	inline ~PoolManager() {
-	  for (int i = 0; i < MAX_SMALL_OBJECT_SIZE; ++i)
-	    delete m_pools[i];
+
+	void* refill(const size_t cls);
+
+	FreeBlock* _free[poolClasses];
+	char* _bump[poolClasses];
+	char* _bumpEnd[poolClasses];
+
+	//Padded away from the free lists, as it is written by other
+	//threads
+	char _padding[64];
+	std::atomic<FreeBlock*> _remote;
+      };
+
+      /*! \brief Singleton class which hands out slabs and thread
+	  caches.
+
+        Any classes deriving from the \ref PoolAllocated class, or
+        containers using \ref PoolAllocator, allocate their memory
+        through the \ref ThreadCache of the calling thread. This class
+        is only locked when a cache needs a new slab, or when a thread
+        starts or exits.
+
+	Memory is never returned to the system. When a thread exits,
+	its cache is kept for the next thread to start, as blocks from
+	its slabs may still be in use (and be freed) elsewhere.
+       */
+      class PoolManager {
+      public:
+	/*! \brief Singleton access function.
+
+	  The manager is never destroyed, so that pooled objects may
+	  be freed during the destruction of static objects.
+	 */
+	inline static PoolManager& getPool()
+	{
+	  static PoolManager* pool = new PoolManager;
+	  return *pool;
+	}
+
+	/*! \brief Allocate a new slab, aligned to its size. */
+	inline char* newSlab()
+	{
+	  std::lock_guard<std::mutex> lock(_lock);
+	  if (_nextSlab == _arenaEnd)
+	    {
+	      //One extra slab is requested, so that an aligned run of
+	      //slabsPerArena slabs can always be found
+	      char* arena = static_cast<char*>(::operator new((slabsPerArena + 1) * slabSize));
+	      _nextSlab = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(arena) + slabSize - 1) & ~std::uintptr_t(slabSize - 1));
+	      _arenaEnd = _nextSlab + slabsPerArena * slabSize;
+	    }
+
+	  char* slab = _nextSlab;
+	  _nextSlab += slabSize;
+	  return slab;
+	}
+
+	/*! \brief Take ownership of a cache for a new thread. */
+	inline ThreadCache* acquireCache()
+	{
+	  std::lock_guard<std::mutex> lock(_lock);
+	  if (_orphans.empty())
+	    return new ThreadCache;
+	  ThreadCache* cache = _orphans.back();
+	  _orphans.pop_back();
+	  return cache;
 	}
-	
+
+	/*! \brief Return the cache of an exiting thread. */
+	inline void releaseCache(ThreadCache* cache)
+	{
+	  std::lock_guard<std::mutex> lock(_lock);
+	  _orphans.push_back(cache);
+	}
+
+      private:
+	inline PoolManager(): _nextSlab(nullptr), _arenaEnd(nullptr) {}
+
 	/*! \brief Hidden constructor as its a Singleton. */
 	PoolManager(const PoolManager&);
 	const PoolManager& operator=(const PoolManager&);
-	
-	/// memory pool array. m_pools[n] corresponds to pool with objectSize==n+1.
-	boost::pool<>* m_pools[MAX_SMALL_OBJECT_SIZE];
+
+	std::mutex _lock;
+	char* _nextSlab;
+	char* _arenaEnd;
+	std::vector<ThreadCache*> _orphans;
       };
+
+      inline void* ThreadCache::refill(const size_t cls)
+      {
+	//Collect any blocks freed by other threads
+	if (_remote.load(std::memory_order_relaxed))
+	  {
+	    FreeBlock* block = _remote.exchange(nullptr, std::memory_order_acquire);
+	    while (block)
+	      {
+		FreeBlock* next = block->next;
+		push(block, slabOf(block)->sizeClass);
+		block = next;
+	      }
+
+	    if (_free[cls])
+	      return allocate(cls);
+	  }
+
+	//Carve a new block from the current slab of this size class
+	const size_t size = (cls + 1) * poolGranularity;
+	if (size_t(_bumpEnd[cls] - _bump[cls]) < size)
+	  {
+	    char* slab = PoolManager::getPool().newSlab();
+	    SlabHeader* header = new (slab) SlabHeader;
+	    header->owner = this;
+	    header->sizeClass = cls;
+	    _bump[cls] = slab + slabHeaderSize;
+	    _bumpEnd[cls] = slab + slabSize;
+	  }
+
+	void* block = _bump[cls];
+	_bump[cls] += size;
+	return block;
+      }
+
+      /*! \brief Holds the cache of a thread, and returns it to the
+          PoolManager when the thread exits. */
+      struct ThreadCacheHandle {
+	ThreadCache* cache;
+
+	~ThreadCacheHandle()
+	{
+	  if (cache) PoolManager::getPool().releaseCache(cache);
+	  cache = nullptr;
+	}
+      };
+
+      /*! \brief The cache of the calling thread. */
+      inline ThreadCache& threadCache()
+      {
+	static thread_local ThreadCacheHandle handle = {nullptr};
+	if (!handle.cache)
+	  handle.cache = PoolManager::getPool().acquireCache();
+	return *handle.cache;
+      }
+
+      /*! \brief Request some memory from a suitable pool. */
+      inline void* allocateMemory(const size_t size)
+      {
+	if (size > MAX_SMALL_OBJECT_SIZE)
+	  return ::operator new(size);
+	return threadCache().allocate(sizeClass(size));
+      }
+
+      /*! \brief Release some allocated memory to a suitable pool.
+
+	\param size The size the memory was allocated with.
+       */
+      inline void releaseMemory(void* deletable, const size_t size)
+      {
+	//Don't delete null pointers
+	if (!deletable) return;
+	if (size > MAX_SMALL_OBJECT_SIZE)
+	  ::operator delete(deletable);
+	else
+	  threadCache().release(deletable);
+      }
     }
-    
+
     /*! \brief Base class for derived classes which want to be
       allocated from a memory pool.
-     
+
       Allocating objects from a memory pool is a way to speed up the
       construction and deletion of small objects. The allocated memory
       is not actually released but is instead cached for the next
@@ -112,17 +304,63 @@ namespace magnet {
         allocation.
        */
       inline static void* operator new(size_t size) {
-	return detail::PoolManager::getPool().allocateMemory(size);
+	return detail::allocateMemory(size);
       }
 
       /*! \brief Specialized delete operator to use the memory pool
-	for deallocation. 
+	for deallocation.
        */
       inline static void operator delete(void* deletable, size_t size) {
-	detail::PoolManager::getPool().releaseMemory(deletable, size);
+	detail::releaseMemory(deletable, size);
       }
-      
+
       virtual ~PoolAllocated() {}
     };
+
+    /*! \brief A standard library allocator which allocates from the
+      memory pools.
+
+      This is intended for node based containers (e.g., std::list or
+      std::unordered_map), where each node is a small allocation.
+      Larger allocations (and over-aligned types) fall through to the
+      global operator new. All PoolAllocators are interchangeable, and
+      memory may be freed by a different thread to the one which
+      allocated it.
+     */
+    template<class T>
+    class PoolAllocator {
+    public:
+      typedef T value_type;
+
+      template<class U> struct rebind { typedef PoolAllocator<U> other; };
+
+      PoolAllocator() {}
+
+      template<class U>
+      PoolAllocator(const PoolAllocator<U>&) {}
+
+      T* allocate(const size_t n)
+      {
+	if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+	  throw std::bad_alloc();
+	if (alignof(T) > detail::poolGranularity)
+	  return static_cast<T*>(::operator new(n * sizeof(T)));
+	return static_cast<T*>(detail::allocateMemory(n * sizeof(T)));
+      }
+
+      void deallocate(T* ptr, const size_t n)
+      {
+	if (alignof(T) > detail::poolGranularity)
+	  ::operator delete(ptr);
+	else
+	  detail::releaseMemory(ptr, n * sizeof(T));
+      }
+    };
+
+    template<class T, class U>
+    inline bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) { return true; }
+
+    template<class T, class U>
+    inline bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) { return false; }
   }
 }
@@ -0,0 +1,69 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <string>
+#include <cstdint>
+
+namespace magnet {
+  namespace string {
+    /*! \brief The length of the base64 encoding of a number of bytes.
+     */
+    inline size_t base64_length(const size_t bytes) { return 4 * ((bytes + 2) / 3); }
+
+    /*! \brief Append the base64 encoding (RFC 4648, with padding) of
+        a block of memory to a string.
+     */
+    inline void base64_encode(const void* data, const size_t bytes, std::string& out)
+    {
+      static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+      const uint8_t* in = static_cast<const uint8_t*>(data);
+      const size_t start = out.size();
+      out.resize(start + base64_length(bytes));
+      char* ptr = &out[start];
+
+      size_t i(0);
+      for (; i + 2 < bytes; i += 3)
+	{
+	  const uint32_t triple = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8) | in[i + 2];
+	  *ptr++ = table[(triple >> 18) & 0x3F];
+	  *ptr++ = table[(triple >> 12) & 0x3F];
+	  *ptr++ = table[(triple >> 6) & 0x3F];
+	  *ptr++ = table[triple & 0x3F];
+	}
+
+      if (i < bytes)
+	{
+	  const bool two = (i + 1 < bytes);
+	  const uint32_t triple = (uint32_t(in[i]) << 16) | (two ? (uint32_t(in[i + 1]) << 8) : 0);
+	  *ptr++ = table[(triple >> 18) & 0x3F];
+	  *ptr++ = table[(triple >> 12) & 0x3F];
+	  *ptr++ = two ? table[(triple >> 6) & 0x3F] : '=';
+	  *ptr++ = '=';
+	}
+    }
+
+    /*! \brief The base64 encoding of a block of memory.
+     */
+    inline std::string base64_encode(const void* data, const size_t bytes)
+    {
+      std::string out;
+      base64_encode(data, bytes, out);
+      return out;
+    }
+  }
+}
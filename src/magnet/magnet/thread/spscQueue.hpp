@@ -0,0 +1,134 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*! \file spscQueue.hpp
+ * \brief Contains the definition of SPSCQueue
+ */
+
+#pragma once
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+namespace magnet {
+  namespace thread {
+    /*! \brief A lock-free, fixed capacity, single-producer
+        single-consumer queue (a ring buffer).
+
+      Exactly one thread may call push() and exactly one (other)
+      thread may call pop(). The head and tail counters are kept on
+      separate cache lines, and each thread keeps a cached copy of
+      the other thread's counter, so the shared counters are only
+      re-read when the queue appears to be full or empty.
+     */
+    template<class T>
+    class SPSCQueue
+    {
+    public:
+      /*! \brief Constructor.
+
+	\param capacity The number of elements the queue can hold,
+	which is rounded up to a power of two.
+       */
+      explicit SPSCQueue(size_t capacity = 4096):
+	_head(0),
+	_cachedTail(0),
+	_tail(0),
+	_cachedHead(0)
+      {
+	if (!capacity)
+	  throw std::runtime_error("Cannot create an SPSCQueue with zero capacity");
+
+	size_t size = 1;
+	while (size < capacity) size <<= 1;
+	_buffer.resize(size);
+	_mask = size - 1;
+      }
+
+      SPSCQueue(const SPSCQueue&) = delete;
+      SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+      /*! \brief Add an element to the queue (producer thread only).
+
+	\return false if the queue is full and the element was not
+	added.
+       */
+      bool push(const T& val)
+      {
+	const size_t tail = _tail.load(std::memory_order_relaxed);
+	if (tail - _cachedHead > _mask)
+	  {
+	    _cachedHead = _head.load(std::memory_order_acquire);
+	    if (tail - _cachedHead > _mask)
+	      return false;
+	  }
+
+	_buffer[tail & _mask] = val;
+	_tail.store(tail + 1, std::memory_order_release);
+	return true;
+      }
+
+      /*! \brief Remove an element from the queue (consumer thread only).
+
+	\return false if the queue was empty.
+       */
+      bool pop(T& val)
+      {
+	const size_t head = _head.load(std::memory_order_relaxed);
+	if (head == _cachedTail)
+	  {
+	    _cachedTail = _tail.load(std::memory_order_acquire);
+	    if (head == _cachedTail)
+	      return false;
+	  }
+
+	val = _buffer[head & _mask];
+	_head.store(head + 1, std::memory_order_release);
+	return true;
+      }
+
+      //! \brief Test if the queue is empty (may be called from either thread).
+      bool empty() const
+      { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+
+      //! \brief The number of elements the queue can hold.
+      size_t capacity() const { return _mask + 1; }
+
+    private:
+      //! \brief The assumed size of a cache line.
+      static const size_t _cacheLine = 64;
+
+      std::vector<T> _buffer;
+      size_t _mask;
+
+      //The two sides are kept on separate cache lines by padding
+      //rather than alignas, as over-aligned allocation (new) of the
+      //queue is not available before C++17.
+      char _pad0[_cacheLine];
+
+      //Consumer side
+      std::atomic<size_t> _head;
+      size_t _cachedTail;
+      char _pad1[_cacheLine - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+
+      //Producer side
+      std::atomic<size_t> _tail;
+      size_t _cachedHead;
+      char _pad2[_cacheLine - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+    };
+  }
+}
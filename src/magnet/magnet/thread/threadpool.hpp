@@ -1,4 +1,4 @@
-/*  dynamo:- Event driven molecular dynamics simulator 
+/*  dynamo:- Event driven molecular dynamics simulator
     http://www.dynamomd.org
     Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
 
@@ -23,188 +23,534 @@
 #include <sstream>
 #include <iostream>
 
+#include <magnet/exception.hpp>
 #include <magnet/thread/threadgroup.hpp>
-#include <magnet/thread/taskQueue.hpp>
-#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace magnet {
   namespace thread {
-    /*! \brief A class providing a pool of worker threads that will
+    /*! \brief A work-stealing pool of worker threads that will
       execute "tasks" pushed to it.
-      
+
+      Each worker has its own deque of tasks. Tasks queued by a
+      worker (i.e., nested tasks) are pushed onto its own deque, and
+      it takes the most recently queued of these first. Idle workers
+      steal the oldest tasks from the other deques. Tasks queued from
+      outside the pool go into a shared queue and are started in the
+      order they were queued, so a pool with a single thread executes
+      them in sequence.
+
+      Tasks can be queued without a result (queueTask(), which are
+      synchronised with wait()), or with a result returned through a
+      future (submit() and then()). The parallel_for() and
+      parallel_reduce() loops split an index range into chunks which
+      are processed by the workers and the calling thread. These may
+      be nested inside tasks of the same pool, as a thread waiting for
+      a future or a loop helps to execute the queued tasks, so a
+      single pool can be shared by all of the code of a process
+      without oversubscribing the processors.
+
       This class will also run in 0 thread mode, where the controlling
-      process will execute the tasks when it enters the
-      ThreadPool::wait() function.
+      process will execute the queued tasks when it enters the
+      ThreadPool::wait() function, and the futures and loops are
+      evaluated immediately in the calling thread.
      */
-    class ThreadPool : public TaskQueue
-    {	
-    private:
-      volatile bool _exception_flag;
-      std::ostringstream _exception_data;
-      
+    class ThreadPool
+    {
+      struct Worker
+      {
+	std::mutex lock;
+	std::deque<std::function<void()> > tasks;
+      };
+
+      /*! \brief The state of a parallel loop, shared between the
+          calling thread and the helper tasks.
+
+	Helper tasks may only start after the loop is complete, so
+	they only touch the loop body after successfully claiming a
+	chunk.
+       */
+      struct LoopState
+      {
+	LoopState(size_t n): next(0), completed(0), chunks(n), failed(false) {}
+
+	std::atomic<size_t> next;
+	std::atomic<size_t> completed;
+	const size_t chunks;
+	std::atomic<bool> failed;
+	std::exception_ptr error;
+	std::mutex lock;
+	std::condition_variable done;
+      };
+
       ThreadPool (const ThreadPool&);
       ThreadPool& operator = (const ThreadPool&);
-  
-      /*! \brief This mutex is to control access to write that an exception has occurred.
+
+      std::vector<std::unique_ptr<Worker> > _workers;
+
+      /*! \brief Tasks queued from outside the pool. */
+      std::deque<std::function<void()> > _injected;
+
+      /*! \brief Guards _injected, and the sleeping and waking of the
+          threads.
        */
-      std::mutex _exception_mutex;
+      std::mutex _queue_mutex;
+
+      /*! \brief Triggered to wake threads when jobs are added to the queue.
+       */
+      std::condition_variable _need_thread;
 
-      /*! \brief Triggered every time a thread becomes available, to
+      /*! \brief Triggered when the last queued task completes, to
         notify the mother thread stuck in the wait() function.
        */
-      std::condition_variable _threadAvailable_condition;
+      std::condition_variable _tasks_complete;
 
-      /*! \brief Triggered to wake threads when jobs are added to the queue.
+      /*! \brief The number of tasks which are queued but not started. */
+      std::atomic<size_t> _queued;
+
+      /*! \brief The number of tasks which are queued or running. */
+      std::atomic<size_t> _unfinished;
+
+      std::atomic<size_t> _idlingThreads;
+      bool _stop_flag;
+
+      /*! \brief This mutex is to control access to write that an exception has occurred.
        */
-      std::condition_variable _need_thread_mutex;
+      std::mutex _exception_mutex;
+      bool _exception_flag;
+      std::ostringstream _exception_data;
 
       magnet::thread::ThreadGroup _threads;
 
-      volatile size_t _idlingThreads;
-      volatile bool _stop_flag;
-
-    public:  
+    public:
       /*! \brief Default Constructor
-       
+
         This initialises the pool to 0 threads
        */
       inline ThreadPool():
-	_exception_flag(false),
+	_queued(0),
+	_unfinished(0),
 	_idlingThreads(0),
-	_stop_flag(false)
+	_stop_flag(false),
+	_exception_flag(false)
       {}
-      
+
+      /*! \brief Destructor
+
+        Join all threads in the pool and wait until they are
+        terminated.
+       */
+      inline ~ThreadPool() throw() { stop(); }
+
       /*! \brief Set the number of threads in the pool
-       
+
         This creates the specified amount of threads to populate the
-        pool. When lowering the number of threads this pool kills ALL
-        threads, but waits for all their current tasks to complete
-        first, then repopulates the pool.
+        pool. When changing the number of threads, this pool kills
+        ALL threads but waits for all their current tasks to complete
+        first, then repopulates the pool. The tasks which were
+        waiting are kept.
        */
       inline void setThreadCount(size_t x)
-      { 
+      {
 	if (x == _threads.size()) return;
-	
-	if (x < _threads.size())
-	  {
-	    //Stop all threads as we're shrinking our thread pool size
-	    stop();
-	    //All threads are dead, reset the kill switch
-	    _stop_flag = false;
-	  }
-	
-	//Add the required number of threads
-	for (size_t i=_threads.size(); i < x; ++i)
-	  _threads.create_thread(std::function<void()>(std::bind(&ThreadPool::beginThread, this)));
+
+	if (currentPool() == this)
+	  M_throw() << "Cannot change the number of threads of a ThreadPool from one of its own tasks";
+
+	stop();
+
+	//The waiting tasks of the old workers are moved to the shared
+	//queue
+	for (const std::unique_ptr<Worker>& worker : _workers)
+	  for (std::function<void()>& task : worker->tasks)
+	    _injected.push_back(std::move(task));
+
+	_workers.clear();
+	_stop_flag = false;
+
+	for (size_t i = 0; i < x; ++i)
+	  _workers.push_back(std::unique_ptr<Worker>(new Worker));
+	for (size_t i = 0; i < x; ++i)
+	  _threads.create_thread(std::function<void()>(std::bind(&ThreadPool::beginThread, this, i)));
       }
 
       /*! \brief The current number of threads in the pool */
-      inline size_t getThreadCount() const { return _threads.size(); }
+      inline size_t getThreadCount() const { return _workers.size(); }
+
+      inline size_t getIdleThreadCount() { return _idlingThreads; }
 
       //Actual queuer
       inline void queueTask(std::function<void()> threadfunc)
-      {
-	TaskQueue::queueTask(threadfunc);
-	_need_thread_mutex.notify_all();
-      }
+      { push(std::move(threadfunc)); }
 
       //Actual queuer
       inline void queueTasks(std::vector<std::function<void()> >& threadfuncs)
       {
-	TaskQueue::queueTasks(threadfuncs);
-	_need_thread_mutex.notify_all();
+	for (std::function<void()>& func : threadfuncs)
+	  push(std::move(func));
+	threadfuncs.clear();
       }
-  
-      /*! \brief Destructor
-       
-        Join all threads in the pool and wait until they are
-        terminated.
-       */
-      inline ~ThreadPool() throw() { stop(); }
 
       /*! \brief Wait for all tasks to complete.
-       
+
         If there are no threads in the pool then this function will
         actually make the waiting/mother process perform the tasks.
+
+	This waits for every task queued to the pool (including those
+	queued by other threads), so it cannot be called from inside
+	a task of the pool. Nested tasks should instead be waited for
+	through their futures.
        */
       inline void wait()
       {
-	if (_threads.size())
+	if (currentPool() == this)
+	  M_throw() << "ThreadPool::wait() cannot be called from one of the pool's own tasks";
+
+	if (!_workers.empty())
 	  {
-	    //We are in threaded mode! Wait until all tasks are gone
-	    //and all threads are idling
-	    std::unique_lock<std::mutex> lock1(_queue_mutex);      
-	    while (!_waitingFunctors.empty() 
-		   || (_idlingThreads != _threads.size()))
-	      _threadAvailable_condition.wait(lock1);
+	    //We are in threaded mode! Wait until all tasks are complete
+	    std::unique_lock<std::mutex> lock(_queue_mutex);
+	    _tasks_complete.wait(lock, [&]() { return _unfinished == 0; });
 	  }
 	else
 	  {
 	    //Non threaded mode
-	    while (!_waitingFunctors.empty())
+	    std::function<void()> task;
+	    while (takeTask(task, nullptr))
+	      run(task);
+	  }
+
+	std::lock_guard<std::mutex> lock(_exception_mutex);
+	if (_exception_flag)
+	  {
+	    const std::string data = _exception_data.str();
+	    _exception_flag = false;
+	    _exception_data.str("");
+	    M_throw() << "Thread Exception found while waiting for tasks/threads to finish"
+		      << data;
+	  }
+      }
+
+      /*! \brief Queue a task whose result (or exception) is returned
+          through a future.
+
+	In 0 thread mode the task is run immediately.
+       */
+      template<class F>
+      inline std::future<typename std::result_of<F()>::type> submit(F func)
+      {
+	typedef typename std::result_of<F()>::type R;
+	std::shared_ptr<std::packaged_task<R()> > task(new std::packaged_task<R()>(std::move(func)));
+	std::future<R> result = task->get_future();
+	if (_workers.empty())
+	  (*task)();
+	else
+	  push([task]() { (*task)(); });
+	return result;
+      }
+
+      /*! \brief Queue a continuation of the task of a future.
+
+	The continuation is called with the (ready) future of the
+	earlier task, from which it may retrieve the result or
+	exception of that task. The continuation may be queued before
+	the earlier task completes.
+       */
+      template<class T, class F>
+      inline std::future<typename std::result_of<F(std::shared_future<T>)>::type>
+      then(std::shared_future<T> before, F func)
+      {
+	return submit([this, before, func]() mutable {
+	    wait(before);
+	    return func(before);
+	  });
+      }
+
+      /*! \brief Wait for a future, executing the pool's queued tasks
+          in the meantime.
+
+	This may be used inside tasks of the pool to wait for nested
+	tasks without deadlocking the pool.
+       */
+      template<class Future>
+      inline void wait(const Future& future)
+      {
+	while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	  {
+	    std::function<void()> task;
+	    if (takeTask(task, currentWorker()))
+	      run(task);
+	    else
+	      future.wait_for(std::chrono::microseconds(100));
+	  }
+      }
+
+      /*! \brief Call func(i) for every i in [begin, end), in parallel.
+
+	The range is split into chunks of grain indices, which are
+	claimed in order by the calling thread and any idle workers.
+	The calling thread always takes part, so the loop completes
+	even if every worker is busy (e.g., in a nested loop). The
+	first exception thrown by func is rethrown once the loop is
+	complete.
+
+	\param grain The number of indices in each chunk. If 0, the
+	range is split into about 8 chunks per thread.
+       */
+      template<class F>
+      inline void parallel_for(const size_t begin, const size_t end, F func, size_t grain = 0)
+      {
+	if (end <= begin) return;
+	grain = getGrain(end - begin, grain);
+	forChunks(end - begin, grain, [&](const size_t chunk) {
+	    const size_t last = std::min(end, begin + (chunk + 1) * grain);
+	    for (size_t i(begin + chunk * grain); i < last; ++i)
+	      func(i);
+	  });
+      }
+
+      /*! \brief Reduce over the indices [begin, end) in parallel.
+
+	Each chunk of indices is accumulated by calling func(i, acc)
+	on a copy of identity, and the chunk results are combined in
+	order with join(a, b). The result is therefore independent of
+	the number of threads for a fixed grain.
+
+	\param grain The number of indices in each chunk. If 0, the
+	range is split into about 8 chunks per thread.
+       */
+      template<class T, class F, class J>
+      inline T parallel_reduce(const size_t begin, const size_t end, const T& identity, F func, J join, size_t grain = 0)
+      {
+	if (end <= begin) return identity;
+	grain = getGrain(end - begin, grain);
+	const size_t chunks = (end - begin + grain - 1) / grain;
+	std::vector<T> partials(chunks, identity);
+	forChunks(end - begin, grain, [&](const size_t chunk) {
+	    T& acc = partials[chunk];
+	    const size_t last = std::min(end, begin + (chunk + 1) * grain);
+	    for (size_t i(begin + chunk * grain); i < last; ++i)
+	      func(i, acc);
+	  });
+
+	T result = identity;
+	for (const T& partial : partials)
+	  result = join(result, partial);
+	return result;
+      }
+
+    private:
+      /*! \brief The pool which the calling thread is a worker of. */
+      static inline const ThreadPool*& currentPool()
+      {
+	static thread_local const ThreadPool* pool = nullptr;
+	return pool;
+      }
+
+      static inline size_t& currentIndex()
+      {
+	static thread_local size_t index = 0;
+	return index;
+      }
+
+      /*! \brief The deque of the calling thread, if it is a worker
+          of this pool.
+       */
+      inline Worker* currentWorker()
+      { return (currentPool() == this) ? _workers[currentIndex()].get() : nullptr; }
+
+      inline size_t getGrain(const size_t n, const size_t grain) const
+      {
+	if (grain) return grain;
+	return std::max<size_t>(1, n / (8 * (_workers.size() + 1)));
+      }
+
+      inline void push(std::function<void()> task)
+      {
+	++_unfinished;
+	Worker* worker = currentWorker();
+	if (worker)
+	  {
+	    std::lock_guard<std::mutex> lock(worker->lock);
+	    worker->tasks.push_back(std::move(task));
+	    ++_queued;
+	  }
+	else
+	  {
+	    std::lock_guard<std::mutex> lock(_queue_mutex);
+	    _injected.push_back(std::move(task));
+	    ++_queued;
+	  }
+
+	//Taking the lock ensures a thread going to sleep sees the task
+	if (_idlingThreads)
+	  {
+	    { std::lock_guard<std::mutex> lock(_queue_mutex); }
+	    _need_thread.notify_one();
+	  }
+      }
+
+      /*! \brief Take a task from the calling thread's own deque, the
+          shared queue or (as a last resort) another worker's deque.
+       */
+      inline bool takeTask(std::function<void()>& task, Worker* self)
+      {
+	if (!_queued) return false;
+
+	if (self)
+	  {
+	    std::lock_guard<std::mutex> lock(self->lock);
+	    if (!self->tasks.empty())
+	      {
+		task = std::move(self->tasks.back());
+		self->tasks.pop_back();
+		--_queued;
+		return true;
+	      }
+	  }
+
+	{
+	  std::lock_guard<std::mutex> lock(_queue_mutex);
+	  if (!_injected.empty())
+	    {
+	      task = std::move(_injected.front());
+	      _injected.pop_front();
+	      --_queued;
+	      return true;
+	    }
+	}
+
+	const size_t start = self ? currentIndex() : 0;
+	for (size_t i(1); i <= _workers.size(); ++i)
+	  {
+	    Worker& victim = *_workers[(start + i) % _workers.size()];
+	    if (&victim == self) continue;
+	    std::lock_guard<std::mutex> lock(victim.lock);
+	    if (!victim.tasks.empty())
 	      {
-		_waitingFunctors.front()();
-		_waitingFunctors.pop();
+		task = std::move(victim.tasks.front());
+		victim.tasks.pop_front();
+		--_queued;
+		return true;
 	      }
 	  }
-	
-	if (_exception_flag) 
-	  M_throw() << "Thread Exception found while waiting for tasks/threads to finish"
-		    << _exception_data.str();
+
+	return false;
       }
 
-      inline size_t getIdleThreadCount() { return _idlingThreads; }
-  
-    private:
-      /*! \brief Thread worker loop, called by the threads beginThreadFunc.
+      inline void run(std::function<void()>& task)
+      {
+	try { task(); }
+	catch(std::exception& cep)
+	  {
+	    //Mark the main process to throw an exception as soon as possible
+	    std::lock_guard<std::mutex> lock2(_exception_mutex);
+
+	    _exception_data << "\nTHREAD: Task threw an exception:-"
+			    << cep.what();
+
+	    _exception_flag = true;
+	  }
+	task = nullptr;
+
+	if (--_unfinished == 0)
+	  {
+	    std::lock_guard<std::mutex> lock(_queue_mutex);
+	    _tasks_complete.notify_all();
+	  }
+      }
+
+      /*! \brief Call body(chunk) for each chunk in [0, chunks),
+          using the calling thread and any idle workers.
        */
-      inline void beginThread()
+      template<class Body>
+      inline void forChunks(const size_t n, const size_t grain, Body body)
+      {
+	const size_t chunks = (n + grain - 1) / grain;
+	if (_workers.empty() || (chunks == 1))
+	  {
+	    for (size_t chunk(0); chunk < chunks; ++chunk)
+	      body(chunk);
+	    return;
+	  }
+
+	std::shared_ptr<LoopState> state(new LoopState(chunks));
+	Body* bodyptr = &body;
+	std::function<void()> helper = [state, bodyptr]() { ThreadPool::runChunks(*state, bodyptr); };
+	for (size_t i(0), helpers = std::min(_workers.size(), chunks - 1); i < helpers; ++i)
+	  push(helper);
+
+	runChunks(*state, bodyptr);
+
+	//Wait for the chunks claimed by the helpers
+	std::unique_lock<std::mutex> lock(state->lock);
+	state->done.wait(lock, [&]() { return state->completed == chunks; });
+	if (state->error)
+	  std::rethrow_exception(state->error);
+      }
+
+      template<class Body>
+      static inline void runChunks(LoopState& state, Body* body)
       {
-	try
+	for (size_t chunk = state.next++; chunk < state.chunks; chunk = state.next++)
 	  {
-	    std::unique_lock<std::mutex> lock1(_queue_mutex);
-	    
-	    while (!_stop_flag)
+	    if (!state.failed)
+	      try { (*body)(chunk); }
+	      catch (...)
+		{
+		  std::lock_guard<std::mutex> lock(state.lock);
+		  if (!state.failed)
+		    state.error = std::current_exception();
+		  state.failed = true;
+		}
+
+	    if (++state.completed == state.chunks)
 	      {
-		if (_waitingFunctors.empty())
-		  {
-		    ++_idlingThreads;
-		    //Let whoever is waiting know that the thread is now available
-		    _threadAvailable_condition.notify_all();
-		    //And send it to sleep
-		    _need_thread_mutex.wait(lock1);
-		    --_idlingThreads;
-		    continue;
-		  }
-		
-		std::function<void()> func = _waitingFunctors.front();
-		_waitingFunctors.pop();
-		
-		lock1.unlock();
-		
-		try { func(); }
-		catch(std::exception& cep)
-		  {
-		    //Mark the main process to throw an exception as soon as possible
-		    std::lock_guard<std::mutex> lock2(_exception_mutex);
-		    
-		    _exception_data << "\nTHREAD: Task threw an exception:-"
-				    << cep.what();
-		    
-		    _exception_flag = true;
-		  }
-		lock1.lock();
+		std::lock_guard<std::mutex> lock(state.lock);
+		state.done.notify_all();
 	      }
 	  }
-	catch (std::exception& p)
+      }
+
+      /*! \brief Thread worker loop, called by the threads beginThreadFunc.
+       */
+      inline void beginThread(const size_t index)
+      {
+	currentPool() = this;
+	currentIndex() = index;
+	Worker* self = _workers[index].get();
+
+	std::function<void()> task;
+	while (true)
 	  {
-	    std::cout << "\nTHREAD :Catastrophic Failure of thread!!! System will Hang, Aborting!"
-		      << p.what();
-	    throw;
+	    if (takeTask(task, self))
+	      {
+		run(task);
+		continue;
+	      }
+
+	    std::unique_lock<std::mutex> lock(_queue_mutex);
+	    if (_stop_flag) break;
+	    if (_queued) continue;
+	    ++_idlingThreads;
+	    _need_thread.wait(lock, [&]() { return _stop_flag || (_queued > 0); });
+	    --_idlingThreads;
+	    if (_stop_flag) break;
 	  }
+
+	currentPool() = nullptr;
       }
-      
+
       /*! \brief Halt the threadpool and terminate all the threads.
        */
       inline void stop()
@@ -214,13 +560,12 @@ namespace magnet {
 	// terminate.
 	{
 	  std::unique_lock<std::mutex> lock1(_queue_mutex);
-	  _stop_flag = true;       
+	  _stop_flag = true;
 	}
-	
-	_need_thread_mutex.notify_all();
+
+	_need_thread.notify_all();
 	_threads.join_all();
       }
-
     };
   }
 }
@@ -0,0 +1,250 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <magnet/xmlwriter.hpp>
+#include <magnet/exception.hpp>
+#include <magnet/string/base64.hpp>
+#include <magnet/thread/threadpool.hpp>
+#ifdef DYNAMO_zlib_support
+# include <zlib.h>
+#endif
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace magnet {
+  namespace vtk {
+    //! \brief The VTK name of the type of a data array element.
+    template<class T> struct TypeName;
+    template<> struct TypeName<float> { static const char* get() { return "Float32"; } };
+    template<> struct TypeName<double> { static const char* get() { return "Float64"; } };
+    template<> struct TypeName<int32_t> { static const char* get() { return "Int32"; } };
+    template<> struct TypeName<uint32_t> { static const char* get() { return "UInt32"; } };
+    template<> struct TypeName<int64_t> { static const char* get() { return "Int64"; } };
+    template<> struct TypeName<uint64_t> { static const char* get() { return "UInt64"; } };
+    template<> struct TypeName<uint8_t> { static const char* get() { return "UInt8"; } };
+
+    //! \brief The byte order of this machine, as named in VTK files.
+    inline const char* byteOrder()
+    {
+      const uint16_t test = 1;
+      return (*reinterpret_cast<const uint8_t*>(&test)) ? "LittleEndian" : "BigEndian";
+    }
+
+    /*! \brief Writes the DataArray elements of a VTK XML file, either
+        as ascii text or in the appended data section.
+
+      In the appended formats the arrays are stored in the
+      AppendedData section at the end of the file, as raw binary or
+      base64 encoded data, and each DataArray element only holds the
+      offset of its data. Every array is preceded by a UInt64 header
+      holding its size in bytes.
+
+      If compression is enabled, the arrays are split into blocks
+      which are compressed with zlib (in parallel, if a thread pool
+      is given), and the header holds the number of blocks and their
+      sizes, as read by vtkZLibDataCompressor.
+
+      Usage:
+      \code
+      ArrayWriter writer(ArrayWriter::RAW, false);
+      XML << tag("VTKFile") << attr("type") << "ImageData";
+      writer.fileAttributes(XML);
+      ...
+      writer.dataArray(XML, "Density", 1, values);
+      ...
+      writer.appendedData(XML);
+      XML << endtag("VTKFile");
+      \endcode
+    */
+    class ArrayWriter
+    {
+    public:
+      typedef enum
+	{
+	  ASCII,
+	  BASE64,
+	  RAW
+	} Encoding;
+
+      /*! \param compress Compress the appended arrays with zlib.
+	  \param pool An optional pool of threads used to compress the blocks.
+	  \param level The zlib compression level.
+	  \param blockSize The uncompressed size of each compressed block.
+       */
+      ArrayWriter(const Encoding encoding, const bool compress, thread::ThreadPool* pool = nullptr,
+		  const int level = 1, const size_t blockSize = 32768):
+	_encoding(encoding),
+	_compress(compress),
+	_pool(pool),
+	_level(level),
+	_blockSize(blockSize)
+      {
+	if (_compress && (_encoding == ASCII))
+	  M_throw() << "Ascii VTK data cannot be compressed";
+#ifndef DYNAMO_zlib_support
+	if (_compress)
+	  M_throw() << "zlib compression support was not built in!";
+#endif
+      }
+
+      /*! \brief Parse the name of an encoding ("ascii", "base64" or
+	  "binary").
+       */
+      static Encoding parseEncoding(const std::string& name)
+      {
+	if (name == "ascii") return ASCII;
+	if (name == "base64") return BASE64;
+	if (name == "binary") return RAW;
+	M_throw() << "Unknown VTK data format \"" << name << "\", expected ascii, base64 or binary";
+      }
+
+      Encoding getEncoding() const { return _encoding; }
+
+      //! \brief Write the version, byte order and compressor attributes of the VTKFile tag.
+      void fileAttributes(xml::XmlStream& XML) const
+      {
+	XML << xml::attr("version") << ((_encoding == ASCII) ? "0.1" : "1.0")
+	    << xml::attr("byte_order") << byteOrder();
+	if (_encoding != ASCII)
+	  XML << xml::attr("header_type") << "UInt64";
+	if (_compress)
+	  XML << xml::attr("compressor") << "vtkZLibDataCompressor";
+      }
+
+      /*! \brief Write a DataArray element.
+
+	\param components The number of components of each tuple.
+       */
+      template<class T>
+      void dataArray(xml::XmlStream& XML, const std::string& name, const size_t components, const std::vector<T>& values)
+      {
+	XML << xml::tag("DataArray")
+	    << xml::attr("type") << TypeName<T>::get();
+	if (!name.empty())
+	  XML << xml::attr("Name") << name;
+	XML << xml::attr("NumberOfComponents") << components;
+
+	if (_encoding == ASCII)
+	  {
+	    XML << xml::attr("format") << "ascii"
+		<< xml::chardata();
+	    for (size_t i(0); i < values.size(); ++i)
+	      XML << +values[i] << (((i + 1) % components) ? " " : "\n");
+	  }
+	else
+	  XML << xml::attr("format") << "appended"
+	      << xml::attr("offset") << append(values.data(), values.size() * sizeof(T));
+
+	XML << xml::endtag("DataArray");
+      }
+
+      /*! \brief Write the AppendedData element holding the arrays
+          written so far (if there are any).
+       */
+      void appendedData(xml::XmlStream& XML)
+      {
+	if (_encoding == ASCII) return;
+
+	XML << xml::tag("AppendedData")
+	    << xml::attr("encoding") << ((_encoding == RAW) ? "raw" : "base64")
+	    << xml::chardata();
+	std::ostream& os = XML.getUnderlyingStream();
+	os << "_";
+	os.write(_appended.data(), _appended.size());
+	os << "\n";
+	XML << xml::endtag("AppendedData");
+	_appended.clear();
+      }
+
+    protected:
+      //! \brief Add a block of data to the appended section, returning its offset.
+      size_t append(const void* data, const size_t bytes)
+      {
+	const size_t offset = _appended.size();
+	std::vector<uint64_t> header;
+	std::vector<std::vector<char> > blocks;
+
+	if (!_compress)
+	  header.push_back(bytes);
+	else
+	  {
+#ifdef DYNAMO_zlib_support
+	    const size_t nblocks = (bytes + _blockSize - 1) / _blockSize;
+	    blocks.resize(nblocks);
+	    auto compressBlock = [=, &blocks](const size_t block) {
+	      const size_t size = std::min(_blockSize, bytes - block * _blockSize);
+	      uLongf csize = compressBound(size);
+	      blocks[block].resize(csize);
+	      if (compress2(reinterpret_cast<Bytef*>(blocks[block].data()), &csize,
+			    static_cast<const Bytef*>(data) + block * _blockSize, size, _level) != Z_OK)
+		M_throw() << "zlib failed to compress a VTK data block";
+	      blocks[block].resize(csize);
+	    };
+
+	    if (_pool)
+	      _pool->parallel_for(0, nblocks, compressBlock, 1);
+	    else
+	      for (size_t block(0); block < nblocks; ++block)
+		compressBlock(block);
+
+	    header.push_back(nblocks);
+	    header.push_back(_blockSize);
+	    header.push_back(bytes % _blockSize);
+	    for (const std::vector<char>& block : blocks)
+	      header.push_back(block.size());
+#endif
+	  }
+
+	if (_encoding == RAW)
+	  {
+	    _appended.append(reinterpret_cast<const char*>(header.data()), header.size() * sizeof(uint64_t));
+	    if (_compress)
+	      for (const std::vector<char>& block : blocks)
+		_appended.append(block.data(), block.size());
+	    else
+	      _appended.append(static_cast<const char*>(data), bytes);
+	  }
+	else
+	  {
+	    //The header and the data are encoded separately
+	    string::base64_encode(header.data(), header.size() * sizeof(uint64_t), _appended);
+	    if (_compress)
+	      {
+		std::vector<char> all;
+		for (const std::vector<char>& block : blocks)
+		  all.insert(all.end(), block.begin(), block.end());
+		string::base64_encode(all.data(), all.size(), _appended);
+	      }
+	    else
+	      string::base64_encode(data, bytes, _appended);
+	  }
+
+	return offset;
+      }
+
+      Encoding _encoding;
+      bool _compress;
+      thread::ThreadPool* _pool;
+      int _level;
+      size_t _blockSize;
+      std::string _appended;
+    };
+  }
+}
@@ -76,7 +76,7 @@ namespace magnet {
 	  M_throw() << "bz2 compressed file support was not built in! (only available on linux)";
 #endif
 	} else {
-	  std::ofstream of(filename);
+	  std::ofstream of(filename, std::ios::binary);
 	  if (!of)
 	    M_throw() << "Failed to open " << filename << " for writing.";
 	  of << s.rdbuf();
@@ -1,7 +1,12 @@
 #define BOOST_TEST_MODULE Cubic_Quartic_test
 #include <boost/test/included/unit_test.hpp>
 #include <magnet/math/quartic.hpp>
+#include <magnet/intersection/parabola_sphere.hpp>
+#include <chrono>
 #include <complex>
+#include <iostream>
+#include <random>
+#include <vector>
 
 double cubic_rootvals[] = {-1e7, -1e6, -1e3, -100, -1, 0, 1, +100, 1e3, 1e6, 1e7 };
 
@@ -167,3 +172,179 @@ BOOST_AUTO_TEST_CASE( quartic_no_roots)
 	    BOOST_CHECK_MESSAGE(rootcount == 0, "rootcount=" << rootcount << " [a,b,c,d]=[" << a << "," << b << "," << c << "," << d << "] roots=[" << roots[0] << "," << roots[1] << "," << roots[2] << "," << roots[3] << "]" << " actual_roots=[" << root1real << ",+-" << root1im << "i," << root2real << "+-" << root2im << "i]");
 	  }
 }
+
+//A mixture of cubics with one and three real roots, across many
+//orders of magnitude, and some of the special cases
+void randomCubics(size_t N, std::vector<double>& p, std::vector<double>& q, std::vector<double>& r)
+{
+  std::mt19937 RNG(1);
+  std::uniform_real_distribution<> dist(-6, 6);
+  for (size_t i(0); i < N; ++i)
+    {
+      p.push_back(std::copysign(std::pow(10, dist(RNG)), dist(RNG)));
+      q.push_back(dist(RNG) * std::pow(10, dist(RNG)));
+      r.push_back((i % 13 == 0) ? 0 : dist(RNG) * std::pow(10, dist(RNG)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( cubic_batch )
+{
+  std::vector<double> p, q, r;
+  for (double root1 : cubic_rootvals)
+    for (double root2 : cubic_rootvals)
+      for (double root3 : cubic_rootvals)
+	{
+	  p.push_back(- root1 - root2 - root3);
+	  q.push_back(root1 * root2 + root1 * root3 + root2 * root3);
+	  r.push_back(- root1 * root2 * root3);
+	}
+  randomCubics(10000, p, q, r);
+
+  const size_t N = p.size();
+  std::vector<double> roots(3 * N);
+  std::vector<size_t> nroots(N);
+  magnet::math::cubicSolve(N, p.data(), q.data(), r.data(), roots.data(), nroots.data());
+
+  //The batched solver must give exactly the roots of the scalar one
+  //(including the NaNs it gives for some badly scaled cubics)
+  size_t mismatches = 0;
+  for (size_t i(0); i < N; ++i)
+    {
+      double scalar[3];
+      const size_t count = magnet::math::cubicSolve(p[i], q[i], r[i], scalar[0], scalar[1], scalar[2]);
+      mismatches += (count != nroots[i]);
+      for (size_t j(0); j < std::min(count, nroots[i]); ++j)
+	mismatches += !((scalar[j] == roots[3 * i + j]) || (std::isnan(scalar[j]) && std::isnan(roots[3 * i + j])));
+    }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+}
+
+BOOST_AUTO_TEST_CASE( parabola_sphere_batch )
+{
+  std::mt19937 RNG(2);
+  std::uniform_real_distribution<> dist(-1, 1);
+  const size_t N = 1000;
+  std::vector<magnet::math::Vector> R(N), V(N), A(N);
+  std::vector<double> d(N), t(N);
+  for (size_t i(0); i < N; ++i)
+    {
+      R[i] = magnet::math::Vector{dist(RNG), dist(RNG), dist(RNG)} * 3;
+      V[i] = magnet::math::Vector{dist(RNG), dist(RNG), dist(RNG)};
+      A[i] = magnet::math::Vector{0, 0, (i % 10) ? -1.0 : 0.0};
+      d[i] = 1 + 0.5 * dist(RNG);
+    }
+
+  magnet::intersection::parabola_sphere(R.data(), V.data(), A.data(), d.data(), t.data(), N);
+  size_t mismatches = 0, events = 0;
+  for (size_t i(0); i < N; ++i)
+    {
+      const double scalar = magnet::intersection::parabola_sphere(R[i], V[i], A[i], d[i]);
+      mismatches += !((scalar == t[i]) || (std::isnan(scalar) && std::isnan(t[i])));
+      events += (t[i] != HUGE_VAL);
+    }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+  BOOST_CHECK(events > 0);
+}
+
+BOOST_AUTO_TEST_CASE( cubic_throughput )
+{
+  std::vector<double> p, q, r;
+  randomCubics(100000, p, q, r);
+  const size_t N = p.size(), repeats = 10;
+  std::vector<double> roots(3 * N), batchRoots(3 * N);
+  std::vector<size_t> nroots(N), batchNroots(N);
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t rep(0); rep < repeats; ++rep)
+    for (size_t i(0); i < N; ++i)
+      nroots[i] = magnet::math::cubicSolve(p[i], q[i], r[i], roots[3 * i], roots[3 * i + 1], roots[3 * i + 2]);
+  const double scalar = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (size_t rep(0); rep < repeats; ++rep)
+    magnet::math::cubicSolve(N, p.data(), q.data(), r.data(), batchRoots.data(), batchNroots.data());
+  const double batched = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  BOOST_TEST_MESSAGE("Cubic throughput: scalar " << 1e9 * scalar / (N * repeats)
+		     << "ns, batched " << 1e9 * batched / (N * repeats) << "ns per cubic");
+
+  //The timed solves must agree, and their roots must be roots. The
+  //three root solutions of the most badly scaled of these cubics are
+  //known to be inaccurate, so only single roots are checked.
+  size_t mismatches = 0, badRoots = 0;
+  for (size_t i(0); i < N; ++i)
+    {
+      mismatches += (nroots[i] != batchNroots[i]);
+      for (size_t j(0); j < std::min(nroots[i], batchNroots[i]); ++j)
+	{
+	  const double x = roots[3 * i + j];
+	  mismatches += !((x == batchRoots[3 * i + j]) || (std::isnan(x) && std::isnan(batchRoots[3 * i + j])));
+	  if ((nroots[i] != 1) || std::isnan(x)) continue;
+	  //The residual, relative to the largest term of the cubic
+	  const double scale = std::max(std::max(std::abs(x * x * x), std::abs(p[i] * x * x)), std::max(std::abs(q[i] * x), std::abs(r[i])));
+	  badRoots += (std::abs(((x + p[i]) * x + q[i]) * x + r[i]) > 1e-6 * scale);
+	}
+    }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+  BOOST_CHECK_EQUAL(badRoots, 0);
+}
+
+BOOST_AUTO_TEST_CASE( quartic_nextEvent_batch )
+{
+  //Overlap functions of a sphere and a point, initially apart, with
+  //a constant acceleration which is mostly towards the sphere
+  std::mt19937 RNG(3);
+  std::uniform_real_distribution<> dist(-1, 1);
+  const size_t N = 100000, repeats = 10;
+  std::vector<magnet::intersection::detail::PolynomialFunction<4> > f;
+  std::vector<double> f0char;
+  while (f.size() < N)
+    {
+      const magnet::math::Vector R = magnet::math::Vector{dist(RNG), dist(RNG), dist(RNG)} * 3,
+	V{dist(RNG), dist(RNG), dist(RNG)},
+	A = magnet::math::Vector{dist(RNG), dist(RNG), dist(RNG)} * 0.2 - R * std::abs(dist(RNG)) / R.nrm();
+      const double d = 1 + 0.5 * dist(RNG);
+      if (R.nrm() <= d) continue;
+      f.push_back(magnet::intersection::detail::PolynomialFunction<4>{R.nrm2() - d * d, 2 * (V | R), 2 * (V.nrm2() + (A | R)), 6 * (A | V), 6 * A.nrm2()});
+      f0char.push_back(d * d);
+    }
+
+  std::vector<double> t(N), batchT(N);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t rep(0); rep < repeats; ++rep)
+    for (size_t i(0); i < N; ++i)
+      t[i] = magnet::intersection::detail::nextEvent(f[i], f0char[i]);
+  const double scalar = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (size_t rep(0); rep < repeats; ++rep)
+    magnet::intersection::detail::nextEvent(f.data(), f0char.data(), batchT.data(), N);
+  const double batched = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  BOOST_TEST_MESSAGE("Quartic nextEvent throughput: scalar " << 1e9 * scalar / (N * repeats)
+		     << "ns, batched " << 1e9 * batched / (N * repeats) << "ns per quartic");
+
+  size_t mismatches = 0, events = 0;
+  for (size_t i(0); i < N; ++i)
+    {
+      mismatches += (t[i] != batchT[i]);
+      events += (t[i] != HUGE_VAL);
+    }
+  BOOST_CHECK_EQUAL(mismatches, 0);
+  BOOST_CHECK(events > N / 10);
+
+  //Compare some of the events against a scan for the first root
+  const size_t samples = 2000;
+  for (size_t i(0); i < 1000; ++i)
+    {
+      const double tmax = (t[i] == HUGE_VAL) ? 10 : t[i];
+      double fmin = HUGE_VAL;
+      for (size_t s(0); s < samples; ++s)
+	fmin = std::min(fmin, f[i].eval(tmax * s / samples).front());
+      //The function is positive up to the event
+      BOOST_CHECK(fmin > 0);
+      //and is zero at it
+      if (t[i] != HUGE_VAL)
+	BOOST_CHECK_SMALL(f[i].eval(t[i]).front() / f0char[i], 1e-8);
+    }
+}
@@ -4,7 +4,9 @@
 #include <magnet/intersection/polynomial.hpp>
 #include <magnet/intersection/parabola_sphere.hpp>
 #include <magnet/intersection/offcentre_spheres.hpp>
+#include <magnet/intersection/line_line.hpp>
 #include <magnet/math/matrix.hpp>
+#include <chrono>
 #include <iostream>
 #include <random>
 
@@ -82,3 +84,63 @@ BOOST_AUTO_TEST_CASE( GravitySphere_Test )
       { BOOST_CHECK_CLOSE(radical_root, numerical_root.second, 1e-12); }
   }
 }
+
+BOOST_AUTO_TEST_CASE( LineLine_Events )
+{
+  RNG.seed(5489u);
+  const size_t N = 20000;
+  std::vector<Vector> r(N), v(N), w1(N), w2(N);
+  std::vector<Quaternion> q1(N), q2(N);
+  for (size_t i(0); i < N; ++i)
+    {
+      r[i] = random_unit_vec() * (1 + dist01(RNG));
+      v[i] = random_vec();
+      q1[i] = Quaternion::fromToVector(random_unit_vec());
+      q2[i] = Quaternion::fromToVector(random_unit_vec());
+      //Thin rods have no angular velocity about their own axis
+      const Vector u1 = q1[i] * Quaternion::initialDirector(), u2 = q2[i] * Quaternion::initialDirector();
+      w1[i] = 2 * random_vec();
+      w1[i] -= (w1[i] | u1) * u1;
+      w2[i] = 2 * random_vec();
+      w2[i] -= (w2[i] | u2) * u2;
+    }
+
+  std::vector<std::pair<bool, double> > results(N);
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i(0); i < N; ++i)
+    results[i] = line_line(r[i], v[i], w1[i], w2[i], q1[i], q2[i], 1, false, 10);
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  size_t events = 0;
+  const size_t samples = 200;
+  for (size_t i(0); i < N; ++i)
+    {
+      if (!results[i].first || (results[i].second == HUGE_VAL)) continue;
+      ++events;
+
+      magnet::intersection::detail::LinesOverlapFunc f(r[i], v[i], w1[i], w2[i], q1[i], q2[i], 1);
+      auto streamed = [&](const double t) { magnet::intersection::detail::LinesOverlapFunc ft(f); ft.stream(t); return ft; };
+
+      //The rods must be touching at the event
+      BOOST_CHECK_SMALL(streamed(results[i].second).eval<0>(), 1e-8);
+      BOOST_CHECK(streamed(results[i].second).test_root());
+
+      //Any earlier crossing of the planes of the rods must miss
+      //the rods themselves
+      for (size_t s(1); s < samples; ++s)
+	{
+	  double low = results[i].second * (s - 1) / samples, high = results[i].second * s / samples;
+	  const bool lowsign = std::signbit(streamed(low).eval<0>());
+	  if (lowsign == std::signbit(streamed(high).eval<0>())) continue;
+	  for (size_t j(0); j < 60; ++j)
+	    {
+	      const double mid = 0.5 * (low + high);
+	      if (std::signbit(streamed(mid).eval<0>()) == lowsign) low = mid; else high = mid;
+	    }
+	  BOOST_CHECK(!streamed(0.5 * (low + high)).test_root());
+	}
+    }
+
+  BOOST_CHECK(events > N / 100);
+  BOOST_TEST_MESSAGE("Line-line throughput: " << 1e9 * elapsed / N << "ns per pair (" << events << " events)");
+}
@@ -0,0 +1,83 @@
+#define BOOST_TEST_MODULE MultiTauCorrelator_test
+#include <boost/test/included/unit_test.hpp>
+#include <magnet/math/correlators.hpp>
+#include <random>
+
+using namespace magnet::math;
+
+namespace {
+  struct SquaredDisplacement
+  {
+    double operator()(const double& x1, const double& x2) const
+    { return (x1 - x2) * (x1 - x2); }
+  };
+}
+
+BOOST_AUTO_TEST_CASE( MultiTau_lags )
+{
+  MultiTauCorrelator<double> correlator(8, 2);
+  correlator.resize(std::vector<size_t>(1, 0));
+
+  std::vector<double> value(1, 0);
+  for (size_t i(0); i < 64; ++i)
+    correlator.push(value, SquaredDisplacement());
+
+  //The first level has the lags 0 to 7, every other level adds the
+  //lags 4 to 7 at twice the spacing of the level below.
+  const std::vector<size_t> expected = {0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14, 16, 20, 24, 28, 32, 40, 48, 56};
+  const auto data = correlator.getCorrelator(0);
+  BOOST_REQUIRE_EQUAL(data.size(), expected.size());
+  for (size_t i(0); i < data.size(); ++i)
+    BOOST_CHECK_EQUAL(data[i].lag, expected[i]);
+}
+
+BOOST_AUTO_TEST_CASE( MultiTau_random_walk_MSD )
+{
+  //Compare the MSD of two groups of random walks against a direct
+  //calculation over all time origins at the same sample intervals.
+  const size_t channels = 6, samples = 3000;
+  std::vector<size_t> groups = {0, 1, 0, 1, 0, 1};
+  MultiTauCorrelator<double> correlator(16, 2);
+  correlator.resize(groups);
+
+  std::mt19937 RNG(12);
+  std::normal_distribution<> step(0, 1);
+  std::vector<std::vector<double> > series(channels);
+  std::vector<double> values(channels, 0);
+  for (size_t s(0); s < samples; ++s)
+    {
+      for (size_t c(0); c < channels; ++c)
+	{
+	  values[c] += step(RNG);
+	  series[c].push_back(values[c]);
+	}
+      correlator.push(values, SquaredDisplacement());
+    }
+
+  BOOST_CHECK_EQUAL(correlator.getSampleCount(), samples);
+
+  for (size_t group(0); group < 2; ++group)
+    for (const auto& data : correlator.getCorrelator(group))
+      {
+	//Find the sample interval of the level which holds this lag
+	size_t interval = 1;
+	while ((data.lag % (interval * 2) == 0) && (data.lag / (interval * 2) >= 8))
+	  interval *= 2;
+
+	double sum = 0;
+	size_t origins = 0;
+	for (size_t c(0); c < channels; ++c)
+	  if (groups[c] == group)
+	    {
+	      origins = 0;
+	      for (size_t t(data.lag); t < samples; t += interval)
+		{
+		  sum += (series[c][t] - series[c][t - data.lag]) * (series[c][t] - series[c][t - data.lag]);
+		  ++origins;
+		}
+	    }
+
+	BOOST_CHECK_EQUAL(data.origins, origins);
+	BOOST_CHECK_CLOSE(data.sum, sum, 1e-8);
+      }
+}
@@ -5,6 +5,7 @@
 #include <magnet/intersection/parabola_sphere.hpp>
 #include <magnet/intersection/offcentre_spheres.hpp>
 #include <magnet/math/matrix.hpp>
+#include <chrono>
 #include <iostream>
 #include <random>
 
@@ -98,3 +99,82 @@ BOOST_AUTO_TEST_CASE( OffCentreSphereGrowing_Test )
   std::cout << "f = " << f1.eval(result1.second).front() << "Result1.second = " << result1.second << std::endl;
   
 }
+
+//A random pair of rotating offcentre spheres (dumbbell halves)
+//which starts within the bounding spheres.
+magnet::intersection::detail::OffcentreSpheresOverlapFunction
+random_pair(const double t_max)
+{
+  const Vector rij = random_unit_vec() * (1 + dist01(RNG));
+  return magnet::intersection::detail::OffcentreSpheresOverlapFunction
+    (rij, random_vec(), 2 * random_vec(), 2 * random_vec(), 0.5 * random_unit_vec(), 0.5 * random_unit_vec(), 1, 1, 2, 0, 0, 0, t_max);
+}
+
+BOOST_AUTO_TEST_CASE( OffCentreSphere_BruteForce )
+{
+  RNG.seed(42);
+  const double t_max = 1;
+  const size_t samples = 10000;
+  for (size_t i(0); i < 1000; ++i)
+    {
+      const auto f = random_pair(t_max);
+      if (f.eval<0>(0).front() <= 0) continue;
+
+      //Scan for the first time the spheres touch
+      double root = HUGE_VAL;
+      for (size_t s(1); s <= samples; ++s)
+	if (f.eval<0>(t_max * s / samples).front() <= 0)
+	  {
+	    double low = t_max * (s - 1) / samples, high = t_max * s / samples;
+	    for (size_t j(0); j < 60; ++j)
+	      {
+		const double mid = 0.5 * (low + high);
+		if (f.eval<0>(mid).front() > 0) low = mid; else high = mid;
+	      }
+	    root = high;
+	    break;
+	  }
+
+      const auto result = f.nextEvent();
+      if (root == HUGE_VAL)
+	BOOST_CHECK(result.second >= t_max);
+      else
+	{
+	  BOOST_CHECK(result.first);
+	  BOOST_CHECK_SMALL(result.second - root, 1e-8);
+	}
+    }
+}
+
+BOOST_AUTO_TEST_CASE( OffCentreSphere_Events )
+{
+  RNG.seed(5489u);
+  std::vector<magnet::intersection::detail::OffcentreSpheresOverlapFunction> pairs;
+  for (size_t i(0); i < 20000; ++i)
+    pairs.push_back(random_pair(1));
+
+  std::vector<std::pair<bool, double> > results(pairs.size());
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i(0); i < pairs.size(); ++i)
+    results[i] = pairs[i].nextEvent();
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  size_t events = 0;
+  const size_t samples = 100;
+  for (size_t i(0); i < pairs.size(); ++i)
+    {
+      const auto& f = pairs[i];
+      if ((f.eval<0>(0).front() <= 0) || (results[i].second >= HUGE_VAL)) continue;
+      ++events;
+
+      //The spheres must be touching at the event, and apart before it
+      BOOST_CHECK(results[i].first);
+      BOOST_CHECK_SMALL(f.eval<0>(results[i].second).front(), 1e-8);
+      for (size_t s(0); s < samples; ++s)
+	BOOST_CHECK(f.eval<0>(results[i].second * s / samples).front() > 0);
+    }
+
+  BOOST_CHECK(events > pairs.size() / 100);
+  BOOST_TEST_MESSAGE("Offcentre sphere throughput: " << 1e9 * elapsed / pairs.size()
+		     << "ns per pair (" << events << " events)");
+}
@@ -0,0 +1,72 @@
+#define BOOST_TEST_MODULE Philox_test
+#include <boost/test/included/unit_test.hpp>
+#include <magnet/math/philox.hpp>
+#include <sstream>
+#include <random>
+
+using namespace magnet::math;
+
+BOOST_AUTO_TEST_CASE( Known_answers )
+{
+  //The test vectors of the Random123 library
+  BOOST_CHECK((Philox::generate({{0, 0, 0, 0}}, {{0, 0}}) == Philox::counter_type{{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}}));
+  BOOST_CHECK((Philox::generate({{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}}, {{0xffffffff, 0xffffffff}})
+	       == Philox::counter_type{{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}}));
+  BOOST_CHECK((Philox::generate({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}}, {{0xa4093822, 0x299f31d0}})
+	       == Philox::counter_type{{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}));
+
+  Philox rng;
+  BOOST_CHECK_EQUAL(rng(), 0x6627e8d5u);
+  BOOST_CHECK_EQUAL(rng(), 0xe169c58du);
+}
+
+BOOST_AUTO_TEST_CASE( Jump_ahead )
+{
+  Philox rng(12345, 1, 2, 3);
+  std::vector<uint32_t> values;
+  for (size_t i(0); i < 103; ++i)
+    values.push_back(rng());
+
+  for (size_t start(0); start < values.size(); ++start)
+    {
+      Philox jumped(12345, 1, 2, 3);
+      jumped.discard(start);
+      BOOST_CHECK_EQUAL(jumped.position(), start);
+      BOOST_CHECK_EQUAL(jumped(), values[start]);
+    }
+
+  //Streams differing in any part of the counter or key differ
+  BOOST_CHECK(Philox(12345, 1, 2, 3)() != Philox(12345, 1, 2, 4)());
+  BOOST_CHECK(Philox(12345, 1, 2, 3)() != Philox(12346, 1, 2, 3)());
+}
+
+BOOST_AUTO_TEST_CASE( Save_restore )
+{
+  Philox rng(987654321, 7);
+  for (size_t i(0); i < 6; ++i)
+    rng();
+
+  std::stringstream ss;
+  ss << rng;
+  Philox restored;
+  ss >> restored;
+  BOOST_CHECK(restored == rng);
+  for (size_t i(0); i < 10; ++i)
+    BOOST_CHECK_EQUAL(restored(), rng());
+}
+
+BOOST_AUTO_TEST_CASE( Uniformity )
+{
+  Philox rng(42);
+  std::uniform_real_distribution<> dist;
+  const size_t N = 1000000;
+  double sum = 0, sum2 = 0;
+  for (size_t i(0); i < N; ++i)
+    {
+      const double x = dist(rng);
+      sum += x;
+      sum2 += x * x;
+    }
+  BOOST_CHECK_CLOSE(sum / N, 0.5, 0.5);
+  BOOST_CHECK_CLOSE(sum2 / N, 1.0 / 3.0, 0.5);
+}
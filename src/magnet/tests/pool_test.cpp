@@ -0,0 +1,203 @@
+#define BOOST_TEST_MODULE Pool_test
+#include <boost/test/included/unit_test.hpp>
+#include <boost/pool/pool.hpp>
+#include <magnet/memory/pool.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace magnet::memory;
+
+template<size_t Size>
+struct Pooled: public PoolAllocated
+{
+  char data[Size];
+};
+
+//The pool manager this allocator replaced, a boost::pool per object
+//size behind a single lock
+struct LockedPool
+{
+  LockedPool()
+  {
+    for (size_t i(0); i < MAX_SMALL_OBJECT_SIZE; ++i)
+      pools.push_back(new boost::pool<>(i + 1));
+  }
+
+  ~LockedPool()
+  {
+    for (boost::pool<>* pool : pools)
+      delete pool;
+  }
+
+  void* allocate(size_t size)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pools[size - 1]->malloc();
+  }
+
+  void release(void* ptr, size_t size)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pools[size - 1]->free(ptr);
+  }
+
+  std::mutex mutex;
+  std::vector<boost::pool<>*> pools;
+};
+
+BOOST_AUTO_TEST_CASE( Pool_reuse )
+{
+  //Blocks of every size are distinct and correctly aligned
+  std::vector<std::pair<char*, size_t> > blocks;
+  for (size_t size(1); size <= MAX_SMALL_OBJECT_SIZE; ++size)
+    {
+      char* ptr = static_cast<char*>(detail::allocateMemory(size));
+      BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(ptr) % detail::poolGranularity, 0);
+      std::memset(ptr, int(size % 256), size);
+      blocks.push_back(std::make_pair(ptr, size));
+    }
+
+  size_t corrupt = 0;
+  for (const auto& block : blocks)
+    for (size_t i(0); i < block.second; ++i)
+      corrupt += (block.first[i] != char(block.second % 256));
+  BOOST_CHECK_EQUAL(corrupt, 0);
+
+  //Freed blocks are reused by the next allocation of that size class
+  void* ptr = detail::allocateMemory(40);
+  detail::releaseMemory(ptr, 40);
+  BOOST_CHECK_EQUAL(detail::allocateMemory(33), ptr);
+  detail::releaseMemory(ptr, 33);
+
+  for (const auto& block : blocks)
+    detail::releaseMemory(block.first, block.second);
+
+  //Large allocations fall through to operator new
+  ptr = detail::allocateMemory(MAX_SMALL_OBJECT_SIZE + 1);
+  detail::releaseMemory(ptr, MAX_SMALL_OBJECT_SIZE + 1);
+  detail::releaseMemory(nullptr, 8);
+}
+
+BOOST_AUTO_TEST_CASE( Pool_remote_release )
+{
+  const size_t N = 10000;
+  std::vector<Pooled<24>*> objects;
+
+  //Allocated on one thread, and freed on this one (which has its own
+  //cache) after the producer has exited
+  std::thread producer([&]() {
+      for (size_t i(0); i < N; ++i)
+	objects.push_back(new Pooled<24>);
+    });
+  producer.join();
+
+  for (Pooled<24>* obj : objects)
+    delete obj;
+
+  //The next thread adopts the exited producer's cache, and collects
+  //the blocks freed by this thread before carving new ones
+  std::vector<Pooled<24>*> reused;
+  std::thread adopter([&]() {
+      for (size_t i(0); i < N; ++i)
+	reused.push_back(new Pooled<24>);
+    });
+  adopter.join();
+
+  std::sort(objects.begin(), objects.end());
+  size_t recycled = 0;
+  for (Pooled<24>* obj : reused)
+    recycled += std::binary_search(objects.begin(), objects.end(), obj);
+  BOOST_CHECK_EQUAL(recycled, N);
+
+  for (Pooled<24>* obj : reused)
+    delete obj;
+}
+
+BOOST_AUTO_TEST_CASE( Pool_allocator_containers )
+{
+  std::list<int, PoolAllocator<int> > list;
+  std::unordered_map<size_t, size_t, std::hash<size_t>, std::equal_to<size_t>,
+		     PoolAllocator<std::pair<const size_t, size_t> > > map;
+
+  for (size_t i(0); i < 10000; ++i)
+    {
+      list.push_back(int(i));
+      map[i] = i * i;
+    }
+
+  //The containers are destroyed on a different thread
+  size_t errors = 0;
+  std::thread other([&]() {
+      size_t i = 0;
+      for (int val : list)
+	errors += (size_t(val) != i++);
+      for (const auto& entry : map)
+	errors += (entry.second != entry.first * entry.first);
+      list.clear();
+      map.clear();
+    });
+  other.join();
+  BOOST_CHECK_EQUAL(errors, 0);
+}
+
+//Each thread churns through a working set of small objects, as the
+//event data of a simulation does. Every block is filled with a
+//pattern of its thread and round, which must be intact when it is
+//released (a block handed out twice is overwritten). Returns the
+//time taken and the number of corrupted blocks.
+template<class Alloc, class Release>
+std::pair<double, size_t> contention(size_t threads, Alloc alloc, Release release)
+{
+  const size_t rounds = 200, working = 1000;
+  std::vector<std::thread> workers;
+  std::atomic<size_t> errors(0);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t t(0); t < threads; ++t)
+    workers.push_back(std::thread([&, t]() {
+	  std::vector<std::pair<void*, size_t> > set(working);
+	  for (size_t r(0); r < rounds; ++r)
+	    {
+	      const char tag = static_cast<char>(t * rounds + r);
+	      for (size_t i(0); i < working; ++i)
+		{
+		  const size_t size = 16 + (i * 37) % (MAX_SMALL_OBJECT_SIZE - 16);
+		  set[i] = std::make_pair(alloc(size), size);
+		  std::memset(set[i].first, tag, size);
+		}
+	      for (const auto& block : set)
+		{
+		  const char* data = static_cast<const char*>(block.first);
+		  errors += (std::count(data, data + block.second, tag) != std::ptrdiff_t(block.second));
+		  release(block.first, block.second);
+		}
+	    }
+	}));
+  for (std::thread& worker : workers)
+    worker.join();
+  return std::make_pair(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), size_t(errors));
+}
+
+BOOST_AUTO_TEST_CASE( Pool_contention )
+{
+  LockedPool locked;
+  const size_t threads = std::max(4u, std::thread::hardware_concurrency());
+
+  const std::pair<double, size_t> pooled = contention(threads,
+						       [](size_t size) { return detail::allocateMemory(size); },
+						       [](void* ptr, size_t size) { detail::releaseMemory(ptr, size); });
+  const std::pair<double, size_t> baseline = contention(threads,
+							 [&](size_t size) { return locked.allocate(size); },
+							 [&](void* ptr, size_t size) { locked.release(ptr, size); });
+
+  BOOST_CHECK_EQUAL(pooled.second, 0);
+  BOOST_CHECK_EQUAL(baseline.second, 0);
+  BOOST_TEST_MESSAGE("Contention over " << threads << " threads: thread cached pool "
+		     << pooled.first << "s, locked boost::pool " << baseline.first << "s");
+}
@@ -0,0 +1,126 @@
+#define BOOST_TEST_MODULE RMSD_test
+#include <boost/test/included/unit_test.hpp>
+#include <magnet/math/rmsd.hpp>
+#include <atomic>
+#include <random>
+
+using namespace magnet::math;
+typedef NVector<double, 3> Vec3;
+
+namespace {
+  std::vector<Vec3> randomChain(std::mt19937& RNG, const size_t N)
+  {
+    std::normal_distribution<> dist(0, 1);
+    std::vector<Vec3> chain(1, Vec3{0, 0, 0});
+    for (size_t i(1); i < N; ++i)
+      {
+	Vec3 step{dist(RNG), dist(RNG), dist(RNG)};
+	chain.push_back(chain.back() + step / step.nrm());
+      }
+    return chain;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( RMSD_rotated_copy )
+{
+  std::mt19937 RNG(5);
+  const std::vector<Vec3> a = randomChain(RNG, 40);
+
+  const NMatrix<double,3> rotation = Rodrigues(Vec3{0.3, -1.2, 0.7});
+  std::vector<Vec3> b;
+  for (const Vec3& point : a)
+    b.push_back(rotation * point);
+
+  BOOST_CHECK_SMALL(rotationalRMSD(a, b), 1e-6);
+
+  //The reversed comparison matches a reversed copy
+  std::vector<Vec3> reversed(b.rbegin(), b.rend());
+  BOOST_CHECK_SMALL(rotationalRMSD(a, reversed, true), 1e-6);
+  BOOST_CHECK(rotationalRMSD(a, reversed) > 0.1);
+}
+
+BOOST_AUTO_TEST_CASE( RMSD_scaled_copy )
+{
+  //For b = 2 a the optimal rotation is the identity, leaving an RMSD
+  //of sqrt(sum |a|^2 / N)
+  std::mt19937 RNG(7);
+  const std::vector<Vec3> a = randomChain(RNG, 25);
+  std::vector<Vec3> b;
+  double sum = 0;
+  for (const Vec3& point : a)
+    {
+      b.push_back(point * 2);
+      sum += point.nrm2();
+    }
+
+  BOOST_CHECK_CLOSE(rotationalRMSD(a, b), std::sqrt(sum / a.size()), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( ContactMap_overlap )
+{
+  //Compare the bit-packed overlap against the direct sums over the
+  //dense contact maps
+  std::mt19937 RNG(11);
+  const size_t N = 30;
+  const double distance = 2.0;
+
+  for (size_t skip(0); skip < 3; ++skip)
+    {
+      const std::vector<Vec3> a = randomChain(RNG, N), b = randomChain(RNG, N);
+      const ContactMap ca(a, distance), cb(b, distance);
+
+      double norm1 = 0, norm2 = 0, common = 0;
+      for (size_t i(0); i < N; ++i)
+	for (size_t j(i + 1); j < N; ++j)
+	  {
+	    const bool c1 = (a[i] - a[j]).nrm() <= distance, c2 = (b[i] - b[j]).nrm() <= distance;
+	    BOOST_CHECK_EQUAL(ca(i, j), c1);
+	    BOOST_CHECK_EQUAL(ca(j, i), c1);
+	    if (j >= i + 1 + skip)
+	      {
+		norm1 += c1;
+		norm2 += c2;
+		common += c1 && c2;
+	      }
+	  }
+
+      const std::vector<uint64_t> mask = ContactMap::mask(N, skip);
+      BOOST_CHECK_CLOSE(ContactMap::overlap(ca, cb, mask), common / (std::sqrt(norm1) * std::sqrt(norm2)), 1e-10);
+      BOOST_CHECK_CLOSE(ContactMap::overlap(ca, ca, mask), 1.0, 1e-10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( ForEachPair_visits_all_pairs )
+{
+  const size_t N = 101;
+  std::vector<std::atomic<size_t> > visits(N * N);
+  for (auto& val : visits) val = 0;
+
+  magnet::thread::ThreadPool pool;
+  pool.setThreadCount(4);
+  forEachPair(N, pool, [&](size_t i, size_t j) { ++visits[i * N + j]; }, 16);
+
+  for (size_t i(0); i < N; ++i)
+    for (size_t j(0); j < N; ++j)
+      BOOST_CHECK_EQUAL(visits[i * N + j], (i < j) ? 1u : 0u);
+}
+
+BOOST_AUTO_TEST_CASE( GreedyClusters )
+{
+  //Two groups of items {0,2,4,6,8,10} and {1,3,5,7}, with item 9
+  //alone. Only the first group exceeds a threshold of 4.
+  auto group = [](size_t i) { return (i == 9) ? 2 : (i % 2); };
+  const std::vector<Cluster> clusters = greedyClusters(11, [&](size_t i, size_t j) { return group(i) == group(j); }, 4);
+
+  BOOST_REQUIRE_EQUAL(clusters.size(), 1u);
+  BOOST_CHECK_EQUAL(clusters[0].centre, 10u);
+  const std::vector<size_t> expected = {0, 2, 4, 6, 8, 10};
+  BOOST_CHECK_EQUAL_COLLECTIONS(clusters[0].members.begin(), clusters[0].members.end(), expected.begin(), expected.end());
+
+  //Lowering the threshold also admits the second group, the
+  //centres are the items with the lexicographically largest lists
+  const std::vector<Cluster> clusters2 = greedyClusters(11, [&](size_t i, size_t j) { return group(i) == group(j); }, 3);
+  BOOST_REQUIRE_EQUAL(clusters2.size(), 2u);
+  BOOST_CHECK_EQUAL(clusters2[1].centre, 7u);
+  BOOST_CHECK_EQUAL(clusters2[1].members.size(), 4u);
+}
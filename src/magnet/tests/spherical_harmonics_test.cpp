@@ -0,0 +1,96 @@
+#define BOOST_TEST_MODULE SphericalHarmonics_test
+#include <boost/test/included/unit_test.hpp>
+#include <boost/math/special_functions/spherical_harmonic.hpp>
+#include <magnet/math/spherical_harmonics.hpp>
+#include <magnet/math/matrix.hpp>
+#include <random>
+
+using namespace magnet::math;
+typedef NVector<double, 3> Vec3;
+typedef std::complex<double> Complex;
+
+BOOST_AUTO_TEST_CASE( SphericalHarmonics_match_boost )
+{
+  const size_t L = 13;
+  SphericalHarmonics harmonics(L);
+  std::vector<Complex> Y(harmonics.size());
+
+  std::mt19937 RNG(3);
+  std::normal_distribution<> dist(0, 1);
+  for (size_t sample(0); sample < 50; ++sample)
+    {
+      Vec3 dir{dist(RNG), dist(RNG), dist(RNG)};
+      dir /= dir.nrm();
+      harmonics.evaluate(dir, Y.data());
+
+      const double theta = std::acos(dir[2]), phi = std::atan2(dir[1], dir[0]);
+      for (int l(0); l < int(L); ++l)
+	for (int m(-l); m <= l; ++m)
+	  {
+	    const Complex expected = boost::math::spherical_harmonic(l, m, theta, phi);
+	    BOOST_CHECK_SMALL(std::abs(Y[SphericalHarmonics::index(l, m)] - expected), 1e-10);
+	  }
+    }
+
+  //The poles, where the azimuth is undefined
+  harmonics.evaluate(Vec3{0, 0, -1}, Y.data());
+  for (int l(0); l < int(L); ++l)
+    for (int m(-l); m <= l; ++m)
+      BOOST_CHECK_SMALL(std::abs(Y[SphericalHarmonics::index(l, m)] - boost::math::spherical_harmonic(l, m, M_PI, 0.0)), 1e-10);
+}
+
+namespace {
+  //The averaged harmonics of a set of bonds
+  std::vector<Complex> average(const SphericalHarmonics& harmonics, const std::vector<Vec3>& bonds)
+  {
+    std::vector<Complex> sum(harmonics.size()), Y(harmonics.size());
+    for (const Vec3& bond : bonds)
+      {
+	harmonics.evaluate(bond / bond.nrm(), Y.data());
+	for (size_t i(0); i < sum.size(); ++i)
+	  sum[i] += Y[i] / double(bonds.size());
+      }
+    return sum;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Steinhardt_fcc )
+{
+  //The 12 nearest neighbours of the face centred cubic lattice
+  std::vector<Vec3> bonds;
+  for (int a : {-1, 1})
+    for (int b : {-1, 1})
+      {
+	bonds.push_back(Vec3{double(a), double(b), 0});
+	bonds.push_back(Vec3{double(a), 0, double(b)});
+	bonds.push_back(Vec3{0, double(a), double(b)});
+      }
+
+  SphericalHarmonics harmonics(7);
+  const std::vector<Complex> q = average(harmonics, bonds);
+  BOOST_CHECK_CLOSE(steinhardtQ(4, &q[SphericalHarmonics::index(4, -4)]), 0.190941, 1e-3);
+  BOOST_CHECK_CLOSE(steinhardtQ(6, &q[SphericalHarmonics::index(6, -6)]), 0.574524, 1e-3);
+  BOOST_CHECK_CLOSE(SteinhardtW(6)(&q[SphericalHarmonics::index(6, -6)]), -0.013161, 1e-2);
+  BOOST_CHECK_CLOSE(SteinhardtW(4)(&q[SphericalHarmonics::index(4, -4)]), -0.159317, 1e-2);
+}
+
+BOOST_AUTO_TEST_CASE( Steinhardt_sc_rotated )
+{
+  //The 6 nearest neighbours of the simple cubic lattice. The
+  //invariants do not depend on the orientation of the lattice.
+  const NMatrix<double,3> rotation = Rodrigues(Vec3{0.4, 0.9, -0.3});
+  std::vector<Vec3> bonds;
+  for (size_t i(0); i < 3; ++i)
+    for (double sign : {-1.0, 1.0})
+      {
+	Vec3 bond{0, 0, 0};
+	bond[i] = sign;
+	bonds.push_back(rotation * bond);
+      }
+
+  SphericalHarmonics harmonics(7);
+  const std::vector<Complex> q = average(harmonics, bonds);
+  BOOST_CHECK_CLOSE(steinhardtQ(4, &q[SphericalHarmonics::index(4, -4)]), 0.763763, 1e-3);
+  BOOST_CHECK_CLOSE(steinhardtQ(6, &q[SphericalHarmonics::index(6, -6)]), 0.353553, 1e-3);
+  BOOST_CHECK_CLOSE(SteinhardtW(6)(&q[SphericalHarmonics::index(6, -6)]), 0.013161, 1e-2);
+}
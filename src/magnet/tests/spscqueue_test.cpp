@@ -0,0 +1,73 @@
+#define BOOST_TEST_MODULE SPSCQueue_test
+#include <boost/test/included/unit_test.hpp>
+#include <magnet/thread/spscQueue.hpp>
+#include <thread>
+
+using namespace magnet::thread;
+
+BOOST_AUTO_TEST_CASE( SPSCQueue_capacity )
+{
+  SPSCQueue<int> queue(5);
+  BOOST_CHECK_EQUAL(queue.capacity(), 8);
+  BOOST_CHECK(queue.empty());
+
+  for (int i = 0; i < 8; ++i)
+    BOOST_CHECK(queue.push(i));
+
+  //The queue is full
+  BOOST_CHECK(!queue.push(8));
+  BOOST_CHECK(!queue.empty());
+
+  int val;
+  for (int i = 0; i < 8; ++i)
+    {
+      BOOST_CHECK(queue.pop(val));
+      BOOST_CHECK_EQUAL(val, i);
+    }
+
+  BOOST_CHECK(!queue.pop(val));
+  BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE( SPSCQueue_wraparound )
+{
+  SPSCQueue<int> queue(4);
+  int val;
+  for (int i = 0; i < 100; ++i)
+    {
+      BOOST_CHECK(queue.push(i));
+      BOOST_CHECK(queue.push(-i));
+      BOOST_CHECK(queue.pop(val));
+      BOOST_CHECK_EQUAL(val, i);
+      BOOST_CHECK(queue.pop(val));
+      BOOST_CHECK_EQUAL(val, -i);
+    }
+  BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE( SPSCQueue_threaded )
+{
+  const size_t N = 1000000;
+  SPSCQueue<size_t> queue(64);
+
+  size_t errors = 0;
+  std::thread consumer([&]() {
+      size_t val;
+      for (size_t expected = 0; expected < N; )
+	if (queue.pop(val))
+	  {
+	    errors += (val != expected);
+	    ++expected;
+	  }
+	else
+	  std::this_thread::yield();
+    });
+
+  for (size_t i = 0; i < N; ++i)
+    while (!queue.push(i))
+      std::this_thread::yield();
+
+  consumer.join();
+  BOOST_CHECK_EQUAL(errors, 0);
+  BOOST_CHECK(queue.empty());
+}
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <vector>
 #include <stdexcept>
+#include <atomic>
 #include <magnet/thread/threadpool.hpp>
 
 std::vector<float> sums;
@@ -33,6 +34,105 @@ struct A
   { std::cerr << "Inside memberfunc3, i=" << i << ", j=" << j << "\n"; }
 };
 
+void check(bool test, const char* what)
+{
+  if (!test)
+    {
+      std::cerr << "Failure: " << what << "\n";
+      throw std::runtime_error(what);
+    }
+}
+
+//Futures, continuations, nested loops and reductions, for a pool of
+//the given size
+void testPool(size_t threads)
+{
+  magnet::thread::ThreadPool pool;
+  pool.setThreadCount(threads);
+
+  //Futures return results and exceptions
+  std::future<int> answer = pool.submit([]() { return 42; });
+  check(answer.get() == 42, "submit() result");
+
+  std::future<int> failure = pool.submit([]() -> int { throw std::runtime_error("expected"); });
+  bool caught = false;
+  try { failure.get(); } catch (std::runtime_error&) { caught = true; }
+  check(caught, "submit() exception");
+
+  //Continuations receive the future of the earlier task
+  std::shared_future<int> first = pool.submit([]() { return 20; }).share();
+  std::future<int> second = pool.then(first, [](std::shared_future<int> f) { return f.get() + 1; });
+  check(second.get() == 21, "then() result");
+
+  //Every index of a loop is visited exactly once, including in loops
+  //nested inside the tasks of the same pool
+  const size_t N = 10000;
+  std::vector<std::atomic<size_t> > visits(N);
+  for (auto& v : visits) v = 0;
+  pool.parallel_for(0, 100, [&](size_t outer) {
+      pool.parallel_for(outer * (N / 100), (outer + 1) * (N / 100), [&](size_t i) { ++visits[i]; }, 7);
+    }, 1);
+  for (const auto& v : visits)
+    check(v == 1, "nested parallel_for visits");
+
+  //Nested futures are waited for without deadlocking the pool
+  std::vector<std::future<size_t> > outer;
+  for (size_t i(0); i < 20; ++i)
+    outer.push_back(pool.submit([&pool, i]() {
+	  std::future<size_t> inner = pool.submit([i]() { return i * i; });
+	  pool.wait(inner);
+	  return inner.get();
+	}));
+  for (size_t i(0); i < outer.size(); ++i)
+    {
+      pool.wait(outer[i]);
+      check(outer[i].get() == i * i, "nested submit() result");
+    }
+
+  //Reductions are combined in order, so are independent of the
+  //number of threads
+  const double sum = pool.parallel_reduce(0, N, 0.0,
+					  [](size_t i, double& acc) { acc += 1.0 / (i + 1); },
+					  [](double a, double b) { return a + b; }, 64);
+  double expected = 0;
+  for (size_t chunk(0); chunk < N; chunk += 64)
+    {
+      double partial = 0;
+      for (size_t i(chunk); i < std::min(N, chunk + 64); ++i)
+	partial += 1.0 / (i + 1);
+      expected += partial;
+    }
+  check(sum == expected, "parallel_reduce result");
+
+  //The first exception of a loop is rethrown in the caller
+  caught = false;
+  try {
+    pool.parallel_for(0, 1000, [](size_t i) { if (i == 500) throw std::runtime_error("expected"); });
+  } catch (std::runtime_error&) { caught = true; }
+  check(caught, "parallel_for exception");
+
+  //Exceptions of queued tasks are reported by wait()
+  pool.queueTask([]() { throw std::runtime_error("expected"); });
+  caught = false;
+  try { pool.wait(); } catch (std::exception&) { caught = true; }
+  check(caught, "queueTask() exception");
+  pool.wait();
+}
+
+//A single threaded pool runs the tasks from outside the pool in order
+void testOrdering()
+{
+  magnet::thread::ThreadPool pool;
+  pool.setThreadCount(1);
+  std::vector<size_t> order;
+  for (size_t i(0); i < 1000; ++i)
+    pool.queueTask([&order, i]() { order.push_back(i); });
+  pool.wait();
+  for (size_t i(0); i < order.size(); ++i)
+    check(order[i] == i, "single thread task order");
+  check(order.size() == 1000, "single thread task count");
+}
+
 int main()
 {
   int N = 1000;
@@ -94,6 +194,11 @@ int main()
 	}
     }
 
+  testPool(0);
+  testPool(1);
+  testPool(4);
+  testOrdering();
+
   std::cerr << "Finished\n";
 
   return 0;
@@ -0,0 +1,126 @@
+#define BOOST_TEST_MODULE VTK_test
+#include <boost/test/included/unit_test.hpp>
+#include <magnet/vtk.hpp>
+#include <magnet/string/base64.hpp>
+#include <cstring>
+
+using namespace magnet;
+
+namespace {
+  //! \brief The contents of the AppendedData element of a file, after the "_".
+  std::string appendedSection(xml::XmlStream& XML)
+  {
+    const std::string file = static_cast<std::stringstream&>(XML.getUnderlyingStream()).str();
+    const size_t start = file.find('_', file.find("<AppendedData")) + 1;
+    return file.substr(start, file.rfind("\n", file.find("</AppendedData>")) - start);
+  }
+
+  std::string writeArray(vtk::ArrayWriter& writer, const std::vector<float>& values, size_t& offset)
+  {
+    xml::XmlStream XML;
+    XML << xml::tag("VTKFile");
+    writer.dataArray(XML, "test", 1, values);
+    writer.appendedData(XML);
+    XML << xml::endtag("VTKFile");
+    const std::string file = static_cast<std::stringstream&>(XML.getUnderlyingStream()).str();
+    BOOST_REQUIRE(file.find("format=\"appended\"") != std::string::npos);
+    offset = std::stoul(file.substr(file.find("offset=\"") + 8));
+    return appendedSection(XML);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( base64_vectors )
+{
+  //The test vectors of RFC 4648
+  BOOST_CHECK_EQUAL(string::base64_encode("", 0), "");
+  BOOST_CHECK_EQUAL(string::base64_encode("f", 1), "Zg==");
+  BOOST_CHECK_EQUAL(string::base64_encode("fo", 2), "Zm8=");
+  BOOST_CHECK_EQUAL(string::base64_encode("foo", 3), "Zm9v");
+  BOOST_CHECK_EQUAL(string::base64_encode("foob", 4), "Zm9vYg==");
+  BOOST_CHECK_EQUAL(string::base64_encode("fooba", 5), "Zm9vYmE=");
+  BOOST_CHECK_EQUAL(string::base64_encode("foobar", 6), "Zm9vYmFy");
+  BOOST_CHECK_EQUAL(string::base64_length(6), 8u);
+  BOOST_CHECK_EQUAL(string::base64_length(7), 12u);
+}
+
+BOOST_AUTO_TEST_CASE( raw_appended_array )
+{
+  const std::vector<float> values = {1.5f, -2.0f, 3.25f};
+  vtk::ArrayWriter writer(vtk::ArrayWriter::RAW, false);
+  size_t offset;
+  const std::string data = writeArray(writer, values, offset);
+  BOOST_CHECK_EQUAL(offset, 0u);
+  BOOST_REQUIRE_EQUAL(data.size(), sizeof(uint64_t) + sizeof(float) * values.size());
+
+  uint64_t header;
+  std::memcpy(&header, data.data(), sizeof(header));
+  BOOST_CHECK_EQUAL(header, sizeof(float) * values.size());
+  BOOST_CHECK(!std::memcmp(data.data() + sizeof(header), values.data(), sizeof(float) * values.size()));
+}
+
+BOOST_AUTO_TEST_CASE( base64_appended_array )
+{
+  //The header and the data are encoded separately
+  const std::vector<float> values = {1.5f, -2.0f, 3.25f, 7.0f};
+  vtk::ArrayWriter writer(vtk::ArrayWriter::BASE64, false);
+  size_t offset;
+  const std::string data = writeArray(writer, values, offset);
+  const uint64_t header = sizeof(float) * values.size();
+  BOOST_CHECK_EQUAL(data, string::base64_encode(&header, sizeof(header))
+		    + string::base64_encode(values.data(), header));
+}
+
+#ifdef DYNAMO_zlib_support
+BOOST_AUTO_TEST_CASE( compressed_appended_array )
+{
+  std::vector<float> values(10000);
+  for (size_t i(0); i < values.size(); ++i)
+    values[i] = i % 17;
+
+  thread::ThreadPool pool;
+  pool.setThreadCount(3);
+  const size_t blockSize = 4096;
+  vtk::ArrayWriter writer(vtk::ArrayWriter::RAW, true, &pool, 6, blockSize);
+  size_t offset;
+  const std::string data = writeArray(writer, values, offset);
+
+  //Header: number of blocks, block size, last block size, and the
+  //compressed size of each block
+  const size_t bytes = sizeof(float) * values.size();
+  const size_t nblocks = (bytes + blockSize - 1) / blockSize;
+  std::vector<uint64_t> header(3 + nblocks);
+  std::memcpy(header.data(), data.data(), header.size() * sizeof(uint64_t));
+  BOOST_REQUIRE_EQUAL(header[0], nblocks);
+  BOOST_CHECK_EQUAL(header[1], blockSize);
+  BOOST_CHECK_EQUAL(header[2], bytes % blockSize);
+
+  std::vector<char> decompressed;
+  size_t pos = header.size() * sizeof(uint64_t);
+  for (size_t block(0); block < nblocks; ++block)
+    {
+      std::vector<char> out(blockSize);
+      uLongf size = out.size();
+      BOOST_REQUIRE_EQUAL(uncompress(reinterpret_cast<Bytef*>(out.data()), &size,
+				     reinterpret_cast<const Bytef*>(data.data() + pos), header[3 + block]), Z_OK);
+      decompressed.insert(decompressed.end(), out.begin(), out.begin() + size);
+      pos += header[3 + block];
+    }
+  BOOST_CHECK_EQUAL(pos, data.size());
+  BOOST_REQUIRE_EQUAL(decompressed.size(), bytes);
+  BOOST_CHECK(!std::memcmp(decompressed.data(), values.data(), bytes));
+}
+#endif
+
+BOOST_AUTO_TEST_CASE( ascii_array )
+{
+  vtk::ArrayWriter writer(vtk::ArrayWriter::ASCII, false);
+  xml::XmlStream XML;
+  XML << xml::tag("VTKFile");
+  writer.dataArray(XML, "test", 2, std::vector<int32_t>{1, 2, 3, 4});
+  writer.appendedData(XML);
+  XML << xml::endtag("VTKFile");
+  const std::string file = static_cast<std::stringstream&>(XML.getUnderlyingStream()).str();
+  BOOST_CHECK(file.find("format=\"ascii\"") != std::string::npos);
+  BOOST_CHECK(file.find("1 2\n3 4\n") != std::string::npos);
+  BOOST_CHECK(file.find("AppendedData") == std::string::npos);
+}